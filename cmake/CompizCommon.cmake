@@ -33,6 +33,13 @@ option (COMPIZ_PACKAGING_ENABLED "Enable to manually set prefix, exec_prefix, li
 option (COMPIZ_BUILD_TESTING "Build Unit Tests" ON)
 option (BUILD_XORG_GTEST "Build Xorg GTest integration tests" ON)
 
+# Changes the layout of every WrapableHandler, so core and all plugins
+# have to be built with the same setting
+option (COMPIZ_WRAPSYSTEM_STATS "Count calls and nesting depth of wrapped functions" OFF)
+if (COMPIZ_WRAPSYSTEM_STATS)
+    add_definitions (-DCOMPIZ_WRAPSYSTEM_STATS)
+endif ()
+
 set (COMPIZ_DATADIR ${CMAKE_INSTALL_PREFIX}/share)
 set (COMPIZ_METADATADIR ${CMAKE_INSTALL_PREFIX}/share/compiz)
 set (COMPIZ_IMAGEDIR ${CMAKE_INSTALL_PREFIX}/share/compiz/images)
@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_INPUTLATENCY_H
+#define _COMPIZ_INPUTLATENCY_H
+
+namespace compiz
+{
+namespace core
+{
+
+/**
+ * How long input events of one type took to show on screen. An event
+ * is followed from the time its server timestamp says it was
+ * generated, or from when compiz read it if that time is unknown,
+ * to the return from the buffer swap of the first frame painted with
+ * damage added after it. All times are in microseconds.
+ */
+struct InputLatency
+{
+    /* Bucket 0 holds latencies below 1ms, bucket i those from
+     * 2^(i - 1)ms up to 2^i ms and the last one everything longer */
+    static const unsigned int Buckets = 12;
+
+    /* The X event type, KeyPress, ButtonPress, MotionNotify... */
+    int type;
+
+    /* Events followed to a swap and events given up on because
+     * nothing was damaged within a second of them */
+    unsigned int events;
+    unsigned int unseen;
+
+    unsigned int averageLatency;
+    unsigned int worstLatency;
+
+    /* The part of the latency the event spent before compiz read it */
+    unsigned int averageDelivery;
+
+    unsigned int histogram[Buckets];
+};
+
+}
+}
+
+#endif
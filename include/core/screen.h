@@ -37,6 +37,7 @@
 #include <core/region.h>
 #include <core/modifierhandler.h>
 #include <core/valueholder.h>
+#include <core/inputlatency.h>
 
 #include <boost/scoped_ptr.hpp>
 
@@ -321,6 +322,9 @@ public:
     virtual int screenNum () = 0;
     virtual void unhookServerWindow (CompWindow *w) = 0;
     virtual void unhookWindow (CompWindow *w) = 0;
+    virtual void updateFrameWindows (CompWindow *w,
+				     Window     oldFrame,
+				     Window     oldServerFrame) = 0;
     virtual void viewportForGeometry (const CompWindow::Geometry &gm,
 				  CompPoint                   &viewport) = 0;
 
@@ -347,6 +351,26 @@ public:
     virtual void updateSupportedWmHints () = 0;
 
     virtual CompWindowList & destroyedWindows () = 0;
+
+    /* The windows bottom to top with the destroyed ones still
+     * being painted in between, each right below the window it was
+     * stacked under. Kept up to date as the stack changes, while
+     * frozen changes to the order wait until it is thawed. Calls
+     * nest, the generation changes whenever the order does */
+    virtual const CompWindowList & windowPaintOrder () = 0;
+    virtual unsigned int windowPaintOrderGeneration () = 0;
+    virtual void freezeWindowPaintOrder () = 0;
+    virtual void thawWindowPaintOrder () = 0;
+
+    /* Appends the windows whose output rect intersects rect or
+     * contains point, in no particular order. Destroyed windows are
+     * included until they are deleted. updateWindowOutputRect is
+     * called by core whenever it sends a move or resize notify */
+    virtual void updateWindowOutputRect (CompWindow *w) = 0;
+    virtual void findWindowsInRect (const CompRect &rect,
+				    CompWindowVector &windows) = 0;
+    virtual void findWindowsAt (const CompPoint  &point,
+				CompWindowVector &windows) = 0;
     virtual const CompRegion & region () const = 0;
     virtual bool hasOverlappingOutputs () = 0;
     virtual CompOutput & fullscreenOutput () = 0;
@@ -396,6 +420,28 @@ public:
     virtual void processEvents () = 0;
     virtual void alwaysHandleEvent (XEvent *event) = 0;
 
+    /* Events of this type are handed to handleEvent one by one
+     * instead of being merged with later ones, calls nest */
+    virtual void inhibitEventCoalescing (int type) = 0;
+    virtual void uninhibitEventCoalescing (int type) = 0;
+
+    /* Events read from the server and events passed to
+     * alwaysHandleEvent since startup */
+    virtual void eventCounts (unsigned long long &received,
+			      unsigned long long &dispatched) = 0;
+
+    /* Key and pointer events are followed until a frame shows them,
+     * see core/inputlatency.h. Compositing plugins report damage, the
+     * point from which a frame takes no more damage and the return
+     * from its buffer swap */
+    virtual void inputLatencyDamaged () = 0;
+    virtual void inputLatencyCutoff () = 0;
+    virtual void inputLatencyPresented () = 0;
+
+    /* One entry for each traced event type */
+    virtual void inputLatencyStatistics (std::vector<compiz::core::InputLatency> &) = 0;
+    virtual void resetInputLatencyStatistics () = 0;
+
     virtual ServerGrabInterface * serverGrabInterface () = 0;
 
     // Replacements for friends accessing priv. They are declared virtual to
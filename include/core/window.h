@@ -593,6 +593,7 @@ class CompWindow :
 	friend class ModifierHandler;
 	friend class CoreWindow;
 	friend class StackDebugger;
+	friend class PrivateMatch;
 
     private:
 
@@ -56,8 +56,28 @@
    {							\
        mCurrFunction[num] = index;			\
    }                                                    \
+   bool func ## Wrapped () const			\
+   {							\
+       return functionWrapped (num);			\
+   }							\
    enum { func ## Index = num };
 
+#ifdef COMPIZ_WRAPSYSTEM_STATS
+#define WRAPABLE_HND_STATS_CALL(num)					\
+    if (!mDepth[num])							\
+	++mStats[num].calls;
+#define WRAPABLE_HND_STATS_ENTER(num)					\
+    ++mStats[num].hops;							\
+    if (++mDepth[num] > mStats[num].maxDepth)				\
+	mStats[num].maxDepth = mDepth[num];
+#define WRAPABLE_HND_STATS_LEAVE(num)					\
+    --mDepth[num];
+#else
+#define WRAPABLE_HND_STATS_CALL(num)
+#define WRAPABLE_HND_STATS_ENTER(num)
+#define WRAPABLE_HND_STATS_LEAVE(num)
+#endif
+
 // For compatability ignore num and forward
 #define WRAPABLE_HND_FUNC(num, func, ...)				\
     WRAPABLE_HND_FUNCTN(func, __VA_ARGS__)
@@ -67,16 +87,20 @@
 {									\
     enum { num = func ## Index };                                       \
     unsigned int curr = mCurrFunction[num];				\
-    while (mCurrFunction[num] < mInterface.size () &&			\
-           !mInterface[mCurrFunction[num]].enabled[num])		\
-	++mCurrFunction[num];						\
-    if (mCurrFunction[num] < mInterface.size ())			\
+    WRAPABLE_HND_STATS_CALL (num)					\
+    if (curr < mInterface.size ())					\
     {									\
-	mInterface[mCurrFunction[num]++].obj-> func (__VA_ARGS__);	\
-	mCurrFunction[num] = curr;					\
-	return;								\
+	Link link = mChain[num * (mInterface.size () + 1) + curr];	\
+	if (link.obj)							\
+	{								\
+	    WRAPABLE_HND_STATS_ENTER (num)				\
+	    mCurrFunction[num] = link.next;				\
+	    link.obj-> func (__VA_ARGS__);				\
+	    mCurrFunction[num] = curr;					\
+	    WRAPABLE_HND_STATS_LEAVE (num)				\
+	    return;							\
+	}								\
     }									\
-    mCurrFunction[num] = curr;						\
 }
 
 // For compatability ignore num and forward
@@ -88,16 +112,20 @@
 {									\
     enum { num = func ## Index };                                       \
     unsigned int curr = mCurrFunction[num];				\
-    while (mCurrFunction[num] < mInterface.size () &&			\
-           !mInterface[mCurrFunction[num]].enabled[num])		\
-	++mCurrFunction[num];						\
-    if (mCurrFunction[num] < mInterface.size ())			\
+    WRAPABLE_HND_STATS_CALL (num)					\
+    if (curr < mInterface.size ())					\
     {									\
-	rtype rv = mInterface[mCurrFunction[num]++].obj-> func (__VA_ARGS__); \
-	mCurrFunction[num] = curr;					\
-	return rv;							\
+	Link link = mChain[num * (mInterface.size () + 1) + curr];	\
+	if (link.obj)							\
+	{								\
+	    WRAPABLE_HND_STATS_ENTER (num)				\
+	    mCurrFunction[num] = link.next;				\
+	    rtype rv = link.obj-> func (__VA_ARGS__);			\
+	    mCurrFunction[num] = curr;					\
+	    WRAPABLE_HND_STATS_LEAVE (num)				\
+	    return rv;							\
+	}								\
     }									\
-    mCurrFunction[num] = curr;						\
 }
 
 template <typename T, typename T2>
@@ -130,6 +158,22 @@ class WrapableHandler : public T
 
 	unsigned int numWrapClients () { return mInterface.size (); }
 
+#ifdef COMPIZ_WRAPSYSTEM_STATS
+	struct DispatchStats
+	{
+	    DispatchStats () : calls (0), hops (0), maxDepth (0) {}
+
+	    unsigned long calls;    /* outermost calls into the handler */
+	    unsigned long hops;     /* wrapper functions invoked */
+	    unsigned int  maxDepth; /* deepest nesting of wrappers seen */
+	};
+
+	const DispatchStats & dispatchStats (unsigned int num) const
+	{
+	    return mStats[num];
+	}
+#endif
+
     protected:
 
 	struct Interface
@@ -143,26 +187,59 @@ class WrapableHandler : public T
             bool enabled[N];
 	};
 
+	/* For every function and every position in mInterface, the
+	 * first interface at or after that position which has the
+	 * function enabled, and the position after it. A NULL obj
+	 * means no wrapper is left and the handler runs its own code */
+	struct Link
+	{
+	    T            *obj;
+	    unsigned int next;
+	};
+
 	WrapableHandler () : mInterface ()
 	{
             std::fill_n(mCurrFunction, N, 0);
+#ifdef COMPIZ_WRAPSYSTEM_STATS
+            std::fill_n(mDepth, N, 0);
+#endif
+	    rebuildChains ();
         }
 
 	~WrapableHandler ()
 	{
 	    mInterface.clear ();
+	    mChain.clear ();
         }
 
 	void functionSetEnabled (T *, unsigned int, bool);
 
+	/* Whether any plugin has function num enabled */
+	bool functionWrapped (unsigned int num) const
+	{
+	    return mChain[num * (mInterface.size () + 1)].obj != NULL;
+	}
+
         mutable unsigned int mCurrFunction[N];
         std::vector<Interface> mInterface;
+	std::vector<Link>      mChain;
+
+#ifdef COMPIZ_WRAPSYSTEM_STATS
+	mutable unsigned int  mDepth[N];
+	mutable DispatchStats mStats[N];
+#endif
+
+    private:
+
+	void rebuildChain (unsigned int);
+	void rebuildChains ();
 };
 
 template <typename T, unsigned int N>
 void WrapableHandler<T,N>::registerWrap (T *obj, bool enabled)
 {
     mInterface.insert (mInterface.begin (), Interface(obj, enabled));
+    rebuildChains ();
 }
 
 template <typename T, unsigned int N>
@@ -174,6 +251,7 @@ void WrapableHandler<T,N>::unregisterWrap (T *obj)
 	if (it->obj == obj)
 	{
 	    mInterface.erase (it);
+	    rebuildChains ();
 	    break;
 	}
     }
@@ -188,10 +266,44 @@ void WrapableHandler<T,N>::functionSetEnabled (T *obj, unsigned int num,
     {
 	if (it->obj == obj)
 	{
-	    it->enabled[num] = enabled;
+	    if (it->enabled[num] != enabled)
+	    {
+		it->enabled[num] = enabled;
+		rebuildChain (num);
+	    }
 	    break;
 	}
     }
 }
 
+template <typename T, unsigned int N>
+void WrapableHandler<T,N>::rebuildChain (unsigned int num)
+{
+    unsigned int size = mInterface.size ();
+    Link         *chain = &mChain[num * (size + 1)];
+    Link         link = { NULL, size };
+
+    chain[size] = link;
+
+    for (unsigned int i = size; i-- > 0;)
+    {
+	if (mInterface[i].enabled[num])
+	{
+	    link.obj = mInterface[i].obj;
+	    link.next = i + 1;
+	}
+
+	chain[i] = link;
+    }
+}
+
+template <typename T, unsigned int N>
+void WrapableHandler<T,N>::rebuildChains ()
+{
+    mChain.resize (N * (mInterface.size () + 1));
+
+    for (unsigned int num = 0; num < N; ++num)
+	rebuildChain (num);
+}
+
 #endif
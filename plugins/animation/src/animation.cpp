@@ -1360,15 +1360,10 @@ PrivateAnimScreen::preparePaint (int msSinceLastPaint)
 	CompWindowList       windowsFinishedAnimations;
 
 	struct timeval curTime;
-	gettimeofday (&curTime, 0);
+	timer::monotonic_time (&curTime);
 
 	if (mLastRedrawTimeFresh)
-	{
 	    msSinceLastPaintActual = timer::timeval_diff (&curTime, &mLastRedrawTime);
-	    // handle clock rollback
-	    if (msSinceLastPaintActual < 0)
-		msSinceLastPaintActual = 0;
-	}
 	else
 	    msSinceLastPaintActual = 20; // assume 20 ms passed
 
@@ -1370,6 +1370,9 @@ BlurWindow::updateDstTexture (const GLMatrix &transform,
 
     filter = bScreen->optionGetFilter ();
 
+    /* What is below this window has to be drawn before it is copied */
+    bScreen->gScreen->submitHeldDraws ();
+
     bScreen->tmpRegion3 = CompRegion ();
 
     if (filter == BlurOptions::FilterGaussian)
@@ -30,7 +30,9 @@
 
 #include <X11/extensions/Xcomposite.h>
 
-#define COMPIZ_COMPOSITE_ABI 6
+#define COMPIZ_COMPOSITE_ABI 7
+
+#include <boost/noncopyable.hpp>
 
 #include "core/pluginclasshandler.h"
 #include "core/timer.h"
@@ -39,6 +41,8 @@
 #include "core/wrapsystem.h"
 
 #include "composite/agedamagequery.h"
+#include "composite/framestatistics.h"
+#include "composite/memoryusage.h"
 
 #define COMPOSITE_SCREEN_DAMAGE_PENDING_MASK (1 << 0)
 #define COMPOSITE_SCREEN_DAMAGE_REGION_MASK  (1 << 1)
@@ -111,6 +115,10 @@ class PaintHandler {
 	virtual bool requiredForcedRefreshRate () { return false; };
 
 	virtual void prepareDrawing () {};
+
+	/* Whether painting after prepareDrawing waits for every X
+	 * request sent before it */
+	virtual bool fencesXRequests () { return false; };
 	virtual bool compositingActive () { return false; };
 	virtual unsigned int getFrameAge () { return 1; }
 };
@@ -268,6 +276,47 @@ class CompositeScreen :
 	int redrawTime ();
 	int optimalRedrawTime ();
 
+	/**
+	 * Microseconds the last frame spent blocked on the X server
+	 * before it could read window contents. Zero when the paint
+	 * handler fences X requests itself.
+	 */
+	unsigned int serverWaitTime ();
+
+	/**
+	 * How long recent frames took to paint and how many of them
+	 * missed the vblank they were scheduled for
+	 */
+	const compiz::composite::FrameStatistics & frameStatistics ();
+	void resetFrameStatistics ();
+
+	/**
+	 * Called by the paint handler once the frame is drawn and only
+	 * the swap is left, so that waiting for vblank in the swap
+	 * doesn't count as paint cost
+	 */
+	void frameSubmitted ();
+
+	/**
+	 * Repaints not scheduled since the statistics were last reset
+	 * because the only damage was covered by opaque windows, or
+	 * came from background windows over their rate cap
+	 */
+	void avoidedFrames (unsigned int &occluded, unsigned int &throttled);
+
+	/**
+	 * Forgets which parts of windows were found covered, see
+	 * CompositeWindow::setOccludedRegion. For plugins that change
+	 * what is visible without damaging it
+	 */
+	void occlusionChanged ();
+
+	/**
+	 * What the contents of each redirected window take up, see
+	 * the memory_budget option
+	 */
+	void memoryUsage (std::vector <compiz::composite::WindowMemoryUsage> &usage);
+
 	bool handlePaintTimeout ();
 
 	WRAPABLE_HND (0, CompositeScreenInterface, void, preparePaint, int);
@@ -289,6 +338,8 @@ class CompositeScreen :
 	WRAPABLE_HND (7, CompositeScreenInterface, void, damageCutoff);
 
 	friend class PrivateCompositeDisplay;
+	friend class CompositeWindow;
+	friend class PrivateCompositeWindow;
 
     private:
 	PrivateCompositeScreen *priv;
@@ -299,6 +350,37 @@ class CompositeScreen :
 					  CompOption::Vector &options);
 };
 
+namespace compiz
+{
+namespace composite
+{
+/**
+ * The window paint list for the length of one paint pass.
+ *
+ * While a snapshot exists the paint order core keeps is frozen, it is
+ * never rebuilt, so the list can be walked without copying it even if
+ * windows are restacked or getWindowPaintList is called again
+ * meanwhile. A list handed out by a plugin wrapping getWindowPaintList
+ * might be rebuilt by a nested call though, so that one is copied.
+ */
+class PaintListSnapshot :
+    boost::noncopyable
+{
+    public:
+
+	PaintListSnapshot (CompositeScreen *cScreen);
+	~PaintListSnapshot ();
+
+	const CompWindowList & list () const { return *mList; }
+
+    private:
+
+	const CompWindowList *mList;
+	CompWindowList       mCopy;
+};
+}
+}
+
 /*
   window paint flags
 
@@ -462,6 +544,25 @@ class CompositeWindow :
 	 */
 	void processDamage (XDamageNotifyEvent *de);
 
+	/**
+	 * Sets the part of the window, in screen coordinates, that the
+	 * last paint found covered by opaque windows above it. Damage to
+	 * the window's contents in there schedules no repaint until
+	 * anything happens that could uncover it. Paint handlers set
+	 * this every frame, a window without it is taken to be visible
+	 */
+	void setOccludedRegion (const CompRegion &occluded);
+	bool occludedRegionKnown ();
+
+	/**
+	 * Paint handlers report the memory they hold for the window's
+	 * contents, and that the window was painted. Windows that
+	 * weren't painted lately have their pixmap released when over
+	 * the memory budget, see setNewPixmapReadyCallback
+	 */
+	void setTextureBytes (unsigned long long bytes);
+	void markPainted ();
+
 	void updateOpacity ();
 	void updateBrightness ();
 	void updateSaturation ();
@@ -481,7 +582,8 @@ class CompositeWindow :
 
 	/**
 	 * A function to call when a new pixmap is ready to
-	 * be bound just before the old one is released
+	 * be bound just before the old one is released, or
+	 * before the pixmap is released to save memory
 	 */
 	void setNewPixmapReadyCallback (const boost::function <void ()> &cb);
 
@@ -489,6 +591,7 @@ class CompositeWindow :
 		      bool, const CompRect &);
 
 	friend class PrivateCompositeWindow;
+	friend class PrivateCompositeScreen;
 	friend class CompositeScreen;
 
     private:
@@ -0,0 +1,57 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_COMPOSITE_FRAMESTATISTICS_H
+#define _COMPIZ_COMPOSITE_FRAMESTATISTICS_H
+
+namespace compiz
+{
+namespace composite
+{
+
+/**
+ * How well repaints keep up with the display. Costs are measured from
+ * preparePaint until the paint handler returned from the buffer swap,
+ * all times are in microseconds.
+ */
+struct FrameStatistics
+{
+    /* Frames painted and frames that were still being painted when
+     * the vblank they were scheduled for had passed */
+    unsigned int frames;
+    unsigned int missed;
+
+    unsigned int lastCost;
+    unsigned int averageCost;
+    unsigned int worstCost;
+
+    /* The time set aside for the next frame and the refresh period
+     * it is fitted into */
+    unsigned int predictedCost;
+    unsigned int period;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_COMPOSITE_MEMORYUSAGE_H
+#define _COMPIZ_COMPOSITE_MEMORYUSAGE_H
+
+namespace compiz
+{
+namespace composite
+{
+
+/**
+ * What a redirected window's contents take up, as estimated from the
+ * size and depth of its pixmap and of the textures it is bound to.
+ * Both are 0 while the window's resources are released.
+ */
+struct WindowMemoryUsage
+{
+    /* The window's XID */
+    unsigned long      id;
+
+    unsigned long long pixmapBytes;
+    unsigned long long textureBytes;
+
+    /* Frames painted since the window was, 0 if it was painted
+     * during the last one */
+    unsigned int       idleFrames;
+};
+
+}
+}
+
+#endif
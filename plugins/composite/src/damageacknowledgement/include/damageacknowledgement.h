@@ -0,0 +1,171 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_COMPOSITE_DAMAGEACKNOWLEDGEMENT_H
+#define _COMPIZ_COMPOSITE_DAMAGEACKNOWLEDGEMENT_H
+
+#include <map>
+
+#include <X11/Xlib.h>
+#include <X11/extensions/Xfixes.h>
+#include <X11/extensions/Xdamage.h>
+
+namespace compiz
+{
+namespace composite
+{
+namespace damage
+{
+
+class ServerDamageInterface
+{
+    public:
+
+	virtual ~ServerDamageInterface () {}
+
+	virtual XserverRegion createRegion () = 0;
+	virtual void setRegion (XserverRegion, const XRectangle &) = 0;
+	virtual void destroyRegion (XserverRegion) = 0;
+	virtual void subtract (Damage, XserverRegion) = 0;
+
+	virtual unsigned long nextRequest () = 0;
+	virtual unsigned long lastRequestProcessed () = 0;
+	virtual void flush () = 0;
+	virtual void sync () = 0;
+};
+
+class X11ServerDamage :
+    public ServerDamageInterface
+{
+    public:
+
+	X11ServerDamage (Display *dpy) :
+	    mDpy (dpy)
+	{
+	}
+
+	XserverRegion createRegion ()
+	{
+	    return XFixesCreateRegion (mDpy, NULL, 0);
+	}
+
+	void setRegion (XserverRegion region, const XRectangle &rect)
+	{
+	    XFixesSetRegion (mDpy, region, const_cast <XRectangle *> (&rect), 1);
+	}
+
+	void destroyRegion (XserverRegion region)
+	{
+	    XFixesDestroyRegion (mDpy, region);
+	}
+
+	void subtract (Damage damage, XserverRegion region)
+	{
+	    XDamageSubtract (mDpy, damage, region, None);
+	}
+
+	unsigned long nextRequest ()
+	{
+	    return NextRequest (mDpy);
+	}
+
+	unsigned long lastRequestProcessed ()
+	{
+	    return LastKnownRequestProcessed (mDpy);
+	}
+
+	void flush ()
+	{
+	    XFlush (mDpy);
+	}
+
+	void sync ()
+	{
+	    XSync (mDpy, False);
+	}
+
+    private:
+
+	Display *mDpy;
+};
+
+/**
+ * Tells the server which reported damage has been repainted.
+ *
+ * The bounding box last reported for each damage object is
+ * subtracted in one go through a single XFixes region that is kept
+ * for the lifetime of the acknowledger, then the requests are
+ * flushed without waiting for a reply.
+ *
+ * The subtraction has to be processed before the repaint reads the
+ * window pixmaps, otherwise drawing that lands in between would be
+ * subtracted without ever being reported. retire () relies on the
+ * paint handler fencing the X request stream when it can, and
+ * otherwise only waits for the server if no later reply or event has
+ * shown that it got past the last subtraction already.
+ */
+class Acknowledger
+{
+    public:
+
+	Acknowledger (ServerDamageInterface *);
+	~Acknowledger ();
+
+	/* Called for every DamageNotify event */
+	void damaged (Damage damage, const XRectangle &area);
+
+	/* Called before the damage object is destroyed */
+	void forget (Damage damage);
+
+	/* Sends the subtractions for everything reported so far */
+	void acknowledge ();
+
+	/* Makes sure the server has processed the last subtractions
+	 * before the pixmaps are read. fenced means that the reads
+	 * already wait for every request sent before them */
+	void retire (bool fenced);
+
+	/* Microseconds retire () spent blocked on the server, for the
+	 * last frame and since startup */
+	unsigned int lastWait () const { return mLastWait; }
+	unsigned long long totalWait () const { return mTotalWait; }
+
+    private:
+
+	ServerDamageInterface *mServer;
+	XserverRegion         mRegion;
+
+	std::map <Damage, XRectangle> mDamages;
+
+	unsigned long mSerial;
+	bool          mUnretired;
+
+	unsigned int       mLastWait;
+	unsigned long long mTotalWait;
+};
+
+}
+}
+}
+
+#endif
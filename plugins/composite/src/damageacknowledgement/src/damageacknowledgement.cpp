@@ -0,0 +1,125 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <time.h>
+
+#include "damageacknowledgement.h"
+
+namespace cd = compiz::composite::damage;
+
+namespace
+{
+unsigned long long
+now ()
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+}
+
+cd::Acknowledger::Acknowledger (ServerDamageInterface *server) :
+    mServer (server),
+    mRegion (None),
+    mSerial (0),
+    mUnretired (false),
+    mLastWait (0),
+    mTotalWait (0)
+{
+}
+
+cd::Acknowledger::~Acknowledger ()
+{
+    if (mRegion)
+	mServer->destroyRegion (mRegion);
+}
+
+void
+cd::Acknowledger::damaged (Damage damage, const XRectangle &area)
+{
+    /* Damage is reported as a bounding box that only ever grows
+     * until it is subtracted, so the last one covers the rest */
+    mDamages[damage] = area;
+}
+
+void
+cd::Acknowledger::forget (Damage damage)
+{
+    mDamages.erase (damage);
+}
+
+void
+cd::Acknowledger::acknowledge ()
+{
+    if (mDamages.empty ())
+	return;
+
+    if (!mRegion)
+    {
+	mRegion = mServer->createRegion ();
+
+	if (!mRegion)
+	    return;
+    }
+
+    /* The server handles our requests in order, so one region can
+     * be refilled for every subtraction */
+    for (std::map <Damage, XRectangle>::iterator it = mDamages.begin ();
+	 it != mDamages.end (); ++it)
+    {
+	mServer->setRegion (mRegion, it->second);
+	mServer->subtract (it->first, mRegion);
+    }
+
+    mDamages.clear ();
+
+    mSerial    = mServer->nextRequest () - 1;
+    mUnretired = true;
+
+    mServer->flush ();
+}
+
+void
+cd::Acknowledger::retire (bool fenced)
+{
+    mLastWait = 0;
+
+    if (!mUnretired)
+	return;
+
+    mUnretired = false;
+
+    /* Sequence numbers wrap, compare the distance */
+    if (fenced ||
+	static_cast <long> (mServer->lastRequestProcessed () - mSerial) >= 0)
+	return;
+
+    unsigned long long start = now ();
+
+    mServer->sync ();
+
+    mLastWait   = now () - start;
+    mTotalWait += mLastWait;
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "damageacknowledgement.h"
+
+using ::testing::InSequence;
+using ::testing::Return;
+using ::testing::StrictMock;
+using ::testing::_;
+
+namespace cd = compiz::composite::damage;
+
+namespace
+{
+const XserverRegion region = 42;
+
+XRectangle
+rect (short x, short y, unsigned short width, unsigned short height)
+{
+    XRectangle r;
+
+    r.x      = x;
+    r.y      = y;
+    r.width  = width;
+    r.height = height;
+
+    return r;
+}
+
+MATCHER_P (IsRect, r, "")
+{
+    return arg.x == r.x && arg.y == r.y &&
+	   arg.width == r.width && arg.height == r.height;
+}
+}
+
+class MockServerDamage :
+    public cd::ServerDamageInterface
+{
+    public:
+
+	MOCK_METHOD0 (createRegion, XserverRegion ());
+	MOCK_METHOD2 (setRegion, void (XserverRegion, const XRectangle &));
+	MOCK_METHOD1 (destroyRegion, void (XserverRegion));
+	MOCK_METHOD2 (subtract, void (Damage, XserverRegion));
+	MOCK_METHOD0 (nextRequest, unsigned long ());
+	MOCK_METHOD0 (lastRequestProcessed, unsigned long ());
+	MOCK_METHOD0 (flush, void ());
+	MOCK_METHOD0 (sync, void ());
+};
+
+class CompositeDamageAcknowledgementTest :
+    public ::testing::Test
+{
+    protected:
+
+	StrictMock <MockServerDamage> server;
+};
+
+TEST_F (CompositeDamageAcknowledgementTest, NothingToAcknowledge)
+{
+    cd::Acknowledger ack (&server);
+
+    ack.acknowledge ();
+    ack.retire (false);
+
+    EXPECT_EQ (0u, ack.lastWait ());
+}
+
+TEST_F (CompositeDamageAcknowledgementTest, SubtractsThroughOneRegion)
+{
+    cd::Acknowledger ack (&server);
+
+    ack.damaged (1, rect (0, 0, 10, 10));
+    ack.damaged (1, rect (0, 0, 20, 20));
+    ack.damaged (2, rect (5, 5, 1, 1));
+
+    {
+	InSequence s;
+
+	EXPECT_CALL (server, createRegion ()).WillOnce (Return (region));
+	EXPECT_CALL (server, setRegion (region, IsRect (rect (0, 0, 20, 20))));
+	EXPECT_CALL (server, subtract (1, region));
+	EXPECT_CALL (server, setRegion (region, IsRect (rect (5, 5, 1, 1))));
+	EXPECT_CALL (server, subtract (2, region));
+	EXPECT_CALL (server, nextRequest ()).WillOnce (Return (101));
+	EXPECT_CALL (server, flush ());
+    }
+
+    ack.acknowledge ();
+
+    ack.damaged (2, rect (0, 0, 1, 1));
+
+    EXPECT_CALL (server, setRegion (region, IsRect (rect (0, 0, 1, 1))));
+    EXPECT_CALL (server, subtract (2, region));
+    EXPECT_CALL (server, nextRequest ()).WillOnce (Return (105));
+    EXPECT_CALL (server, flush ());
+
+    ack.acknowledge ();
+
+    EXPECT_CALL (server, destroyRegion (region));
+}
+
+TEST_F (CompositeDamageAcknowledgementTest, ForgottenDamageIsNotSubtracted)
+{
+    cd::Acknowledger ack (&server);
+
+    ack.damaged (1, rect (0, 0, 10, 10));
+    ack.forget (1);
+
+    ack.acknowledge ();
+}
+
+TEST_F (CompositeDamageAcknowledgementTest, FencedRetireNeverWaits)
+{
+    cd::Acknowledger ack (&server);
+
+    ack.damaged (1, rect (0, 0, 10, 10));
+
+    EXPECT_CALL (server, createRegion ()).WillOnce (Return (region));
+    EXPECT_CALL (server, setRegion (_, _));
+    EXPECT_CALL (server, subtract (_, _));
+    EXPECT_CALL (server, nextRequest ()).WillOnce (Return (100));
+    EXPECT_CALL (server, flush ());
+
+    ack.acknowledge ();
+    ack.retire (true);
+
+    EXPECT_EQ (0u, ack.lastWait ());
+
+    EXPECT_CALL (server, destroyRegion (region));
+}
+
+TEST_F (CompositeDamageAcknowledgementTest, ProcessedRequestsAreNotWaitedFor)
+{
+    cd::Acknowledger ack (&server);
+
+    ack.damaged (1, rect (0, 0, 10, 10));
+
+    EXPECT_CALL (server, createRegion ()).WillOnce (Return (region));
+    EXPECT_CALL (server, setRegion (_, _));
+    EXPECT_CALL (server, subtract (_, _));
+    EXPECT_CALL (server, nextRequest ()).WillOnce (Return (100));
+    EXPECT_CALL (server, flush ());
+    EXPECT_CALL (server, lastRequestProcessed ()).WillOnce (Return (99));
+
+    ack.acknowledge ();
+    ack.retire (false);
+
+    EXPECT_CALL (server, destroyRegion (region));
+}
+
+TEST_F (CompositeDamageAcknowledgementTest, WaitsWhenServerIsBehind)
+{
+    cd::Acknowledger ack (&server);
+
+    ack.damaged (1, rect (0, 0, 10, 10));
+
+    EXPECT_CALL (server, createRegion ()).WillOnce (Return (region));
+    EXPECT_CALL (server, setRegion (_, _));
+    EXPECT_CALL (server, subtract (_, _));
+    EXPECT_CALL (server, nextRequest ()).WillOnce (Return (100));
+    EXPECT_CALL (server, flush ());
+    EXPECT_CALL (server, lastRequestProcessed ()).WillOnce (Return (98));
+    EXPECT_CALL (server, sync ());
+
+    ack.acknowledge ();
+    ack.retire (false);
+
+    /* Already retired */
+    ack.retire (false);
+
+    EXPECT_CALL (server, destroyRegion (region));
+}
+
+TEST_F (CompositeDamageAcknowledgementTest, SequenceNumbersWrap)
+{
+    cd::Acknowledger ack (&server);
+
+    ack.damaged (1, rect (0, 0, 10, 10));
+
+    EXPECT_CALL (server, createRegion ()).WillOnce (Return (region));
+    EXPECT_CALL (server, setRegion (_, _));
+    EXPECT_CALL (server, subtract (_, _));
+    EXPECT_CALL (server, nextRequest ()).WillOnce (Return (0));
+    EXPECT_CALL (server, flush ());
+    EXPECT_CALL (server, lastRequestProcessed ()).WillOnce (Return (3));
+
+    ack.acknowledge ();
+    ack.retire (false);
+
+    EXPECT_CALL (server, destroyRegion (region));
+}
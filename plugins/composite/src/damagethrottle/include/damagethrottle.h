@@ -0,0 +1,120 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_COMPOSITE_DAMAGETHROTTLE_H
+#define _COMPIZ_COMPOSITE_DAMAGETHROTTLE_H
+
+namespace compiz
+{
+namespace composite
+{
+namespace damage
+{
+
+/* Microseconds on the monotonic clock */
+typedef unsigned long long Time;
+
+/**
+ * Holds back the damage of a window so that it causes no more than
+ * one repaint per interval.
+ *
+ * Damage arriving a full interval after the last damage that was
+ * passed on goes through at once. Anything sooner is held until the
+ * interval is over, so a window that keeps drawing is repainted at
+ * the capped rate and its last update still makes it to the screen.
+ */
+class RateLimiter
+{
+    public:
+
+	RateLimiter ();
+
+	/* Microseconds between repaints, 0 lifts the cap */
+	void setInterval (unsigned int interval);
+	unsigned int interval () const { return mInterval; }
+
+	/* Damage arrived at now. Returns 0 if it may be passed on right
+	 * away, together with anything held. Otherwise it is held and
+	 * this is the number of microseconds until release () */
+	unsigned int damaged (Time now);
+
+	/* Whether damage is being held */
+	bool holding () const { return mHolding; }
+
+	/* Passes held damage on at now */
+	void release (Time now);
+
+	/* Forgets held damage and when damage was last passed on */
+	void reset ();
+
+    private:
+
+	unsigned int mInterval;
+	Time         mLast;
+	bool         mHaveLast;
+	bool         mHolding;
+};
+
+/**
+ * Counts the repaints that dropped or held back damage would have
+ * caused. Damage arriving while a repaint is due anyway avoids
+ * nothing, and at most one repaint is counted per refresh period.
+ */
+class AvoidedFrames
+{
+    public:
+
+	enum Reason
+	{
+	    Occluded,
+	    Throttled
+	};
+
+	AvoidedFrames ();
+
+	void setPeriod (unsigned int period);
+
+	/* Damage was kept from scheduling a repaint at now, one
+	 * had already been scheduled when repaintDue */
+	void avoided (Reason reason, Time now, bool repaintDue);
+
+	unsigned int occluded () const { return mOccluded; }
+	unsigned int throttled () const { return mThrottled; }
+
+	void reset ();
+
+    private:
+
+	unsigned int mPeriod;
+	Time         mLast;
+	bool         mHaveLast;
+
+	unsigned int mOccluded;
+	unsigned int mThrottled;
+};
+
+}
+}
+}
+
+#endif
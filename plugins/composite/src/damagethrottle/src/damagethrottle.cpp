@@ -0,0 +1,126 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "damagethrottle.h"
+
+namespace cd = compiz::composite::damage;
+
+namespace
+{
+const int DefaultRefreshRate = 60;
+}
+
+cd::RateLimiter::RateLimiter () :
+    mInterval (0),
+    mLast (0),
+    mHaveLast (false),
+    mHolding (false)
+{
+}
+
+void
+cd::RateLimiter::setInterval (unsigned int interval)
+{
+    mInterval = interval;
+}
+
+unsigned int
+cd::RateLimiter::damaged (Time now)
+{
+    if (mHolding)
+    {
+	/* Released on time, whatever arrives in the meantime */
+	if (now - mLast < mInterval)
+	    return mLast + mInterval - now;
+
+	release (now);
+	return 0;
+    }
+
+    if (!mInterval || !mHaveLast || now - mLast >= mInterval)
+    {
+	mLast     = now;
+	mHaveLast = true;
+	return 0;
+    }
+
+    mHolding = true;
+
+    return mLast + mInterval - now;
+}
+
+void
+cd::RateLimiter::release (Time now)
+{
+    mLast     = now;
+    mHaveLast = true;
+    mHolding  = false;
+}
+
+void
+cd::RateLimiter::reset ()
+{
+    mLast     = 0;
+    mHaveLast = false;
+    mHolding  = false;
+}
+
+cd::AvoidedFrames::AvoidedFrames () :
+    mPeriod (1000000 / DefaultRefreshRate),
+    mLast (0),
+    mHaveLast (false),
+    mOccluded (0),
+    mThrottled (0)
+{
+}
+
+void
+cd::AvoidedFrames::setPeriod (unsigned int period)
+{
+    mPeriod = period;
+}
+
+void
+cd::AvoidedFrames::avoided (Reason reason, Time now, bool repaintDue)
+{
+    if (repaintDue)
+	return;
+
+    if (mHaveLast && now - mLast < mPeriod)
+	return;
+
+    mLast     = now;
+    mHaveLast = true;
+
+    if (reason == Occluded)
+	++mOccluded;
+    else
+	++mThrottled;
+}
+
+void
+cd::AvoidedFrames::reset ()
+{
+    mOccluded  = 0;
+    mThrottled = 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "damagethrottle.h"
+
+namespace cd = compiz::composite::damage;
+
+using cd::AvoidedFrames;
+using cd::RateLimiter;
+
+namespace
+{
+const unsigned int interval = 100000;
+const unsigned int period = 1000000 / 60;
+}
+
+TEST (CompositeDamageThrottle, UncappedPassesEverything)
+{
+    RateLimiter limiter;
+
+    EXPECT_EQ (0u, limiter.damaged (1000));
+    EXPECT_EQ (0u, limiter.damaged (1001));
+    EXPECT_FALSE (limiter.holding ());
+}
+
+TEST (CompositeDamageThrottle, HoldsDamageWithinInterval)
+{
+    RateLimiter limiter;
+
+    limiter.setInterval (interval);
+
+    EXPECT_EQ (0u, limiter.damaged (1000000));
+    EXPECT_EQ (interval - 20000, limiter.damaged (1020000));
+    EXPECT_TRUE (limiter.holding ());
+
+    /* Still due when the first was */
+    EXPECT_EQ (interval - 50000, limiter.damaged (1050000));
+
+    limiter.release (1100000);
+    EXPECT_FALSE (limiter.holding ());
+
+    /* The interval starts over at the release */
+    EXPECT_EQ (interval - 10000, limiter.damaged (1110000));
+}
+
+TEST (CompositeDamageThrottle, LateDamagePassesHeldDamage)
+{
+    RateLimiter limiter;
+
+    limiter.setInterval (interval);
+
+    limiter.damaged (1000000);
+    limiter.damaged (1050000);
+
+    EXPECT_EQ (0u, limiter.damaged (1200000));
+    EXPECT_FALSE (limiter.holding ());
+}
+
+TEST (CompositeDamageThrottle, IdleWindowPassesAtOnce)
+{
+    RateLimiter limiter;
+
+    limiter.setInterval (interval);
+
+    EXPECT_EQ (0u, limiter.damaged (1000000));
+    EXPECT_EQ (0u, limiter.damaged (1000000 + interval));
+    EXPECT_EQ (0u, limiter.damaged (5000000));
+}
+
+TEST (CompositeDamageThrottle, ResetForgetsHeldDamage)
+{
+    RateLimiter limiter;
+
+    limiter.setInterval (interval);
+
+    limiter.damaged (1000000);
+    limiter.damaged (1010000);
+    limiter.reset ();
+
+    EXPECT_FALSE (limiter.holding ());
+    EXPECT_EQ (0u, limiter.damaged (1020000));
+}
+
+TEST (CompositeDamageThrottle, CountsOneAvoidedFramePerPeriod)
+{
+    AvoidedFrames frames;
+
+    frames.setPeriod (period);
+
+    frames.avoided (AvoidedFrames::Occluded, 1000000, false);
+    frames.avoided (AvoidedFrames::Occluded, 1001000, false);
+    frames.avoided (AvoidedFrames::Throttled, 1002000, false);
+    frames.avoided (AvoidedFrames::Throttled, 1000000 + period, false);
+
+    EXPECT_EQ (1u, frames.occluded ());
+    EXPECT_EQ (1u, frames.throttled ());
+}
+
+TEST (CompositeDamageThrottle, NothingAvoidedWhenRepaintIsDue)
+{
+    AvoidedFrames frames;
+
+    frames.avoided (AvoidedFrames::Occluded, 1000000, true);
+    frames.avoided (AvoidedFrames::Throttled, 2000000, true);
+
+    EXPECT_EQ (0u, frames.occluded ());
+    EXPECT_EQ (0u, frames.throttled ());
+
+    frames.avoided (AvoidedFrames::Occluded, 3000000, false);
+    frames.reset ();
+
+    EXPECT_EQ (0u, frames.occluded ());
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_COMPOSITE_FRAMEPACING_H
+#define _COMPIZ_COMPOSITE_FRAMEPACING_H
+
+#include <composite/framestatistics.h>
+
+namespace compiz
+{
+namespace composite
+{
+namespace pacing
+{
+
+/* Microseconds on the monotonic clock */
+typedef unsigned long long Time;
+
+/**
+ * Decides when the next frame should start painting.
+ *
+ * The cost of a frame runs from its start until the paint handler
+ * submitted the swap, time spent blocked in the swap waiting for
+ * vblank is not part of it. Paint handlers that don't report the
+ * submission have the cost measured until the swap returned.
+ *
+ * The cost of the last CostSamples frames is kept and the next frame
+ * is assumed to take about as long as the slowest of the typical
+ * ones, that is the mean plus two standard deviations but no more
+ * than the worst sample.
+ *
+ * When the paint handler syncs to vblank the end of a swap that had
+ * to wait gives the phase of the display. A frame is then started
+ * predictedCost () + Margin before the first vblank it can still
+ * make, so that it samples input as late as possible. A frame that
+ * is still painting half a period after its vblank has missed it.
+ *
+ * Otherwise frames are started no sooner than one refresh period
+ * after the one before, and miss when they take longer than that.
+ */
+class FramePacer
+{
+    public:
+
+	static const unsigned int CostSamples = 32;
+
+	/* Left for the main loop to wake up late, timers only have
+	 * millisecond resolution */
+	static const unsigned int Margin = 1000;
+
+	FramePacer ();
+
+	void setRefreshRate (int rate);
+	unsigned int period () const { return mPeriod; }
+
+	/* Microseconds from now until the next frame should start.
+	 * alignToVBlank when the swap waits for vblank */
+	unsigned int schedule (Time now, bool alignToVBlank);
+
+	void frameStarted (Time now);
+	void frameSubmitted (Time now);
+	void frameFinished (Time now);
+
+	unsigned int predictedCost () const;
+
+	const FrameStatistics & statistics ();
+
+	/* Clears the frame counters, the cost history is kept as it
+	 * still predicts the next frame */
+	void resetStatistics ();
+
+    private:
+
+	unsigned int mPeriod;
+
+	unsigned int mCosts[CostSamples];
+	unsigned int mNCosts;
+	unsigned int mNextCost;
+
+	Time mStart;
+	Time mSubmitted;
+	bool mHaveSubmitted;
+	Time mLastStart;
+	bool mHaveLastStart;
+	bool mStarted;
+
+	Time mDeadline;
+	bool mHaveDeadline;
+	bool mAligned;
+
+	Time mPhase;
+	bool mHavePhase;
+
+	FrameStatistics mStatistics;
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,228 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <cmath>
+#include <climits>
+#include <cstring>
+
+#include "framepacing.h"
+
+namespace cp = compiz::composite::pacing;
+
+namespace
+{
+const int DefaultRefreshRate = 60;
+}
+
+cp::FramePacer::FramePacer () :
+    mPeriod (1000000 / DefaultRefreshRate),
+    mNCosts (0),
+    mNextCost (0),
+    mStart (0),
+    mSubmitted (0),
+    mHaveSubmitted (false),
+    mLastStart (0),
+    mHaveLastStart (false),
+    mStarted (false),
+    mDeadline (0),
+    mHaveDeadline (false),
+    mAligned (false),
+    mPhase (0),
+    mHavePhase (false)
+{
+    memset (mCosts, 0, sizeof (mCosts));
+    memset (&mStatistics, 0, sizeof (mStatistics));
+}
+
+void
+cp::FramePacer::setRefreshRate (int rate)
+{
+    if (rate <= 0)
+	return;
+
+    if (mPeriod != 1000000u / rate)
+    {
+	mPeriod    = 1000000 / rate;
+	mHavePhase = false;
+    }
+}
+
+unsigned int
+cp::FramePacer::schedule (Time now, bool alignToVBlank)
+{
+    mAligned = alignToVBlank;
+
+    if (alignToVBlank)
+    {
+	/* Nothing to align to until a swap has waited for vblank */
+	if (!mHavePhase)
+	{
+	    mHaveDeadline = false;
+	    return 0;
+	}
+
+	Time budget   = predictedCost () + Margin;
+	Time earliest = now + budget;
+	Time vblank   = mPhase;
+
+	if (earliest > vblank)
+	    vblank += (earliest - vblank + mPeriod - 1) / mPeriod * mPeriod;
+
+	mDeadline     = vblank;
+	mHaveDeadline = true;
+
+	return vblank - earliest;
+    }
+
+    Time start = now;
+
+    if (mHaveLastStart && mLastStart + mPeriod > now)
+	start = mLastStart + mPeriod;
+
+    mDeadline     = start + mPeriod;
+    mHaveDeadline = true;
+
+    return start - now;
+}
+
+void
+cp::FramePacer::frameStarted (Time now)
+{
+    mStart         = now;
+    mLastStart     = now;
+    mHaveLastStart = true;
+    mStarted       = true;
+    mHaveSubmitted = false;
+}
+
+void
+cp::FramePacer::frameSubmitted (Time now)
+{
+    if (!mStarted)
+	return;
+
+    mSubmitted     = now;
+    mHaveSubmitted = true;
+}
+
+void
+cp::FramePacer::frameFinished (Time now)
+{
+    if (!mStarted)
+	return;
+
+    /* The swap return only gives the phase, waiting in it for
+     * vblank is not painting */
+    Time end  = mHaveSubmitted ? mSubmitted : now;
+    Time cost = end > mStart ? end - mStart : 0;
+
+    if (cost > UINT_MAX)
+	cost = UINT_MAX;
+
+    mCosts[mNextCost] = cost;
+    mNextCost = (mNextCost + 1) % CostSamples;
+
+    if (mNCosts < CostSamples)
+	++mNCosts;
+
+    ++mStatistics.frames;
+    mStatistics.lastCost = cost;
+
+    if (mAligned)
+    {
+	if (mHaveDeadline && now > mDeadline + mPeriod / 2)
+	    ++mStatistics.missed;
+
+	/* A swap that returns before the vblank it was meant for
+	 * didn't wait for it, so it says nothing about the phase */
+	if (!mHavePhase || (mHaveDeadline && now >= mDeadline))
+	{
+	    mPhase     = now;
+	    mHavePhase = true;
+	}
+    }
+    else if (mHaveDeadline && now > mDeadline)
+	++mStatistics.missed;
+
+    mStarted       = false;
+    mHaveSubmitted = false;
+    mHaveDeadline  = false;
+}
+
+unsigned int
+cp::FramePacer::predictedCost () const
+{
+    if (!mNCosts)
+	return 0;
+
+    double       sum = 0, squares = 0;
+    unsigned int worst = 0;
+
+    for (unsigned int i = 0; i < mNCosts; ++i)
+    {
+	sum     += mCosts[i];
+	squares += (double) mCosts[i] * mCosts[i];
+
+	if (mCosts[i] > worst)
+	    worst = mCosts[i];
+    }
+
+    /* Too few samples to say what is typical */
+    if (mNCosts < 4)
+	return worst;
+
+    double mean     = sum / mNCosts;
+    double variance = squares / mNCosts - mean * mean;
+    double predicted = mean + 2 * sqrt (variance > 0 ? variance : 0);
+
+    return predicted < worst ? (unsigned int) predicted : worst;
+}
+
+const compiz::composite::FrameStatistics &
+cp::FramePacer::statistics ()
+{
+    unsigned long long sum = 0;
+    unsigned int       worst = 0;
+
+    for (unsigned int i = 0; i < mNCosts; ++i)
+    {
+	sum += mCosts[i];
+
+	if (mCosts[i] > worst)
+	    worst = mCosts[i];
+    }
+
+    mStatistics.averageCost   = mNCosts ? sum / mNCosts : 0;
+    mStatistics.worstCost     = worst;
+    mStatistics.predictedCost = predictedCost ();
+    mStatistics.period        = mPeriod;
+
+    return mStatistics;
+}
+
+void
+cp::FramePacer::resetStatistics ()
+{
+    mStatistics.frames = 0;
+    mStatistics.missed = 0;
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "framepacing.h"
+
+namespace cp = compiz::composite::pacing;
+
+using cp::FramePacer;
+using cp::Time;
+
+namespace
+{
+const unsigned int period = 1000000 / 60;
+}
+
+class CompositeFramePacingTest :
+    public ::testing::Test
+{
+    protected:
+
+	/* Paints a frame at now that takes cost */
+	void paint (Time now, unsigned int cost)
+	{
+	    pacer.frameStarted (now);
+	    pacer.frameFinished (now + cost);
+	}
+
+	FramePacer pacer;
+};
+
+TEST_F (CompositeFramePacingTest, PredictsWorstOfFewSamples)
+{
+    EXPECT_EQ (0u, pacer.predictedCost ());
+
+    paint (0, 3000);
+    paint (20000, 5000);
+
+    EXPECT_EQ (5000u, pacer.predictedCost ());
+}
+
+TEST_F (CompositeFramePacingTest, PredictionIgnoresRareOutliers)
+{
+    for (unsigned int i = 0; i < FramePacer::CostSamples - 1; ++i)
+	paint (i * period, 4000);
+
+    paint (FramePacer::CostSamples * period, 14000);
+
+    EXPECT_LT (pacer.predictedCost (), 14000u);
+    EXPECT_GE (pacer.predictedCost (), 4000u);
+}
+
+TEST_F (CompositeFramePacingTest, UnalignedFramesAreOnePeriodApart)
+{
+    EXPECT_EQ (0u, pacer.schedule (1000000, false));
+    paint (1000000, 2000);
+
+    EXPECT_EQ (period - 5000, pacer.schedule (1005000, false));
+    EXPECT_EQ (0u, pacer.schedule (1000000 + 2 * period, false));
+}
+
+TEST_F (CompositeFramePacingTest, UnalignedFrameLongerThanAPeriodMisses)
+{
+    pacer.schedule (0, false);
+    paint (0, period + 1);
+
+    pacer.schedule (1000000, false);
+    paint (1000000, period - 1);
+
+    const compiz::composite::FrameStatistics &stats = pacer.statistics ();
+
+    EXPECT_EQ (2u, stats.frames);
+    EXPECT_EQ (1u, stats.missed);
+}
+
+TEST_F (CompositeFramePacingTest, AlignedStartsAsLateAsPossible)
+{
+    /* Nothing to align to before the first swap */
+    EXPECT_EQ (0u, pacer.schedule (0, true));
+    paint (period - 3000, 3000);
+
+    /* 3ms of painting plus the margin before the next vblank */
+    EXPECT_EQ (period - 3000 - FramePacer::Margin - 2000,
+	       pacer.schedule (period + 2000, true));
+
+    paint (2 * period - 3000 - FramePacer::Margin, 3000 + FramePacer::Margin + 100);
+
+    EXPECT_EQ (2u, pacer.statistics ().frames);
+    EXPECT_EQ (0u, pacer.statistics ().missed);
+}
+
+TEST_F (CompositeFramePacingTest, AlignedSkipsVBlankThatCanNoLongerBeMade)
+{
+    pacer.schedule (0, true);
+    paint (period - 3000, 3000);
+
+    /* Only 2ms left before the next vblank, aim for the one after */
+    EXPECT_EQ (period - 2000, pacer.schedule (2 * period - 2000, true));
+}
+
+TEST_F (CompositeFramePacingTest, AlignedFrameFinishingAVBlankLateMisses)
+{
+    pacer.schedule (0, true);
+    paint (period - 3000, 3000);
+
+    pacer.schedule (period + 1000, true);
+    paint (2 * period - 4000, period + 4100);
+
+    EXPECT_EQ (2u, pacer.statistics ().frames);
+    EXPECT_EQ (1u, pacer.statistics ().missed);
+
+    pacer.resetStatistics ();
+
+    EXPECT_EQ (0u, pacer.statistics ().frames);
+    EXPECT_EQ (0u, pacer.statistics ().missed);
+    EXPECT_EQ (period + 4100, pacer.statistics ().worstCost);
+}
+
+TEST_F (CompositeFramePacingTest, TimeBlockedInTheSwapIsNotCost)
+{
+    Time         now = 0;
+    unsigned int delay = 0;
+
+    /* 3ms of painting, then a swap that blocks until the next vblank */
+    for (unsigned int i = 0; i < FramePacer::CostSamples; ++i)
+    {
+	delay = pacer.schedule (now, true);
+
+	Time start = now + delay;
+	Time submitted = start + 3000;
+	Time vblank = (submitted / period + 1) * period;
+
+	pacer.frameStarted (start);
+	pacer.frameSubmitted (submitted);
+	pacer.frameFinished (vblank);
+
+	now = vblank;
+    }
+
+    EXPECT_EQ (3000u, pacer.predictedCost ());
+    EXPECT_EQ (3000u, pacer.statistics ().lastCost);
+    EXPECT_EQ (0u, pacer.statistics ().missed);
+
+    /* The paint is started as late as it can be */
+    EXPECT_EQ (period - 3000 - FramePacer::Margin, delay);
+}
+
+TEST_F (CompositeFramePacingTest, RefreshRateChangeDropsPhase)
+{
+    pacer.schedule (0, true);
+    paint (period - 3000, 3000);
+
+    pacer.setRefreshRate (75);
+
+    EXPECT_EQ (1000000u / 75, pacer.period ());
+    EXPECT_EQ (0u, pacer.schedule (period + 1000, true));
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_COMPOSITE_MEMORYBUDGET_H
+#define _COMPIZ_COMPOSITE_MEMORYBUDGET_H
+
+#include <map>
+#include <vector>
+
+#include <composite/memoryusage.h>
+
+namespace compiz
+{
+namespace composite
+{
+namespace memory
+{
+
+/**
+ * Adds up the memory held for the contents of redirected windows and
+ * picks the windows to release it for once that goes over a limit.
+ *
+ * Only windows known not to be visible are picked, and of those only
+ * the ones that weren't painted during the last frame, the one painted
+ * longest ago first. A visible window can go unpainted just because
+ * nothing of it was damaged, releasing it would only have it bound
+ * again for the next paint. Whoever holds the memory releases it
+ * and sets its bytes to 0, binding it again once the window is needed
+ * sets them back.
+ */
+class Budget
+{
+    public:
+
+	typedef unsigned long Id;
+
+	Budget ();
+
+	/* In bytes, 0 means no limit */
+	void setLimit (unsigned long long limit);
+	unsigned long long limit () const { return mLimit; }
+
+	void setPixmapBytes (Id id, unsigned long long bytes);
+	void setTextureBytes (Id id, unsigned long long bytes);
+	void forget (Id id);
+
+	/* id was painted during the current frame */
+	void painted (Id id);
+
+	/* Whether id is minimized, off the screen or fully covered,
+	 * windows start out visible */
+	void setHidden (Id id, bool hidden);
+	void frameDone ();
+
+	unsigned long long total () const { return mTotal; }
+	bool overLimit () const;
+
+	/* Hidden windows holding memory that weren't painted during the
+	 * last frame, least recently painted first */
+	void idle (std::vector <Id> &ids) const;
+
+	void usage (std::vector <WindowMemoryUsage> &usage) const;
+
+    private:
+
+	struct Entry
+	{
+	    unsigned long long pixmap;
+	    unsigned long long texture;
+	    unsigned long long lastPainted;
+	    bool               hidden;
+	};
+
+	Entry & entry (Id id);
+	void setBytes (Id id, unsigned long long Entry::*field,
+		       unsigned long long bytes);
+
+	std::map <Id, Entry> mEntries;
+
+	unsigned long long mLimit;
+	unsigned long long mTotal;
+	unsigned long long mFrame;
+};
+
+}
+}
+}
+
+#endif
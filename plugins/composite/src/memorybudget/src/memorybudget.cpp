@@ -0,0 +1,173 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <algorithm>
+
+#include "memorybudget.h"
+
+namespace cm = compiz::composite::memory;
+
+namespace
+{
+typedef std::pair <unsigned long long, cm::Budget::Id> Candidate;
+}
+
+cm::Budget::Budget () :
+    mLimit (0),
+    mTotal (0),
+    mFrame (0)
+{
+}
+
+void
+cm::Budget::setLimit (unsigned long long limit)
+{
+    mLimit = limit;
+}
+
+cm::Budget::Entry &
+cm::Budget::entry (Id id)
+{
+    std::map <Id, Entry>::iterator it = mEntries.find (id);
+
+    if (it == mEntries.end ())
+    {
+	Entry e;
+
+	/* Just bound, so about to be painted */
+	e.pixmap      = 0;
+	e.texture     = 0;
+	e.lastPainted = mFrame;
+	e.hidden      = false;
+
+	it = mEntries.insert (std::make_pair (id, e)).first;
+    }
+
+    return it->second;
+}
+
+void
+cm::Budget::setBytes (Id                      id,
+		      unsigned long long Entry::*field,
+		      unsigned long long      bytes)
+{
+    Entry &e = entry (id);
+
+    mTotal -= e.*field;
+    e.*field = bytes;
+    mTotal += bytes;
+}
+
+void
+cm::Budget::setPixmapBytes (Id id, unsigned long long bytes)
+{
+    setBytes (id, &Entry::pixmap, bytes);
+}
+
+void
+cm::Budget::setTextureBytes (Id id, unsigned long long bytes)
+{
+    setBytes (id, &Entry::texture, bytes);
+}
+
+void
+cm::Budget::forget (Id id)
+{
+    std::map <Id, Entry>::iterator it = mEntries.find (id);
+
+    if (it == mEntries.end ())
+	return;
+
+    mTotal -= it->second.pixmap + it->second.texture;
+    mEntries.erase (it);
+}
+
+void
+cm::Budget::painted (Id id)
+{
+    entry (id).lastPainted = mFrame;
+}
+
+void
+cm::Budget::setHidden (Id id, bool hidden)
+{
+    std::map <Id, Entry>::iterator it = mEntries.find (id);
+
+    if (it != mEntries.end ())
+	it->second.hidden = hidden;
+}
+
+void
+cm::Budget::frameDone ()
+{
+    ++mFrame;
+}
+
+bool
+cm::Budget::overLimit () const
+{
+    return mLimit && mTotal > mLimit;
+}
+
+void
+cm::Budget::idle (std::vector <Id> &ids) const
+{
+    std::vector <Candidate> candidates;
+
+    for (std::map <Id, Entry>::const_iterator it = mEntries.begin ();
+	 it != mEntries.end (); ++it)
+    {
+	const Entry &e = it->second;
+
+	if (e.hidden && e.pixmap + e.texture && e.lastPainted + 1 < mFrame)
+	    candidates.push_back (Candidate (e.lastPainted, it->first));
+    }
+
+    std::sort (candidates.begin (), candidates.end ());
+
+    ids.clear ();
+
+    for (unsigned int i = 0; i < candidates.size (); ++i)
+	ids.push_back (candidates[i].second);
+}
+
+void
+cm::Budget::usage (std::vector <WindowMemoryUsage> &usage) const
+{
+    usage.clear ();
+
+    for (std::map <Id, Entry>::const_iterator it = mEntries.begin ();
+	 it != mEntries.end (); ++it)
+    {
+	const Entry       &e = it->second;
+	WindowMemoryUsage u;
+
+	u.id           = it->first;
+	u.pixmapBytes  = e.pixmap;
+	u.textureBytes = e.texture;
+	u.idleFrames   = e.lastPainted + 1 < mFrame ?
+			 mFrame - e.lastPainted - 1 : 0;
+
+	usage.push_back (u);
+    }
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "memorybudget.h"
+
+namespace cm = compiz::composite::memory;
+
+class CompositeMemoryBudgetTest :
+    public ::testing::Test
+{
+    protected:
+
+	cm::Budget budget;
+};
+
+TEST_F (CompositeMemoryBudgetTest, AddsUpBytes)
+{
+    budget.setPixmapBytes (1, 100);
+    budget.setTextureBytes (1, 100);
+    budget.setPixmapBytes (2, 50);
+    budget.setPixmapBytes (1, 10);
+
+    EXPECT_EQ (160u, budget.total ());
+
+    budget.forget (1);
+
+    EXPECT_EQ (50u, budget.total ());
+}
+
+TEST_F (CompositeMemoryBudgetTest, NoLimitIsNeverExceeded)
+{
+    budget.setPixmapBytes (1, 1000000);
+
+    EXPECT_FALSE (budget.overLimit ());
+
+    budget.setLimit (1000);
+
+    EXPECT_TRUE (budget.overLimit ());
+}
+
+TEST_F (CompositeMemoryBudgetTest, PaintedWindowsAreNotIdle)
+{
+    std::vector <cm::Budget::Id> ids;
+
+    budget.setPixmapBytes (1, 100);
+    budget.setPixmapBytes (2, 100);
+    budget.setHidden (1, true);
+    budget.setHidden (2, true);
+    budget.frameDone ();
+
+    /* Just bound counts as painted */
+    budget.idle (ids);
+    EXPECT_TRUE (ids.empty ());
+
+    budget.painted (2);
+    budget.frameDone ();
+
+    budget.idle (ids);
+    ASSERT_EQ (1u, ids.size ());
+    EXPECT_EQ (1u, ids[0]);
+}
+
+TEST_F (CompositeMemoryBudgetTest, LeastRecentlyPaintedFirst)
+{
+    std::vector <cm::Budget::Id> ids;
+
+    budget.setPixmapBytes (3, 100);
+    budget.setPixmapBytes (2, 100);
+    budget.setPixmapBytes (1, 100);
+    budget.setHidden (1, true);
+    budget.setHidden (2, true);
+    budget.setHidden (3, true);
+    budget.frameDone ();
+
+    budget.painted (1);
+    budget.painted (3);
+    budget.frameDone ();
+
+    budget.painted (1);
+    budget.frameDone ();
+
+    budget.idle (ids);
+    ASSERT_EQ (2u, ids.size ());
+    EXPECT_EQ (2u, ids[0]);
+    EXPECT_EQ (3u, ids[1]);
+}
+
+TEST_F (CompositeMemoryBudgetTest, VisibleWindowsNotRepaintedAreNotIdle)
+{
+    std::vector <cm::Budget::Id> ids;
+
+    /* Window 1 is on screen but had no damage, window 2 is covered */
+    budget.setPixmapBytes (1, 100);
+    budget.setPixmapBytes (2, 100);
+    budget.setHidden (2, true);
+    budget.frameDone ();
+    budget.frameDone ();
+
+    budget.idle (ids);
+    ASSERT_EQ (1u, ids.size ());
+    EXPECT_EQ (2u, ids[0]);
+
+    /* Uncovered again */
+    budget.setHidden (2, false);
+
+    budget.idle (ids);
+    EXPECT_TRUE (ids.empty ());
+}
+
+TEST_F (CompositeMemoryBudgetTest, ReleasedWindowsAreNotIdle)
+{
+    std::vector <cm::Budget::Id> ids;
+
+    budget.setPixmapBytes (1, 100);
+    budget.setHidden (1, true);
+    budget.frameDone ();
+    budget.frameDone ();
+
+    budget.setPixmapBytes (1, 0);
+
+    budget.idle (ids);
+    EXPECT_TRUE (ids.empty ());
+}
+
+TEST_F (CompositeMemoryBudgetTest, ReportsUsage)
+{
+    std::vector <compiz::composite::WindowMemoryUsage> usage;
+
+    budget.setPixmapBytes (1, 100);
+    budget.setTextureBytes (1, 200);
+    budget.frameDone ();
+    budget.frameDone ();
+    budget.frameDone ();
+
+    budget.usage (usage);
+
+    ASSERT_EQ (1u, usage.size ());
+    EXPECT_EQ (1u, usage[0].id);
+    EXPECT_EQ (100u, usage[0].pixmapBytes);
+    EXPECT_EQ (200u, usage[0].textureBytes);
+    EXPECT_EQ (2u, usage[0].idleFrames);
+}
@@ -181,6 +181,12 @@ class PixmapBinding :
 	bool bind ();
 	const CompSize & size () const;
 	void release ();
+
+	/* Frees the pixmap right away instead of when the next one is
+	 * bound, after the new pixmap ready callback. Returns false if
+	 * there is none or it is frozen */
+	bool discard ();
+
 	void setNewPixmapReadyCallback (const boost::function <void ()> &);
 	void allowFurtherRebindAttempts ();
 
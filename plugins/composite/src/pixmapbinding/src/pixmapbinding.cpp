@@ -130,6 +130,21 @@ PixmapBinding::release ()
 	needsRebind = true;
 }
 
+bool
+PixmapBinding::discard ()
+{
+    if (!mPixmap.get () || pixmapFreezer->frozen ())
+	return false;
+
+    if (newPixmapReadyCallback)
+	newPixmapReadyCallback ();
+
+    mPixmap.reset ();
+    needsRebind = true;
+
+    return true;
+}
+
 void
 PixmapBinding::setNewPixmapReadyCallback (const NewPixmapReadyCallback &cb)
 {
@@ -522,3 +522,70 @@ TEST(CompositePixmapBinderTest, TestInitialBindFailureWindowUnmappedSuccessOnRem
     EXPECT_EQ (pr.pixmap (), 1);
     EXPECT_EQ (pr.size (), CompSize (102, 202));
 }
+
+TEST(CompositePixmapBinderTest, TestDiscardFreesPixmapAndRebinds)
+{
+    MockPixmap::Ptr wp (boost::make_shared <MockPixmap> ());
+
+    MockWindowPixmapGet mwpg;
+    MockWindowAttributesGet mwag;
+    MockServerGrab          msg;
+    MockPixmapFreezer       mpf;
+    XWindowAttributes xwa;
+
+    xwa.width = 100;
+    xwa.height = 200;
+    xwa.map_state = IsViewable;
+    xwa.border_width = 1;
+
+    FakeWindowAttributesGet fwag (xwa);
+
+    MockPixmapReady ready;
+
+    boost::function <void ()> readyCb (boost::bind (&PixmapReadyInterface::ready, &ready));
+
+    PixmapBinding pr (readyCb,
+			&mwpg,
+			&mwag,
+			&mpf,
+			&msg);
+
+    EXPECT_CALL (msg, grabServer ());
+    EXPECT_CALL (msg, syncServer ()).Times (2);
+    EXPECT_CALL (mwag, getAttributes (_)).WillOnce (Invoke (&fwag, &FakeWindowAttributesGet::getAttributes));
+    EXPECT_CALL (mwpg, getPixmap ()).WillOnce (Return (wp));
+
+    EXPECT_CALL (*wp, pixmap ()).WillOnce (Return (1));
+
+    EXPECT_CALL (ready, ready ());
+    EXPECT_CALL (msg, ungrabServer ());
+
+    EXPECT_TRUE (pr.bind ());
+
+    /* Frozen pixmaps are kept */
+    EXPECT_CALL (mpf, frozen ()).WillOnce (Return (true));
+
+    EXPECT_FALSE (pr.discard ());
+
+    EXPECT_CALL (mpf, frozen ()).WillOnce (Return (false));
+    EXPECT_CALL (ready, ready ());
+    EXPECT_CALL (*wp, releasePixmap ());
+
+    EXPECT_TRUE (pr.discard ());
+    EXPECT_EQ (pr.pixmap (), None);
+    EXPECT_FALSE (pr.discard ());
+
+    EXPECT_CALL (msg, grabServer ());
+    EXPECT_CALL (msg, syncServer ()).Times (2);
+    EXPECT_CALL (mwag, getAttributes (_)).WillOnce (Invoke (&fwag, &FakeWindowAttributesGet::getAttributes));
+    EXPECT_CALL (mwpg, getPixmap ()).WillOnce (Return (wp));
+
+    EXPECT_CALL (*wp, pixmap ()).WillOnce (Return (1));
+
+    EXPECT_CALL (ready, ready ());
+    EXPECT_CALL (msg, ungrabServer ());
+
+    EXPECT_TRUE (pr.bind ());
+
+    EXPECT_CALL (*wp, releasePixmap ());
+}
@@ -37,6 +37,10 @@
 
 #include "pixmapbinding.h"
 #include "backbuffertracking.h"
+#include "damageacknowledgement.h"
+#include "framepacing.h"
+#include "damagethrottle.h"
+#include "memorybudget.h"
 #include "composite_options.h"
 
 extern CompPlugin::VTable *compositeVTable;
@@ -76,6 +80,11 @@ class PrivateCompositeScreen :
 
 	const CompRegion * damageTrackedBuffer (const CompRegion &);
 
+	void frameAvoided (compiz::composite::damage::AvoidedFrames::Reason,
+			   compiz::composite::damage::Time now);
+
+	void enforceMemoryBudget ();
+
     public:
 
 	CompositeScreen *cScreen;
@@ -117,17 +126,24 @@ class PrivateCompositeScreen :
 
 	CompTimer paintTimer;
 
+	compiz::composite::pacing::FramePacer framePacer;
+
+	/* Bumped whenever what windows cover of each other may change */
+	unsigned int occlusionSerial;
+
+	compiz::composite::damage::AvoidedFrames avoidedFrames;
+
+	compiz::composite::memory::Budget memoryBudget;
+
 	compiz::composite::PaintHandler *pHnd;
 
 	CompositeFPSLimiterMode FPSLimiterMode;
 
-	CompWindowList withDestroyedWindows;
-
 	Atom cmSnAtom;
 	Window newCmSnOwner;
 
-	/* Map Damage handle to its bounding box */
-	std::map<Damage, XRectangle> damages;
+	compiz::composite::damage::X11ServerDamage serverDamage;
+	compiz::composite::damage::Acknowledger    damageAcknowledger;
 
 	compiz::composite::buffertracking::AgeingDamageBuffers ageingBuffers;
 	compiz::composite::buffertracking::FrameRoster         roster;
@@ -162,6 +178,12 @@ class PrivateCompositeWindow :
 				      int             width,
 				      int             height);
 
+	void damageContents (const CompRect &rect);
+	void clipToVisible (CompRegion &damage);
+	bool knownHidden ();
+	bool releaseHeldDamage ();
+	void dropHeldDamage ();
+
     public:
 	CompWindow      *window;
 	CompositeWindow *cWindow;
@@ -183,6 +205,16 @@ class PrivateCompositeWindow :
 	int        sizeDamage;
 	int        nDamage;
 
+	/* Covered by opaque windows as of the last paint, valid while
+	 * occlusionSerial matches the screen's */
+	CompRegion   occluded;
+	unsigned int occlusionSerial;
+
+	/* Damage held back by the background window rate cap */
+	compiz::composite::damage::RateLimiter rateLimiter;
+	CompRegion                             heldDamage;
+	CompTimer                              heldDamageTimer;
+
     private:
 
 	bool getAttributes (XWindowAttributes &);
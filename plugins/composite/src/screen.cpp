@@ -53,6 +53,12 @@ namespace bt = compiz::composite::buffertracking;
 
 static const int FALLBACK_REFRESH_RATE = 60;   /* if all else fails */
 
+static compiz::composite::pacing::Time
+microseconds (const struct timeval &tv)
+{
+    return (compiz::composite::pacing::Time) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
 CompWindow *lastDamagedWindow = 0;
 
 void
@@ -107,7 +113,7 @@ PrivateCompositeScreen::handleEvent (XEvent *event)
 	    else if (event->type == damageEvent + XDamageNotify)
 	    {
 		XDamageNotifyEvent *de = (XDamageNotifyEvent*)event;
-		damages[de->damage] = de->area;
+		damageAcknowledger.damaged (de->damage, de->area);
 	    }
 	    break;
     }
@@ -309,16 +315,18 @@ PrivateCompositeScreen::PrivateCompositeScreen (CompositeScreen *cs) :
     reschedule (false),
     damageRequiresRepaintReschedule (true),
     slowAnimations (false),
+    occlusionSerial (1),
     pHnd (NULL),
     FPSLimiterMode (CompositeFPSLimiterModeDefault),
-    withDestroyedWindows (),
     cmSnAtom (0),
     newCmSnOwner (None),
+    serverDamage (screen->dpy ()),
+    damageAcknowledger (&serverDamage),
     roster (*screen,
 	    ageingBuffers,
 	    boost::bind (alwaysMarkDirty))
 {
-    gettimeofday (&lastRedraw, 0);
+    compiz::core::timer::monotonic_time (&lastRedraw);
     // wrap outputChangeNotify
     ScreenInterface::setHandler (screen);
 
@@ -530,6 +538,10 @@ CompositeScreen::damageScreen ()
 
     priv->damageMask |= COMPOSITE_SCREEN_DAMAGE_ALL_MASK;
     priv->damageMask &= ~COMPOSITE_SCREEN_DAMAGE_REGION_MASK;
+    ++priv->occlusionSerial;
+
+    if (priv->currentlyTrackingDamage == DamageForCurrentFrame)
+	screen->inputLatencyDamaged ();
 
     if (priv->damageRequiresRepaintReschedule)
 	priv->scheduleRepaint ();
@@ -555,6 +567,11 @@ CompositeScreen::damageRegion (const CompRegion &region)
 {
     WRAPABLE_HND_FUNCTN (damageRegion, region);
 
+    /* Damage carried over from older frames shows nothing new */
+    if (priv->currentlyTrackingDamage == DamageForCurrentFrame &&
+	!region.isEmpty ())
+	screen->inputLatencyDamaged ();
+
     if (priv->damageMask & COMPOSITE_SCREEN_DAMAGE_ALL_MASK)
 	return;
 
@@ -757,6 +774,9 @@ CompositeScreen::overlayWindowCount ()
 void
 CompositeScreen::setWindowPaintOffset (int x, int y)
 {
+    if (priv->windowPaintOffset != CompPoint (x, y))
+	++priv->occlusionSerial;
+
     priv->windowPaintOffset = CompPoint (x, y);
 }
 
@@ -797,6 +817,7 @@ PrivateCompositeScreen::detectRefreshRate ()
 	screen->setOptionForPlugin ("composite", "refresh_rate", value);
 	mOptions[CompositeOptions::DetectRefreshRate].value ().set (true);
 	optimalRedrawTime = redrawTime = 1000 / value.i ();
+	framePacer.setRefreshRate (value.i ());
     }
     else
     {
@@ -811,6 +832,7 @@ PrivateCompositeScreen::detectRefreshRate ()
 
 	redrawTime = 1000 / optionGetRefreshRate ();
 	optimalRedrawTime = redrawTime;
+	framePacer.setRefreshRate (optionGetRefreshRate ());
     }
 }
 
@@ -840,22 +862,17 @@ PrivateCompositeScreen::scheduleRepaint ()
 
     scheduled = true;
 
-    int delay;
+    bool alignToVBlank = FPSLimiterMode == CompositeFPSLimiterModeVSyncLike ||
+			 (pHnd && pHnd->hasVSync ());
 
-    if (FPSLimiterMode == CompositeFPSLimiterModeVSyncLike ||
-	(pHnd && pHnd->hasVSync ()))
-	delay = 1;
-    else
-    {
-	struct timeval now;
-	gettimeofday (&now, 0);
-	int elapsed = compiz::core::timer::timeval_diff (&now, &lastRedraw);
+    struct timeval now;
+    compiz::core::timer::monotonic_time (&now);
 
-	if (elapsed < 0)
-	    elapsed = 0;
+    /* Timers count whole milliseconds, rather wake up a little early */
+    int delay = framePacer.schedule (microseconds (now), alignToVBlank) / 1000;
 
- 	delay = elapsed < optimalRedrawTime ? optimalRedrawTime - elapsed : 1;
-    }
+    if (delay < 1)
+	delay = 1;
 
     paintTimer.start
 	(boost::bind (&CompositeScreen::handlePaintTimeout, cScreen),
@@ -874,6 +891,104 @@ CompositeScreen::optimalRedrawTime ()
     return priv->optimalRedrawTime;
 }
 
+unsigned int
+CompositeScreen::serverWaitTime ()
+{
+    return priv->damageAcknowledger.lastWait ();
+}
+
+const compiz::composite::FrameStatistics &
+CompositeScreen::frameStatistics ()
+{
+    return priv->framePacer.statistics ();
+}
+
+void
+CompositeScreen::frameSubmitted ()
+{
+    struct timeval tv;
+
+    compiz::core::timer::monotonic_time (&tv);
+    priv->framePacer.frameSubmitted (microseconds (tv));
+}
+
+void
+CompositeScreen::resetFrameStatistics ()
+{
+    priv->framePacer.resetStatistics ();
+    priv->avoidedFrames.reset ();
+}
+
+void
+CompositeScreen::avoidedFrames (unsigned int &occluded,
+				unsigned int &throttled)
+{
+    occluded  = priv->avoidedFrames.occluded ();
+    throttled = priv->avoidedFrames.throttled ();
+}
+
+void
+CompositeScreen::occlusionChanged ()
+{
+    ++priv->occlusionSerial;
+}
+
+void
+CompositeScreen::memoryUsage (std::vector <compiz::composite::WindowMemoryUsage> &usage)
+{
+    priv->memoryBudget.usage (usage);
+}
+
+/*
+ * Lets go of the pixmaps of windows that weren't painted lately while
+ * window contents take up more than memory_budget. Paint handlers
+ * drop their textures in the new pixmap ready callback and bind the
+ * window again when it is next painted.
+ */
+void
+PrivateCompositeScreen::enforceMemoryBudget ()
+{
+    typedef compiz::composite::memory::Budget::Id Id;
+
+    memoryBudget.setLimit ((unsigned long long) optionGetMemoryBudget () << 20);
+    memoryBudget.frameDone ();
+
+    if (!memoryBudget.overLimit ())
+	return;
+
+    /* Windows on screen can go unpainted for lack of damage, only
+     * those nobody can see are worth releasing */
+    foreach (CompWindow *w, screen->windows ())
+	memoryBudget.setHidden (w->id (),
+				CompositeWindow::get (w)->priv->knownHidden ());
+
+    std::vector <Id> idle;
+
+    memoryBudget.idle (idle);
+
+    foreach (Id id, idle)
+    {
+	CompWindow *w = screen->findWindow (id);
+
+	if (!w)
+	    continue;
+
+	if (CompositeWindow::get (w)->priv->mPixmapBinding.discard ())
+	    memoryBudget.setPixmapBytes (id, 0);
+
+	if (!memoryBudget.overLimit ())
+	    break;
+    }
+}
+
+void
+PrivateCompositeScreen::frameAvoided (compiz::composite::damage::AvoidedFrames::Reason reason,
+				      compiz::composite::damage::Time                  now)
+{
+    avoidedFrames.setPeriod (framePacer.period ());
+    avoidedFrames.avoided (reason, now, damageMask != 0);
+}
+
 bool
 CompositeScreen::handlePaintTimeout ()
 {
@@ -881,7 +996,7 @@ CompositeScreen::handlePaintTimeout ()
 
     priv->painting = true;
     priv->reschedule = false;
-    gettimeofday (&tv, 0);
+    compiz::core::timer::monotonic_time (&tv);
 
     if (priv->damageMask)
     {
@@ -889,14 +1004,18 @@ CompositeScreen::handlePaintTimeout ()
 	 * as it will end up on this frame */
 	priv->damageRequiresRepaintReschedule = false;
 
+	priv->framePacer.frameStarted (microseconds (tv));
+
+	/* Subtract the damage we are about to repair before the paint
+	 * handler fences X rendering, so anything drawn after it is
+	 * reported again */
+	priv->damageAcknowledger.acknowledge ();
+
 	if (priv->pHnd)
 	    priv->pHnd->prepareDrawing ();
 
 	int timeDiff = compiz::core::timer::timeval_diff (&tv, &priv->lastRedraw);
 
-	/* handle clock rollback */
-	if (timeDiff < 0)
-	    timeDiff = 0;
 	/*
 	 * Now that we use a "tickless" timing algorithm, timeDiff could be
 	 * very large if the screen is truely idle.
@@ -939,6 +1058,7 @@ CompositeScreen::handlePaintTimeout ()
 	 * priv->tmpRegion will be assigned. Notify plugins that do
 	 * damage tracking of this */
 	damageCutoff ();
+	screen->inputLatencyCutoff ();
 
 	priv->tmpRegion = (priv->roster.currentFrameDamage () + priv->lastFrameDamage) & screen->region ();
 	priv->currentlyTrackingDamage = DamageFinalPaintRegion;
@@ -947,21 +1067,8 @@ CompositeScreen::handlePaintTimeout ()
 	    priv->tmpRegion == screen->region ())
 		damageScreen ();
 
-	Display *dpy = screen->dpy ();
-	std::map<Damage, XRectangle>::iterator d = priv->damages.begin ();
-
-	for (; d != priv->damages.end (); ++d)
-	{
-	    XserverRegion sub = XFixesCreateRegion (dpy, &d->second, 1);
-	    if (sub != None)
-	    {
-		XDamageSubtract (dpy, d->first, sub, None);
-		XFixesDestroyRegion (dpy, sub);
-	    }
-	}
-
-	XSync (dpy, False);
-	priv->damages.clear ();
+	priv->damageAcknowledger.retire (!priv->pHnd ||
+					 priv->pHnd->fencesXRequests ());
 
 	/* Any more damage requires a repaint reschedule */
 	priv->damageRequiresRepaintReschedule = true;
@@ -992,6 +1099,14 @@ CompositeScreen::handlePaintTimeout ()
 
 	donePaint ();
 
+	/* The paint handler has returned from the swap */
+	struct timeval done;
+	compiz::core::timer::monotonic_time (&done);
+	priv->framePacer.frameFinished (microseconds (done));
+	screen->inputLatencyPresented ();
+
+	priv->enforceMemoryBudget ();
+
 	priv->outputShapeChanged = false;
 
 	foreach (CompWindow *w, screen->windows ())
@@ -1036,41 +1151,30 @@ CompositeScreen::getWindowPaintList ()
 {
     WRAPABLE_HND_FUNCTN_RETURN (const CompWindowList &, getWindowPaintList)
 
-    /* Include destroyed windows */
-    if (screen->destroyedWindows ().empty ())
-	return screen->windows ();
-    else
-    {
-	CompWindowList destroyedWindows = screen->destroyedWindows ();
-
-	priv->withDestroyedWindows.resize (0);
-
-	foreach (CompWindow *w, screen->windows ())
-	{
-	    foreach (CompWindow *dw, screen->destroyedWindows ())
-	    {
-		if (dw->next == w)
-		{
-		    priv->withDestroyedWindows.push_back (dw);
-		    destroyedWindows.remove (dw);
-		    break;
-		}
-	    }
-
-	    priv->withDestroyedWindows.push_back (w);
-	}
+    /* Core keeps destroyed windows in place in the paint order */
+    return screen->windowPaintOrder ();
+}
 
-	/* We need to put all the destroyed windows which didn't get
-	 * inserted in the paint list at the top of the stack since
-	 * w->next was probably either invalid or NULL */
+compiz::composite::PaintListSnapshot::PaintListSnapshot (CompositeScreen *cScreen)
+{
+    screen->freezeWindowPaintOrder ();
 
-	foreach (CompWindow *dw, destroyedWindows)
-	    priv->withDestroyedWindows.push_back (dw);
+    const CompWindowList &pl = cScreen->getWindowPaintList ();
 
-	return priv->withDestroyedWindows;
+    if (&pl == &screen->windowPaintOrder ())
+	mList = &pl;
+    else
+    {
+	mCopy = pl;
+	mList = &mCopy;
     }
 }
 
+compiz::composite::PaintListSnapshot::~PaintListSnapshot ()
+{
+    screen->thawWindowPaintOrder ();
+}
+
 void
 PrivateCompositeScreen::handleExposeEvent (XExposeEvent *event)
 {
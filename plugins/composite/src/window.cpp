@@ -27,6 +27,29 @@
 
 #include "privates.h"
 
+#include <core/timer.h>
+
+namespace cd = compiz::composite::damage;
+
+namespace
+{
+cd::Time
+now ()
+{
+    struct timeval tv;
+
+    compiz::core::timer::monotonic_time (&tv);
+
+    return (cd::Time) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+unsigned int
+bytesPerPixel (int depth)
+{
+    return depth > 16 ? 4 : (depth > 8 ? 2 : 1);
+}
+}
+
 template class WrapableInterface<CompositeWindow, CompositeWindowInterface>;
 template class PluginClassHandler<CompositeWindow, CompWindow, COMPIZ_COMPOSITE_ABI>;
 
@@ -61,7 +84,10 @@ CompositeWindow::CompositeWindow (CompWindow *w) :
 CompositeWindow::~CompositeWindow ()
 {
     if (priv->damage)
+    {
+	priv->cScreen->priv->damageAcknowledger.forget (priv->damage);
 	XDamageDestroy (screen->dpy (), priv->damage);
+    }
 
      if (!priv->redirected)
     {
@@ -75,6 +101,8 @@ CompositeWindow::~CompositeWindow ()
 
     addDamage ();
 
+    priv->cScreen->priv->memoryBudget.forget (priv->window->id ());
+
     if (lastDamagedWindow == priv->window)
 	lastDamagedWindow = NULL;
 
@@ -118,7 +146,8 @@ PrivateCompositeWindow::PrivateCompositeWindow (CompWindow      *w,
     saturation (COLOR),
     damageRects (0),
     sizeDamage (0),
-    nDamage (0)
+    nDamage (0),
+    occlusionSerial (0)
 {
     WindowInterface::setHandler (w);
 }
@@ -132,7 +161,17 @@ PrivateCompositeWindow::~PrivateCompositeWindow ()
 bool
 PrivateCompositeWindow::bind ()
 {
-    return mPixmapBinding.bind ();
+    if (!mPixmapBinding.bind ())
+	return false;
+
+    const CompSize &size = mPixmapBinding.size ();
+
+    cScreen->priv->memoryBudget.setPixmapBytes (window->id (),
+						(unsigned long long) size.width () *
+						size.height () *
+						bytesPerPixel (window->depth ()));
+
+    return true;
 }
 
 bool
@@ -371,6 +410,9 @@ CompositeWindow::addDamageRect (const CompRect &rect)
 void
 CompositeWindow::addDamage (bool force)
 {
+    /* Whatever changed about the window may uncover others */
+    ++priv->cScreen->priv->occlusionSerial;
+
     if (priv->cScreen->damageMask () & COMPOSITE_SCREEN_DAMAGE_ALL_MASK)
 	return;
 
@@ -447,14 +489,150 @@ PrivateCompositeWindow::handleDamageRect (CompositeWindow *w,
 	x += geom.x () + geom.border ();
 	y += geom.y () + geom.border ();
 
-	w->priv->cScreen->damageRegion (CompRegion (CompRect
-						    (x, y, width, height)));
+	w->priv->damageContents (CompRect (x, y, width, height));
     }
 
     if (initial)
 	w->damageOutputExtents ();
 }
 
+void
+CompositeWindow::setOccludedRegion (const CompRegion &occluded)
+{
+    priv->occluded        = occluded;
+    priv->occlusionSerial = priv->cScreen->priv->occlusionSerial;
+}
+
+bool
+CompositeWindow::occludedRegionKnown ()
+{
+    return priv->occlusionSerial == priv->cScreen->priv->occlusionSerial;
+}
+
+void
+CompositeWindow::setTextureBytes (unsigned long long bytes)
+{
+    priv->cScreen->priv->memoryBudget.setTextureBytes (priv->window->id (),
+						       bytes);
+}
+
+void
+CompositeWindow::markPainted ()
+{
+    priv->cScreen->priv->memoryBudget.painted (priv->window->id ());
+}
+
+/* Leaves out what the last paint found covered, as long as
+ * nothing happened since that could have uncovered it */
+void
+PrivateCompositeWindow::clipToVisible (CompRegion &damage)
+{
+    if (!cWindow->occludedRegionKnown ())
+	return;
+
+    damage -= occluded;
+    damage &= screen->region ();
+}
+
+/* Minimized, off the screen, or covered completely according to the
+ * last paint with nothing changed since */
+bool
+PrivateCompositeWindow::knownHidden ()
+{
+    if (window->minimized () || !window->isViewable ())
+	return true;
+
+    CompRegion shown = CompRegion (window->outputRect ()) & screen->region ();
+
+    if (shown.isEmpty ())
+	return true;
+
+    return cWindow->occludedRegionKnown () && (shown - occluded).isEmpty ();
+}
+
+/*
+ * Damage to what the window shows, in screen coordinates. Damage
+ * nobody can see schedules no repaint, and background windows are
+ * repainted at no more than background_refresh_rate.
+ */
+void
+PrivateCompositeWindow::damageContents (const CompRect &rect)
+{
+    PrivateCompositeScreen *ps = cScreen->priv;
+    CompRegion             damage (rect);
+
+    clipToVisible (damage);
+
+    if (damage.isEmpty ())
+    {
+	ps->frameAvoided (cd::AvoidedFrames::Occluded, now ());
+	return;
+    }
+
+    if (screen->activeWindow () == window->id () ||
+	!ps->optionGetBackgroundMatch ().evaluate (window))
+    {
+	if (rateLimiter.holding ())
+	{
+	    damage += heldDamage;
+	    dropHeldDamage ();
+	}
+
+	cScreen->damageRegion (damage);
+	return;
+    }
+
+    cd::Time     t = now ();
+    unsigned int wait;
+
+    rateLimiter.setInterval (1000000 / ps->optionGetBackgroundRefreshRate ());
+    wait = rateLimiter.damaged (t);
+
+    if (!wait)
+    {
+	damage += heldDamage;
+	heldDamage = CompRegion ();
+	heldDamageTimer.stop ();
+
+	cScreen->damageRegion (damage);
+	return;
+    }
+
+    heldDamage += damage;
+    ps->frameAvoided (cd::AvoidedFrames::Throttled, t);
+
+    if (!heldDamageTimer.active ())
+	heldDamageTimer.start (boost::bind (&PrivateCompositeWindow::releaseHeldDamage,
+					    this),
+			       (wait + 999) / 1000);
+}
+
+bool
+PrivateCompositeWindow::releaseHeldDamage ()
+{
+    rateLimiter.release (now ());
+
+    clipToVisible (heldDamage);
+
+    if (!heldDamage.isEmpty ())
+	cScreen->damageRegion (heldDamage);
+
+    heldDamage = CompRegion ();
+
+    return false;
+}
+
+/* Held damage is in screen coordinates and out of date once the
+ * window moves, is resized or goes away, all of which damage the
+ * whole window anyway */
+void
+PrivateCompositeWindow::dropHeldDamage ()
+{
+    rateLimiter.reset ();
+    heldDamage = CompRegion ();
+    heldDamageTimer.stop ();
+}
+
 void
 CompositeWindow::updateOpacity ()
 {
@@ -529,6 +707,8 @@ CompositeWindow::damageRect (bool           initial,
 void
 PrivateCompositeWindow::windowNotify (CompWindowNotify n)
 {
+    ++cScreen->priv->occlusionSerial;
+
     switch (n)
     {
 	case CompWindowNotifyMap:
@@ -537,6 +717,7 @@ PrivateCompositeWindow::windowNotify (CompWindowNotify n)
 	    break;
 
 	case CompWindowNotifyUnmap:
+	    dropHeldDamage ();
 	    cWindow->addDamage (true);
 	    cWindow->release ();
 
@@ -591,6 +772,9 @@ PrivateCompositeWindow::resizeNotify (int dx, int dy, int dwidth, int dheight)
 {
     window->resizeNotify (dx, dy, dwidth, dheight);
 
+    ++cScreen->priv->occlusionSerial;
+    dropHeldDamage ();
+
     if (window->shaded () || (window->isViewable ()))
     {
 	int x = window->geometry ().x ();
@@ -613,6 +797,9 @@ PrivateCompositeWindow::resizeNotify (int dx, int dy, int dwidth, int dheight)
 void
 PrivateCompositeWindow::moveNotify (int dx, int dy, bool now)
 {
+    ++cScreen->priv->occlusionSerial;
+    dropHeldDamage ();
+
     if (window->shaded () || (window->isViewable ()))
     {
 	int x = window->geometry ().x ();
@@ -244,7 +244,8 @@ DecorWindow::glDecorate (const GLMatrix     &transform,
     {
 	CompRect box;
 	GLTexture::MatrixList ml (1);
-	mask |= PAINT_WINDOW_BLEND_MASK;
+	/* Windows sharing a decoration texture can be drawn together */
+	mask |= PAINT_WINDOW_BLEND_MASK | PAINT_WINDOW_BATCH_MASK;
 
 	gWindow->vertexBuffer ()->begin ();
 	const CompRegion *preg = NULL;
@@ -401,6 +401,8 @@ MagScreen::paintSimple ()
 	ch = h;
     }
 
+    gScreen->submitHeldDraws ();
+
     glBindTexture (target, texture);
 
     if (width != w || height != h)
@@ -578,6 +580,8 @@ MagScreen::paintImage ()
     
     glEnable (target);
 
+    gScreen->submitHeldDraws ();
+
     glBindTexture (target, texture);
 
     if (width != w || height != h)
@@ -731,6 +735,8 @@ MagScreen::paintFisheye ()
  
     glEnable (target);
 
+    gScreen->submitHeldDraws ();
+
     glBindTexture (target, texture);
 
     if (width != 2 * size || height != 2 * size)
@@ -152,6 +152,20 @@ typedef intptr_t GLintptr;
 #define GL_SYNC_X11_FENCE_EXT              0x90E1
 #endif
 
+#ifndef GL_PROGRAM_BINARY_LENGTH
+# ifdef GL_OES_get_program_binary
+#  define GL_PROGRAM_BINARY_LENGTH         GL_PROGRAM_BINARY_LENGTH_OES
+#  define GL_NUM_PROGRAM_BINARY_FORMATS    GL_NUM_PROGRAM_BINARY_FORMATS_OES
+# else
+#  define GL_PROGRAM_BINARY_LENGTH         0x8741
+#  define GL_NUM_PROGRAM_BINARY_FORMATS    0x87FE
+# endif
+#endif
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+
 namespace GL {
     #ifdef USE_GLES
     typedef EGLImageKHR (*EGLCreateImageKHRProc)  (EGLDisplay dpy,
@@ -373,6 +387,19 @@ namespace GL {
 				    GLintptr external_sync,
 				    GLbitfield flags);
 
+    typedef void (*GLGetProgramBinaryProc) (GLuint program,
+					GLsizei bufSize,
+					GLsizei *length,
+					GLenum *binaryFormat,
+					GLvoid *binary);
+    typedef void (*GLProgramBinaryProc) (GLuint program,
+				     GLenum binaryFormat,
+				     const GLvoid *binary,
+				     GLint length);
+    typedef void (*GLProgramParameteriProc) (GLuint program,
+					 GLenum pname,
+					 GLint value);
+
 
     /* GL_ARB_shader_objects */
     #ifndef USE_GLES
@@ -580,6 +607,10 @@ namespace GL {
 
     extern GLImportSyncProc importSync;
 
+    extern GLGetProgramBinaryProc  getProgramBinary;
+    extern GLProgramBinaryProc     programBinary;
+    extern GLProgramParameteriProc programParameteri;
+
     extern bool  textureFromPixmap;
     extern bool  textureRectangle;
     extern bool  textureNonPowerOfTwo;
@@ -601,6 +632,7 @@ namespace GL {
 
     extern bool  sync;
     extern bool  xToGLSync;
+    extern bool  programBinaries;
 
     extern bool canDoSaturated;
     extern bool canDoSlightlySaturated;
@@ -849,6 +881,75 @@ class GLScreen :
 
 	void resetRasterPos ();
 
+	/**
+	 * Returns how many windows had their occlusion taken from the
+	 * previous frame and how many had it worked out again
+	 */
+	void occlusionCacheStatistics (unsigned long long &hits,
+				       unsigned long long &misses) const;
+
+	/**
+	 * Returns how many state changes (texture binds, program
+	 * switches, blend, stencil and scissor toggles) the last frame
+	 * made and how many were left out because nothing changed.
+	 * Plugins hooking paint functions make them all while they run
+	 */
+	void glStateStatistics (unsigned int &issued,
+				unsigned int &elided) const;
+
+	/**
+	 * Returns how many draws the last frame held back to batch them,
+	 * see PAINT_WINDOW_BATCH_MASK, and how many draw calls it took
+	 * to submit them
+	 */
+	void drawBatchStatistics (unsigned int &held,
+				  unsigned int &submitted) const;
+
+	/**
+	 * Draws whatever is held back for batching right away. Plugins
+	 * that read the framebuffer while painting have to call this
+	 * first, or they miss the held draws
+	 */
+	void submitHeldDraws ();
+
+	/**
+	 * Returns how many programs were built ahead of time while
+	 * compiz was idle and how many had to be built while painting
+	 */
+	void shaderWarmupStatistics (unsigned int &prebuilt,
+				     unsigned int &onDemand) const;
+
+	/**
+	 * Returns how many window pixmaps were bound to a texture object
+	 * kept from an earlier pixmap and how many needed a new one
+	 */
+	void texturePoolStatistics (unsigned long long &reused,
+				    unsigned long long &created) const;
+
+	/**
+	 * Returns how many times painting left an unbound window unbound
+	 * because nothing of it was drawn, and how many windows were
+	 * bound ahead of their first paint through prefetch
+	 */
+	void lazyBindStatistics (unsigned long long &deferred,
+				 unsigned long long &prefetched) const;
+
+	/**
+	 * Returns how many windows painting had to bind itself, and the
+	 * microseconds spent binding windows while painting and ahead
+	 * of it through prefetch. Time spent binding while painting is
+	 * added to the frame that first shows the window
+	 */
+	void lazyBindTimes (unsigned long long &paintBinds,
+			    unsigned long long &painting,
+			    unsigned long long &prefetching) const;
+
+	/**
+	 * Binds the windows on a viewport as soon as compiz is idle,
+	 * for plugins about to bring that viewport into view
+	 */
+	void prefetchViewport (const CompPoint &viewport);
+
 	bool glInitContext (XVisualInfo *);
 
 	WRAPABLE_HND (0, GLScreenInterface, bool, glPaintOutput,
@@ -882,6 +983,14 @@ class GLScreen :
 	PrivateGLScreen *priv;
 };
 
+/**
+ * flag indicate that glDrawTexture may hold the draw back and submit
+ * it later together with other draws using the same texture and
+ * state. Whatever is drawn in the meantime must go through
+ * GLVertexBuffer, which submits held draws it would cover first.
+ */
+#define PAINT_WINDOW_BATCH_MASK			(1 << 20)
+
 struct GLWindowPaintAttrib {
     GLushort opacity;
     GLushort brightness;
@@ -993,6 +1102,12 @@ class GLWindow :
 	 */
 	bool bind ();
 
+	/**
+	 * Binds this window as soon as compiz is idle, so that its
+	 * first paint does not have to wait for the binding
+	 */
+	void prefetch ();
+
 	/**
 	 * Releases this window from an openGL texture
 	 */
@@ -1015,6 +1130,17 @@ class GLWindow :
 	 */
 	GLVertexBuffer * vertexBuffer ();
 
+	/**
+	 * Marks the geometry of this window as changing every frame.
+	 *
+	 * Geometry built by an unwrapped glAddGeometry is kept in a
+	 * static buffer while the window, its clip and its textures stay
+	 * the same. Plugins that wrap glAddGeometry are detected, plugins
+	 * that change the window geometry some other way must set this
+	 * while they do.
+	 */
+	void setDynamicGeometry (bool dynamic);
+
 	/**
 	 * Add a vertex and/or fragment shader function to the pipeline.
 	 *
@@ -40,6 +40,25 @@ class PrivateProgram;
 class GLProgram
 {
     public:
+	/**
+	 * A uniform name resolved once, to be kept around and used with
+	 * the setUniform overloads taking one. Those look the location up
+	 * only the first time and skip the upload if the program already
+	 * holds the value. The name overloads resolve a handle each call,
+	 * which is cheap when given the same string literal every time
+	 * but still slower than keeping a handle.
+	 */
+	class UniformHandle
+	{
+	    public:
+		explicit UniformHandle (const char *name);
+
+	    private:
+		unsigned int id;
+
+		friend class GLProgram;
+	};
+
 	GLProgram (CompString &vertexShader, CompString &fragmentShader);
 	~GLProgram ();
 
@@ -65,6 +84,30 @@ class GLProgram
 	                   GLint z,
                            GLint w);
 
+	bool setUniform   (const UniformHandle &uniform, GLfloat value);
+	bool setUniform   (const UniformHandle &uniform, GLint value);
+	bool setUniform   (const UniformHandle &uniform, const GLMatrix &value);
+	bool setUniform2f (const UniformHandle &uniform, GLfloat x, GLfloat y);
+	bool setUniform3f (const UniformHandle &uniform,
+	                   GLfloat x,
+	                   GLfloat y,
+	                   GLfloat z);
+	bool setUniform4f (const UniformHandle &uniform,
+	                   GLfloat x,
+	                   GLfloat y,
+	                   GLfloat z,
+	                   GLfloat w);
+	bool setUniform2i (const UniformHandle &uniform, GLint x, GLint y);
+	bool setUniform3i (const UniformHandle &uniform,
+	                   GLint x,
+	                   GLint y,
+	                   GLint z);
+	bool setUniform4i (const UniformHandle &uniform,
+	                   GLint x,
+	                   GLint y,
+	                   GLint z,
+	                   GLint w);
+
 	GLuint attributeLocation (const char *name);
 
     private:
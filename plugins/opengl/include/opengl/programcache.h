@@ -45,6 +45,12 @@ class GLProgramCache
 	~GLProgramCache ();
 
 	GLProgram* operator () (std::list<const GLShaderData*>);
+
+	/* Whether the program is cached, without counting as a use */
+	bool cached (const std::list<const GLShaderData*> &) const;
+
+	/* How many programs had to be built because they weren't cached */
+	unsigned int compiled () const;
 };
 
 #endif // _COMPIZ_GLPROGRAMCACHE_H
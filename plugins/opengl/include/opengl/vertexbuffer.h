@@ -68,9 +68,19 @@ class GLVertexBuffer
 
 	static GLVertexBuffer *streamingBuffer ();
 
+	/* Bytes of vertex data uploaded and buffer storage allocations
+	 * made during the last frame painted */
+	static void frameStatistics (unsigned long long &bytesUploaded,
+				     unsigned int       &allocations);
+
 	void begin (GLenum primitiveType = GL_TRIANGLES);
 	bool end ();
 
+	// Prepares another render () of what the last end () uploaded,
+	// resetting uniforms, color and vertex range as begin () would.
+	// Returns false if there is nothing to render
+	bool restart ();
+
 	// vertices and normals are 3 parts, count is number of xyz groups
 	void addVertices (GLuint nVertices, const GLfloat *vertices);
 	GLfloat *getVertices () const;  // AKA GLWindow::Geometry::vertices
@@ -102,6 +112,20 @@ class GLVertexBuffer
 	void addUniform4i (const char *name, GLint x, GLint y,
 			                     GLint z, GLint w);
 
+	// the same, for names resolved once up front
+	void addUniform (const GLProgram::UniformHandle &, GLfloat value);
+	void addUniform (const GLProgram::UniformHandle &, GLint value);
+	void addUniform2f (const GLProgram::UniformHandle &, GLfloat x, GLfloat y);
+	void addUniform3f (const GLProgram::UniformHandle &,
+			   GLfloat x, GLfloat y, GLfloat z);
+	void addUniform4f (const GLProgram::UniformHandle &,
+			   GLfloat x, GLfloat y, GLfloat z, GLfloat w);
+	void addUniform2i (const GLProgram::UniformHandle &, GLint x, GLint y);
+	void addUniform3i (const GLProgram::UniformHandle &,
+			   GLint x, GLint y, GLint z);
+	void addUniform4i (const GLProgram::UniformHandle &,
+			   GLint x, GLint y, GLint z, GLint w);
+
 	void setProgram (GLProgram *program);
 
 	void setAutoProgram (AutoProgram *autoProgram);
@@ -124,6 +148,8 @@ class GLVertexBuffer
 
     private:
 	PrivateVertexBuffer *priv;
+
+	friend class PrivateVertexBuffer;
 };
 
 #endif // _COMPIZ_GLVERTEXBUFFER_H
@@ -0,0 +1,193 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "drawbatch.h"
+
+namespace co = compiz::opengl;
+
+namespace
+{
+bool
+intersect (const co::DrawBatch::Box &a, const co::DrawBatch::Box &b)
+{
+    return a.x1 < b.x2 && b.x1 < a.x2 &&
+	   a.y1 < b.y2 && b.y1 < a.y2;
+}
+}
+
+bool
+co::DrawBatch::Span::overlaps (const Box &box) const
+{
+    if (!intersect (box, extents))
+	return false;
+
+    for (unsigned int i = 0; i < draws.size (); ++i)
+	if (intersect (box, draws[i]))
+	    return true;
+
+    return false;
+}
+
+co::DrawBatch::DrawBatch () :
+    mAdded (0),
+    mBatches (0),
+    mLastAdded (0),
+    mLastBatches (0)
+{
+}
+
+bool
+co::DrawBatch::bounds (const float *vertices, unsigned int count, Box &box)
+{
+    if (!count)
+	return false;
+
+    box.x1 = box.x2 = vertices[0];
+    box.y1 = box.y2 = vertices[1];
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+	const float *v = vertices + i * 3;
+
+	if (v[2] != 0.0f)
+	    return false;
+
+	if (v[0] < box.x1)
+	    box.x1 = v[0];
+	else if (v[0] > box.x2)
+	    box.x2 = v[0];
+
+	if (v[1] < box.y1)
+	    box.y1 = v[1];
+	else if (v[1] > box.y2)
+	    box.y2 = v[1];
+    }
+
+    return true;
+}
+
+bool
+co::DrawBatch::add (unsigned int key,
+		    const float  *vertices,
+		    const float  *texCoords,
+		    unsigned int count,
+		    const Box    &box)
+{
+    Span *span = 0;
+
+    for (unsigned int i = 0; i < mSpans.size (); ++i)
+    {
+	if (mSpans[i].key == key)
+	    span = &mSpans[i];
+	else if (mSpans[i].overlaps (box))
+	    return false;
+    }
+
+    if (!span)
+    {
+	mSpans.push_back (Span ());
+
+	span          = &mSpans.back ();
+	span->key     = key;
+	span->extents = box;
+    }
+    else
+    {
+	Box &extents = span->extents;
+
+	if (box.x1 < extents.x1)
+	    extents.x1 = box.x1;
+	if (box.y1 < extents.y1)
+	    extents.y1 = box.y1;
+	if (box.x2 > extents.x2)
+	    extents.x2 = box.x2;
+	if (box.y2 > extents.y2)
+	    extents.y2 = box.y2;
+    }
+
+    span->vertices.insert (span->vertices.end (),
+			   vertices, vertices + count * 3);
+    span->texCoords.insert (span->texCoords.end (),
+			    texCoords, texCoords + count * 2);
+    span->draws.push_back (box);
+
+    ++mAdded;
+
+    return true;
+}
+
+bool
+co::DrawBatch::overlaps (const Box &box) const
+{
+    for (unsigned int i = 0; i < mSpans.size (); ++i)
+	if (mSpans[i].overlaps (box))
+	    return true;
+
+    return false;
+}
+
+unsigned int
+co::DrawBatch::key (unsigned int span) const
+{
+    return mSpans[span].key;
+}
+
+unsigned int
+co::DrawBatch::count (unsigned int span) const
+{
+    return mSpans[span].vertices.size () / 3;
+}
+
+const float *
+co::DrawBatch::vertices (unsigned int span) const
+{
+    return &mSpans[span].vertices[0];
+}
+
+const float *
+co::DrawBatch::texCoords (unsigned int span) const
+{
+    return &mSpans[span].texCoords[0];
+}
+
+void
+co::DrawBatch::submitted ()
+{
+    mBatches += mSpans.size ();
+    clear ();
+}
+
+void
+co::DrawBatch::clear ()
+{
+    mSpans.clear ();
+}
+
+void
+co::DrawBatch::frameDone ()
+{
+    mLastAdded   = mAdded;
+    mLastBatches = mBatches;
+    mAdded       = 0;
+    mBatches     = 0;
+}
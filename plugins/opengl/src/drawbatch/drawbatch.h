@@ -0,0 +1,122 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_OPENGL_DRAWBATCH_H
+#define _COMPIZ_OPENGL_DRAWBATCH_H
+
+#include <vector>
+
+namespace compiz {
+namespace opengl {
+
+/**
+ * Collects the triangles of textured draws so that draws sharing all
+ * their GL state can be submitted as one.
+ *
+ * Draws are added under a key standing for that state, each key's
+ * draws form a span submitted with one draw call, spans in the order
+ * they were started. GL draws primitives in the order they are
+ * submitted, so the draws of one span may overlap each other. A draw
+ * that overlaps a held draw of another key can't be moved ahead of it
+ * and is refused, submit what is held first. The same goes for any
+ * other draw made while draws are held, check it with overlaps ().
+ * Only flat geometry (z = 0) can be checked, see bounds ().
+ */
+class DrawBatch
+{
+    public:
+
+	struct Box
+	{
+	    float x1, y1, x2, y2;
+	};
+
+	DrawBatch ();
+
+	/* Bounding box of count xyz vertices. Returns false if there
+	 * are none or any of them has a z other than 0 */
+	static bool bounds (const float *vertices, unsigned int count,
+			    Box &box);
+
+	/* Adds count vertices (xyz) and texture coordinates (st) that
+	 * lie within box to the span of key. Returns false if box
+	 * overlaps a draw held for another key */
+	bool add (unsigned int key,
+		  const float  *vertices,
+		  const float  *texCoords,
+		  unsigned int count,
+		  const Box    &box);
+
+	/* Whether box shares any area with a held draw */
+	bool overlaps (const Box &box) const;
+
+	bool empty () const { return mSpans.empty (); }
+
+	/* Spans held, in the order they have to be submitted */
+	unsigned int spans () const { return mSpans.size (); }
+	unsigned int key (unsigned int span) const;
+	unsigned int count (unsigned int span) const;
+	const float *vertices (unsigned int span) const;
+	const float *texCoords (unsigned int span) const;
+
+	/* Call once every span has been drawn, drops them */
+	void submitted ();
+
+	/* Drops what is held without counting it as drawn */
+	void clear ();
+
+	/* Ends a frame for the counters below */
+	void frameDone ();
+
+	/* Draws added and draw calls submitted for them during the
+	 * last frame */
+	unsigned int added () const { return mLastAdded; }
+	unsigned int batches () const { return mLastBatches; }
+
+    private:
+
+	struct Span
+	{
+	    unsigned int        key;
+	    std::vector <float> vertices;
+	    std::vector <float> texCoords;
+
+	    /* One box per draw and the box around all of them */
+	    std::vector <Box>   draws;
+	    Box                 extents;
+
+	    bool overlaps (const Box &box) const;
+	};
+
+	std::vector <Span> mSpans;
+
+	unsigned int mAdded;
+	unsigned int mBatches;
+	unsigned int mLastAdded;
+	unsigned int mLastBatches;
+};
+
+}
+}
+
+#endif
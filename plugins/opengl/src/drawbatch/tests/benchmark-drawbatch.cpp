@@ -0,0 +1,202 @@
+/*
+ * Counts the draw calls of one frame of 50 decorated windows, drawn
+ * one glDrawTexture per decoration as DecorWindow::glDecorate does,
+ * against holding the decorations back in a DrawBatch.
+ *
+ * Every window draws its content and then its decoration, in stacking
+ * order. The held decorations are submitted before any draw that
+ * overlaps them, as PrivateVertexBuffer does. The layouts are windows
+ * tiled apart from each other and windows cascaded on top of each
+ * other, with every decoration sharing one texture (a shadow only or
+ * default decoration) or only every other one doing so.
+ *
+ * Run compiz_opengl_drawbatch_benchmark [frames]
+ */
+
+#include "drawbatch.h"
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+using compiz::opengl::DrawBatch;
+
+namespace
+{
+
+const unsigned int nWindows (50);
+
+/* Shadow around the window and the title bar above it */
+const float shadow (16);
+const float title (28);
+
+double
+now ()
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+struct Window
+{
+    float        x, y, width, height;
+    unsigned int decorTexture;
+};
+
+void
+quad (std::vector <float> &vertices,
+      std::vector <float> &texCoords,
+      float x1, float y1, float x2, float y2)
+{
+    const float corners[6][2] = {
+	{ x1, y1 }, { x1, y2 }, { x2, y1 },
+	{ x1, y2 }, { x2, y2 }, { x2, y1 }
+    };
+
+    for (int i = 0; i < 6; ++i)
+    {
+	vertices.push_back (corners[i][0]);
+	vertices.push_back (corners[i][1]);
+	vertices.push_back (0.0f);
+	texCoords.push_back (0.0f);
+	texCoords.push_back (0.0f);
+    }
+}
+
+/* The eight quads of a pixmap decoration around the window */
+void
+decoration (const Window        &w,
+	    std::vector <float> &vertices,
+	    std::vector <float> &texCoords)
+{
+    float x1 = w.x - shadow;
+    float y1 = w.y - shadow - title;
+    float x2 = w.x + w.width + shadow;
+    float y2 = w.y + w.height + shadow;
+
+    vertices.clear ();
+    texCoords.clear ();
+
+    quad (vertices, texCoords, x1, y1, w.x, w.y);
+    quad (vertices, texCoords, w.x, y1, w.x + w.width, w.y);
+    quad (vertices, texCoords, w.x + w.width, y1, x2, w.y);
+    quad (vertices, texCoords, x1, w.y, w.x, w.y + w.height);
+    quad (vertices, texCoords, w.x + w.width, w.y, x2, w.y + w.height);
+    quad (vertices, texCoords, x1, w.y + w.height, w.x, y2);
+    quad (vertices, texCoords, w.x, w.y + w.height, w.x + w.width, y2);
+    quad (vertices, texCoords, w.x + w.width, w.y + w.height, x2, y2);
+}
+
+std::vector <Window>
+tiled (bool shared)
+{
+    std::vector <Window> windows;
+
+    for (unsigned int i = 0; i < nWindows; ++i)
+    {
+	Window w = { 40.0f + (i % 10) * 250.0f, 60.0f + (i / 10) * 220.0f,
+		     200.0f, 150.0f, shared || i % 2 ? 0 : i + 1 };
+
+	windows.push_back (w);
+    }
+
+    return windows;
+}
+
+std::vector <Window>
+cascaded (bool shared)
+{
+    std::vector <Window> windows;
+
+    for (unsigned int i = 0; i < nWindows; ++i)
+    {
+	Window w = { 40.0f + i * 30.0f, 60.0f + i * 20.0f,
+		     640.0f, 480.0f, shared || i % 2 ? 0 : i + 1 };
+
+	windows.push_back (w);
+    }
+
+    return windows;
+}
+
+/* Returns the draw calls made for one frame */
+unsigned int
+frame (const std::vector <Window> &windows, DrawBatch &batch)
+{
+    std::vector <float> vertices, texCoords;
+    unsigned int        calls = 0;
+
+    for (unsigned int i = 0; i < windows.size (); ++i)
+    {
+	const Window   &w = windows[i];
+	DrawBatch::Box content = { w.x, w.y, w.x + w.width, w.y + w.height };
+	DrawBatch::Box box;
+
+	if (batch.overlaps (content))
+	{
+	    calls += batch.spans ();
+	    batch.submitted ();
+	}
+
+	/* The content itself */
+	++calls;
+
+	decoration (w, vertices, texCoords);
+	DrawBatch::bounds (&vertices[0], vertices.size () / 3, box);
+
+	if (!batch.add (w.decorTexture, &vertices[0], &texCoords[0],
+			vertices.size () / 3, box))
+	{
+	    calls += batch.spans ();
+	    batch.submitted ();
+	    batch.add (w.decorTexture, &vertices[0], &texCoords[0],
+		       vertices.size () / 3, box);
+	}
+    }
+
+    calls += batch.spans ();
+    batch.submitted ();
+
+    batch.frameDone ();
+
+    return calls;
+}
+
+void
+run (const char *name, const std::vector <Window> &windows, int frames)
+{
+    DrawBatch    batch;
+    unsigned int calls = 0;
+    double       start = now ();
+
+    for (int n = 0; n < frames; ++n)
+	calls = frame (windows, batch);
+
+    double elapsed = now () - start;
+
+    printf ("%-22s %8u %8u %8u %10.2f us\n", name,
+	    (unsigned int) windows.size () * 2, calls, batch.batches (),
+	    elapsed * 1000.0 / frames);
+}
+
+}
+
+int
+main (int argc, char **argv)
+{
+    int frames = argc > 1 ? atoi (argv[1]) : 1000;
+
+    printf ("%u windows, %d frames\n", nWindows, frames);
+    printf ("%-22s %8s %8s %8s %13s\n", "layout", "before", "after",
+	    "batches", "cpu/frame");
+
+    run ("tiled, shared", tiled (true), frames);
+    run ("tiled, every other", tiled (false), frames);
+    run ("cascaded, shared", cascaded (true), frames);
+    run ("cascaded, every other", cascaded (false), frames);
+
+    return 0;
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "drawbatch.h"
+
+using compiz::opengl::DrawBatch;
+
+namespace
+{
+/* Two triangles covering a rectangle, as glAddGeometry makes them */
+struct Quad
+{
+    Quad (float x1, float y1, float x2, float y2, float z = 0.0f)
+    {
+	const float corners[6][2] = {
+	    { x1, y1 }, { x1, y2 }, { x2, y1 },
+	    { x1, y2 }, { x2, y2 }, { x2, y1 }
+	};
+
+	for (int i = 0; i < 6; ++i)
+	{
+	    vertices.push_back (corners[i][0]);
+	    vertices.push_back (corners[i][1]);
+	    vertices.push_back (z);
+	    texCoords.push_back (corners[i][0] / 100.0f);
+	    texCoords.push_back (corners[i][1] / 100.0f);
+	}
+    }
+
+    std::vector <float> vertices;
+    std::vector <float> texCoords;
+};
+
+DrawBatch::Box
+box (float x1, float y1, float x2, float y2)
+{
+    DrawBatch::Box b = { x1, y1, x2, y2 };
+
+    return b;
+}
+
+bool
+add (DrawBatch &batch, unsigned int key, const Quad &quad)
+{
+    DrawBatch::Box b;
+
+    if (!DrawBatch::bounds (&quad.vertices[0], 6, b))
+	return false;
+
+    return batch.add (key, &quad.vertices[0], &quad.texCoords[0], 6, b);
+}
+}
+
+TEST (OpenGLDrawBatch, BoundsOfFlatGeometry)
+{
+    Quad           quad (10, 20, 30, 50);
+    DrawBatch::Box b;
+
+    ASSERT_TRUE (DrawBatch::bounds (&quad.vertices[0], 6, b));
+    EXPECT_EQ (10, b.x1);
+    EXPECT_EQ (20, b.y1);
+    EXPECT_EQ (30, b.x2);
+    EXPECT_EQ (50, b.y2);
+}
+
+TEST (OpenGLDrawBatch, NoBoundsWithoutFlatGeometry)
+{
+    Quad           quad (10, 20, 30, 50, 1.0f);
+    DrawBatch::Box b;
+
+    EXPECT_FALSE (DrawBatch::bounds (&quad.vertices[0], 6, b));
+    EXPECT_FALSE (DrawBatch::bounds (&quad.vertices[0], 0, b));
+}
+
+TEST (OpenGLDrawBatch, AppendsInOrder)
+{
+    DrawBatch batch;
+
+    EXPECT_TRUE (batch.empty ());
+
+    EXPECT_TRUE (add (batch, 7, Quad (0, 0, 10, 10)));
+    EXPECT_TRUE (add (batch, 7, Quad (50, 50, 60, 60)));
+
+    EXPECT_FALSE (batch.empty ());
+    ASSERT_EQ (1u, batch.spans ());
+    EXPECT_EQ (7u, batch.key (0));
+    ASSERT_EQ (12u, batch.count (0));
+    EXPECT_EQ (0, batch.vertices (0)[0]);
+    EXPECT_EQ (50, batch.vertices (0)[6 * 3]);
+    EXPECT_FLOAT_EQ (0.5f, batch.texCoords (0)[6 * 2]);
+}
+
+TEST (OpenGLDrawBatch, SameKeyMayOverlap)
+{
+    DrawBatch batch;
+
+    EXPECT_TRUE (add (batch, 1, Quad (0, 0, 10, 10)));
+    EXPECT_TRUE (add (batch, 1, Quad (5, 5, 15, 15)));
+
+    EXPECT_EQ (1u, batch.spans ());
+}
+
+/* Spans are submitted in the order they were started, a draw joining
+ * an earlier span must not overlap anything held for a later one */
+TEST (OpenGLDrawBatch, OtherKeysMustNotOverlap)
+{
+    DrawBatch batch;
+
+    EXPECT_TRUE (add (batch, 1, Quad (0, 0, 10, 10)));
+    EXPECT_TRUE (add (batch, 2, Quad (20, 0, 30, 10)));
+    EXPECT_TRUE (add (batch, 1, Quad (40, 0, 50, 10)));
+    EXPECT_FALSE (add (batch, 1, Quad (25, 5, 45, 10)));
+    EXPECT_FALSE (add (batch, 3, Quad (5, 5, 45, 10)));
+
+    ASSERT_EQ (2u, batch.spans ());
+    EXPECT_EQ (1u, batch.key (0));
+    EXPECT_EQ (12u, batch.count (0));
+    EXPECT_EQ (2u, batch.key (1));
+    EXPECT_EQ (6u, batch.count (1));
+}
+
+TEST (OpenGLDrawBatch, OverlapsOnlyHeldDraws)
+{
+    DrawBatch batch;
+
+    EXPECT_FALSE (batch.overlaps (box (0, 0, 100, 100)));
+
+    add (batch, 1, Quad (0, 0, 10, 10));
+    add (batch, 1, Quad (50, 50, 60, 60));
+    add (batch, 2, Quad (100, 0, 110, 10));
+
+    EXPECT_TRUE (batch.overlaps (box (5, 5, 6, 6)));
+    EXPECT_TRUE (batch.overlaps (box (55, 0, 56, 51)));
+    EXPECT_TRUE (batch.overlaps (box (105, 5, 106, 6)));
+
+    /* Within the extents, between the draws */
+    EXPECT_FALSE (batch.overlaps (box (20, 20, 40, 40)));
+
+    /* Sharing an edge is no overlap */
+    EXPECT_FALSE (batch.overlaps (box (10, 0, 50, 10)));
+    EXPECT_FALSE (batch.overlaps (box (200, 200, 300, 300)));
+}
+
+TEST (OpenGLDrawBatch, CountsAddedAndSubmittedPerFrame)
+{
+    DrawBatch batch;
+
+    add (batch, 1, Quad (0, 0, 10, 10));
+    add (batch, 1, Quad (20, 0, 30, 10));
+    add (batch, 2, Quad (40, 0, 50, 10));
+    batch.submitted ();
+
+    EXPECT_TRUE (batch.empty ());
+    EXPECT_FALSE (batch.overlaps (box (0, 0, 10, 10)));
+
+    add (batch, 1, Quad (0, 0, 10, 10));
+    batch.submitted ();
+
+    /* Nothing held, nothing to submit */
+    batch.submitted ();
+
+    add (batch, 1, Quad (0, 0, 10, 10));
+    batch.clear ();
+
+    EXPECT_EQ (0u, batch.added ());
+    EXPECT_EQ (0u, batch.batches ());
+
+    batch.frameDone ();
+
+    EXPECT_EQ (5u, batch.added ());
+    EXPECT_EQ (3u, batch.batches ());
+
+    batch.frameDone ();
+
+    EXPECT_EQ (0u, batch.added ());
+    EXPECT_EQ (0u, batch.batches ());
+}
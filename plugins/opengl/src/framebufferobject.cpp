@@ -27,6 +27,8 @@
 #include <opengl/framebufferobject.h>
 #include <opengl/texture.h>
 
+#include "privates.h"
+
 struct PrivateGLFramebufferObject
 {
     PrivateGLFramebufferObject () :
@@ -156,6 +158,9 @@ GLFramebufferObject::bind ()
 		"An FBO without GLFramebufferObject cannot be restored");
     }
 
+    /* Held draws go where they were made */
+    PrivateVertexBuffer::submitHeld ();
+
     (*GL::bindFramebuffer) (GL::FRAMEBUFFER, priv->fboId);
     priv->boundId = priv->fboId;
 
@@ -173,6 +178,7 @@ GLFramebufferObject::rebind (GLFramebufferObject *fbo)
 
     if (id != fbo->priv->boundId)
     {
+	PrivateVertexBuffer::submitHeld ();
 	(*GL::bindFramebuffer) (GL::FRAMEBUFFER, id);
 	fbo->priv->boundId = id;
     }
@@ -0,0 +1,333 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "glstate.h"
+
+namespace co = compiz::opengl;
+
+co::StateCache::Key::Key (Kind kind, unsigned int unit, unsigned int target) :
+    kind (kind),
+    unit (unit),
+    target (target)
+{
+}
+
+bool
+co::StateCache::Key::operator< (const Key &other) const
+{
+    if (kind != other.kind)
+	return kind < other.kind;
+
+    if (unit != other.unit)
+	return unit < other.unit;
+
+    return target < other.target;
+}
+
+co::StateCache::Item::Item () :
+    known (false),
+    value (0),
+    released (false)
+{
+}
+
+co::StateCache::StateCache (Driver *driver) :
+    mDriver (driver),
+    mDeferTextureRelease (false),
+    mSuspended (false),
+    mReleased (0),
+    mUnit (0),
+    mIssued (0),
+    mElided (0),
+    mLastIssued (0),
+    mLastElided (0)
+{
+}
+
+void
+co::StateCache::setDeferTextureRelease (bool defer)
+{
+    if (!defer)
+	flush ();
+
+    mDeferTextureRelease = defer;
+}
+
+void
+co::StateCache::enable (unsigned int cap)
+{
+    set (Key (Capability, 0, cap), 1);
+}
+
+void
+co::StateCache::disable (unsigned int cap)
+{
+    set (Key (Capability, 0, cap), 0);
+}
+
+void
+co::StateCache::release (unsigned int cap)
+{
+    release (Key (Capability, 0, cap), true);
+}
+
+void
+co::StateCache::settle (unsigned int cap)
+{
+    ItemMap::iterator it = mItems.find (Key (Capability, 0, cap));
+
+    if (mSuspended || it == mItems.end () || !it->second.released)
+	return;
+
+    it->second.released = false;
+    it->second.known    = true;
+    it->second.value    = 0;
+    --mReleased;
+    issue (it->first, 0);
+}
+
+void
+co::StateCache::activeTexture (unsigned int unit)
+{
+    mUnit = unit;
+
+    if (mSuspended)
+    {
+	mDriver->activeTexture (unit);
+	++mIssued;
+    }
+    else if (mActive.known && mActive.value == unit)
+	++mElided;
+    else
+	select (unit);
+}
+
+void
+co::StateCache::enableTarget (unsigned int target)
+{
+    set (Key (Target, mUnit, target), 1);
+}
+
+void
+co::StateCache::releaseTarget (unsigned int target)
+{
+    release (Key (Target, mUnit, target), mDeferTextureRelease);
+}
+
+void
+co::StateCache::bindTexture (unsigned int target, unsigned int name)
+{
+    set (Key (Binding, mUnit, target), name);
+}
+
+void
+co::StateCache::releaseTexture (unsigned int target)
+{
+    release (Key (Binding, mUnit, target), mDeferTextureRelease);
+}
+
+void
+co::StateCache::textureDeleted (unsigned int name)
+{
+    for (ItemMap::iterator it = mItems.begin (); it != mItems.end (); ++it)
+    {
+	Item &item = it->second;
+
+	if (it->first.kind != Binding || !item.known || item.value != name)
+	    continue;
+
+	if (item.released)
+	{
+	    item.released = false;
+	    --mReleased;
+	}
+
+	item.value = 0;
+    }
+}
+
+void
+co::StateCache::useProgram (unsigned int program)
+{
+    set (Key (Program, 0, 0), program);
+}
+
+void
+co::StateCache::releaseProgram ()
+{
+    release (Key (Program, 0, 0), true);
+}
+
+void
+co::StateCache::flush ()
+{
+    if (mReleased)
+    {
+	for (ItemMap::iterator it = mItems.begin (); it != mItems.end (); ++it)
+	    if (it->second.released)
+	    {
+		it->second.released = false;
+		it->second.known    = true;
+		it->second.value    = 0;
+		issue (it->first, 0);
+	    }
+
+	mReleased = 0;
+    }
+
+    /* Leave the unit callers asked for active for direct GL calls */
+    if (mActive.known && mActive.value != mUnit)
+	select (mUnit);
+}
+
+void
+co::StateCache::invalidate ()
+{
+    /* Whatever happened meanwhile, released state has to end up
+     * back at the default */
+    flush ();
+
+    mItems.clear ();
+    mReleased = 0;
+    mActive   = Item ();
+}
+
+void
+co::StateCache::suspend ()
+{
+    invalidate ();
+    mSuspended = true;
+}
+
+void
+co::StateCache::resume ()
+{
+    mSuspended = false;
+}
+
+void
+co::StateCache::frameDone ()
+{
+    mLastIssued = mIssued;
+    mLastElided = mElided;
+    mIssued     = 0;
+    mElided     = 0;
+}
+
+void
+co::StateCache::set (const Key &key, unsigned int value)
+{
+    if (mSuspended)
+    {
+	issue (key, value);
+	return;
+    }
+
+    Item &item = mItems[key];
+
+    if (item.released)
+    {
+	/* Putting the default back is never needed now */
+	item.released = false;
+	--mReleased;
+	++mElided;
+    }
+
+    if (item.known && item.value == value)
+    {
+	++mElided;
+	return;
+    }
+
+    item.known = true;
+    item.value = value;
+    issue (key, value);
+}
+
+void
+co::StateCache::release (const Key &key, bool defer)
+{
+    if (!defer || mSuspended)
+    {
+	set (key, 0);
+	return;
+    }
+
+    Item &item = mItems[key];
+
+    if (item.released || (item.known && item.value == 0))
+    {
+	++mElided;
+	return;
+    }
+
+    item.released = true;
+    ++mReleased;
+}
+
+void
+co::StateCache::issue (const Key &key, unsigned int value)
+{
+    switch (key.kind) {
+	case Capability:
+	    if (value)
+		mDriver->enable (key.target);
+	    else
+		mDriver->disable (key.target);
+	    break;
+	case Target:
+	    select (key.unit);
+	    if (value)
+		mDriver->enable (key.target);
+	    else
+		mDriver->disable (key.target);
+	    break;
+	case Binding:
+	    select (key.unit);
+	    mDriver->bindTexture (key.target, value);
+	    break;
+	case Program:
+	    mDriver->useProgram (value);
+	    break;
+    }
+
+    ++mIssued;
+}
+
+void
+co::StateCache::select (unsigned int unit)
+{
+    /* Whoever else makes calls may have changed the unit, texture
+     * calls go to the one made active last like in GL */
+    if (mSuspended)
+	return;
+
+    if (mActive.known && mActive.value == unit)
+	return;
+
+    mDriver->activeTexture (unit);
+
+    mActive.known = true;
+    mActive.value = unit;
+    ++mIssued;
+}
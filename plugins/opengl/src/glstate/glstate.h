@@ -0,0 +1,173 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_OPENGL_GLSTATE_H
+#define _COMPIZ_OPENGL_GLSTATE_H
+
+#include <map>
+
+namespace compiz {
+namespace opengl {
+
+/**
+ * Remembers the GL state set through it and leaves out calls that
+ * wouldn't change anything.
+ *
+ * Code that sets state for a draw and puts the default back afterwards
+ * does the latter with one of the release calls. Those only say the
+ * state isn't needed any more: if the next draw asks for the same
+ * state again neither call is made, anything still released at the
+ * next flush () is set back to the default then.
+ *
+ * The cache can't see GL calls that don't go through it. Suspend it
+ * while running code that may make such calls, every call is then
+ * made as asked for.
+ */
+class StateCache
+{
+    public:
+
+	class Driver
+	{
+	    public:
+
+		virtual ~Driver () {}
+
+		virtual void enable (unsigned int cap) = 0;
+		virtual void disable (unsigned int cap) = 0;
+
+		/* Unit counts from 0 */
+		virtual void activeTexture (unsigned int unit) = 0;
+		virtual void bindTexture (unsigned int target,
+					  unsigned int name) = 0;
+
+		virtual void useProgram (unsigned int program) = 0;
+	};
+
+	StateCache (Driver *driver);
+
+	/* Whether releasing a texture may be put off. Only safe when
+	 * every draw binds the textures it samples and doesn't depend
+	 * on which targets are enabled, as with shaders */
+	void setDeferTextureRelease (bool defer);
+
+	/* Capabilities that aren't per texture unit */
+	void enable (unsigned int cap);
+	void disable (unsigned int cap);
+	void release (unsigned int cap);
+
+	/* Disables cap now if it was released, leaves it alone otherwise.
+	 * For draws that don't need cap but mustn't override a caller
+	 * that enabled it directly */
+	void settle (unsigned int cap);
+
+	/* Texture calls apply to the active unit, like in GL */
+	void activeTexture (unsigned int unit);
+	void enableTarget (unsigned int target);
+	void releaseTarget (unsigned int target);
+	void bindTexture (unsigned int target, unsigned int name);
+	void releaseTexture (unsigned int target);
+
+	/* Deleting a bound texture binds 0 in its place */
+	void textureDeleted (unsigned int name);
+
+	void useProgram (unsigned int program);
+	void releaseProgram ();
+
+	/* Makes the calls released state still waits for */
+	void flush ();
+
+	/* Flushes, then forgets everything so the next call for each
+	 * state is made */
+	void invalidate ();
+
+	/* Invalidates and makes every call until resumed */
+	void suspend ();
+	void resume ();
+	bool suspended () const { return mSuspended; }
+
+	/* Ends a frame for the counters below */
+	void frameDone ();
+
+	/* GL calls made and left out during the last frame */
+	unsigned int issued () const { return mLastIssued; }
+	unsigned int elided () const { return mLastElided; }
+
+    private:
+
+	enum Kind
+	{
+	    Capability,
+	    Target,
+	    Binding,
+	    Program
+	};
+
+	struct Key
+	{
+	    Key (Kind kind, unsigned int unit, unsigned int target);
+
+	    bool operator< (const Key &other) const;
+
+	    Kind         kind;
+	    unsigned int unit;
+	    unsigned int target;
+	};
+
+	struct Item
+	{
+	    Item ();
+
+	    bool         known;
+	    unsigned int value;
+	    bool         released;
+	};
+
+	typedef std::map <Key, Item> ItemMap;
+
+	void set (const Key &key, unsigned int value);
+	void release (const Key &key, bool defer);
+	void issue (const Key &key, unsigned int value);
+	void select (unsigned int unit);
+
+	Driver       *mDriver;
+	bool         mDeferTextureRelease;
+	bool         mSuspended;
+
+	ItemMap      mItems;
+	unsigned int mReleased;
+
+	/* The unit callers asked for and the one GL has active */
+	unsigned int mUnit;
+	Item         mActive;
+
+	unsigned int mIssued;
+	unsigned int mElided;
+	unsigned int mLastIssued;
+	unsigned int mLastElided;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,337 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "glstate.h"
+
+using compiz::opengl::StateCache;
+
+namespace
+{
+const unsigned int Blend     = 0x0be2;
+const unsigned int Scissor   = 0x0c11;
+const unsigned int Texture2D = 0x0de1;
+
+class RecordingDriver :
+    public StateCache::Driver
+{
+    public:
+
+	void enable (unsigned int cap)
+	{
+	    record ("enable", cap);
+	}
+
+	void disable (unsigned int cap)
+	{
+	    record ("disable", cap);
+	}
+
+	void activeTexture (unsigned int unit)
+	{
+	    record ("unit", unit);
+	}
+
+	void bindTexture (unsigned int, unsigned int name)
+	{
+	    record ("bind", name);
+	}
+
+	void useProgram (unsigned int program)
+	{
+	    record ("program", program);
+	}
+
+	std::vector <std::string> calls;
+
+    private:
+
+	void record (const char *call, unsigned int value)
+	{
+	    char buffer[32];
+
+	    snprintf (buffer, sizeof (buffer), "%s %x", call, value);
+	    calls.push_back (buffer);
+	}
+};
+
+/* What glDrawTexture does for one window */
+void
+drawWindow (StateCache &state, unsigned int texture, unsigned int program)
+{
+    state.enable (Blend);
+    state.activeTexture (0);
+    state.enableTarget (Texture2D);
+    state.bindTexture (Texture2D, texture);
+    state.useProgram (program);
+    state.releaseProgram ();
+    state.releaseTexture (Texture2D);
+    state.releaseTarget (Texture2D);
+    state.release (Blend);
+}
+}
+
+class OpenGLStateCacheTest :
+    public ::testing::Test
+{
+    protected:
+
+	OpenGLStateCacheTest () :
+	    state (&driver)
+	{
+	}
+
+	RecordingDriver driver;
+	StateCache      state;
+};
+
+TEST_F (OpenGLStateCacheTest, FirstCallIsAlwaysMade)
+{
+    state.disable (Blend);
+
+    ASSERT_EQ (1u, driver.calls.size ());
+    EXPECT_EQ ("disable be2", driver.calls[0]);
+}
+
+TEST_F (OpenGLStateCacheTest, UnchangedStateIsElided)
+{
+    state.enable (Scissor);
+    state.enable (Scissor);
+    state.disable (Scissor);
+    state.disable (Scissor);
+
+    EXPECT_EQ (2u, driver.calls.size ());
+
+    state.frameDone ();
+
+    EXPECT_EQ (2u, state.issued ());
+    EXPECT_EQ (2u, state.elided ());
+}
+
+TEST_F (OpenGLStateCacheTest, ReleasedStateIsKeptForTheNextDraw)
+{
+    state.setDeferTextureRelease (true);
+
+    drawWindow (state, 1, 7);
+    driver.calls.clear ();
+
+    drawWindow (state, 2, 7);
+
+    /* Only the texture differs between the two windows */
+    ASSERT_EQ (1u, driver.calls.size ());
+    EXPECT_EQ ("bind 2", driver.calls[0]);
+}
+
+TEST_F (OpenGLStateCacheTest, FlushPutsReleasedStateBack)
+{
+    state.setDeferTextureRelease (true);
+
+    drawWindow (state, 1, 7);
+    driver.calls.clear ();
+
+    state.flush ();
+
+    ASSERT_EQ (4u, driver.calls.size ());
+    EXPECT_EQ ("disable be2", driver.calls[0]);
+    EXPECT_EQ ("disable de1", driver.calls[1]);
+    EXPECT_EQ ("bind 0", driver.calls[2]);
+    EXPECT_EQ ("program 0", driver.calls[3]);
+
+    driver.calls.clear ();
+    state.flush ();
+
+    EXPECT_TRUE (driver.calls.empty ());
+}
+
+TEST_F (OpenGLStateCacheTest, SettleOnlyPutsReleasedStateBack)
+{
+    state.enable (Blend);
+    state.release (Blend);
+    driver.calls.clear ();
+
+    state.settle (Blend);
+
+    ASSERT_EQ (1u, driver.calls.size ());
+    EXPECT_EQ ("disable be2", driver.calls[0]);
+
+    /* A caller enabled blending itself and the cache was resumed */
+    state.suspend ();
+    state.resume ();
+    driver.calls.clear ();
+
+    state.settle (Blend);
+    state.settle (Scissor);
+    state.flush ();
+
+    EXPECT_TRUE (driver.calls.empty ());
+}
+
+TEST_F (OpenGLStateCacheTest, TexturesAreReleasedAtOnceUnlessDeferred)
+{
+    drawWindow (state, 1, 7);
+    driver.calls.clear ();
+
+    drawWindow (state, 1, 7);
+
+    /* The program and blending may wait, the fixed function texture
+     * state can't */
+    ASSERT_EQ (4u, driver.calls.size ());
+    EXPECT_EQ ("enable de1", driver.calls[0]);
+    EXPECT_EQ ("bind 1", driver.calls[1]);
+    EXPECT_EQ ("bind 0", driver.calls[2]);
+    EXPECT_EQ ("disable de1", driver.calls[3]);
+}
+
+TEST_F (OpenGLStateCacheTest, TextureStateIsPerUnit)
+{
+    state.activeTexture (0);
+    state.bindTexture (Texture2D, 1);
+    state.activeTexture (1);
+    state.bindTexture (Texture2D, 1);
+    state.activeTexture (0);
+    state.bindTexture (Texture2D, 1);
+
+    ASSERT_EQ (5u, driver.calls.size ());
+    EXPECT_EQ ("unit 0", driver.calls[0]);
+    EXPECT_EQ ("bind 1", driver.calls[1]);
+    EXPECT_EQ ("unit 1", driver.calls[2]);
+    EXPECT_EQ ("bind 1", driver.calls[3]);
+    EXPECT_EQ ("unit 0", driver.calls[4]);
+}
+
+TEST_F (OpenGLStateCacheTest, FlushRestoresTheActiveUnit)
+{
+    state.setDeferTextureRelease (true);
+
+    state.activeTexture (1);
+    state.bindTexture (Texture2D, 3);
+    state.releaseTexture (Texture2D);
+    state.activeTexture (0);
+    driver.calls.clear ();
+
+    state.flush ();
+
+    ASSERT_EQ (3u, driver.calls.size ());
+    EXPECT_EQ ("unit 1", driver.calls[0]);
+    EXPECT_EQ ("bind 0", driver.calls[1]);
+    EXPECT_EQ ("unit 0", driver.calls[2]);
+}
+
+TEST_F (OpenGLStateCacheTest, InvalidateForgetsWhatWasSet)
+{
+    state.useProgram (7);
+    state.invalidate ();
+    state.useProgram (7);
+
+    EXPECT_EQ (2u, driver.calls.size ());
+}
+
+TEST_F (OpenGLStateCacheTest, InvalidateFlushesFirst)
+{
+    state.useProgram (7);
+    state.releaseProgram ();
+    driver.calls.clear ();
+
+    state.invalidate ();
+
+    ASSERT_EQ (1u, driver.calls.size ());
+    EXPECT_EQ ("program 0", driver.calls[0]);
+}
+
+TEST_F (OpenGLStateCacheTest, CountsPerFrame)
+{
+    state.setDeferTextureRelease (true);
+
+    drawWindow (state, 1, 7);
+    drawWindow (state, 2, 7);
+    state.flush ();
+    state.frameDone ();
+
+    /* 5 calls for the first window, 1 for the second, 4 to flush */
+    EXPECT_EQ (10u, state.issued ());
+    /* Setting and releasing each kept state, the repeated unit and
+     * the release of the first texture */
+    EXPECT_EQ (8u, state.elided ());
+
+    state.frameDone ();
+
+    EXPECT_EQ (0u, state.issued ());
+    EXPECT_EQ (0u, state.elided ());
+}
+
+TEST_F (OpenGLStateCacheTest, SuspendedCacheMakesEveryCall)
+{
+    state.setDeferTextureRelease (true);
+
+    state.useProgram (7);
+    state.releaseProgram ();
+    state.suspend ();
+
+    EXPECT_TRUE (state.suspended ());
+
+    driver.calls.clear ();
+
+    drawWindow (state, 1, 7);
+    drawWindow (state, 1, 7);
+
+    EXPECT_EQ (18u, driver.calls.size ());
+}
+
+TEST_F (OpenGLStateCacheTest, ResumedCacheKnowsNothing)
+{
+    state.enable (Blend);
+    state.suspend ();
+    state.resume ();
+    driver.calls.clear ();
+
+    state.enable (Blend);
+    state.enable (Blend);
+
+    EXPECT_EQ (1u, driver.calls.size ());
+}
+
+TEST_F (OpenGLStateCacheTest, DeletedTextureNameCanBeBoundAgain)
+{
+    state.setDeferTextureRelease (true);
+
+    state.bindTexture (Texture2D, 5);
+    state.releaseTexture (Texture2D);
+    state.textureDeleted (5);
+    driver.calls.clear ();
+
+    /* GL unbound it already */
+    state.flush ();
+
+    EXPECT_TRUE (driver.calls.empty ());
+
+    /* A new texture may get the same name */
+    state.bindTexture (Texture2D, 5);
+
+    ASSERT_EQ (1u, driver.calls.size ());
+    EXPECT_EQ ("bind 5", driver.calls[0]);
+}
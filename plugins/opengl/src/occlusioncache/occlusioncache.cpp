@@ -0,0 +1,137 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "occlusioncache.h"
+
+namespace co = compiz::opengl;
+
+namespace
+{
+const CompRegion nothing;
+}
+
+co::OcclusionCache::OcclusionCache () :
+    mPosition (0),
+    mValid (false),
+    mHits (0),
+    mMisses (0)
+{
+}
+
+void
+co::OcclusionCache::begin ()
+{
+    mPosition = 0;
+    mValid    = true;
+}
+
+bool
+co::OcclusionCache::same (const Entry &e, const Window &window)
+{
+    return e.id == window.id && e.state == window.state &&
+	   e.opacity == window.opacity && e.region == *window.region;
+}
+
+bool
+co::OcclusionCache::lookup (const Window &window)
+{
+    if (!mValid || mPosition >= mEntries.size ())
+	return false;
+
+    if (!same (mEntries[mPosition], window))
+    {
+	mValid = false;
+	return false;
+    }
+
+    ++mPosition;
+    ++mHits;
+
+    return true;
+}
+
+void
+co::OcclusionCache::store (const Window &window, bool occludes)
+{
+    /* Worked out again, but nothing changed for the windows below */
+    if (mValid && mPosition < mEntries.size () &&
+	same (mEntries[mPosition], window) &&
+	mEntries[mPosition].occludes == occludes)
+    {
+	++mPosition;
+	++mHits;
+	return;
+    }
+
+    /* Everything below depends on this one */
+    mValid = false;
+
+    if (mPosition >= mEntries.size ())
+	mEntries.resize (mPosition + 1);
+
+    Entry &e = mEntries[mPosition];
+
+    e.above    = occluded ();
+    e.id       = window.id;
+    e.region   = *window.region;
+    e.state    = window.state;
+    e.opacity  = window.opacity;
+    e.occludes = occludes;
+    e.below    = occludes ? e.above + e.region : e.above;
+
+    ++mPosition;
+    ++mMisses;
+}
+
+void
+co::OcclusionCache::end ()
+{
+    if (mPosition < mEntries.size ())
+	mEntries.resize (mPosition);
+}
+
+bool
+co::OcclusionCache::occludes () const
+{
+    return mPosition ? mEntries[mPosition - 1].occludes : false;
+}
+
+const CompRegion &
+co::OcclusionCache::occludedAbove () const
+{
+    return mPosition ? mEntries[mPosition - 1].above : nothing;
+}
+
+const CompRegion &
+co::OcclusionCache::occluded () const
+{
+    return mPosition ? mEntries[mPosition - 1].below : nothing;
+}
+
+void
+co::OcclusionCache::invalidate ()
+{
+    mEntries.clear ();
+    mPosition = 0;
+    mValid    = false;
+}
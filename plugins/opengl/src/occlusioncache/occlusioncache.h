@@ -0,0 +1,126 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_OPENGL_OCCLUSIONCACHE_H
+#define _COMPIZ_OPENGL_OCCLUSIONCACHE_H
+
+#include <vector>
+
+#include "core/region.h"
+
+namespace compiz {
+namespace opengl {
+
+/**
+ * Remembers the outcome of the occlusion pass from one paint to the
+ * next.
+ *
+ * The pass walks the windows from the top down. For every window
+ * that takes part in it the cache keeps what the window looked like,
+ * whether it occluded what is below and the area covered by the
+ * occluding windows above it. The clip of a window is then just the
+ * paint region minus that area, whatever the paint region is.
+ *
+ * As long as every window from the top is the same as last time, its
+ * result is reused. From the first window that changed on, everything
+ * below is worked out again and stored.
+ *
+ * Windows painted through plugin hooks have to be asked every time,
+ * as the hooks may change their opacity or what they cover. Storing
+ * the same result as last time for such a window doesn't count as a
+ * change, the windows below can still be looked up.
+ */
+class OcclusionCache
+{
+    public:
+
+	/* Everything about a window the occlusion pass looks at */
+	struct Window
+	{
+	    const void       *id;
+	    const CompRegion *region;
+	    unsigned int     state;
+	    unsigned short   opacity;
+	};
+
+	OcclusionCache ();
+
+	/* Starts over at the top of the stack */
+	void begin ();
+
+	/* Whether the next window down is unchanged and so is every
+	 * window above it. If so, occludes () and occludedAbove ()
+	 * are what they were last time */
+	bool lookup (const Window &window);
+
+	/* Records the result for the next window down, which has to
+	 * be worked out when lookup () fails or isn't used. Only a
+	 * result that differs from the last one makes the windows
+	 * further down be worked out again */
+	void store (const Window &window, bool occludes);
+
+	/* Forgets about windows further down that weren't seen */
+	void end ();
+
+	/* For the window last looked up or stored */
+	bool occludes () const;
+	const CompRegion & occludedAbove () const;
+
+	/* The area covered by the occluding windows seen so far */
+	const CompRegion & occluded () const;
+
+	/* Windows whose result was reused and windows whose result
+	 * had to be worked out */
+	unsigned long long hits () const { return mHits; }
+	unsigned long long misses () const { return mMisses; }
+
+	/* Makes the next walk work everything out again */
+	void invalidate ();
+
+    private:
+
+	struct Entry
+	{
+	    const void     *id;
+	    CompRegion     region;
+	    unsigned int   state;
+	    unsigned short opacity;
+	    bool           occludes;
+	    CompRegion     above;
+	    CompRegion     below;
+	};
+
+	static bool same (const Entry &entry, const Window &window);
+
+	std::vector <Entry> mEntries;
+	unsigned int        mPosition;
+	bool                mValid;
+
+	unsigned long long mHits;
+	unsigned long long mMisses;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,215 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "occlusioncache.h"
+
+using compiz::opengl::OcclusionCache;
+
+namespace
+{
+struct TestWindow
+{
+    TestWindow (int x, int y, int w, int h, bool occludes = true) :
+	region (x, y, w, h),
+	occludes (occludes),
+	opacity (0xffff),
+	hooked (false)
+    {
+    }
+
+    OcclusionCache::Window window () const
+    {
+	OcclusionCache::Window w = { this, &region, 0, opacity };
+
+	return w;
+    }
+
+    CompRegion     region;
+    bool           occludes;
+    unsigned short opacity;
+
+    /* Painted through a plugin's glPaint, so always asked */
+    bool           hooked;
+};
+}
+
+class OpenGLOcclusionCache :
+    public ::testing::Test
+{
+    protected:
+
+	OpenGLOcclusionCache () :
+	    top (0, 0, 100, 100),
+	    middle (50, 50, 100, 100, false),
+	    bottom (0, 0, 200, 200)
+	{
+	    stack.push_back (&top);
+	    stack.push_back (&middle);
+	    stack.push_back (&bottom);
+	}
+
+	/* Does what paintOutputRegion does, returns the clips */
+	std::vector <CompRegion> walk (const CompRegion &region)
+	{
+	    std::vector <CompRegion> clips;
+
+	    cache.begin ();
+
+	    for (unsigned int i = 0; i < stack.size (); ++i)
+	    {
+		OcclusionCache::Window w = stack[i]->window ();
+
+		if (stack[i]->hooked || !cache.lookup (w))
+		    cache.store (w, stack[i]->occludes);
+
+		clips.push_back (region - cache.occludedAbove ());
+	    }
+
+	    cache.end ();
+
+	    return clips;
+	}
+
+	TestWindow                top, middle, bottom;
+	std::vector <TestWindow *> stack;
+	OcclusionCache            cache;
+};
+
+TEST_F (OpenGLOcclusionCache, ClipsMatchSubtractingFromTheTop)
+{
+    CompRegion region (0, 0, 300, 300);
+    std::vector <CompRegion> clips = walk (region);
+
+    ASSERT_EQ (3u, clips.size ());
+    EXPECT_EQ (region, clips[0]);
+    EXPECT_EQ (region - top.region, clips[1]);
+    EXPECT_EQ (region - top.region, clips[2]);
+    EXPECT_EQ (top.region + bottom.region, cache.occluded ());
+}
+
+TEST_F (OpenGLOcclusionCache, UnchangedStackIsReused)
+{
+    walk (CompRegion (0, 0, 300, 300));
+
+    EXPECT_EQ (0u, cache.hits ());
+    EXPECT_EQ (3u, cache.misses ());
+
+    /* A different paint region doesn't matter */
+    std::vector <CompRegion> clips = walk (CompRegion (0, 0, 10, 300));
+
+    EXPECT_EQ (3u, cache.hits ());
+    EXPECT_EQ (3u, cache.misses ());
+    EXPECT_EQ (CompRegion (0, 100, 10, 200), clips[2]);
+}
+
+TEST_F (OpenGLOcclusionCache, WindowsBelowAChangeAreWorkedOutAgain)
+{
+    walk (CompRegion (0, 0, 300, 300));
+
+    middle.occludes = true;
+    middle.opacity  = 0xfffe;
+
+    std::vector <CompRegion> clips = walk (CompRegion (0, 0, 300, 300));
+
+    EXPECT_EQ (1u, cache.hits ());
+    EXPECT_EQ (5u, cache.misses ());
+    EXPECT_EQ (CompRegion (0, 0, 300, 300) - top.region - middle.region,
+	       clips[2]);
+}
+
+TEST_F (OpenGLOcclusionCache, HookedWindowWithTheSameResultIsNoChange)
+{
+    top.hooked = middle.hooked = bottom.hooked = true;
+
+    walk (CompRegion (0, 0, 300, 300));
+    std::vector <CompRegion> clips = walk (CompRegion (0, 0, 300, 300));
+
+    EXPECT_EQ (3u, cache.hits ());
+    EXPECT_EQ (3u, cache.misses ());
+    EXPECT_EQ (CompRegion (0, 0, 300, 300) - top.region, clips[2]);
+}
+
+TEST_F (OpenGLOcclusionCache, HookedWindowWithANewResultIsAChange)
+{
+    middle.hooked = true;
+
+    walk (CompRegion (0, 0, 300, 300));
+
+    /* A plugin fading it in made it opaque */
+    middle.occludes = true;
+    std::vector <CompRegion> clips = walk (CompRegion (0, 0, 300, 300));
+
+    EXPECT_EQ (1u, cache.hits ());
+    EXPECT_EQ (5u, cache.misses ());
+    EXPECT_EQ (CompRegion (0, 0, 300, 300) - top.region - middle.region,
+	       clips[2]);
+}
+
+TEST_F (OpenGLOcclusionCache, MovedWindowIsAChange)
+{
+    walk (CompRegion (0, 0, 300, 300));
+
+    top.region = CompRegion (10, 10, 100, 100);
+    walk (CompRegion (0, 0, 300, 300));
+
+    EXPECT_EQ (0u, cache.hits ());
+    EXPECT_EQ (6u, cache.misses ());
+}
+
+TEST_F (OpenGLOcclusionCache, RestackIsAChange)
+{
+    walk (CompRegion (0, 0, 300, 300));
+
+    std::swap (stack[1], stack[2]);
+    walk (CompRegion (0, 0, 300, 300));
+
+    EXPECT_EQ (1u, cache.hits ());
+    EXPECT_EQ (5u, cache.misses ());
+}
+
+TEST_F (OpenGLOcclusionCache, RemovedWindowsAreForgotten)
+{
+    walk (CompRegion (0, 0, 300, 300));
+
+    stack.pop_back ();
+    walk (CompRegion (0, 0, 300, 300));
+
+    stack.push_back (&bottom);
+    walk (CompRegion (0, 0, 300, 300));
+
+    EXPECT_EQ (4u, cache.hits ());
+    EXPECT_EQ (4u, cache.misses ());
+}
+
+TEST_F (OpenGLOcclusionCache, InvalidateStartsOver)
+{
+    walk (CompRegion (0, 0, 300, 300));
+
+    cache.invalidate ();
+    walk (CompRegion (0, 0, 300, 300));
+
+    EXPECT_EQ (0u, cache.hits ());
+    EXPECT_EQ (6u, cache.misses ());
+}
@@ -86,6 +86,8 @@ PrivateGLScreen::paintBackground (const GLMatrix   &transform,
     if (!nBox)
 	return;
 
+    glStateCache ().disable (GL_BLEND);
+
     if (screen->desktopWindowCount ())
     {
 	if (!backgroundTextures.empty ())
@@ -229,6 +231,20 @@ PrivateGLScreen::paintBackground (const GLMatrix   &transform,
 }
 
 
+/* What GLWindow::glPaint decides occlusion on, besides the opacity */
+static unsigned int
+occlusionState (CompWindow *w)
+{
+    unsigned int state = 0;
+
+    if (w->alpha ())
+	state |= 1 << 0;
+    if (w->shaded ())
+	state |= 1 << 1;
+
+    return state;
+}
+
 /* This function currently always performs occlusion detection to
    minimize paint regions. OpenGL precision requirements are no good
    enough to guarantee that the results from using occlusion detection
@@ -252,8 +268,7 @@ PrivateGLScreen::paintOutputRegion (const GLMatrix   &transform,
     CompPoint     offXY;
     std::set<CompWindow*> unredirected;
 
-    CompWindowList                   pl;
-    CompWindowList::reverse_iterator rit;
+    CompWindowList::const_reverse_iterator rit;
 
     unredirectFS = CompositeScreen::get (screen)->
 	getOption ("unredirect_fullscreen_windows")->value ().b ();
@@ -276,16 +291,34 @@ PrivateGLScreen::paintOutputRegion (const GLMatrix   &transform,
     }
 
     /*
-     * We need to COPY the PaintList for now because there seem to be some
-     * odd cases where the master list might change during the below loops.
-     * (LP: #958540)
+     * The paint list must not change during the below loops, a nested
+     * getWindowPaintList call used to rebuild it. (LP: #958540)
      */
-    pl = cScreen->getWindowPaintList ();
+    compiz::composite::PaintListSnapshot snapshot (cScreen);
+    const CompWindowList                 &pl = snapshot.list ();
 
     if (!(mask & PAINT_SCREEN_NO_OCCLUSION_DETECTION_MASK))
     {
 	FullscreenRegion fs (*output, screen->region ());
 
+	/*
+	 * Without transformations and offsets the outcome for a window
+	 * only depends on itself and the windows above it, so most of
+	 * it can be taken from the last frame.
+	 */
+	bool cached = !(mask & (PAINT_SCREEN_TRANSFORMED_MASK |
+				PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS_MASK)) &&
+		      cScreen->windowPaintOffset ().x () == 0 &&
+		      cScreen->windowPaintOffset ().y () == 0;
+
+	if (cached)
+	    occlusionCache.begin ();
+	else
+	{
+	    occlusionCache.invalidate ();
+	    cScreen->occlusionChanged ();
+	}
+
 	/* detect occlusions */
 	for (rit = pl.rbegin (); rit != pl.rend (); ++rit)
 	{
@@ -309,43 +342,78 @@ PrivateGLScreen::paintOutputRegion (const GLMatrix   &transform,
 		    continue;
 	    }
 
-	    /* copy region */
-	    gw->priv->clip = tmpRegion;
-
 	    odMask = PAINT_WINDOW_OCCLUSION_DETECTION_MASK;
 
-	    if ((cScreen->windowPaintOffset ().x () != 0 ||
-		 cScreen->windowPaintOffset ().y () != 0) &&
-		!w->onAllViewports ())
+	    if (cached)
 	    {
-		withOffset = true;
-
-		offXY = w->getMovementForOffset (cScreen->windowPaintOffset ());
-
-		vTransform = transform;
-		vTransform.translate (offXY.x (), offXY.y (), 0);
+		compiz::opengl::OcclusionCache::Window cw;
+
+		cw.id      = w;
+		cw.region  = &w->region ();
+		cw.state   = occlusionState (w);
+		cw.opacity = gw->paintAttrib ().opacity;
+
+		/* Plugins hooking glPaint can change the opacity or
+		 * region every frame, so always ask them. As long as
+		 * the answer stays the same, the windows below are
+		 * still looked up */
+		if (!gw->glPaintWrapped () && occlusionCache.lookup (cw))
+		{
+		    gw->priv->clip = region - occlusionCache.occludedAbove ();
+		    status = occlusionCache.occludes ();
 
-		gw->priv->clip.translate (-offXY.x (), -offXY. y ());
+		    if (!gw->priv->cWindow->occludedRegionKnown ())
+			gw->priv->cWindow->setOccludedRegion (occlusionCache.occludedAbove ());
+		}
+		else
+		{
+		    gw->priv->clip = region - occlusionCache.occluded ();
+		    status = gw->glPaint (gw->paintAttrib (), transform,
+					  gw->priv->clip, odMask);
+		    occlusionCache.store (cw, status);
 
-		odMask |= PAINT_WINDOW_WITH_OFFSET_MASK;
-		status = gw->glPaint (gw->paintAttrib (), vTransform,
-				      tmpRegion, odMask);
+		    /* Lets composite drop damage nobody would see */
+		    gw->priv->cWindow->setOccludedRegion (occlusionCache.occludedAbove ());
+		}
 	    }
 	    else
 	    {
-		withOffset = false;
-		status = gw->glPaint (gw->paintAttrib (), transform, tmpRegion,
-				      odMask);
-	    }
+		/* copy region */
+		gw->priv->clip = tmpRegion;
 
-	    if (status)
-	    {
-		if (withOffset)
+		if ((cScreen->windowPaintOffset ().x () != 0 ||
+		     cScreen->windowPaintOffset ().y () != 0) &&
+		    !w->onAllViewports ())
 		{
-		    tmpRegion -= w->region ().translated (offXY);
+		    withOffset = true;
+
+		    offXY = w->getMovementForOffset (cScreen->windowPaintOffset ());
+
+		    vTransform = transform;
+		    vTransform.translate (offXY.x (), offXY.y (), 0);
+
+		    gw->priv->clip.translate (-offXY.x (), -offXY. y ());
+
+		    odMask |= PAINT_WINDOW_WITH_OFFSET_MASK;
+		    status = gw->glPaint (gw->paintAttrib (), vTransform,
+					  tmpRegion, odMask);
 		}
 		else
-		    tmpRegion -= w->region ();
+		{
+		    withOffset = false;
+		    status = gw->glPaint (gw->paintAttrib (), transform, tmpRegion,
+					  odMask);
+		}
+
+		if (status)
+		{
+		    if (withOffset)
+		    {
+			tmpRegion -= w->region ().translated (offXY);
+		    }
+		    else
+			tmpRegion -= w->region ();
+		}
 	    }
 
 	    FullscreenRegion::WinFlags flags = 0;
@@ -365,20 +433,16 @@ PrivateGLScreen::paintOutputRegion (const GLMatrix   &transform,
 	     * Windows with alpha channels can partially occlude windows
 	     * beneath them and so neither should be unredirected in that case.
 	     *
-	     * Performance note:  unredirectable.evaluate is SLOW because it
-	     * involves regex matching. Too slow to do on every window for
-	     * every frame. So we only call it if a window is redirected AND
-	     * potentially needs unredirecting. This means changes to
-	     * unredirect_match while a window is unredirected already may not
-	     * take effect until it is un-fullscreened again. But that's better
-	     * than the high price of regex matching on every frame.
+	     * CompMatch caches its result per window, so evaluating
+	     * unredirect_match here every frame is cheap and changes to it
+	     * apply to windows which are already unredirected too.
 	     */
 	    if (unredirectFS &&
 		!blacklisted &&
 		!(mask & PAINT_SCREEN_TRANSFORMED_MASK) &&
 		!(mask & PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS_MASK) &&
 		fs.isCoveredBy (w->region (), flags) &&
-		(!cw->redirected () || unredirectable.evaluate (w)))
+		unredirectable.evaluate (w))
 	    {
 		unredirected.insert (w);
 	    }
@@ -406,6 +470,12 @@ PrivateGLScreen::paintOutputRegion (const GLMatrix   &transform,
 		}
 	    }
 	}
+
+	if (cached)
+	{
+	    occlusionCache.end ();
+	    tmpRegion = region - occlusionCache.occluded ();
+	}
     }
 
     /* Unredirect any redirected fullscreen windows */
@@ -417,6 +487,23 @@ PrivateGLScreen::paintOutputRegion (const GLMatrix   &transform,
 	                 tmpRegion,
 	                 (mask & PAINT_SCREEN_TRANSFORMED_MASK));
 
+    /* Windows that are painted where they are can be skipped
+     * when they are nowhere near the area being painted */
+    bool culled = !(mask & (PAINT_SCREEN_TRANSFORMED_MASK |
+			    PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS_MASK)) &&
+		  cScreen->windowPaintOffset ().x () == 0 &&
+		  cScreen->windowPaintOffset ().y () == 0;
+
+    if (culled)
+    {
+	++paintStamp;
+	paintCandidates.clear ();
+	screen->findWindowsInRect (region.boundingRect (), paintCandidates);
+
+	foreach (w, paintCandidates)
+	    GLWindow::get (w)->priv->paintStamp = paintStamp;
+    }
+
     /* paint all windows from bottom to top */
     foreach (w, pl)
     {
@@ -431,6 +518,11 @@ PrivateGLScreen::paintOutputRegion (const GLMatrix   &transform,
 	if (unredirected.find (w) != unredirected.end ())
 	    continue;
 
+	/* Plugins hooking glPaint might paint the window elsewhere */
+	if (culled && gw->priv->paintStamp != paintStamp &&
+	    !gw->glPaintWrapped ())
+	    continue;
+
 	if (!w->shaded ())
 	{
 	    if (!w->isViewable ())
@@ -485,8 +577,14 @@ GLScreen::glEnableOutputClipping (const GLMatrix   &transform,
 				  const CompRegion &region,
 				  CompOutput       *output)
 {
+    /* Held draws belong to the clip they were made in */
+    PrivateVertexBuffer::submitHeld ();
+
+    GLStateCallOut stateOut (glEnableOutputClippingWrapped ());
     WRAPABLE_HND_FUNCTN (glEnableOutputClipping, transform, region, output)
 
+    GLStateCallIn stateIn;
+
     // Bottom-left corner of the output:
     const GLint x = output->x1 ();
     const GLint y = screen->height () - output->y2 ();
@@ -504,15 +602,20 @@ GLScreen::glEnableOutputClipping (const GLMatrix   &transform,
     GLfloat ty = centrey - (scaledh / 2.0f) + transy * h;
 
     glScissor (tx, ty, roundf (scaledw), roundf (scaledh));
-    glEnable (GL_SCISSOR_TEST);
+    glStateCache ().enable (GL_SCISSOR_TEST);
 }
 
 void
 GLScreen::glDisableOutputClipping ()
 {
+    PrivateVertexBuffer::submitHeld ();
+
+    GLStateCallOut stateOut (glDisableOutputClippingWrapped ());
     WRAPABLE_HND_FUNCTN (glDisableOutputClipping)
 
-    glDisable (GL_SCISSOR_TEST);
+    GLStateCallIn stateIn;
+
+    glStateCache ().disable (GL_SCISSOR_TEST);
 }
 
 void
@@ -520,8 +623,13 @@ GLScreen::glBufferStencil (const GLMatrix       &matrix,
 			   GLVertexBuffer       &vertexBuffer,
 			   CompOutput           *output)
 {
+    PrivateVertexBuffer::submitHeld ();
+
+    GLStateCallOut stateOut (glBufferStencilWrapped ());
     WRAPABLE_HND_FUNCTN (glBufferStencil, matrix, vertexBuffer, output);
 
+    GLStateCallIn stateIn;
+
     GLfloat x = output->x ();
     GLfloat y = screen->height () - output->y2 ();
     GLfloat x2 = output->x () + output->width ();
@@ -555,9 +663,12 @@ GLScreen::glPaintTransformedOutput (const GLScreenPaintAttrib &sAttrib,
 				    CompOutput                *output,
 				    unsigned int              mask)
 {
+    GLStateCallOut stateOut (glPaintTransformedOutputWrapped ());
     WRAPABLE_HND_FUNCTN (glPaintTransformedOutput, sAttrib, transform,
 		       region, output, mask)
 
+    GLStateCallIn stateIn;
+
     GLMatrix sTransform = transform;
 
     if (mask & PAINT_SCREEN_CLEAR_MASK)
@@ -583,7 +694,7 @@ GLScreen::glPaintTransformedOutput (const GLScreenPaintAttrib &sAttrib,
 
 	    glClearStencil (0);
 	    glClear (GL_STENCIL_BUFFER_BIT);
-	    glEnable (GL_STENCIL_TEST);
+	    glStateCache ().enable (GL_STENCIL_TEST);
 	    glStencilFunc (GL_ALWAYS, 1, 1);
 	    glStencilOp (GL_KEEP, GL_KEEP, GL_REPLACE);
 
@@ -598,7 +709,10 @@ GLScreen::glPaintTransformedOutput (const GLScreenPaintAttrib &sAttrib,
 	    glStencilFunc (GL_EQUAL, 1, 1);
 	    glStencilOp (GL_KEEP, GL_KEEP, GL_KEEP);
 	    priv->paintOutputRegion (sTransform, region, output, mask);
-	    glDisable (GL_STENCIL_TEST);
+
+	    /* Held draws have to go out while the stencil still clips */
+	    PrivateVertexBuffer::submitHeld ();
+	    glStateCache ().disable (GL_STENCIL_TEST);
 	}
 	else
 	{
@@ -613,6 +727,10 @@ GLScreen::glPaintTransformedOutput (const GLScreenPaintAttrib &sAttrib,
 	sTransform.toScreenSpace (output, -sAttrib.zTranslate);
 	priv->paintOutputRegion (sTransform, region, output, mask);
     }
+
+    /* Plugins wrapping this change state and read the framebuffer
+     * once it returns */
+    PrivateVertexBuffer::submitHeld ();
 }
 
 bool
@@ -622,9 +740,12 @@ GLScreen::glPaintOutput (const GLScreenPaintAttrib &sAttrib,
 			 CompOutput                *output,
 			 unsigned int              mask)
 {
+    GLStateCallOut stateOut (glPaintOutputWrapped ());
     WRAPABLE_HND_FUNCTN_RETURN (bool, glPaintOutput, sAttrib, transform,
 			      region, output, mask)
 
+    GLStateCallIn stateIn;
+
     GLMatrix sTransform = transform;
 
     if (mask & PAINT_SCREEN_REGION_MASK)
@@ -667,6 +788,9 @@ GLScreen::glPaintOutput (const GLScreenPaintAttrib &sAttrib,
 	    (mask & PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS_MASK))
 	    priv->paintOutputRegion (sTransform, region, output, mask);
 
+	/* Plugins wrapping this read the framebuffer once it returns */
+	PrivateVertexBuffer::submitHeld ();
+
 	return true;
     }
     else if (mask & PAINT_SCREEN_FULL_MASK)
@@ -700,8 +824,11 @@ GLScreen::glPaintCompositedOutput (const CompRegion    &region,
 				   GLFramebufferObject *fbo,
 				   unsigned int         mask)
 {
+    GLStateCallOut stateOut (glPaintCompositedOutputWrapped ());
     WRAPABLE_HND_FUNCTN (glPaintCompositedOutput, region, fbo, mask)
 
+    GLStateCallIn stateIn;
+
     GLMatrix sTransform;
     const GLTexture::Matrix & texmatrix = fbo->tex ()->matrix ();
     GLVertexBuffer *streamingBuffer = GLVertexBuffer::streamingBuffer ();
@@ -775,6 +902,7 @@ GLScreen::glPaintCompositedOutput (const CompRegion    &region,
     }
 
     streamingBuffer->end ();
+    glStateCache ().disable (GL_BLEND);
     fbo->tex ()->enable (GLTexture::Fast);
     sTransform.toScreenSpace (&screen->fullscreenOutput (), -DEFAULT_Z_CAMERA);
     streamingBuffer->render (sTransform);
@@ -1093,7 +1221,7 @@ enableLegacyOBSAndRender (GLScreen                  *gs,
 
 	glColor4f (1.0f, 1.0f, 1.0f, 0.5f);
 
-	GL::activeTexture (GL_TEXTURE1_ARB);
+	glStateCache ().activeTexture (1);
 
 	texture->enable (filter);
 
@@ -1118,7 +1246,7 @@ enableLegacyOBSAndRender (GLScreen                  *gs,
 
 	    glTexEnvfv (GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, constant);
 
-	    GL::activeTexture (GL_TEXTURE2_ARB);
+	    glStateCache ().activeTexture (2);
 
 	    texture->enable (filter);
 
@@ -1143,7 +1271,7 @@ enableLegacyOBSAndRender (GLScreen                  *gs,
 	    if (attrib.opacity < OPAQUE ||
 		attrib.brightness != BRIGHT)
 	    {
-		GL::activeTexture (GL_TEXTURE3_ARB);
+		glStateCache ().activeTexture (3);
 
 		texture->enable (filter);
 
@@ -1173,7 +1301,7 @@ enableLegacyOBSAndRender (GLScreen                  *gs,
 
 		glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
 
-		GL::activeTexture (GL_TEXTURE2_ARB);
+		glStateCache ().activeTexture (2);
 	    }
 	    else
 	    {
@@ -1184,7 +1312,7 @@ enableLegacyOBSAndRender (GLScreen                  *gs,
 
 	    glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
 
-	    GL::activeTexture (GL_TEXTURE1_ARB);
+	    glStateCache ().activeTexture (1);
 	}
 	else
 	{
@@ -1211,7 +1339,7 @@ enableLegacyOBSAndRender (GLScreen                  *gs,
 
 	glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
 
-	GL::activeTexture (GL_TEXTURE0_ARB);
+	glStateCache ().activeTexture (0);
 
 	texture->disable ();
 
@@ -1271,12 +1399,12 @@ GLWindow::glDrawTexture (GLTexture          *texture,
 			 const GLWindowPaintAttrib &attrib,
 			 unsigned int       mask)
 {
+    GLStateCallOut stateOut (glDrawTextureWrapped ());
     WRAPABLE_HND_FUNCTN (glDrawTexture, texture, transform, attrib, mask)
 
-    GLTexture::Filter filter;
+    GLStateCallIn stateIn;
 
-    if (mask & PAINT_WINDOW_BLEND_MASK)
-	glEnable (GL_BLEND);
+    GLTexture::Filter filter;
 
     if (mask & (PAINT_WINDOW_TRANSFORMED_MASK |
 		PAINT_WINDOW_ON_TRANSFORMED_SCREEN_MASK))
@@ -1284,7 +1412,33 @@ GLWindow::glDrawTexture (GLTexture          *texture,
     else
 	filter = priv->gScreen->filter (NOTHING_TRANS_FILTER);
 
-    glActiveTexture(GL_TEXTURE0);
+    if (GLVertexBuffer::enabled ())
+    {
+	const GLMatrix *projection = priv->gScreen->projectionMatrix ();
+
+	/* Plugins painting transformed screens change state between
+	 * windows directly, don't hold draws across that */
+	if ((mask & PAINT_WINDOW_BATCH_MASK) && priv->shaders.empty () &&
+	    !(mask & (PAINT_WINDOW_TRANSFORMED_MASK |
+		      PAINT_WINDOW_ON_TRANSFORMED_SCREEN_MASK)) &&
+	    PrivateVertexBuffer::hold (priv->vertexBuffer, texture, filter,
+				       *projection, transform, attrib,
+				       mask & PAINT_WINDOW_BLEND_MASK))
+	    return;
+
+	/* Before this draw's state replaces that of the held ones */
+	PrivateVertexBuffer::submitHeldUnder (priv->vertexBuffer,
+					      projection, &transform);
+    }
+
+    /* Without the mask blending is left as the caller set it, only
+     * a release the previous window left behind is carried out */
+    if (mask & PAINT_WINDOW_BLEND_MASK)
+	glStateCache ().enable (GL_BLEND);
+    else
+	glStateCache ().settle (GL_BLEND);
+
+    glStateCache ().activeTexture (0);
     texture->enable (filter);
 
     #ifdef USE_GLES
@@ -1311,7 +1465,101 @@ GLWindow::glDrawTexture (GLTexture          *texture,
     texture->disable ();
 
     if (mask & PAINT_WINDOW_BLEND_MASK)
-	glDisable (GL_BLEND);
+	glStateCache ().release (GL_BLEND);
+}
+
+static bool
+sameMatrix (const GLTexture::Matrix &a,
+	    const GLTexture::Matrix &b)
+{
+    return a.xx == b.xx && a.yx == b.yx &&
+	   a.xy == b.xy && a.yy == b.yy &&
+	   a.x0 == b.x0 && a.y0 == b.y0;
+}
+
+/* The geometry kept for this draw of the window, one per texture */
+std::vector<PrivateGLWindow::RetainedGeometry> &
+PrivateGLWindow::retainedForPass (unsigned int frame)
+{
+    unsigned int output = targetOutput ? targetOutput->id () : 0;
+
+    if (drawFrame != frame || drawOutput != output)
+    {
+	drawFrame  = frame;
+	drawOutput = output;
+	drawPass   = 0;
+    }
+    else
+	++drawPass;
+
+    std::vector<RetainedGeometry> &pass =
+	retained[RetainedPass (output, drawPass)];
+
+    if (pass.size () != textures.size ())
+    {
+	foreach (RetainedGeometry &r, pass)
+	    delete r.buffer;
+
+	pass.clear ();
+	pass.resize (textures.size ());
+    }
+
+    return pass;
+}
+
+/* Returns false if texture i has to be drawn from streamed geometry */
+bool
+PrivateGLWindow::drawRetained (RetainedGeometry          &r,
+			       unsigned int              i,
+			       const GLTexture::MatrixList &ml,
+			       const CompRegion          &clip,
+			       const GLMatrix            &transform,
+			       const GLWindowPaintAttrib &attrib,
+			       unsigned int              mask)
+{
+    if (!r.seen                          ||
+	!sameMatrix (r.matrix, ml[0])    ||
+	!(r.region == regions[i])        ||
+	!(r.clip == clip))
+    {
+	r.matrix = ml[0];
+	r.region = regions[i];
+	r.clip   = clip;
+	r.seen   = true;
+	r.built  = false;
+
+	return false;
+    }
+
+    if (!r.buffer)
+    {
+	r.buffer = new GLVertexBuffer (GL::STATIC_DRAW);
+	r.buffer->setAutoProgram (autoProgram);
+    }
+
+    /* Wrapped glDrawTexture still finds the buffer being drawn
+     * through GLWindow::vertexBuffer () */
+    GLVertexBuffer *streamed = vertexBuffer;
+    bool           drawable;
+
+    vertexBuffer = r.buffer;
+
+    if (!r.built)
+    {
+	r.buffer->begin ();
+	gWindow->glAddGeometry (ml, regions[i], clip);
+	drawable = r.buffer->end ();
+	r.built  = true;
+    }
+    else
+	drawable = r.buffer->restart ();
+
+    if (drawable)
+	gWindow->glDrawTexture (textures[i], transform, attrib, mask);
+
+    vertexBuffer = streamed;
+
+    return true;
 }
 
 bool
@@ -1320,9 +1568,12 @@ GLWindow::glDraw (const GLMatrix     &transform,
 		  const CompRegion   &region,
 		  unsigned int       mask)
 {
+    GLStateCallOut stateOut (glDrawWrapped ());
     WRAPABLE_HND_FUNCTN_RETURN (bool, glDraw, transform,
 			      attrib, region, mask)
 
+    GLStateCallIn stateIn;
+
     const CompRegion &reg = (mask & PAINT_WINDOW_TRANSFORMED_MASK) ?
                             infiniteRegion : region;
 
@@ -1333,8 +1584,30 @@ GLWindow::glDraw (const GLMatrix     &transform,
 	!priv->cWindow->damaged ())
 	return true;
 
-    if (textures ().empty () && !bind ())
-	return false;
+    if (textures ().empty ())
+    {
+	/* Nothing of an unbound window is drawn when it lies outside
+	 * the region being painted, so leave naming its pixmap and
+	 * binding it to a texture until a paint actually shows it */
+	if (!(mask & (PAINT_WINDOW_TRANSFORMED_MASK |
+		      PAINT_WINDOW_WITH_OFFSET_MASK |
+		      PAINT_WINDOW_ON_TRANSFORMED_SCREEN_MASK)) &&
+	    !glAddGeometryWrapped ()                         &&
+	    !reg.intersects (priv->window->outputRect ()))
+	{
+	    priv->gScreen->priv->deferredBinds++;
+	    return true;
+	}
+
+	PrivateGLScreen *gs = priv->gScreen->priv;
+
+	gs->paintBinds++;
+
+	if (!gs->timedBind (this, gs->paintBindTime))
+	    return false;
+    }
+
+    priv->cWindow->markPainted ();
 
     if (mask & PAINT_WINDOW_TRANSLUCENT_MASK)
 	mask |= PAINT_WINDOW_BLEND_MASK;
@@ -1355,9 +1628,26 @@ GLWindow::glDraw (const GLMatrix     &transform,
     if (priv->updateState & PrivateGLWindow::UpdateRegion)
 	priv->updateWindowRegions ();
 
+    bool retain = GLVertexBuffer::enabled () &&
+		  !priv->dynamicGeometry     &&
+		  !glAddGeometryWrapped ();
+
+    if (!retain && !priv->retained.empty ())
+	priv->releaseRetainedGeometry ();
+
+    std::vector<PrivateGLWindow::RetainedGeometry> *pass =
+	retain ? &priv->retainedForPass (priv->gScreen->priv->frameStamp) :
+		 NULL;
+
     for (unsigned int i = 0; i < priv->textures.size (); i++)
     {
 	ml[0] = priv->matrices[i];
+
+	if (pass &&
+	    priv->drawRetained ((*pass)[i], i, ml, reg,
+				transform, attrib, mask))
+	    continue;
+
 	priv->vertexBuffer->begin ();
 	glAddGeometry (ml, priv->regions[i], reg);
 	if (priv->vertexBuffer->end ())
@@ -1373,8 +1663,11 @@ GLWindow::glPaint (const GLWindowPaintAttrib &attrib,
 		   const CompRegion          &region,
 		   unsigned int              mask)
 {
+    GLStateCallOut stateOut (glPaintWrapped ());
     WRAPABLE_HND_FUNCTN_RETURN (bool, glPaint, attrib, transform, region, mask)
 
+    GLStateCallIn stateIn;
+
     bool               status;
 
     priv->lastPaint = attrib;
@@ -0,0 +1,75 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _PROGRAM_PRIVATE_H
+#define _PROGRAM_PRIVATE_H
+
+#include <string>
+
+#include <opengl/opengl.h>
+
+#include "uniformcache/uniformcache.h"
+#include "programbinary/programbinary.h"
+#include "privatestate.h"
+
+using compiz::opengl::UniformCache;
+
+class PrivateProgram :
+    public UniformCache::Locator
+{
+    public:
+	GLuint program;
+	bool valid;
+
+	/* Uniform values live in the program, so the cache of what
+	 * was uploaded stays right across binds */
+	UniformCache uniforms;
+
+	int locate (const char *name)
+	{
+	    return (*GL::getUniformLocation) (program, name);
+	}
+
+	GLint location (UniformCache::Name name)
+	{
+	    return uniforms.location (name, *this);
+	}
+
+	template <typename T>
+	bool changed (UniformCache::Name name,
+		      UniformCache::Type type,
+		      const T            *value,
+		      unsigned int       count)
+	{
+	    return uniforms.update (name, type, value, sizeof (T) * count);
+	}
+
+	bool loadBinary (const std::string &key);
+	void storeBinary (const std::string &key, unsigned long long buildTime);
+
+	/* Where linked programs are kept between runs, NULL unless
+	 * the driver can hand them out */
+	static compiz::opengl::ProgramBinaryStore *binaryStore;
+};
+
+#endif
@@ -28,6 +28,7 @@
 #ifndef _OPENGL_PRIVATES_H
 #define _OPENGL_PRIVATES_H
 
+#include <map>
 #include <memory>
 #include <vector>
 #include <tr1/tuple>
@@ -44,7 +45,11 @@
 
 #include "privatetexture.h"
 #include "privatevertexbuffer.h"
+#include "privateprogram.h"
+#include "privatestate.h"
 #include "opengl_options.h"
+#include "occlusioncache/occlusioncache.h"
+#include "shaderwarmup/shaderwarmup.h"
 
 extern CompOutput *targetOutput;
 
@@ -167,6 +172,7 @@ class PrivateGLScreen :
 	void updateFrameProvider ();
 
 	void prepareDrawing ();
+	bool fencesXRequests ();
 
 	bool compositingActive ();
 
@@ -189,6 +195,14 @@ class PrivateGLScreen :
 	bool syncObjectsEnabled ();
 	void initXToGLSyncs ();
 	void destroyXToGLSyncs ();
+
+	void initProgramBinaries ();
+	void releaseProgramBinaries ();
+
+	bool initPluginForScreen (CompPlugin *p);
+
+	void startShaderWarmup ();
+	bool shaderWarmupTimeout ();
 	void updateXToGLSyncs ();
 
 	bool driverIsBlacklisted (const char *regex) const;
@@ -266,6 +280,41 @@ class PrivateGLScreen :
 	std::vector<XToGLSync*>::size_type currentSyncNum;
 	XToGLSync *currentSync;
 	std::vector<XToGLSync*>::size_type warmupSyncs;
+
+	compiz::opengl::OcclusionCache occlusionCache;
+
+	/* The windows in the area being painted, each marked with
+	 * the stamp of the paint that found it */
+	CompWindowVector paintCandidates;
+	unsigned int     paintStamp;
+
+	/* Counts frames, so windows drawn more than once in a frame
+	 * can tell the passes drawing them apart */
+	unsigned int frameStamp;
+
+	/* Builds likely programs while nothing is being painted */
+	compiz::opengl::ShaderWarmup shaderWarmup;
+
+	/* What getShaderData was last asked for, getProgram tells the
+	 * warmup about it if it is drawn without plugin shaders */
+	GLShaderParameters           lastShaderParams;
+	const GLShaderData           *lastShaderData;
+
+	CompTimer                    shaderWarmupTimer;
+	unsigned long long           lastPaintTime;
+
+	/* Windows to bind while nothing is being painted, so that
+	 * they are ready before the paint that first shows them */
+	std::vector<Window> prefetchQueue;
+	CompTimer           prefetchTimer;
+	unsigned long long  deferredBinds;
+	unsigned long long  prefetchedBinds;
+	unsigned long long  paintBinds;
+	unsigned long long  paintBindTime;
+	unsigned long long  prefetchBindTime;
+
+	bool prefetchQueued ();
+	bool timedBind (GLWindow *gw, unsigned long long &time);
 };
 
 class PrivateGLWindow :
@@ -289,6 +338,18 @@ class PrivateGLWindow :
 	void setWindowMatrix ();
 	void updateWindowRegions ();
 
+	struct RetainedGeometry;
+
+	std::vector<RetainedGeometry> & retainedForPass (unsigned int frame);
+	bool drawRetained (RetainedGeometry          &r,
+			   unsigned int              i,
+			   const GLTexture::MatrixList &ml,
+			   const CompRegion          &clip,
+			   const GLMatrix            &transform,
+			   const GLWindowPaintAttrib &attrib,
+			   unsigned int              mask);
+	void releaseRetainedGeometry ();
+
 	void clearTextures ();
 
 	CompWindow      *window;
@@ -318,6 +379,37 @@ class PrivateGLWindow :
 
 	GLVertexBuffer *vertexBuffer;
 
+	/* What the geometry of one texture was built from, it is only
+	 * kept in a static buffer once it was the same two frames in a
+	 * row, so windows being moved keep using the streamed one */
+	struct RetainedGeometry
+	{
+	    RetainedGeometry () :
+		buffer (NULL),
+		seen (false),
+		built (false)
+	    {
+	    }
+
+	    GLVertexBuffer    *buffer;
+	    GLTexture::Matrix matrix;
+	    CompRegion        region;
+	    CompRegion        clip;
+	    bool              seen;
+	    bool              built;
+	};
+
+	/* Kept per output and per pass drawing the window on it, as
+	 * each clips it differently. The pass is counted from the
+	 * first draw of the window on the output in this frame */
+	typedef std::pair<unsigned int, unsigned int> RetainedPass;
+
+	std::map<RetainedPass, std::vector<RetainedGeometry> > retained;
+	bool                                                   dynamicGeometry;
+	unsigned int                                           drawFrame;
+	unsigned int                                           drawOutput;
+	unsigned int                                           drawPass;
+
 	// map of shaders, plugin name is key, pair of vertex and fragment
 	// shader source code is value
 	std::list<const GLShaderData*> shaders;
@@ -326,6 +418,8 @@ class PrivateGLWindow :
 	std::list<GLIcon> icons;
 
 	compiz::window::configure_buffers::Releasable::Ptr configureLock;
+
+	unsigned int paintStamp;
 };
 
 #endif
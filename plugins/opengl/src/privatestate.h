@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _GLSTATE_PRIVATE_H
+#define _GLSTATE_PRIVATE_H
+
+#include "glstate/glstate.h"
+
+/* The state of the context compiz draws with, everything in this
+ * plugin that changes tracked state goes through it. It is only
+ * resumed while our own paint code runs, everywhere else plugins
+ * may be making GL calls of their own */
+compiz::opengl::StateCache &glStateCache ();
+
+/* Suspends the cache around a call to a function plugins wrapped.
+ * Hooks that only work something out (glApplyTransform, glAddGeometry,
+ * projectionMatrix) aren't expected to make GL calls and don't */
+class GLStateCallOut
+{
+    public:
+
+	GLStateCallOut (bool wrapped) :
+	    suspend (wrapped && !glStateCache ().suspended ())
+	{
+	    if (suspend)
+		glStateCache ().suspend ();
+	}
+
+	~GLStateCallOut ()
+	{
+	    if (suspend)
+		glStateCache ().resume ();
+	}
+
+    private:
+
+	bool suspend;
+};
+
+/* Resumes the cache in a wrappable function called by a plugin */
+class GLStateCallIn
+{
+    public:
+
+	GLStateCallIn () :
+	    resume (glStateCache ().suspended ())
+	{
+	    if (resume)
+		glStateCache ().resume ();
+	}
+
+	~GLStateCallIn ()
+	{
+	    if (resume)
+		glStateCache ().suspend ();
+	}
+
+    private:
+
+	bool resume;
+};
+
+#endif
@@ -44,6 +44,8 @@
 
 #include <map>
 
+#include "texturepool/texturepool.h"
+
 class GLScreen;
 class GLDisplay;
 
@@ -58,6 +60,18 @@ class PrivateTexture {
 					      GLenum       format,
 					      GLenum       type);
 
+	/* Textures window pixmaps were bound to, kept for the next
+	 * pixmap bound once the texture goes away */
+	static compiz::opengl::TexturePool & pool ();
+
+	/* The next texture constructed takes a pooled name fitting
+	 * key instead of generating one, if there is one */
+	static void reuse (const compiz::opengl::TexturePool::Key &key);
+
+	/* texture goes back to the pool under key once destroyed */
+	static void keep (GLTexture                              *texture,
+			  const compiz::opengl::TexturePool::Key &key);
+
     public:
 	GLTexture         *texture;
 	GLuint            name;
@@ -69,6 +83,13 @@ class PrivateTexture {
 	bool              mipmapSupport;
 	bool              initial;
 	int               refCount;
+
+	bool                             pooled;
+	compiz::opengl::TexturePool::Key poolKey;
+
+    private:
+
+	static GLuint reusedName;
 };
 
 #ifdef USE_GLES
@@ -34,8 +34,12 @@
 #endif
 
 #include <opengl/program.h>
+#include <opengl/texture.h>
 #include <typeinfo>
 
+#include "streamring/streamring.h"
+#include "drawbatch/drawbatch.h"
+
 class GLVertexBuffer;
 
 class AbstractUniform
@@ -49,49 +53,45 @@ template < typename T, int C >
 class Uniform: public AbstractUniform
 {
     public:
-	Uniform(const char *_name, ... );
+	Uniform(const GLProgram::UniformHandle &_handle, const T *values);
 	void set(GLProgram* program);
 
     public:
 	T a[C];
-	std::string name;
+	GLProgram::UniformHandle handle;
 };
 
 template < typename T, int C >
-Uniform< T, C >::Uniform(const char *_name, ... )
+Uniform< T, C >::Uniform(const GLProgram::UniformHandle &_handle,
+			 const T                        *values) :
+    handle (_handle)
 {
-    va_list arg_list;
-    va_start( arg_list, _name );
-    name = _name;
     for( int i = 0; i < C; i++ )
-	a[i] = va_arg( arg_list, T );
-    va_end( arg_list );
+	a[i] = values[i];
 }
 
 template < typename T, int C >
 void Uniform< T, C >::set(GLProgram* prog)
 {
-    const char* n = name.c_str();
-
     // This will only get called from privateVertexBuffer::render
     // so we know we've got a valid, bound program here
-    if (typeid(a[0]) == typeid(double))
+    if (typeid(a[0]) == typeid(GLfloat))
     {
 	switch (C)
 	{
-	    case 1: prog->setUniform   (n, (GLfloat) a[0]); break;
-	    case 2: prog->setUniform2f (n, a[0], a[1]); break;
-	    case 3: prog->setUniform3f (n, a[0], a[1], a[2]); break;
-	    case 4: prog->setUniform4f (n, a[0], a[1], a[2], a[3]); break;
+	    case 1: prog->setUniform   (handle, (GLfloat) a[0]); break;
+	    case 2: prog->setUniform2f (handle, a[0], a[1]); break;
+	    case 3: prog->setUniform3f (handle, a[0], a[1], a[2]); break;
+	    case 4: prog->setUniform4f (handle, a[0], a[1], a[2], a[3]); break;
 	}
-    } else if (typeid(a[0]) == typeid(int))
+    } else if (typeid(a[0]) == typeid(GLint))
     {
 	switch (C)
 	{
-	    case 1: prog->setUniform   (n, (GLint) a[0]); break;
-	    case 2: prog->setUniform2i (n, a[0], a[1]); break;
-	    case 3: prog->setUniform3i (n, a[0], a[1], a[2]); break;
-	    case 4: prog->setUniform4i (n, a[0], a[1], a[2], a[3]); break;
+	    case 1: prog->setUniform   (handle, (GLint) a[0]); break;
+	    case 2: prog->setUniform2i (handle, a[0], a[1]); break;
+	    case 3: prog->setUniform3i (handle, a[0], a[1], a[2]); break;
+	    case 4: prog->setUniform4i (handle, a[0], a[1], a[2], a[3]); break;
 	}
     } else
     {
@@ -114,9 +114,87 @@ class PrivateVertexBuffer
 	                  const GLMatrix            &modelview,
 	                  const GLWindowPaintAttrib &attrib);
 
+	/* Call once the draws of a frame have been submitted */
+	static void frameDone ();
+	static void destroyStreamRing ();
+
+	/* Holds back the draw of what buffer's last end () uploaded if
+	 * it can be submitted with other held draws later on. Only plain
+	 * textured triangles drawn with the automatic program qualify */
+	static bool hold (GLVertexBuffer            *buffer,
+			  GLTexture                 *texture,
+			  GLTexture::Filter         filter,
+			  const GLMatrix            &projection,
+			  const GLMatrix            &modelview,
+			  const GLWindowPaintAttrib &attrib,
+			  bool                      blend);
+
+	/* Submits the held draws the next render () of buffer could
+	 * cover. Call before setting up GL state for that render (),
+	 * render () itself has to put back what submitting changes */
+	static void submitHeldUnder (GLVertexBuffer *buffer,
+				     const GLMatrix *projection,
+				     const GLMatrix *modelview);
+
+	/* Submits every held draw. Call before anything that changes
+	 * where or how the held draws end up: framebuffer, viewport,
+	 * scissor and stencil */
+	static void submitHeld ();
+
     public:
 	static GLVertexBuffer *streamingBuffer;
 
+	/* Shared by every buffer created with GL::STREAM_DRAW */
+	static compiz::opengl::StreamRing *streamRing;
+
+	/* Bytes uploaded and buffers allocated in this frame and
+	 * the one before */
+	static unsigned long long uploaded, lastUploaded;
+	static unsigned int       allocations, lastAllocations;
+
+	/* The state a span of held draws is submitted with */
+	struct HeldDraw
+	{
+	    GLTexture                   *texture;
+	    GLTexture::Filter           filter;
+	    GLushort                    opacity;
+	    GLushort                    brightness;
+	    GLushort                    saturation;
+	    GLfloat                     color[4];
+	    bool                        blend;
+	    GLVertexBuffer::AutoProgram *autoProgram;
+	};
+
+	/* Every held draw shares the same matrices */
+	static compiz::opengl::DrawBatch drawBatch;
+	static std::vector<HeldDraw>     heldDraws;
+	static GLMatrix                  heldProjection;
+	static GLMatrix                  heldModelview;
+	static GLVertexBuffer            *heldBuffer;
+	static bool                      submitting;
+
+	/* Set once the next render () has been checked against the
+	 * held draws */
+	static PrivateVertexBuffer       *checked;
+
+	bool coversHeld (const GLMatrix *projection,
+			 const GLMatrix *modelview) const;
+
+	/* Where end () put an array */
+	struct Source
+	{
+	    GLuint   buffer;
+	    GLintptr offset;
+	};
+
+	/* Uploads every array end () has data for */
+	void upload ();
+	void upload (Source                     &source,
+		     GLuint                     buffer,
+		     const std::vector<GLfloat> &data);
+
+	void bindAttribute (GLint index, GLint size, const Source &source);
+
 	std::vector<GLfloat> vertexData;
 	std::vector<GLfloat> normalData;
 	std::vector<GLfloat> colorData;
@@ -143,6 +221,11 @@ class PrivateVertexBuffer
 	GLuint textureBuffers[4];
 	std::vector<AbstractUniform*> uniforms;
 
+	Source vertexSource;
+	Source normalSource;
+	Source colorSource;
+	Source textureSources[MAX_TEXTURES];
+
 	GLVertexBuffer::AutoProgram *autoProgram;
 };
 
@@ -27,13 +27,21 @@
 #include <fstream>
 #include <opengl/opengl.h>
 
-class PrivateProgram
+#include <time.h>
+
+#include "privateprogram.h"
+
+compiz::opengl::ProgramBinaryStore *PrivateProgram::binaryStore = NULL;
+
+static unsigned long long
+microseconds ()
 {
-    public:
-	GLuint program;
-	bool valid;
-};
+    struct timespec ts;
 
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
 
 void printShaderInfoLog (GLuint shader)
 {
@@ -84,15 +92,83 @@ static bool compileShader (GLuint *shader, GLenum type, CompString &source)
     return (status == GL_TRUE);
 }
 
+bool PrivateProgram::loadBinary (const std::string &key)
+{
+    unsigned long long start = microseconds ();
+    unsigned long long buildTime;
+    unsigned int       format;
+    std::vector<char>  binary;
+    GLint              status;
+
+    if (!binaryStore->load (key, format, binary, buildTime))
+	return false;
+
+    (*GL::programBinary) (program, format, &binary[0], binary.size ());
+    (*GL::getProgramiv) (program, GL::LINK_STATUS, &status);
+
+    /* Usually a driver update that kept the version string */
+    if (status == GL_FALSE)
+    {
+	binaryStore->discard (key);
+	return false;
+    }
+
+    binaryStore->loaded (buildTime, microseconds () - start);
+
+    return true;
+}
+
+void PrivateProgram::storeBinary (const std::string  &key,
+                                  unsigned long long buildTime)
+{
+    GLint   length = 0;
+    GLsizei written = 0;
+    GLenum  format;
+
+    (*GL::getProgramiv) (program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+	return;
+
+    std::vector<char> binary (length);
+
+    (*GL::getProgramBinary) (program, length, &written, &format, &binary[0]);
+    if (written <= 0)
+	return;
+
+    binary.resize (written);
+
+    if (!binaryStore->store (key, format, binary, buildTime))
+	compLogMessage ("opengl", CompLogLevelDebug,
+			"Couldn't save program binary %s", key.c_str ());
+}
+
 GLProgram::GLProgram (CompString &vertexShader, CompString &fragmentShader) :
     priv (new PrivateProgram ())
 {
     GLuint vertex, fragment;
     GLint status;
+    std::string key;
+    unsigned long long start = microseconds ();
 
     priv->valid = false;
     priv->program = (*GL::createProgram) ();
 
+    if (PrivateProgram::binaryStore)
+    {
+	key = PrivateProgram::binaryStore->key (vertexShader, fragmentShader);
+
+	if (priv->loadBinary (key))
+	{
+	    priv->valid = true;
+	    return;
+	}
+
+	if (GL::programParameteri)
+	    (*GL::programParameteri) (priv->program,
+				      GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+				      GL_TRUE);
+    }
+
     if (!compileShader (&vertex, GL::VERTEX_SHADER, vertexShader))
     {
 	printShaderInfoLog (vertex);
@@ -124,6 +200,9 @@ GLProgram::GLProgram (CompString &vertexShader, CompString &fragmentShader) :
     (*GL::deleteShader) (fragment);
 
     priv->valid = true;
+
+    if (PrivateProgram::binaryStore)
+	priv->storeBinary (key, microseconds () - start);
 }
 
 GLProgram::~GLProgram ()
@@ -139,119 +218,210 @@ bool GLProgram::valid ()
 
 void GLProgram::bind ()
 {
-    (*GL::useProgram) (priv->program);
+    glStateCache ().useProgram (priv->program);
 }
 
 void GLProgram::unbind ()
 {
-    (*GL::useProgram) (0);
+    glStateCache ().releaseProgram ();
+}
+
+GLProgram::UniformHandle::UniformHandle (const char *name) :
+    id (compiz::opengl::UniformCache::intern (name))
+{
 }
 
 bool GLProgram::setUniform (const char *name, GLfloat value)
 {
-    GLint location = (*GL::getUniformLocation) (priv->program, name);
+    return setUniform (UniformHandle (name), value);
+}
+
+bool GLProgram::setUniform (const char *name, GLint value)
+{
+    return setUniform (UniformHandle (name), value);
+}
+
+bool GLProgram::setUniform (const char *name, const GLMatrix &value)
+{
+    return setUniform (UniformHandle (name), value);
+}
+
+bool GLProgram::setUniform2f (const char *name,
+                              GLfloat x,
+                              GLfloat y)
+{
+    return setUniform2f (UniformHandle (name), x, y);
+}
+
+bool GLProgram::setUniform3f (const char *name,
+                              GLfloat x,
+                              GLfloat y,
+                              GLfloat z)
+{
+    return setUniform3f (UniformHandle (name), x, y, z);
+}
+
+bool GLProgram::setUniform4f (const char *name,
+                              GLfloat x,
+                              GLfloat y,
+                              GLfloat z,
+                              GLfloat w)
+{
+    return setUniform4f (UniformHandle (name), x, y, z, w);
+}
+
+bool GLProgram::setUniform2i (const char *name,
+                              GLint x,
+                              GLint y)
+{
+    return setUniform2i (UniformHandle (name), x, y);
+}
+
+bool GLProgram::setUniform3i (const char *name,
+                              GLint x,
+                              GLint y,
+                              GLint z)
+{
+    return setUniform3i (UniformHandle (name), x, y, z);
+}
+
+bool GLProgram::setUniform4i (const char *name,
+                              GLint x,
+                              GLint y,
+                              GLint z,
+                              GLint w)
+{
+    return setUniform4i (UniformHandle (name), x, y, z, w);
+}
+
+bool GLProgram::setUniform (const UniformHandle &uniform, GLfloat value)
+{
+    GLint location = priv->location (uniform.id);
     if (location == -1)
 	return false;
 
-    (*GL::uniform1f) (location, value);
+    if (priv->changed (uniform.id, UniformCache::Float, &value, 1))
+	(*GL::uniform1f) (location, value);
     return true;
 }
 
-bool GLProgram::setUniform (const char *name, GLint value)
+bool GLProgram::setUniform (const UniformHandle &uniform, GLint value)
 {
-    GLint location = (*GL::getUniformLocation) (priv->program, name);
+    GLint location = priv->location (uniform.id);
     if (location == -1)
 	return false;
 
-    (*GL::uniform1i) (location, value);
+    if (priv->changed (uniform.id, UniformCache::Int, &value, 1))
+	(*GL::uniform1i) (location, value);
     return true;
 }
 
-bool GLProgram::setUniform (const char *name, const GLMatrix &value)
+bool GLProgram::setUniform (const UniformHandle &uniform,
+                            const GLMatrix      &value)
 {
-    GLint location = (*GL::getUniformLocation) (priv->program, name);
+    GLint location = priv->location (uniform.id);
     if (location == -1)
 	return false;
 
-    (*GL::uniformMatrix4fv) (location, 1, GL_FALSE, value.getMatrix ());
+    if (priv->changed (uniform.id, UniformCache::Matrix,
+		       value.getMatrix (), 16))
+	(*GL::uniformMatrix4fv) (location, 1, GL_FALSE, value.getMatrix ());
     return true;
 }
 
-bool GLProgram::setUniform2f (const char *name,
+bool GLProgram::setUniform2f (const UniformHandle &uniform,
                               GLfloat x,
                               GLfloat y)
 {
-    GLint location = (*GL::getUniformLocation) (priv->program, name);
+    GLint location = priv->location (uniform.id);
     if (location == -1)
 	return false;
 
-    (*GL::uniform2f) (location, x, y);
+    GLfloat v[2] = { x, y };
+
+    if (priv->changed (uniform.id, UniformCache::Float, v, 2))
+	(*GL::uniform2f) (location, x, y);
     return true;
 }
 
-bool GLProgram::setUniform3f (const char *name,
+bool GLProgram::setUniform3f (const UniformHandle &uniform,
                               GLfloat x,
                               GLfloat y,
                               GLfloat z)
 {
-    GLint location = (*GL::getUniformLocation) (priv->program, name);
+    GLint location = priv->location (uniform.id);
     if (location == -1)
 	return false;
 
-    (*GL::uniform3f) (location, x, y, z);
+    GLfloat v[3] = { x, y, z };
+
+    if (priv->changed (uniform.id, UniformCache::Float, v, 3))
+	(*GL::uniform3f) (location, x, y, z);
     return true;
 }
 
-bool GLProgram::setUniform4f (const char *name,
+bool GLProgram::setUniform4f (const UniformHandle &uniform,
                               GLfloat x,
                               GLfloat y,
                               GLfloat z,
                               GLfloat w)
 {
-    GLint location = (*GL::getUniformLocation) (priv->program, name);
+    GLint location = priv->location (uniform.id);
     if (location == -1)
 	return false;
 
-    (*GL::uniform4f) (location, x, y, z, w);
+    GLfloat v[4] = { x, y, z, w };
+
+    if (priv->changed (uniform.id, UniformCache::Float, v, 4))
+	(*GL::uniform4f) (location, x, y, z, w);
     return true;
 }
 
-bool GLProgram::setUniform2i (const char *name,
+bool GLProgram::setUniform2i (const UniformHandle &uniform,
                               GLint x,
                               GLint y)
 {
-    GLint location = (*GL::getUniformLocation) (priv->program, name);
+    GLint location = priv->location (uniform.id);
     if (location == -1)
 	return false;
 
-    (*GL::uniform2i) (location, x, y);
+    GLint v[2] = { x, y };
+
+    if (priv->changed (uniform.id, UniformCache::Int, v, 2))
+	(*GL::uniform2i) (location, x, y);
     return true;
 }
 
-bool GLProgram::setUniform3i (const char *name,
+bool GLProgram::setUniform3i (const UniformHandle &uniform,
                               GLint x,
                               GLint y,
                               GLint z)
 {
-    GLint location = (*GL::getUniformLocation) (priv->program, name);
+    GLint location = priv->location (uniform.id);
     if (location == -1)
 	return false;
 
-    (*GL::uniform3i) (location, x, y, z);
+    GLint v[3] = { x, y, z };
+
+    if (priv->changed (uniform.id, UniformCache::Int, v, 3))
+	(*GL::uniform3i) (location, x, y, z);
     return true;
 }
 
-bool GLProgram::setUniform4i (const char *name,
+bool GLProgram::setUniform4i (const UniformHandle &uniform,
                               GLint x,
                               GLint y,
                               GLint z,
                               GLint w)
 {
-    GLint location = (*GL::getUniformLocation) (priv->program, name);
+    GLint location = priv->location (uniform.id);
     if (location == -1)
 	return false;
 
-    (*GL::uniform4i) (location, x, y, z, w);
+    GLint v[4] = { x, y, z, w };
+
+    if (priv->changed (uniform.id, UniformCache::Int, v, 4))
+	(*GL::uniform4i) (location, x, y, z, w);
     return true;
 }
 
@@ -0,0 +1,263 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "programbinary.h"
+
+namespace co = compiz::opengl;
+
+namespace
+{
+const char         Magic[8] = { 'C', 'Z', 'P', 'R', 'O', 'G', 0, 1 };
+
+/* Nothing compiz builds comes close, anything bigger is garbage */
+const unsigned int MaxBinary = 16 << 20;
+
+struct Header
+{
+    char               magic[8];
+    unsigned int       format;
+    unsigned int       driverLength;
+    unsigned int       binaryLength;
+    unsigned int       reserved;
+    unsigned long long buildTime;
+};
+
+/* FNV-1a, the key only has to tell sources apart */
+void
+hash (unsigned long long &h, const std::string &s)
+{
+    for (std::string::size_type i = 0; i < s.size (); ++i)
+    {
+	h ^= (unsigned char) s[i];
+	h *= 0x100000001b3ULL;
+    }
+
+    h ^= 0xff;
+    h *= 0x100000001b3ULL;
+}
+}
+
+co::ProgramBinaryStore::ProgramBinaryStore (const std::string &directory,
+					    const std::string &driver) :
+    mDirectory (directory),
+    mDriver (driver),
+    mHits (0),
+    mMisses (0),
+    mRejected (0),
+    mSaved (0)
+{
+}
+
+std::string
+co::ProgramBinaryStore::defaultDirectory ()
+{
+    const char *cache = getenv ("XDG_CACHE_HOME");
+    std::string directory;
+
+    if (cache && *cache)
+	directory = cache;
+    else if (const char *home = getenv ("HOME"))
+	directory = std::string (home) + "/.cache";
+    else
+	return std::string ();
+
+    return directory + "/compiz-1/programs";
+}
+
+std::string
+co::ProgramBinaryStore::key (const std::string &vertex,
+			     const std::string &fragment) const
+{
+    unsigned long long h = 0xcbf29ce484222325ULL;
+    char               buffer[17];
+
+    hash (h, mDriver);
+    hash (h, vertex);
+    hash (h, fragment);
+
+    snprintf (buffer, sizeof (buffer), "%016llx", h);
+
+    return buffer;
+}
+
+std::string
+co::ProgramBinaryStore::path (const std::string &key) const
+{
+    return mDirectory + "/" + key + ".bin";
+}
+
+bool
+co::ProgramBinaryStore::load (const std::string  &key,
+			      unsigned int       &format,
+			      std::vector <char> &binary,
+			      unsigned long long &buildTime)
+{
+    std::string file = path (key);
+    FILE        *fp = fopen (file.c_str (), "rb");
+
+    if (!fp)
+    {
+	++mMisses;
+	return false;
+    }
+
+    Header      header;
+    std::string driver;
+    bool        valid = fread (&header, sizeof (header), 1, fp) == 1 &&
+			!memcmp (header.magic, Magic, sizeof (Magic)) &&
+			header.driverLength == mDriver.size () &&
+			header.binaryLength > 0 &&
+			header.binaryLength <= MaxBinary;
+
+    if (valid)
+    {
+	driver.resize (header.driverLength);
+	binary.resize (header.binaryLength);
+
+	valid = (driver.empty () ||
+		 fread (&driver[0], driver.size (), 1, fp) == 1) &&
+		driver == mDriver &&
+		fread (&binary[0], binary.size (), 1, fp) == 1 &&
+		fgetc (fp) == EOF;
+    }
+
+    fclose (fp);
+
+    if (!valid)
+    {
+	unlink (file.c_str ());
+	binary.clear ();
+	++mMisses;
+	return false;
+    }
+
+    format    = header.format;
+    buildTime = header.buildTime;
+    ++mHits;
+
+    return true;
+}
+
+bool
+co::ProgramBinaryStore::createDirectory (const std::string &path) const
+{
+    if (mkdir (path.c_str (), 0700) == 0 || errno == EEXIST)
+	return true;
+
+    if (errno != ENOENT)
+	return false;
+
+    std::string::size_type pos = path.rfind ('/');
+
+    if (pos == std::string::npos || pos == 0)
+	return false;
+
+    if (!createDirectory (path.substr (0, pos)))
+	return false;
+
+    return mkdir (path.c_str (), 0700) == 0 || errno == EEXIST;
+}
+
+bool
+co::ProgramBinaryStore::store (const std::string        &key,
+			       unsigned int             format,
+			       const std::vector <char> &binary,
+			       unsigned long long       buildTime)
+{
+    if (mDirectory.empty () || binary.empty () || binary.size () > MaxBinary)
+	return false;
+
+    if (!createDirectory (mDirectory))
+	return false;
+
+    Header header;
+
+    memset (&header, 0, sizeof (header));
+    memcpy (header.magic, Magic, sizeof (Magic));
+    header.format       = format;
+    header.driverLength = mDriver.size ();
+    header.binaryLength = binary.size ();
+    header.buildTime    = buildTime;
+
+    /* Written aside and renamed over, a crash or a second compiz
+     * never leaves half a file behind. Each writer gets a name of
+     * its own, so two storing the same key can't write into one */
+    std::string        file = path (key);
+    std::string        pattern = file + ".XXXXXX";
+    std::vector <char> temporary (pattern.begin (), pattern.end ());
+
+    temporary.push_back ('\0');
+
+    int fd = mkstemp (&temporary[0]);
+
+    if (fd == -1)
+	return false;
+
+    FILE *fp = fdopen (fd, "wb");
+
+    if (!fp)
+    {
+	close (fd);
+	unlink (&temporary[0]);
+	return false;
+    }
+
+    bool written = fwrite (&header, sizeof (header), 1, fp) == 1 &&
+		   (mDriver.empty () ||
+		    fwrite (mDriver.data (), mDriver.size (), 1, fp) == 1) &&
+		   fwrite (&binary[0], binary.size (), 1, fp) == 1;
+
+    if (fclose (fp) != 0)
+	written = false;
+
+    if (!written || rename (&temporary[0], file.c_str ()) != 0)
+    {
+	unlink (&temporary[0]);
+	return false;
+    }
+
+    return true;
+}
+
+void
+co::ProgramBinaryStore::discard (const std::string &key)
+{
+    unlink (path (key).c_str ());
+    ++mRejected;
+}
+
+void
+co::ProgramBinaryStore::loaded (unsigned long long buildTime,
+				unsigned long long loadTime)
+{
+    if (buildTime > loadTime)
+	mSaved += buildTime - loadTime;
+}
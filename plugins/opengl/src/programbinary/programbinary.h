@@ -0,0 +1,100 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_OPENGL_PROGRAMBINARY_H
+#define _COMPIZ_OPENGL_PROGRAMBINARY_H
+
+#include <string>
+#include <vector>
+
+namespace compiz {
+namespace opengl {
+
+/**
+ * Keeps linked program binaries in files, so that the next start
+ * doesn't have to compile and link the same shaders again.
+ *
+ * A binary is found by a key made from the shader sources and the
+ * driver (vendor, renderer and version). Each file also records the
+ * driver it came from and how long compiling and linking took. A
+ * file that is unreadable, truncated or from another driver is
+ * deleted rather than handed out.
+ */
+class ProgramBinaryStore
+{
+    public:
+
+	ProgramBinaryStore (const std::string &directory,
+			    const std::string &driver);
+
+	/* $XDG_CACHE_HOME/compiz-1/programs, or the same under
+	 * ~/.cache, empty if neither is known */
+	static std::string defaultDirectory ();
+
+	std::string key (const std::string &vertex,
+			 const std::string &fragment) const;
+
+	/* Fills in the binary, its driver defined format and the
+	 * microseconds it took to build it. Returns false on a miss */
+	bool load (const std::string   &key,
+		   unsigned int        &format,
+		   std::vector <char>  &binary,
+		   unsigned long long  &buildTime);
+
+	bool store (const std::string        &key,
+		    unsigned int             format,
+		    const std::vector <char> &binary,
+		    unsigned long long       buildTime);
+
+	/* Drops a binary the driver wouldn't take */
+	void discard (const std::string &key);
+
+	/* Binaries found, binaries not found and binaries found that
+	 * the driver then refused */
+	unsigned int hits () const { return mHits; }
+	unsigned int misses () const { return mMisses; }
+	unsigned int rejected () const { return mRejected; }
+
+	/* Microseconds spent building what was found, and loading it */
+	void loaded (unsigned long long buildTime,
+		     unsigned long long loadTime);
+	unsigned long long saved () const { return mSaved; }
+
+    private:
+
+	std::string path (const std::string &key) const;
+	bool        createDirectory (const std::string &path) const;
+
+	std::string mDirectory;
+	std::string mDriver;
+
+	unsigned int       mHits;
+	unsigned int       mMisses;
+	unsigned int       mRejected;
+	unsigned long long mSaved;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,201 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <vector>
+
+#include "programbinary.h"
+
+using compiz::opengl::ProgramBinaryStore;
+
+class OpenGLProgramBinaryTest :
+    public ::testing::Test
+{
+    protected:
+
+	void SetUp ()
+	{
+	    char dir[] = "/tmp/compiz-programbinary-XXXXXX";
+
+	    ASSERT_TRUE (mkdtemp (dir));
+	    root = dir;
+	    directory = root + "/cache/programs";
+
+	    binary.push_back ('a');
+	    binary.push_back ('b');
+	    binary.push_back ('c');
+	}
+
+	void TearDown ()
+	{
+	    std::string command = "rm -rf '" + root + "'";
+	    ASSERT_EQ (0, system (command.c_str ()));
+	}
+
+	std::string file (const std::string &key)
+	{
+	    return directory + "/" + key + ".bin";
+	}
+
+	std::string        root;
+	std::string        directory;
+	std::vector <char> binary;
+};
+
+TEST_F (OpenGLProgramBinaryTest, KeysDependOnSourcesAndDriver)
+{
+    ProgramBinaryStore store (directory, "vendor renderer 1.0");
+    ProgramBinaryStore other (directory, "vendor renderer 2.0");
+
+    EXPECT_EQ (store.key ("v", "f"), store.key ("v", "f"));
+    EXPECT_NE (store.key ("v", "f"), store.key ("f", "v"));
+    EXPECT_NE (store.key ("vf", ""), store.key ("v", "f"));
+    EXPECT_NE (store.key ("v", "f"), other.key ("v", "f"));
+}
+
+TEST_F (OpenGLProgramBinaryTest, StoredBinaryIsLoaded)
+{
+    ProgramBinaryStore store (directory, "driver");
+    std::string        key = store.key ("v", "f");
+
+    ASSERT_TRUE (store.store (key, 42, binary, 1500));
+
+    unsigned int       format = 0;
+    unsigned long long buildTime = 0;
+    std::vector <char> loaded;
+
+    ASSERT_TRUE (store.load (key, format, loaded, buildTime));
+    EXPECT_EQ (42u, format);
+    EXPECT_EQ (1500u, buildTime);
+    EXPECT_EQ (binary, loaded);
+    EXPECT_EQ (1u, store.hits ());
+    EXPECT_EQ (0u, store.misses ());
+}
+
+TEST_F (OpenGLProgramBinaryTest, StoringLeavesOnlyTheBinary)
+{
+    ProgramBinaryStore store (directory, "driver");
+    ProgramBinaryStore other (directory, "driver");
+    std::string        key = store.key ("v", "f");
+
+    ASSERT_TRUE (store.store (key, 42, binary, 1500));
+    ASSERT_TRUE (other.store (key, 42, binary, 1500));
+
+    DIR                       *dir = opendir (directory.c_str ());
+    struct dirent             *entry;
+    std::vector <std::string> names;
+
+    ASSERT_TRUE (dir);
+
+    while ((entry = readdir (dir)))
+	if (entry->d_name[0] != '.')
+	    names.push_back (entry->d_name);
+
+    closedir (dir);
+
+    ASSERT_EQ (1u, names.size ());
+    EXPECT_EQ (key + ".bin", names[0]);
+}
+
+TEST_F (OpenGLProgramBinaryTest, MissingBinaryIsAMiss)
+{
+    ProgramBinaryStore store (directory, "driver");
+    unsigned int       format;
+    unsigned long long buildTime;
+    std::vector <char> loaded;
+
+    EXPECT_FALSE (store.load (store.key ("v", "f"), format, loaded, buildTime));
+    EXPECT_EQ (1u, store.misses ());
+}
+
+TEST_F (OpenGLProgramBinaryTest, OtherDriverIsRejectedAndDeleted)
+{
+    ProgramBinaryStore store (directory, "old driver");
+    ProgramBinaryStore updated (directory, "new driver");
+    std::string        key = store.key ("v", "f");
+
+    ASSERT_TRUE (store.store (key, 1, binary, 10));
+
+    unsigned int       format;
+    unsigned long long buildTime;
+    std::vector <char> loaded;
+
+    /* Same key as if the hash had collided */
+    EXPECT_FALSE (updated.load (key, format, loaded, buildTime));
+    EXPECT_NE (0, access (file (key).c_str (), F_OK));
+}
+
+TEST_F (OpenGLProgramBinaryTest, TruncatedFileIsRejectedAndDeleted)
+{
+    ProgramBinaryStore store (directory, "driver");
+    std::string        key = store.key ("v", "f");
+
+    ASSERT_TRUE (store.store (key, 1, binary, 10));
+    ASSERT_EQ (0, truncate (file (key).c_str (), 20));
+
+    unsigned int       format;
+    unsigned long long buildTime;
+    std::vector <char> loaded;
+
+    EXPECT_FALSE (store.load (key, format, loaded, buildTime));
+    EXPECT_TRUE (loaded.empty ());
+    EXPECT_NE (0, access (file (key).c_str (), F_OK));
+}
+
+TEST_F (OpenGLProgramBinaryTest, DiscardDeletesTheBinary)
+{
+    ProgramBinaryStore store (directory, "driver");
+    std::string        key = store.key ("v", "f");
+
+    ASSERT_TRUE (store.store (key, 1, binary, 10));
+
+    store.discard (key);
+
+    EXPECT_NE (0, access (file (key).c_str (), F_OK));
+    EXPECT_EQ (1u, store.rejected ());
+}
+
+TEST_F (OpenGLProgramBinaryTest, SavedTimeNeverGoesBackwards)
+{
+    ProgramBinaryStore store (directory, "driver");
+
+    store.loaded (1000, 100);
+    store.loaded (100, 1000);
+
+    EXPECT_EQ (900u, store.saved ());
+}
+
+TEST_F (OpenGLProgramBinaryTest, NothingIsStoredWithoutADirectory)
+{
+    ProgramBinaryStore store ("", "driver");
+
+    EXPECT_FALSE (store.store (store.key ("v", "f"), 1, binary, 10));
+}
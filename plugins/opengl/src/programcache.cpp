@@ -88,12 +88,30 @@ compileProgram (std::string name, std::list<const GLShaderData*> shaders)
     return new GLProgram (vertex_shader, fragment_shader);
 }
 
+static std::string
+cacheKey (const std::list<const GLShaderData*> &shaders)
+{
+    std::list<const GLShaderData*>::const_iterator name_it;
+    std::string name;
+
+    for (name_it = shaders.begin(); name_it != shaders.end(); ++name_it)
+    {
+	if (name.length () == 0)
+	    name += (*name_it)->name;
+	else
+	    name += ":" + (*name_it)->name;
+    }
+
+    return name;
+}
+
 class PrivateProgramCache
 {
     public:
 	PrivateProgramCache (size_t);
 
 	const size_t                 capacity;
+	unsigned int                 compiled;
 	access_history_t             access_history;
 	std::map<std::string, value> cache;
 
@@ -114,22 +132,14 @@ GLProgramCache::~GLProgramCache ()
  
 GLProgram* GLProgramCache::operator () (std::list<const GLShaderData*> shaders)
 {
-    std::list<const GLShaderData*>::const_iterator name_it;
-    std::string name;
-
-    for (name_it = shaders.begin(); name_it != shaders.end(); ++name_it)
-    {
-	if (name.length () == 0)
-	    name += (*name_it)->name;
-	else
-	    name += ":" + (*name_it)->name;
-    }
+    std::string name = cacheKey (shaders);
 
     std::map<std::string, value>::iterator it = priv->cache.find (name);
  
     if (it == priv->cache.end ())
     {
 	GLProgram *program = compileProgram (name, shaders);
+	++priv->compiled;
 	priv->insert (name, program);
 	return program;
     }
@@ -144,8 +154,21 @@ GLProgram* GLProgramCache::operator () (std::list<const GLShaderData*> shaders)
     }
 }
 
+bool
+GLProgramCache::cached (const std::list<const GLShaderData*> &shaders) const
+{
+    return priv->cache.find (cacheKey (shaders)) != priv->cache.end ();
+}
+
+unsigned int
+GLProgramCache::compiled () const
+{
+    return priv->compiled;
+}
+
 PrivateProgramCache::PrivateProgramCache (size_t c) :
-    capacity (c)
+    capacity (c),
+    compiled (0)
 {
 }
 
@@ -40,6 +40,7 @@
 
 #include <dlfcn.h>
 #include <math.h>
+#include <time.h>
 
 template class WrapableInterface<GLScreen, GLScreenInterface>;
 
@@ -78,6 +79,11 @@ static const size_t NUM_X11_SYNCS = 16;
  */
 static const GLuint64 MAX_SYNC_WAIT_TIME = 1000000000ull; // One second
 
+/**
+ * The number of texture objects kept for window pixmaps bound later.
+ */
+static const unsigned int TEXTURE_POOL_SIZE = 16;
+
 namespace GL {
     #ifdef USE_GLES
     EGLCreateImageKHRProc  createImage;
@@ -188,6 +194,10 @@ namespace GL {
 
     GLImportSyncProc importSync = NULL;
 
+    GLGetProgramBinaryProc  getProgramBinary = NULL;
+    GLProgramBinaryProc     programBinary = NULL;
+    GLProgramParameteriProc programParameteri = NULL;
+
     bool  textureFromPixmap = true;
     bool  textureRectangle = false;
     bool  textureNonPowerOfTwo = false;
@@ -208,6 +218,7 @@ namespace GL {
 
     bool sync = false;
     bool xToGLSync = false;
+    bool programBinaries = false;
 
     bool canDoSaturated = false;
     bool canDoSlightlySaturated = false;
@@ -302,6 +313,50 @@ namespace GL {
 
 CompOutput *targetOutput = NULL;
 
+namespace
+{
+class GLStateDriver :
+    public compiz::opengl::StateCache::Driver
+{
+    public:
+
+	void enable (unsigned int cap)
+	{
+	    glEnable (cap);
+	}
+
+	void disable (unsigned int cap)
+	{
+	    glDisable (cap);
+	}
+
+	void activeTexture (unsigned int unit)
+	{
+	    if (GL::activeTexture)
+		(*GL::activeTexture) (GL_TEXTURE0 + unit);
+	}
+
+	void bindTexture (unsigned int target, unsigned int name)
+	{
+	    glBindTexture (target, name);
+	}
+
+	void useProgram (unsigned int program)
+	{
+	    (*GL::useProgram) (program);
+	}
+};
+}
+
+compiz::opengl::StateCache &
+glStateCache ()
+{
+    static GLStateDriver               driver;
+    static compiz::opengl::StateCache cache (&driver);
+
+    return cache;
+}
+
 /**
  * Callback object to create GLPrograms automatically when using GLVertexBuffer.
  */
@@ -701,6 +756,17 @@ GLScreen::glInitContext (XVisualInfo *visinfo)
     GL::eglImageTargetTexture = (GL::GLEGLImageTargetTexture2DOESProc)
 	eglGetProcAddress ("glEGLImageTargetTexture2DOES");
 
+    if (strstr (glExtensions, "GL_OES_get_program_binary"))
+    {
+	GL::getProgramBinary = (GL::GLGetProgramBinaryProc)
+	    eglGetProcAddress ("glGetProgramBinaryOES");
+	GL::programBinary = (GL::GLProgramBinaryProc)
+	    eglGetProcAddress ("glProgramBinaryOES");
+
+	if (GL::getProgramBinary && GL::programBinary)
+	    GL::programBinaries = true;
+    }
+
     if (!strstr (eglExtensions, "EGL_KHR_image_pixmap") ||
         !strstr (glExtensions, "GL_OES_EGL_image") ||
 	!GL::createImage || !GL::destroyImage || !GL::eglImageTargetTexture)
@@ -1105,6 +1171,19 @@ GLScreen::glInitContext (XVisualInfo *visinfo)
 	    GL::xToGLSync = true;
     }
 
+    if (GL::shaders && strstr (glExtensions, "GL_ARB_get_program_binary"))
+    {
+	GL::getProgramBinary = (GL::GLGetProgramBinaryProc)
+	    getProcAddress ("glGetProgramBinary");
+	GL::programBinary = (GL::GLProgramBinaryProc)
+	    getProcAddress ("glProgramBinary");
+	GL::programParameteri = (GL::GLProgramParameteriProc)
+	    getProcAddress ("glProgramParameteri");
+
+	if (GL::getProgramBinary && GL::programBinary)
+	    GL::programBinaries = true;
+    }
+
     glClearColor (0.0, 0.0, 0.0, 1.0);
     glBlendFunc (GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
     glEnable (GL_CULL_FACE);
@@ -1143,6 +1222,8 @@ GLScreen::glInitContext (XVisualInfo *visinfo)
 	registerBindPixmap (TfpTexture::bindPixmapToTexture);
 #endif
 
+    priv->initProgramBinaries ();
+
     /* Scratch framebuffer must be allocated before updating
      * the backbuffer provider */
     if (GL::fboSupported)
@@ -1154,6 +1235,12 @@ GLScreen::glInitContext (XVisualInfo *visinfo)
     GLVertexBuffer::streamingBuffer ()->setAutoProgram (priv->autoProgram);
     priv->updateFrameProvider ();
 
+    /* Every draw binds its own textures when shaders are used */
+    glStateCache ().setDeferTextureRelease (GLVertexBuffer::enabled ());
+    glStateCache ().suspend ();
+
+    priv->startShaderWarmup ();
+
     return true;
 }
 
@@ -1460,12 +1547,17 @@ GLScreen::GLScreen (CompScreen *s) :
 #endif
     if (!glInitContext (visinfo))
 	setFailed ();
+    else
+	PrivateTexture::pool ().setCapacity (TEXTURE_POOL_SIZE);
 }
 
 GLScreen::~GLScreen ()
 {
     // Must occur before context is destroyed.
     priv->destroyXToGLSyncs ();
+    PrivateVertexBuffer::destroyStreamRing ();
+    PrivateTexture::pool ().setCapacity (0);
+    priv->releaseProgramBinaries ();
 
     if (priv->hasCompositing)
 	CompositeScreen::get (screen)->unregisterPaintHandler ();
@@ -1530,7 +1622,24 @@ PrivateGLScreen::PrivateGLScreen (GLScreen   *gs) :
     prevBlacklisted (false),
     currentSyncNum (0),
     currentSync (0),
-    warmupSyncs (0)
+    warmupSyncs (0),
+    paintStamp (0),
+    frameStamp (0),
+    /* The likely programs and a few used ones, well short of the 30
+     * the program cache holds, so that warming up never pushes the
+     * programs including plugin shaders out */
+    shaderWarmup (compiz::opengl::ShaderWarmup::likelyParameters (), 18),
+    lastShaderParams (),
+    lastShaderData (NULL),
+    shaderWarmupTimer (),
+    lastPaintTime (0),
+    prefetchQueue (),
+    prefetchTimer (),
+    deferredBinds (0),
+    prefetchedBinds (0),
+    paintBinds (0),
+    paintBindTime (0),
+    prefetchBindTime (0)
 {
     ScreenInterface::setHandler (screen);
     CompositeScreenInterface::setHandler (cScreen);
@@ -2031,18 +2140,20 @@ GLScreen::clearOutput (CompOutput   *output,
 {
     BoxPtr pBox = &output->region ()->extents;
 
+    PrivateVertexBuffer::submitHeld ();
+
     if (pBox->x1 != 0	     ||
 	pBox->y1 != 0	     ||
 	pBox->x2 != (int) screen->width () ||
 	pBox->y2 != (int) screen->height ())
     {
-	glEnable (GL_SCISSOR_TEST);
+	glStateCache ().enable (GL_SCISSOR_TEST);
 	glScissor (pBox->x1,
 		   screen->height () - pBox->y2,
 		   pBox->x2 - pBox->x1,
 		   pBox->y2 - pBox->y1);
 	glClear (mask);
-	glDisable (GL_SCISSOR_TEST);
+	glStateCache ().disable (GL_SCISSOR_TEST);
     }
     else
     {
@@ -2076,13 +2187,21 @@ GLScreen::getEGLContext ()
 GLProgram *
 GLScreen::getProgram (std::list<const GLShaderData*> shaders)
 {
+    /* Only programs made of parameters alone are worth warming up,
+     * the shaders plugins add come and go with the windows */
+    if (shaders.size () == 1 && shaders.front () == priv->lastShaderData)
+	priv->shaderWarmup.used (priv->lastShaderParams);
+
     return (*priv->programCache)(shaders);
 }
 
 const GLShaderData *
 GLScreen::getShaderData (GLShaderParameters &params)
 {
-    return &priv->shaderCache.getShaderData(params);
+    priv->lastShaderParams = params;
+    priv->lastShaderData   = &priv->shaderCache.getShaderData(params);
+
+    return priv->lastShaderData;
 }
 
 GLDoubleBuffer::GLDoubleBuffer (Display                                             *d,
@@ -2130,6 +2249,178 @@ PrivateGLScreen::initXToGLSyncs ()
     }
 }
 
+void
+PrivateGLScreen::initProgramBinaries ()
+{
+    GLint formats = 0;
+
+    if (GL::programBinaries)
+	glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+    /* Some drivers have the extension without any format to use */
+    if (formats <= 0)
+    {
+	GL::programBinaries = false;
+	return;
+    }
+
+    std::string directory =
+	compiz::opengl::ProgramBinaryStore::defaultDirectory ();
+
+    if (directory.empty ())
+	return;
+
+    const char  *strings[] = {
+	(const char *) glGetString (GL_VENDOR),
+	(const char *) glGetString (GL_RENDERER),
+	(const char *) glGetString (GL_VERSION)
+    };
+    std::string driver;
+
+    for (unsigned int i = 0; i < sizeof (strings) / sizeof (strings[0]); ++i)
+    {
+	driver += strings[i] ? strings[i] : "";
+	driver += '\n';
+    }
+
+    PrivateProgram::binaryStore =
+	new compiz::opengl::ProgramBinaryStore (directory, driver);
+}
+
+void
+PrivateGLScreen::releaseProgramBinaries ()
+{
+    compiz::opengl::ProgramBinaryStore *store = PrivateProgram::binaryStore;
+
+    if (!store)
+	return;
+
+    unsigned int found = store->hits () - store->rejected ();
+    unsigned int total = store->hits () + store->misses ();
+
+    if (total)
+	compLogMessage ("opengl", CompLogLevelInfo,
+			"Program binaries: %u of %u programs loaded (%u%%), "
+			"%u refused by the driver, %.1f ms of compiling "
+			"and linking saved",
+			found, total, found * 100 / total,
+			store->rejected (), store->saved () / 1000.0);
+
+    delete store;
+    PrivateProgram::binaryStore = NULL;
+}
+
+namespace
+{
+unsigned long long
+microseconds ()
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/* Programs are built with the same parameters GLScreenAutoProgram
+ * asks for, so a warmed up program is the one a paint would get */
+class ShaderWarmupBuilder :
+    public compiz::opengl::ShaderWarmup::Builder
+{
+    public:
+
+	ShaderWarmupBuilder (GLScreen *gScreen, GLProgramCache *cache) :
+	    gScreen (gScreen),
+	    cache (cache)
+	{
+	}
+
+	bool build (const GLShaderParameters &p)
+	{
+	    GLShaderParameters              params (p);
+	    std::list<const GLShaderData *> shaders;
+	    unsigned int                    compiled = cache->compiled ();
+
+	    shaders.push_back (gScreen->getShaderData (params));
+
+	    /* Looking a cached program up would make it the most
+	     * recently used, ahead of programs painting really uses */
+	    if (cache->cached (shaders))
+		return false;
+
+	    gScreen->getProgram (shaders);
+
+	    return cache->compiled () != compiled;
+	}
+
+	unsigned long long now ()
+	{
+	    return microseconds ();
+	}
+
+    private:
+
+	GLScreen       *gScreen;
+	GLProgramCache *cache;
+};
+
+/* How long a slice may keep the main loop busy and how recently a
+ * frame must have been painted for the screen to count as busy */
+const unsigned int warmupInterval = 50;
+const unsigned int warmupBudget   = 4000;
+const unsigned int warmupIdle     = 100000;
+}
+
+void
+PrivateGLScreen::startShaderWarmup ()
+{
+    if (!GL::shaders)
+	return;
+
+    shaderWarmup.restart ();
+
+    if (!shaderWarmupTimer.active ())
+	shaderWarmupTimer.start
+	    (boost::bind (&PrivateGLScreen::shaderWarmupTimeout, this),
+	     warmupInterval);
+}
+
+bool
+PrivateGLScreen::shaderWarmupTimeout ()
+{
+    /* Don't take time away from an animation */
+    if (microseconds () - lastPaintTime < warmupIdle)
+	return true;
+
+    ShaderWarmupBuilder builder (gScreen, programCache);
+
+    if (shaderWarmup.slice (builder, warmupBudget))
+	return true;
+
+    unsigned int prebuilt, onDemand;
+
+    gScreen->shaderWarmupStatistics (prebuilt, onDemand);
+    compLogMessage ("opengl", CompLogLevelDebug,
+		    "Shader warmup: %u programs built ahead of time, "
+		    "%u while painting", prebuilt, onDemand);
+
+    return false;
+}
+
+/* A plugin that was just loaded may have pushed programs in use out
+ * of the cache with its own, look over the likely and the used ones
+ * again */
+bool
+PrivateGLScreen::initPluginForScreen (CompPlugin *p)
+{
+    bool status = screen->initPluginForScreen (p);
+
+    if (status)
+	startShaderWarmup ();
+
+    return status;
+}
+
 void
 PrivateGLScreen::destroyXToGLSyncs ()
 {
@@ -2357,6 +2648,8 @@ PrivateGLScreen::paintOutputs (CompOutput::ptrList &outputs,
 			       unsigned int        mask,
 			       const CompRegion    &region)
 {
+    ++frameStamp;
+
     if (clearBuffers)
     {
 	if (mask & COMPOSITE_SCREEN_DAMAGE_ALL_MASK)
@@ -2366,9 +2659,12 @@ PrivateGLScreen::paintOutputs (CompOutput::ptrList &outputs,
     if (currentSync)
 	currentSync->insertWait ();
 
+    /* Nothing but our own paint code runs until a plugin is called */
+    glStateCache ().resume ();
+
     // Disable everything that we don't usually need and could slow us down
-    glDisable (GL_BLEND);
-    glDisable (GL_STENCIL_TEST);
+    glStateCache ().disable (GL_BLEND);
+    glStateCache ().disable (GL_STENCIL_TEST);
     glDisable (GL_DEPTH_TEST);
     glDepthMask (GL_FALSE);
     glStencilMask (0);
@@ -2475,6 +2771,9 @@ PrivateGLScreen::paintOutputs (CompOutput::ptrList &outputs,
 		cScreen->recordDamageOnCurrentFrame (outputReg);
 	    }
 	}
+
+	/* Before the viewport moves on */
+	PrivateVertexBuffer::submitHeld ();
     }
 
     targetOutput = &screen->outputDevs ()[0];
@@ -2493,7 +2792,13 @@ PrivateGLScreen::paintOutputs (CompOutput::ptrList &outputs,
 					      paintRegion, scratchFbo.get (), mask);
     }
 
+    glStateCache ().suspend ();
+    glStateCache ().frameDone ();
+
     frameProvider->endFrame ();
+    PrivateVertexBuffer::frameDone ();
+
+    lastPaintTime = microseconds ();
 
     if (cScreen->outputWindowChanged ())
     {
@@ -2516,6 +2821,10 @@ PrivateGLScreen::paintOutputs (CompOutput::ptrList &outputs,
     doubleBuffer.set (DoubleBuffer::VSYNC, optionGetSyncToVblank ());
     doubleBuffer.set (DoubleBuffer::HAVE_PERSISTENT_BACK_BUFFER, persistence);
     doubleBuffer.set (DoubleBuffer::NEED_PERSISTENT_BACK_BUFFER, alwaysSwap);
+
+    /* Everything from here on may wait for vblank */
+    cScreen->frameSubmitted ();
+
     doubleBuffer.render (paintRegion, fullscreen);
 
     lastMask = mask;
@@ -2523,6 +2832,52 @@ PrivateGLScreen::paintOutputs (CompOutput::ptrList &outputs,
     updateXToGLSyncs ();
 }
 
+/* Runs from the main loop as soon as it is idle, which ahead of an
+ * animation is before the paint timeout of its next frame fires */
+bool
+PrivateGLScreen::prefetchQueued ()
+{
+    std::vector<Window> queued;
+    queued.swap (prefetchQueue);
+
+    foreach (Window id, queued)
+    {
+	CompWindow *w = screen->findWindow (id);
+
+	if (!w || !w->isViewable ())
+	    continue;
+
+	GLWindow *gw = GLWindow::get (w);
+
+	if (!gw->priv->needsRebind)
+	    continue;
+
+	if (timedBind (gw, prefetchBindTime))
+	    prefetchedBinds++;
+    }
+
+    compLogMessage ("opengl", CompLogLevelDebug,
+		    "Window binds: %llu prefetched in %llu us, "
+		    "%llu while painting in %llu us, %llu deferred",
+		    prefetchedBinds, prefetchBindTime,
+		    paintBinds, paintBindTime, deferredBinds);
+
+    return false;
+}
+
+/* Binds gw, adding the time it took to time */
+bool
+PrivateGLScreen::timedBind (GLWindow           *gw,
+			    unsigned long long &time)
+{
+    unsigned long long start = microseconds ();
+    bool               bound = gw->bind ();
+
+    time += microseconds () - start;
+
+    return bound;
+}
+
 unsigned int
 PrivateGLScreen::getFrameAge ()
 {
@@ -2668,6 +3023,14 @@ PrivateGLScreen::prepareDrawing ()
     }
 }
 
+/* The fence triggered in prepareDrawing is waited for before
+ * anything is drawn, see paintOutputs */
+bool
+PrivateGLScreen::fencesXRequests ()
+{
+    return currentSync != NULL;
+}
+
 bool
 PrivateGLScreen::driverIsBlacklisted (const char *regex) const
 {
@@ -2759,3 +3122,85 @@ GLScreen::resetRasterPos ()
     priv->rasterPos.setY (0);
 }
 
+void
+GLScreen::occlusionCacheStatistics (unsigned long long &hits,
+				    unsigned long long &misses) const
+{
+    hits   = priv->occlusionCache.hits ();
+    misses = priv->occlusionCache.misses ();
+}
+
+void
+GLScreen::glStateStatistics (unsigned int &issued,
+			     unsigned int &elided) const
+{
+    issued = glStateCache ().issued ();
+    elided = glStateCache ().elided ();
+}
+
+void
+GLScreen::submitHeldDraws ()
+{
+    PrivateVertexBuffer::submitHeld ();
+}
+
+void
+GLScreen::drawBatchStatistics (unsigned int &held,
+			       unsigned int &submitted) const
+{
+    held      = PrivateVertexBuffer::drawBatch.added ();
+    submitted = PrivateVertexBuffer::drawBatch.batches ();
+}
+
+void
+GLScreen::texturePoolStatistics (unsigned long long &reused,
+				 unsigned long long &created) const
+{
+    reused  = PrivateTexture::pool ().reused ();
+    created = PrivateTexture::pool ().created ();
+}
+
+void
+GLScreen::lazyBindStatistics (unsigned long long &deferred,
+			      unsigned long long &prefetched) const
+{
+    deferred   = priv->deferredBinds;
+    prefetched = priv->prefetchedBinds;
+}
+
+void
+GLScreen::lazyBindTimes (unsigned long long &paintBinds,
+			 unsigned long long &painting,
+			 unsigned long long &prefetching) const
+{
+    paintBinds  = priv->paintBinds;
+    painting    = priv->paintBindTime;
+    prefetching = priv->prefetchBindTime;
+}
+
+void
+GLScreen::prefetchViewport (const CompPoint &viewport)
+{
+    CompRect area (screen->width ()  * (viewport.x () - screen->vp ().x ()),
+		   screen->height () * (viewport.y () - screen->vp ().y ()),
+		   screen->width (),
+		   screen->height ());
+
+    foreach (CompWindow *w, screen->windows ())
+    {
+	if (!w->isViewable () || w->onAllViewports ())
+	    continue;
+
+	if (w->outputRect ().intersects (area))
+	    GLWindow::get (w)->prefetch ();
+    }
+}
+
+void
+GLScreen::shaderWarmupStatistics (unsigned int &prebuilt,
+				  unsigned int &onDemand) const
+{
+    prebuilt = priv->shaderWarmup.prebuilt ();
+    onDemand = priv->programCache->compiled () - prebuilt;
+}
+
@@ -0,0 +1,127 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "shaderwarmup.h"
+
+namespace co = compiz::opengl;
+
+namespace
+{
+GLShaderParameters
+parameters (bool                 opacity,
+	    bool                 brightness,
+	    bool                 saturation,
+	    GLShaderVariableType color,
+	    int                  numTextures)
+{
+    GLShaderParameters params;
+
+    params.opacity     = opacity;
+    params.brightness  = brightness;
+    params.saturation  = saturation;
+    params.color       = color;
+    params.normal      = GLShaderVariableUniform;
+    params.numTextures = numTextures;
+
+    return params;
+}
+
+bool
+same (const GLShaderParameters &a,
+      const GLShaderParameters &b)
+{
+    return a.opacity == b.opacity && a.brightness == b.brightness &&
+	   a.saturation == b.saturation && a.color == b.color &&
+	   a.normal == b.normal && a.numTextures == b.numTextures;
+}
+}
+
+std::vector <GLShaderParameters>
+co::ShaderWarmup::likelyParameters ()
+{
+    std::vector <GLShaderParameters> plan;
+
+    /* Opacity changes most often (fade, scale, switchers), then
+     * brightness, then saturation */
+    for (int i = 0; i < 8; ++i)
+	plan.push_back (parameters (i & 1, i & 2, i & 4,
+				    GLShaderVariableUniform, 1));
+
+    plan.push_back (parameters (false, false, false,
+				GLShaderVariableVarying, 0));
+    plan.push_back (parameters (true, false, false,
+				GLShaderVariableVarying, 0));
+    plan.push_back (parameters (false, false, false,
+				GLShaderVariableUniform, 0));
+    plan.push_back (parameters (true, false, false,
+				GLShaderVariableUniform, 0));
+    plan.push_back (parameters (false, false, false,
+				GLShaderVariableUniform, 2));
+    plan.push_back (parameters (true, false, false,
+				GLShaderVariableUniform, 2));
+
+    return plan;
+}
+
+co::ShaderWarmup::ShaderWarmup (const std::vector <GLShaderParameters> &plan,
+				unsigned int                           limit) :
+    mPlan (plan),
+    mNext (0),
+    mLimit (limit),
+    mPrebuilt (0)
+{
+}
+
+void
+co::ShaderWarmup::used (const GLShaderParameters &params)
+{
+    for (unsigned int i = 0; i < mPlan.size (); ++i)
+	if (same (mPlan[i], params))
+	    return;
+
+    if (mPlan.size () < mLimit)
+	mPlan.push_back (params);
+}
+
+void
+co::ShaderWarmup::restart ()
+{
+    mNext = 0;
+}
+
+bool
+co::ShaderWarmup::slice (Builder &builder, unsigned long long budget)
+{
+    unsigned long long start = builder.now ();
+
+    while (mNext < mPlan.size ())
+    {
+	if (builder.build (mPlan[mNext++]))
+	    ++mPrebuilt;
+
+	if (builder.now () - start >= budget)
+	    break;
+    }
+
+    return !done ();
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_OPENGL_SHADERWARMUP_H
+#define _COMPIZ_OPENGL_SHADERWARMUP_H
+
+#include <vector>
+
+#include <opengl/shadercache.h>
+
+namespace compiz {
+namespace opengl {
+
+/**
+ * Builds the programs windows are most likely to be drawn with ahead
+ * of time, a few at a time, so that the first frame that needs one
+ * doesn't have to compile and link it.
+ *
+ * Each slice builds programs until its time budget is used up. A
+ * program takes as long as it takes, so a slice can overrun by the
+ * time of the last one it started.
+ *
+ * The plan starts out as a fixed guess, as which plugins will draw
+ * with what isn't known before they do. Parameters painting draws
+ * with, without any plugin shaders, are added to it, so a restart
+ * after loading a plugin rebuilds the programs actually in use if
+ * the plugin's own pushed them out. Shaders plugins add to windows
+ * are not covered, only the programs built from parameters alone.
+ * The limit keeps the plan well short of what the program cache
+ * holds, so that it never pushes programs with plugin shaders out.
+ */
+class ShaderWarmup
+{
+    public:
+
+	class Builder
+	{
+	    public:
+
+		virtual ~Builder () {}
+
+		/* Makes sure the program exists, returns true if it
+		 * had to be built */
+		virtual bool build (const GLShaderParameters &params) = 0;
+
+		/* Microseconds on a monotonic clock */
+		virtual unsigned long long now () = 0;
+	};
+
+	/* Most likely first: textured windows with every combination
+	 * of opacity, brightness and saturation, then plain fills and
+	 * two texture draws. Kept short enough not to push programs in
+	 * use out of the program cache */
+	static std::vector <GLShaderParameters> likelyParameters ();
+
+	/* The plan grows to at most limit programs */
+	ShaderWarmup (const std::vector <GLShaderParameters> &plan,
+		      unsigned int                           limit);
+
+	/* Adds params to the plan if it isn't in it yet */
+	void used (const GLShaderParameters &params);
+
+	/* Goes through the plan again, after plugins were loaded */
+	void restart ();
+
+	/* Builds what the budget allows, returns true while there are
+	 * programs left to look at */
+	bool slice (Builder &builder, unsigned long long budget);
+
+	bool done () const { return mNext == mPlan.size (); }
+
+	unsigned int size () const { return mPlan.size (); }
+
+	/* Programs that had to be built by a slice */
+	unsigned int prebuilt () const { return mPrebuilt; }
+
+    private:
+
+	std::vector <GLShaderParameters>           mPlan;
+	std::vector <GLShaderParameters>::size_type mNext;
+	unsigned int                               mLimit;
+	unsigned int                               mPrebuilt;
+};
+
+}
+}
+
+#endif
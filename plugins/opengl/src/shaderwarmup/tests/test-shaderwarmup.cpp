@@ -0,0 +1,302 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <list>
+#include <set>
+#include <string>
+
+#include "shaderwarmup.h"
+
+using compiz::opengl::ShaderWarmup;
+
+namespace
+{
+std::string
+key (const GLShaderParameters &p)
+{
+    char buffer[32];
+
+    snprintf (buffer, sizeof (buffer), "%d%d%d%d%d%d",
+	      p.opacity, p.brightness, p.saturation,
+	      p.color, p.normal, p.numTextures);
+
+    return buffer;
+}
+
+/* Every build takes cost microseconds, programs in cached were
+ * built before and cost nothing */
+class FakeBuilder :
+    public ShaderWarmup::Builder
+{
+    public:
+
+	FakeBuilder (unsigned long long cost) :
+	    time (0),
+	    cost (cost),
+	    calls (0)
+	{
+	}
+
+	bool build (const GLShaderParameters &params)
+	{
+	    ++calls;
+
+	    if (!cached.insert (key (params)).second)
+		return false;
+
+	    time += cost;
+	    return true;
+	}
+
+	unsigned long long now ()
+	{
+	    return time;
+	}
+
+	std::set <std::string> cached;
+	unsigned long long     time;
+	unsigned long long     cost;
+	unsigned int           calls;
+};
+
+/* A program cache holding capacity programs, the least recently
+ * built goes first. Like the real builder, cached programs are
+ * skipped without counting as used */
+class LruBuilder :
+    public ShaderWarmup::Builder
+{
+    public:
+
+	LruBuilder (unsigned int capacity) :
+	    capacity (capacity)
+	{
+	}
+
+	void add (const std::string &program)
+	{
+	    order.push_back (program);
+
+	    if (order.size () > capacity)
+		order.pop_front ();
+	}
+
+	bool has (const std::string &program) const
+	{
+	    return std::find (order.begin (), order.end (), program) !=
+		   order.end ();
+	}
+
+	bool build (const GLShaderParameters &params)
+	{
+	    if (has (key (params)))
+		return false;
+
+	    add (key (params));
+	    return true;
+	}
+
+	unsigned long long now ()
+	{
+	    return 0;
+	}
+
+	unsigned int            capacity;
+	std::list <std::string> order;
+};
+}
+
+TEST (OpenGLShaderWarmupTest, LikelyParametersAreDistinct)
+{
+    std::vector <GLShaderParameters> plan = ShaderWarmup::likelyParameters ();
+    std::set <std::string>           keys;
+
+    for (unsigned int i = 0; i < plan.size (); ++i)
+	keys.insert (key (plan[i]));
+
+    EXPECT_EQ (plan.size (), keys.size ());
+
+    /* Half of the program cache at most */
+    EXPECT_LE (plan.size (), 15u);
+}
+
+TEST (OpenGLShaderWarmupTest, PlainTexturedWindowComesFirst)
+{
+    GLShaderParameters first = ShaderWarmup::likelyParameters ()[0];
+
+    EXPECT_FALSE (first.opacity);
+    EXPECT_FALSE (first.brightness);
+    EXPECT_FALSE (first.saturation);
+    EXPECT_EQ (GLShaderVariableUniform, first.color);
+    EXPECT_EQ (1, first.numTextures);
+}
+
+TEST (OpenGLShaderWarmupTest, SliceStopsWhenBudgetIsSpent)
+{
+    ShaderWarmup warmup (ShaderWarmup::likelyParameters (), 30);
+    FakeBuilder  builder (1000);
+
+    EXPECT_TRUE (warmup.slice (builder, 3000));
+    EXPECT_EQ (3u, builder.calls);
+    EXPECT_EQ (3u, warmup.prebuilt ());
+    EXPECT_FALSE (warmup.done ());
+}
+
+TEST (OpenGLShaderWarmupTest, SliceBuildsAtLeastOneProgram)
+{
+    ShaderWarmup warmup (ShaderWarmup::likelyParameters (), 30);
+    FakeBuilder  builder (10000);
+
+    warmup.slice (builder, 1000);
+
+    EXPECT_EQ (1u, builder.calls);
+}
+
+TEST (OpenGLShaderWarmupTest, CachedProgramsCostNothing)
+{
+    std::vector <GLShaderParameters> plan = ShaderWarmup::likelyParameters ();
+    ShaderWarmup                     warmup (plan, 30);
+    FakeBuilder                      builder (1000);
+
+    builder.cached.insert (key (plan[0]));
+    builder.cached.insert (key (plan[1]));
+
+    warmup.slice (builder, 2000);
+
+    EXPECT_EQ (4u, builder.calls);
+    EXPECT_EQ (2u, warmup.prebuilt ());
+}
+
+TEST (OpenGLShaderWarmupTest, RunsUntilDone)
+{
+    std::vector <GLShaderParameters> plan = ShaderWarmup::likelyParameters ();
+    ShaderWarmup                     warmup (plan, 30);
+    FakeBuilder                      builder (1000);
+    unsigned int                     slices = 1;
+
+    while (warmup.slice (builder, 4000))
+	++slices;
+
+    EXPECT_TRUE (warmup.done ());
+    EXPECT_EQ ((plan.size () + 3) / 4, slices);
+    EXPECT_EQ (plan.size (), warmup.prebuilt ());
+    EXPECT_EQ (plan.size (), builder.cached.size ());
+}
+
+TEST (OpenGLShaderWarmupTest, RestartOnlyRebuildsEvictedPrograms)
+{
+    std::vector <GLShaderParameters> plan = ShaderWarmup::likelyParameters ();
+    ShaderWarmup                     warmup (plan, 30);
+    FakeBuilder                      builder (1000);
+
+    while (warmup.slice (builder, 100000));
+
+    builder.cached.erase (key (plan[5]));
+    warmup.restart ();
+
+    EXPECT_FALSE (warmup.done ());
+    EXPECT_FALSE (warmup.slice (builder, 100000));
+    EXPECT_EQ (plan.size () + 1, warmup.prebuilt ());
+}
+
+TEST (OpenGLShaderWarmupTest, UsedParametersAreAddedOnce)
+{
+    std::vector <GLShaderParameters> plan = ShaderWarmup::likelyParameters ();
+    ShaderWarmup                     warmup (plan, 30);
+    GLShaderParameters               params = plan[0];
+
+    warmup.used (params);
+    EXPECT_EQ (plan.size (), warmup.size ());
+
+    params.normal = GLShaderVariableVarying;
+    warmup.used (params);
+    warmup.used (params);
+    EXPECT_EQ (plan.size () + 1, warmup.size ());
+}
+
+TEST (OpenGLShaderWarmupTest, RestartRebuildsUsedPrograms)
+{
+    std::vector <GLShaderParameters> plan = ShaderWarmup::likelyParameters ();
+    ShaderWarmup                     warmup (plan, 30);
+    FakeBuilder                      builder (1000);
+    GLShaderParameters               params = plan[0];
+
+    while (warmup.slice (builder, 100000));
+
+    /* A plugin drew with it, and another one has since pushed it
+     * out of the cache */
+    params.numTextures = 3;
+    warmup.used (params);
+
+    warmup.restart ();
+    warmup.slice (builder, 100000);
+
+    EXPECT_EQ (1u, builder.cached.count (key (params)));
+    EXPECT_EQ (plan.size () + 1, warmup.prebuilt ());
+}
+
+TEST (OpenGLShaderWarmupTest, PlanStopsGrowingAtTheLimit)
+{
+    std::vector <GLShaderParameters> plan = ShaderWarmup::likelyParameters ();
+    ShaderWarmup                     warmup (plan, plan.size () + 1);
+    GLShaderParameters               params = plan[0];
+
+    for (int i = 3; i < 6; ++i)
+    {
+	params.numTextures = i;
+	warmup.used (params);
+    }
+
+    EXPECT_EQ (plan.size () + 1, warmup.size ());
+}
+
+TEST (OpenGLShaderWarmupTest, WarmupLeavesRoomForPluginPrograms)
+{
+    std::vector <GLShaderParameters> plan = ShaderWarmup::likelyParameters ();
+    ShaderWarmup                     warmup (plan, plan.size () + 4);
+    LruBuilder                       builder (plan.size () + 8);
+    GLShaderParameters               params = plan[0];
+
+    /* More parameters are used than the plan takes */
+    for (int i = 3; i < 10; ++i)
+    {
+	params.numTextures = i;
+	warmup.used (params);
+    }
+
+    builder.add ("plugin:a");
+    builder.add ("plugin:b");
+
+    while (warmup.slice (builder, 100000));
+
+    /* Loading a plugin starts the warmup over */
+    warmup.restart ();
+    while (warmup.slice (builder, 100000));
+
+    EXPECT_EQ (plan.size () + 4, warmup.size ());
+    EXPECT_TRUE (builder.has ("plugin:a"));
+    EXPECT_TRUE (builder.has ("plugin:b"));
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "streamring.h"
+
+namespace co = compiz::opengl;
+
+co::StreamRing::StreamRing (Storage *storage, std::size_t size) :
+    mStorage (storage),
+    mSize (size),
+    mAllocated (false),
+    mHead (0),
+    mUsed (0),
+    mCurrent (0),
+    mUploaded (0),
+    mAllocations (0)
+{
+}
+
+co::StreamRing::~StreamRing ()
+{
+    for (unsigned int i = 0; i < mFrames.size (); ++i)
+	mStorage->release (mFrames[i].fence);
+}
+
+std::size_t
+co::StreamRing::write (const void *data, std::size_t size)
+{
+    std::size_t offset = reserve (size);
+
+    upload (offset, data, size);
+
+    return offset;
+}
+
+std::size_t
+co::StreamRing::reserve (std::size_t size)
+{
+    std::size_t space  = aligned (size);
+    std::size_t offset = 0;
+
+    if (!mAllocated || !fit (space, offset))
+    {
+	retire ();
+
+	if (!mAllocated || !fit (space, offset))
+	{
+	    orphan (space);
+	    offset = 0;
+	}
+    }
+
+    mHead     = offset + space;
+    mUsed    += space;
+    mCurrent += space;
+
+    return offset;
+}
+
+void
+co::StreamRing::upload (std::size_t offset, const void *data, std::size_t size)
+{
+    mStorage->upload (offset, data, size);
+    mUploaded += size;
+}
+
+void
+co::StreamRing::frameDone ()
+{
+    if (mCurrent)
+    {
+	Frame frame;
+
+	frame.bytes = mCurrent;
+	frame.fence = mStorage->fence ();
+
+	mFrames.push_back (frame);
+	mCurrent = 0;
+    }
+
+    /* Keeps the number of fences down while the ring is far
+     * from full */
+    retire ();
+}
+
+bool
+co::StreamRing::fit (std::size_t size, std::size_t &offset)
+{
+    if (size > mSize - mUsed)
+	return false;
+
+    if (!mUsed)
+    {
+	mHead  = 0;
+	offset = 0;
+	return true;
+    }
+
+    std::size_t tail = (mHead + mSize - mUsed) % mSize;
+
+    if (mHead > tail)
+    {
+	if (size <= mSize - mHead)
+	{
+	    offset = mHead;
+	    return true;
+	}
+
+	/* Skip the end of the buffer and start over at the front */
+	std::size_t skipped = mSize - mHead;
+
+	if (size > tail || size + skipped > mSize - mUsed)
+	    return false;
+
+	mUsed    += skipped;
+	mCurrent += skipped;
+	offset    = 0;
+	return true;
+    }
+
+    /* Already wrapped, the free space ends at the tail */
+    if (size > tail - mHead)
+	return false;
+
+    offset = mHead;
+    return true;
+}
+
+void
+co::StreamRing::retire ()
+{
+    while (!mFrames.empty () && mStorage->signalled (mFrames.front ().fence))
+    {
+	mUsed -= mFrames.front ().bytes;
+	mStorage->release (mFrames.front ().fence);
+	mFrames.pop_front ();
+    }
+}
+
+void
+co::StreamRing::orphan (std::size_t size)
+{
+    /* One write has to fit with room to spare */
+    while (size > mSize / 2)
+	mSize *= 2;
+
+    for (unsigned int i = 0; i < mFrames.size (); ++i)
+	mStorage->release (mFrames[i].fence);
+
+    mFrames.clear ();
+    mStorage->allocate (mSize);
+
+    mAllocated = true;
+    mHead      = 0;
+    mUsed      = 0;
+    mCurrent   = 0;
+    ++mAllocations;
+}
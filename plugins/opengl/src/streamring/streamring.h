@@ -0,0 +1,138 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_OPENGL_STREAMRING_H
+#define _COMPIZ_OPENGL_STREAMRING_H
+
+#include <cstddef>
+#include <deque>
+
+namespace compiz {
+namespace opengl {
+
+/**
+ * Hands out space in one large buffer object for vertex data that
+ * is specified anew for every draw.
+ *
+ * Data is appended behind what was written before, so the draws of
+ * a frame all come out of the same allocation and only differ in
+ * their offsets. At the end of a frame the space it used is fenced.
+ * Once the ring comes round to it again that space is only reused if
+ * its fence has signalled, so writing never waits for the GPU. If
+ * the space is still in use the storage is orphaned instead: the
+ * driver keeps the old storage alive for the draws reading it and
+ * writing starts over in new storage.
+ */
+class StreamRing
+{
+    public:
+
+	typedef void * Fence;
+
+	/* What the ring needs from GL */
+	class Storage
+	{
+	    public:
+
+		virtual ~Storage () {}
+
+		/* New storage of size bytes, the old contents may
+		 * still be read by draws already submitted */
+		virtual void allocate (std::size_t size) = 0;
+		virtual void upload (std::size_t offset,
+				     const void  *data,
+				     std::size_t size) = 0;
+
+		/* Fences the commands submitted so far, signalled
+		 * must not wait */
+		virtual Fence fence () = 0;
+		virtual bool signalled (Fence) = 0;
+		virtual void release (Fence) = 0;
+	};
+
+	static const std::size_t DefaultSize = 1 << 20;
+
+	/* Offsets are aligned to this */
+	static const std::size_t Alignment = 16;
+
+	StreamRing (Storage *storage, std::size_t size = DefaultSize);
+	~StreamRing ();
+
+	/* Copies the data into the ring and returns its offset */
+	std::size_t write (const void *data, std::size_t size);
+
+	/* Makes room for size bytes in one piece and returns where.
+	 * Everything one draw reads has to be reserved at once: when
+	 * the ring starts over in new storage, what was written to
+	 * the old one is gone for draws not submitted yet */
+	std::size_t reserve (std::size_t size);
+
+	/* Copies the data to offset, inside space reserved before */
+	void upload (std::size_t offset, const void *data, std::size_t size);
+
+	/* What size takes up in the ring */
+	static std::size_t aligned (std::size_t size)
+	{
+	    return (size + Alignment - 1) & ~(Alignment - 1);
+	}
+
+	/* Call once the draws of a frame have been submitted */
+	void frameDone ();
+
+	std::size_t size () const { return mSize; }
+
+	/* Bytes written and storage allocated so far */
+	unsigned long long uploaded () const { return mUploaded; }
+	unsigned int allocations () const { return mAllocations; }
+
+    private:
+
+	struct Frame
+	{
+	    std::size_t bytes;
+	    Fence       fence;
+	};
+
+	bool fit (std::size_t size, std::size_t &offset);
+	void retire ();
+	void orphan (std::size_t size);
+
+	Storage            *mStorage;
+	std::size_t        mSize;
+	bool               mAllocated;
+
+	/* Space in use runs from mUsed bytes before mHead up to it,
+	 * including the end of the buffer skipped when wrapping */
+	std::size_t        mHead;
+	std::size_t        mUsed;
+	std::size_t        mCurrent;
+	std::deque <Frame> mFrames;
+
+	unsigned long long mUploaded;
+	unsigned int       mAllocations;
+};
+
+}
+}
+
+#endif
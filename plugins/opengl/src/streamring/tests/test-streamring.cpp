@@ -0,0 +1,292 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <set>
+#include <vector>
+
+#include "streamring.h"
+
+using compiz::opengl::StreamRing;
+
+namespace
+{
+/* Remembers what was written and which fences the GPU is done with */
+class FakeStorage :
+    public StreamRing::Storage
+{
+    public:
+
+	FakeStorage () :
+	    allocated (0),
+	    nextFence (1)
+	{
+	}
+
+	void allocate (std::size_t size)
+	{
+	    data.assign (size, 0);
+	    ++allocated;
+	}
+
+	void upload (std::size_t offset, const void *src, std::size_t size)
+	{
+	    ASSERT_LE (offset + size, data.size ());
+	    memcpy (&data[offset], src, size);
+	}
+
+	StreamRing::Fence fence ()
+	{
+	    StreamRing::Fence f = reinterpret_cast <StreamRing::Fence> (nextFence++);
+
+	    live.insert (f);
+	    return f;
+	}
+
+	bool signalled (StreamRing::Fence f)
+	{
+	    return done.count (f) != 0;
+	}
+
+	void release (StreamRing::Fence f)
+	{
+	    ASSERT_EQ (1u, live.erase (f));
+	}
+
+	/* The GPU finished everything fenced so far */
+	void finish ()
+	{
+	    done = live;
+	}
+
+	std::vector <char>           data;
+	unsigned int                 allocated;
+	unsigned long                nextFence;
+	std::set <StreamRing::Fence> live;
+	std::set <StreamRing::Fence> done;
+};
+
+std::vector <char>
+bytes (std::size_t size, char value)
+{
+    return std::vector <char> (size, value);
+}
+}
+
+TEST (OpenGLStreamRing, DrawsOfAFrameShareOneAllocation)
+{
+    FakeStorage storage;
+    StreamRing  ring (&storage, 1024);
+
+    std::vector <char> a = bytes (100, 'a');
+    std::vector <char> b = bytes (30, 'b');
+
+    std::size_t first  = ring.write (&a[0], a.size ());
+    std::size_t second = ring.write (&b[0], b.size ());
+
+    EXPECT_EQ (0u, first);
+    EXPECT_EQ (112u, second);
+    EXPECT_EQ (0u, second % StreamRing::Alignment);
+    EXPECT_EQ ('a', storage.data[99]);
+    EXPECT_EQ ('b', storage.data[112]);
+
+    EXPECT_EQ (1u, storage.allocated);
+    EXPECT_EQ (1u, ring.allocations ());
+    EXPECT_EQ (130u, ring.uploaded ());
+}
+
+TEST (OpenGLStreamRing, FinishedSpaceIsReused)
+{
+    FakeStorage        storage;
+    StreamRing         ring (&storage, 1024);
+    std::vector <char> data = bytes (256, 'x');
+
+    for (int frame = 0; frame < 20; ++frame)
+    {
+	ring.write (&data[0], data.size ());
+	ring.write (&data[0], data.size ());
+	ring.frameDone ();
+	storage.finish ();
+    }
+
+    EXPECT_EQ (1u, storage.allocated);
+    EXPECT_TRUE (storage.live.size () <= 1);
+}
+
+TEST (OpenGLStreamRing, SpaceInUseIsNeverOverwritten)
+{
+    FakeStorage        storage;
+    StreamRing         ring (&storage, 1024);
+    std::vector <char> data = bytes (256, 'x');
+
+    ring.write (&data[0], data.size ());
+    ring.write (&data[0], data.size ());
+    ring.frameDone ();
+
+    /* The GPU is still on the first frame */
+    ring.write (&data[0], data.size ());
+    ring.write (&data[0], data.size ());
+    EXPECT_EQ (1u, storage.allocated);
+
+    ring.write (&data[0], data.size ());
+    EXPECT_EQ (2u, storage.allocated);
+
+    /* Everything fenced before the orphan went with it */
+    EXPECT_TRUE (storage.live.empty ());
+}
+
+TEST (OpenGLStreamRing, WrapsToTheFrontOnceItIsFree)
+{
+    FakeStorage        storage;
+    StreamRing         ring (&storage, 1024);
+    std::vector <char> big = bytes (400, 'b');
+    std::vector <char> small = bytes (300, 's');
+
+    ring.write (&big[0], big.size ());
+    ring.frameDone ();
+    storage.finish ();
+
+    ring.write (&big[0], big.size ());
+    ring.frameDone ();
+
+    /* Doesn't fit behind the second frame, the first one is done */
+    EXPECT_EQ (0u, ring.write (&small[0], small.size ()));
+    EXPECT_EQ ('s', storage.data[0]);
+    EXPECT_EQ ('b', storage.data[400]);
+    EXPECT_EQ (1u, storage.allocated);
+}
+
+TEST (OpenGLStreamRing, WrappingDoesntReachIntoTheCurrentFrame)
+{
+    FakeStorage        storage;
+    StreamRing         ring (&storage, 1024);
+    std::vector <char> data = bytes (400, 'x');
+
+    ring.write (&data[0], data.size ());
+    ring.write (&data[0], data.size ());
+    ring.write (&data[0], data.size ());
+
+    EXPECT_EQ (2u, storage.allocated);
+}
+
+TEST (OpenGLStreamRing, GrowsForLargeWrites)
+{
+    FakeStorage        storage;
+    StreamRing         ring (&storage, 1024);
+    std::vector <char> data = bytes (3000, 'x');
+
+    EXPECT_EQ (0u, ring.write (&data[0], data.size ()));
+    EXPECT_LE (6000u, ring.size ());
+    EXPECT_EQ (ring.size (), storage.data.size ());
+}
+
+TEST (OpenGLStreamRing, EmptyFramesAreNotFenced)
+{
+    FakeStorage storage;
+    StreamRing  ring (&storage, 1024);
+
+    ring.frameDone ();
+    ring.frameDone ();
+
+    EXPECT_TRUE (storage.live.empty ());
+    EXPECT_EQ (0u, storage.allocated);
+}
+
+TEST (OpenGLStreamRing, ArraysOfADrawSurviveNewStorage)
+{
+    FakeStorage        storage;
+    StreamRing         ring (&storage, 256);
+    std::vector <char> filler = bytes (120, 'f');
+
+    /* Still being read, the draw below needs new storage */
+    ring.write (&filler[0], filler.size ());
+    ring.frameDone ();
+
+    std::vector <char> vertices = bytes (24, 'v');
+    std::vector <char> colors = bytes (16, 'c');
+    std::vector <char> texCoords = bytes (100, 't');
+
+    std::size_t base = ring.reserve (StreamRing::aligned (vertices.size ()) +
+				     StreamRing::aligned (colors.size ()) +
+				     StreamRing::aligned (texCoords.size ()));
+    std::size_t v = base;
+    std::size_t c = v + StreamRing::aligned (vertices.size ());
+    std::size_t t = c + StreamRing::aligned (colors.size ());
+
+    ring.upload (v, &vertices[0], vertices.size ());
+    ring.upload (c, &colors[0], colors.size ());
+    ring.upload (t, &texCoords[0], texCoords.size ());
+
+    EXPECT_EQ (2u, storage.allocated);
+    EXPECT_EQ ('v', storage.data[v + vertices.size () - 1]);
+    EXPECT_EQ ('c', storage.data[c + colors.size () - 1]);
+    EXPECT_EQ ('t', storage.data[t + texCoords.size () - 1]);
+    EXPECT_EQ (140u, ring.uploaded () - filler.size ());
+}
+
+/* Without fences nothing is ever known to be free, so the ring keeps
+ * starting over. No draw may lose an array it wrote before that */
+TEST (OpenGLStreamRing, DrawsNeverSpanTwoAllocations)
+{
+    FakeStorage  storage;
+    StreamRing   ring (&storage, 1024);
+    unsigned int lost = 0;
+
+    for (int frame = 0; frame < 10; ++frame)
+    {
+	for (int draw = 0; draw < 40; ++draw)
+	{
+	    std::size_t sizes[3] = { 24u + (draw * 36) % 200,
+				     16,
+				     16u + (draw * 52) % 300 };
+	    std::size_t total = 0;
+
+	    for (int i = 0; i < 3; ++i)
+		total += StreamRing::aligned (sizes[i]);
+
+	    std::size_t offset = ring.reserve (total);
+	    std::size_t offsets[3];
+
+	    for (int i = 0; i < 3; ++i)
+	    {
+		std::vector <char> array = bytes (sizes[i], 'a' + i);
+
+		offsets[i] = offset;
+		ring.upload (offset, &array[0], array.size ());
+		offset += StreamRing::aligned (sizes[i]);
+	    }
+
+	    for (int i = 0; i < 3; ++i)
+		if (storage.data[offsets[i]] != 'a' + i ||
+		    storage.data[offsets[i] + sizes[i] - 1] != 'a' + i)
+		    ++lost;
+	}
+
+	ring.frameDone ();
+    }
+
+    EXPECT_LT (1u, storage.allocated);
+    EXPECT_EQ (0u, lost);
+}
@@ -127,19 +127,71 @@ PrivateTexture::PrivateTexture (GLTexture *texture) :
     mipmap  (true),
     mipmapSupport (false),
     initial (true),
-    refCount (1)
+    refCount (1),
+    pooled (false)
 {
-    glGenTextures (1, &name);
+    if (reusedName)
+    {
+	name = reusedName;
+	reusedName = 0;
+    }
+    else
+	glGenTextures (1, &name);
 }
 
 PrivateTexture::~PrivateTexture ()
 {
     if (name)
     {
-	glDeleteTextures (1, &name);
+	if (pooled)
+	    pool ().give (poolKey, name);
+	else
+	{
+	    glDeleteTextures (1, &name);
+	    glStateCache ().textureDeleted (name);
+	}
     }
 }
 
+namespace
+{
+void
+deletePooledTexture (unsigned int name)
+{
+    GLuint texture = name;
+
+    glDeleteTextures (1, &texture);
+    glStateCache ().textureDeleted (texture);
+}
+}
+
+GLuint PrivateTexture::reusedName = 0;
+
+compiz::opengl::TexturePool &
+PrivateTexture::pool ()
+{
+    static compiz::opengl::TexturePool texturePool (0, deletePooledTexture);
+
+    return texturePool;
+}
+
+void
+PrivateTexture::reuse (const compiz::opengl::TexturePool::Key &key)
+{
+    unsigned int name;
+
+    if (pool ().take (key, name))
+	reusedName = name;
+}
+
+void
+PrivateTexture::keep (GLTexture                              *texture,
+		      const compiz::opengl::TexturePool::Key &key)
+{
+    texture->priv->pooled  = true;
+    texture->priv->poolKey = key;
+}
+
 GLuint
 GLTexture::name () const
 {
@@ -175,9 +227,9 @@ GLTexture::enable (GLTexture::Filter filter)
 {
     GLScreen *gs = GLScreen::get (screen);
 #ifndef USE_GLES
-    glEnable (priv->target);
+    glStateCache ().enableTarget (priv->target);
 #endif
-    glBindTexture (priv->target, priv->name);
+    glStateCache ().bindTexture (priv->target, priv->name);
 
     if (filter == Fast)
     {
@@ -248,9 +300,9 @@ GLTexture::enable (GLTexture::Filter filter)
 void
 GLTexture::disable ()
 {
-    glBindTexture (priv->target, 0);
+    glStateCache ().releaseTexture (priv->target);
 #ifndef USE_GLES
-    glDisable (priv->target);
+    glStateCache ().releaseTarget (priv->target);
 #endif
 }
 
@@ -271,27 +323,27 @@ GLTexture::setMipmap (bool enable)
 void
 GLTexture::setFilter (GLenum filter)
 {
-    glBindTexture (priv->target, priv->name);
+    glStateCache ().bindTexture (priv->target, priv->name);
 
     priv->filter = filter;
 
     glTexParameteri (priv->target, GL_TEXTURE_MIN_FILTER, filter);
     glTexParameteri (priv->target, GL_TEXTURE_MAG_FILTER, filter);
 
-    glBindTexture (priv->target, 0);
+    glStateCache ().releaseTexture (priv->target);
 }
 
 void
 GLTexture::setWrap (GLenum wrap)
 {
-    glBindTexture (priv->target, priv->name);
+    glStateCache ().bindTexture (priv->target, priv->name);
 
     priv->wrap = GL_CLAMP_TO_EDGE;
 
     glTexParameteri (priv->target, GL_TEXTURE_WRAP_S, wrap);
     glTexParameteri (priv->target, GL_TEXTURE_WRAP_T, wrap);
 
-    glBindTexture (priv->target, 0);
+    glStateCache ().releaseTexture (priv->target);
 }
 
 GLTexture::List
@@ -360,12 +412,12 @@ PrivateTexture::loadImageData (const char   *image,
 	internalFormat = GL_COMPRESSED_RGBA_ARB;
     #endif
 
-    glBindTexture (target, t->name ());
+    glStateCache ().bindTexture (target, t->name ());
 
     glTexImage2D (target, 0, internalFormat, width, height, 0,
 		  format, type, image);
 
-    glBindTexture (target, 0);
+    glStateCache ().releaseTexture (target);
 
     return rv;
 }
@@ -477,12 +529,12 @@ EglTexture::EglTexture () :
 
 EglTexture::~EglTexture ()
 {
-    GLuint temp = name ();
-    glBindTexture (target (), name ());
-
-    glDeleteTextures (1, &temp);
-
-    glBindTexture (target (), 0);
+    /* Lets go of the pixmap's storage, the texture object itself
+     * goes back to the pool */
+    glStateCache ().bindTexture (target (), name ());
+    glTexImage2D (target (), 0, GL_RGBA, 0, 0, 0, GL_RGBA,
+		  GL_UNSIGNED_BYTE, NULL);
+    glStateCache ().releaseTexture (target ());
 
     boundPixmapTex.erase (damage);
     XDamageDestroy (screen->dpy (), damage);
@@ -521,7 +573,17 @@ EglTexture::bindPixmapToTexture (Pixmap                       pixmap,
     matrix.yy = 1.0f / height;
     matrix.y0 = 0.0f;
 
+    compiz::opengl::TexturePool::Key key;
+
+    key.target = GL_TEXTURE_2D;
+    key.width  = width;
+    key.height = height;
+    key.depth  = depth;
+
+    PrivateTexture::reuse (key);
+
     tex = new EglTexture ();
+    PrivateTexture::keep (tex, key);
     tex->setData (GL_TEXTURE_2D, matrix,
 	GL::textureNonPowerOfTwoMipmap ||
 	(POWER_OF_TWO (width) && POWER_OF_TWO (height)));
@@ -529,7 +591,7 @@ EglTexture::bindPixmapToTexture (Pixmap                       pixmap,
 
     rv[0] = tex;
 
-    glBindTexture (GL_TEXTURE_2D, tex->name ());
+    glStateCache ().bindTexture (GL_TEXTURE_2D, tex->name ());
 
     GL::eglImageTargetTexture (GL_TEXTURE_2D, (GLeglImageOES)eglImage);
     GL::destroyImage (eglGetDisplay (screen->dpy ()), eglImage);
@@ -537,7 +599,7 @@ EglTexture::bindPixmapToTexture (Pixmap                       pixmap,
     tex->setFilter (GL_NEAREST);
     tex->setWrap (GL_CLAMP_TO_EDGE);
 
-    glBindTexture (GL_TEXTURE_2D, 0);
+    glStateCache ().releaseTexture (GL_TEXTURE_2D);
 
     tex->damage = XDamageCreate (screen->dpy (), pixmap,
 			         XDamageReportBoundingBox);
@@ -549,7 +611,7 @@ EglTexture::bindPixmapToTexture (Pixmap                       pixmap,
 void
 EglTexture::enable (GLTexture::Filter filter)
 {
-    glBindTexture (target (), name ());
+    glStateCache ().bindTexture (target (), name ());
     GLTexture::enable (filter);
     
     if (damaged)
@@ -621,14 +683,14 @@ TfpTexture::~TfpTexture ()
 {
     if (pixmap)
     {
-	glEnable (target ());
+	glStateCache ().enableTarget (target ());
 
-	glBindTexture (target (), name ());
+	glStateCache ().bindTexture (target (), name ());
 
 	releaseTexImage ();
 
-	glBindTexture (target (), 0);
-	glDisable (target ());
+	glStateCache ().releaseTexture (target ());
+	glStateCache ().releaseTarget (target ());
 
 	GL::destroyPixmap (screen->dpy (), pixmap);
 
@@ -791,7 +853,17 @@ TfpTexture::bindPixmapToTexture (Pixmap            pixmap,
 	    return GLTexture::List ();
     }
 
+    compiz::opengl::TexturePool::Key key;
+
+    key.target = texTarget;
+    key.width  = width;
+    key.height = height;
+    key.depth  = depth;
+
+    PrivateTexture::reuse (key);
+
     tex = new TfpTexture ();
+    PrivateTexture::keep (tex, key);
     tex->setData (texTarget, matrix, mipmap);
     tex->setGeometry (0, 0, width, height);
     tex->pixmap = glxPixmap;
@@ -800,13 +872,13 @@ TfpTexture::bindPixmapToTexture (Pixmap            pixmap,
 
     rv[0] = tex;
 
-    glBindTexture (texTarget, tex->name ());
+    glStateCache ().bindTexture (texTarget, tex->name ());
 
     tex->bindTexImage (glxPixmap);
     tex->setFilter (GL_NEAREST);
     tex->setWrap (GL_CLAMP_TO_EDGE);
 
-    glBindTexture (texTarget, 0);
+    glStateCache ().releaseTexture (texTarget);
 
     tex->damage = XDamageCreate (screen->dpy (), pixmap,
 			         XDamageReportBoundingBox);
@@ -818,8 +890,8 @@ TfpTexture::bindPixmapToTexture (Pixmap            pixmap,
 void
 TfpTexture::enable (GLTexture::Filter filter)
 {
-    glEnable (target ());
-    glBindTexture (target (), name ());
+    glStateCache ().enableTarget (target ());
+    glStateCache ().bindTexture (target (), name ());
 
     if (damaged && pixmap)
     {
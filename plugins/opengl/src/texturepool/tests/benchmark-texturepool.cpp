@@ -0,0 +1,186 @@
+/*
+ * Counts the texture objects created while windows are resized, with
+ * and without a TexturePool.
+ *
+ * A window rebinds its pixmap every frame of an interactive resize and
+ * of a client side decoration animation, binding the new pixmap before
+ * the texture of the old one is released, as GLWindow::bind does. The
+ * storms are one window dragged bigger, one whose shadow flips between
+ * two sizes and ten windows resized one after the other.
+ *
+ * Run compiz_opengl_texturepool_benchmark [frames]
+ */
+
+#include "texturepool.h"
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include <boost/bind.hpp>
+
+using compiz::opengl::TexturePool;
+
+namespace
+{
+
+const unsigned int Texture2D (0x0DE1);
+const unsigned int poolSize (16);
+
+double
+now ()
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* Stands in for glGenTextures and glDeleteTextures */
+struct Driver
+{
+    Driver () : next (1), created (0), destroyed (0) {}
+
+    unsigned int create ()
+    {
+	++created;
+	return next++;
+    }
+
+    void destroy (unsigned int)
+    {
+	++destroyed;
+    }
+
+    unsigned int next;
+    unsigned int created;
+    unsigned int destroyed;
+};
+
+struct Window
+{
+    unsigned int     name;
+    TexturePool::Key key;
+};
+
+enum Storm
+{
+    Drag,
+    Pulse,
+    OneAfterAnother
+};
+
+const char *stormNames[] = {
+    "drag resize",
+    "shadow flip",
+    "10 windows in turn"
+};
+
+TexturePool::Key
+size (Storm storm, unsigned int frame, unsigned int window)
+{
+    TexturePool::Key key;
+
+    key.target = Texture2D;
+    key.depth  = 32;
+
+    switch (storm)
+    {
+	case Drag:
+	    key.width  = 400 + frame * 3;
+	    key.height = 300 + frame * 2;
+	    break;
+	case Pulse:
+	    key.width  = 400 + (frame % 2) * 16;
+	    key.height = 300 + (frame % 2) * 16;
+	    break;
+	default:
+	    key.width  = 400 + window * 10 + frame;
+	    key.height = 300 + window * 10;
+	    break;
+    }
+
+    return key;
+}
+
+void
+rebind (Window &w, const TexturePool::Key &key, Driver &driver,
+	TexturePool *pool)
+{
+    unsigned int name;
+
+    if (!pool || !pool->take (key, name))
+	name = driver.create ();
+
+    if (w.name)
+    {
+	if (pool)
+	    pool->give (w.key, w.name);
+	else
+	    driver.destroy (w.name);
+    }
+
+    w.name = name;
+    w.key  = key;
+}
+
+unsigned int
+run (Storm storm, unsigned int frames, bool pooled, unsigned int &sameSize,
+     double &time)
+{
+    Driver      driver;
+    TexturePool pool (poolSize, boost::bind (&Driver::destroy, &driver, _1));
+    unsigned int nWindows = storm == OneAfterAnother ? 10 : 1;
+
+    std::vector <Window> windows (nWindows);
+
+    for (unsigned int i = 0; i < nWindows; ++i)
+    {
+	windows[i].name = 0;
+	rebind (windows[i], size (storm, 0, i), driver, pooled ? &pool : NULL);
+    }
+
+    double start = now ();
+
+    for (unsigned int f = 1; f <= frames; ++f)
+    {
+	unsigned int i = storm == OneAfterAnother ?
+			 (f * nWindows / (frames + 1)) : 0;
+
+	rebind (windows[i], size (storm, f, i), driver, pooled ? &pool : NULL);
+    }
+
+    time = now () - start;
+    sameSize = pool.reusedSameSize ();
+
+    return driver.created - nWindows;
+}
+
+}
+
+int
+main (int argc, char **argv)
+{
+    unsigned int frames = argc > 1 ? atoi (argv[1]) : 600;
+
+    printf ("%u frames, pool of %u\n", frames, poolSize);
+    printf ("%-20s %10s %10s %10s %12s\n", "", "created", "pooled",
+	    "same size", "ns/rebind");
+
+    for (unsigned int s = Drag; s <= OneAfterAnother; ++s)
+    {
+	unsigned int sameSize;
+	double       plainTime, pooledTime;
+
+	unsigned int plain = run ((Storm) s, frames, false, sameSize,
+				  plainTime);
+	unsigned int pooled = run ((Storm) s, frames, true, sameSize,
+				   pooledTime);
+
+	printf ("%-20s %10u %10u %10u %12.1f\n", stormNames[s], plain, pooled,
+		sameSize, pooledTime * 1000000.0 / frames);
+    }
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include "texturepool.h"
+
+using compiz::opengl::TexturePool;
+
+namespace
+{
+const unsigned int Texture2D (0x0DE1);
+const unsigned int TextureRectangle (0x84F5);
+
+TexturePool::Key
+key (unsigned int target, int width, int height, int depth = 24)
+{
+    TexturePool::Key k;
+
+    k.target = target;
+    k.width  = width;
+    k.height = height;
+    k.depth  = depth;
+
+    return k;
+}
+
+void
+destroyed (std::vector <unsigned int> *names, unsigned int name)
+{
+    names->push_back (name);
+}
+}
+
+class OpenGLTexturePoolTest :
+    public ::testing::Test
+{
+    protected:
+
+	OpenGLTexturePoolTest () :
+	    pool (2, boost::bind (destroyed, &names, _1))
+	{
+	}
+
+	std::vector <unsigned int> names;
+	TexturePool                pool;
+};
+
+TEST_F (OpenGLTexturePoolTest, EmptyPoolCreates)
+{
+    unsigned int name = 0;
+
+    EXPECT_FALSE (pool.take (key (Texture2D, 10, 10), name));
+    EXPECT_EQ (1u, pool.created ());
+    EXPECT_EQ (0u, pool.reused ());
+}
+
+TEST_F (OpenGLTexturePoolTest, ReusesOtherSizes)
+{
+    unsigned int name = 0;
+
+    pool.give (key (Texture2D, 10, 10), 5);
+
+    EXPECT_TRUE (pool.take (key (Texture2D, 11, 10), name));
+    EXPECT_EQ (5u, name);
+    EXPECT_EQ (1u, pool.reused ());
+    EXPECT_EQ (0u, pool.reusedSameSize ());
+    EXPECT_EQ (0u, pool.size ());
+}
+
+TEST_F (OpenGLTexturePoolTest, PrefersSameSize)
+{
+    unsigned int name = 0;
+
+    pool.give (key (Texture2D, 10, 10), 5);
+    pool.give (key (Texture2D, 20, 20), 6);
+
+    EXPECT_TRUE (pool.take (key (Texture2D, 10, 10), name));
+    EXPECT_EQ (5u, name);
+    EXPECT_EQ (1u, pool.reusedSameSize ());
+
+    /* Then the most recently given back */
+    pool.give (key (Texture2D, 30, 30), 7);
+
+    EXPECT_TRUE (pool.take (key (Texture2D, 40, 40), name));
+    EXPECT_EQ (7u, name);
+}
+
+TEST_F (OpenGLTexturePoolTest, TargetAndDepthMustMatch)
+{
+    unsigned int name = 0;
+
+    pool.give (key (Texture2D, 10, 10, 32), 5);
+
+    EXPECT_FALSE (pool.take (key (TextureRectangle, 10, 10, 32), name));
+    EXPECT_FALSE (pool.take (key (Texture2D, 10, 10, 24), name));
+    EXPECT_TRUE (pool.take (key (Texture2D, 10, 10, 32), name));
+}
+
+TEST_F (OpenGLTexturePoolTest, DestroysOldestBeyondCapacity)
+{
+    pool.give (key (Texture2D, 10, 10), 5);
+    pool.give (key (Texture2D, 10, 10), 6);
+    pool.give (key (Texture2D, 10, 10), 7);
+
+    ASSERT_EQ (1u, names.size ());
+    EXPECT_EQ (5u, names[0]);
+    EXPECT_EQ (2u, pool.size ());
+
+    pool.setCapacity (0);
+
+    EXPECT_EQ (3u, names.size ());
+    EXPECT_EQ (0u, pool.size ());
+
+    /* Nothing is kept without capacity */
+    pool.give (key (Texture2D, 10, 10), 8);
+
+    EXPECT_EQ (8u, names.back ());
+    EXPECT_EQ (0u, pool.size ());
+}
+
+TEST_F (OpenGLTexturePoolTest, ClearDestroysEverything)
+{
+    pool.give (key (Texture2D, 10, 10), 5);
+    pool.give (key (TextureRectangle, 10, 10), 6);
+
+    pool.clear ();
+
+    EXPECT_EQ (2u, names.size ());
+    EXPECT_EQ (0u, pool.size ());
+}
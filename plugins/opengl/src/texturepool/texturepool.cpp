@@ -0,0 +1,134 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "texturepool.h"
+
+namespace co = compiz::opengl;
+
+namespace
+{
+bool
+compatible (const co::TexturePool::Key &a, const co::TexturePool::Key &b)
+{
+    return a.target == b.target && a.depth == b.depth;
+}
+
+bool
+sameSize (const co::TexturePool::Key &a, const co::TexturePool::Key &b)
+{
+    return a.width == b.width && a.height == b.height;
+}
+}
+
+co::TexturePool::TexturePool (unsigned int capacity, const Destroy &destroy) :
+    mCapacity (capacity),
+    mDestroy (destroy),
+    mReused (0),
+    mReusedSameSize (0),
+    mCreated (0)
+{
+}
+
+co::TexturePool::~TexturePool ()
+{
+    clear ();
+}
+
+void
+co::TexturePool::setCapacity (unsigned int capacity)
+{
+    mCapacity = capacity;
+    trim ();
+}
+
+bool
+co::TexturePool::take (const Key &key, unsigned int &name)
+{
+    std::list <Entry>::iterator found = mEntries.end ();
+
+    for (std::list <Entry>::iterator it = mEntries.begin ();
+	 it != mEntries.end (); ++it)
+    {
+	if (!compatible (it->key, key))
+	    continue;
+
+	if (sameSize (it->key, key))
+	{
+	    found = it;
+	    ++mReusedSameSize;
+	    break;
+	}
+
+	/* The most recently given back one otherwise */
+	if (found == mEntries.end ())
+	    found = it;
+    }
+
+    if (found == mEntries.end ())
+    {
+	++mCreated;
+	return false;
+    }
+
+    name = found->name;
+    mEntries.erase (found);
+    ++mReused;
+
+    return true;
+}
+
+void
+co::TexturePool::give (const Key &key, unsigned int name)
+{
+    Entry entry;
+
+    entry.key  = key;
+    entry.name = name;
+
+    mEntries.push_front (entry);
+    trim ();
+}
+
+void
+co::TexturePool::clear ()
+{
+    while (!mEntries.empty ())
+    {
+	unsigned int name = mEntries.back ().name;
+
+	mEntries.pop_back ();
+	mDestroy (name);
+    }
+}
+
+void
+co::TexturePool::trim ()
+{
+    while (mEntries.size () > mCapacity)
+    {
+	unsigned int name = mEntries.back ().name;
+
+	mEntries.pop_back ();
+	mDestroy (name);
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_OPENGL_TEXTUREPOOL_H
+#define _COMPIZ_OPENGL_TEXTUREPOOL_H
+
+#include <list>
+
+#include <boost/function.hpp>
+
+namespace compiz {
+namespace opengl {
+
+/**
+ * Keeps the texture objects window pixmaps were bound to once the
+ * pixmap is gone, so that binding the next pixmap of a window being
+ * resized reuses one instead of creating a texture object.
+ *
+ * A texture can only be reused for the same target and depth. One that
+ * last held an image of the same size is preferred, drivers can often
+ * keep its storage as it is. At most capacity textures are kept, those
+ * given back longest ago are destroyed first.
+ */
+class TexturePool
+{
+    public:
+
+	struct Key
+	{
+	    unsigned int target;
+	    int          width;
+	    int          height;
+	    int          depth;
+	};
+
+	typedef boost::function <void (unsigned int)> Destroy;
+
+	/* destroy is called for every name the pool lets go of */
+	TexturePool (unsigned int capacity, const Destroy &destroy);
+	~TexturePool ();
+
+	/* Destroys what doesn't fit anymore, a capacity of 0
+	 * destroys every name as soon as it is given back */
+	void setCapacity (unsigned int capacity);
+	unsigned int capacity () const { return mCapacity; }
+
+	/* Returns false if no name fits key, create one then */
+	bool take (const Key &key, unsigned int &name);
+
+	/* The texture of name is no longer used and holds no image
+	 * of its own, it was last bound to an image fitting key */
+	void give (const Key &key, unsigned int name);
+
+	/* Destroys every name kept */
+	void clear ();
+
+	unsigned int size () const { return mEntries.size (); }
+
+	/* Texture objects take () handed out instead of having one
+	 * created, how many of them last had the same size and how
+	 * many times one had to be created */
+	unsigned long long reused () const { return mReused; }
+	unsigned long long reusedSameSize () const { return mReusedSameSize; }
+	unsigned long long created () const { return mCreated; }
+
+    private:
+
+	struct Entry
+	{
+	    Key          key;
+	    unsigned int name;
+	};
+
+	void trim ();
+
+	/* Most recently given back first */
+	std::list <Entry> mEntries;
+
+	unsigned int mCapacity;
+	Destroy      mDestroy;
+
+	unsigned long long mReused;
+	unsigned long long mReusedSameSize;
+	unsigned long long mCreated;
+};
+
+}
+}
+
+#endif
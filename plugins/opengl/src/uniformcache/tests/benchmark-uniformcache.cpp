@@ -0,0 +1,237 @@
+/*
+ * Compares setting uniforms with a location lookup and an upload per
+ * uniform per draw, as GLProgram::setUniform used to, against the
+ * per program UniformCache. The cache is used both the way the name
+ * overloads use it, interning the name on every call, and the way
+ * the handle overloads do, with names interned once at setup.
+ *
+ * The uniforms are the ones PrivateVertexBuffer::render sets for the
+ * window draws of the blur, decor and scale paths. The location lookup
+ * stands in for glGetUniformLocation with a name keyed map, uploads
+ * are only counted, so the numbers are CPU side only.
+ *
+ * Run compiz_opengl_uniformcache_benchmark [iterations]
+ */
+
+#include "uniformcache.h"
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+using compiz::opengl::UniformCache;
+
+namespace
+{
+
+const int nWindows (40);
+
+double
+now ()
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+class Program :
+    public UniformCache::Locator
+{
+    public:
+
+	Program (const char * const *uniforms)
+	{
+	    for (int i = 0; uniforms[i]; ++i)
+		locations[uniforms[i]] = i;
+	}
+
+	int locate (const char *name)
+	{
+	    std::map <std::string, int>::iterator it = locations.find (name);
+
+	    return it != locations.end () ? it->second : -1;
+	}
+
+	std::map <std::string, int> locations;
+	UniformCache                cache;
+};
+
+struct Uniform
+{
+    const char         *name;
+    UniformCache::Type type;
+    unsigned int       size;
+    /* Whether the value differs from one window to the next */
+    bool               perWindow;
+};
+
+struct Path
+{
+    const char    *name;
+    const char    *program[16];
+    Uniform       uniforms[16];
+};
+
+/* Keeps the optimiser from throwing the work away */
+volatile long sink;
+
+float values[2][16];
+
+/* One draw per window, a lookup and an upload for everything */
+long
+uncached (Program &program, const Path &path)
+{
+    long uploads = 0;
+
+    for (int w = 0; w < nWindows; ++w)
+	for (int u = 0; path.uniforms[u].name; ++u)
+	{
+	    int location = program.locate (path.uniforms[u].name);
+
+	    if (location != -1)
+	    {
+		sink += location;
+		++uploads;
+	    }
+	}
+
+    return uploads;
+}
+
+/* Through the cache, the name interned as given if names is NULL */
+long
+cached (Program                                &program,
+	const Path                             &path,
+	const std::vector <UniformCache::Name> *names)
+{
+    long uploads = 0;
+
+    for (int w = 0; w < nWindows; ++w)
+	for (int u = 0; path.uniforms[u].name; ++u)
+	{
+	    const Uniform      &uniform = path.uniforms[u];
+	    UniformCache::Name name = names ? (*names)[u] :
+				      UniformCache::intern (uniform.name);
+	    int                location = program.cache.location (name, program);
+
+	    if (location == -1)
+		continue;
+
+	    const float *value = values[uniform.perWindow ? w & 1 : 0];
+
+	    if (program.cache.update (name, uniform.type,
+				      value, uniform.size))
+	    {
+		sink += location;
+		++uploads;
+	    }
+	}
+
+    return uploads;
+}
+
+}
+
+int
+main (int argc, char **argv)
+{
+    int iterations = argc > 1 ? atoi (argv[1]) : 10000;
+
+    const unsigned int f1 = sizeof (float);
+    const unsigned int m = 16 * sizeof (float);
+
+    Path paths[] = {
+	{ "blur",
+	  { "projection", "modelview", "paintAttrib", "texture0", "texture1",
+	    "singleColor", "offset0", "offset1", "blurRadius", NULL },
+	  { { "projection",   UniformCache::Matrix, m,      false },
+	    { "modelview",    UniformCache::Matrix, m,      false },
+	    { "singleNormal", UniformCache::Float,  3 * f1, false },
+	    { "singleColor",  UniformCache::Float,  4 * f1, false },
+	    { "texture0",     UniformCache::Int,    f1,     false },
+	    { "texture1",     UniformCache::Int,    f1,     false },
+	    { "offset0",      UniformCache::Float,  4 * f1, true },
+	    { "offset1",      UniformCache::Float,  4 * f1, true },
+	    { "blurRadius",   UniformCache::Float,  f1,     false },
+	    { "paintAttrib",  UniformCache::Float,  3 * f1, true },
+	    { NULL,           UniformCache::Float,  0,      false } } },
+	{ "decor",
+	  { "projection", "modelview", "paintAttrib", "texture0",
+	    "singleColor", NULL },
+	  { { "projection",   UniformCache::Matrix, m,      false },
+	    { "modelview",    UniformCache::Matrix, m,      false },
+	    { "singleNormal", UniformCache::Float,  3 * f1, false },
+	    { "singleColor",  UniformCache::Float,  4 * f1, false },
+	    { "texture0",     UniformCache::Int,    f1,     false },
+	    { "paintAttrib",  UniformCache::Float,  3 * f1, true },
+	    { NULL,           UniformCache::Float,  0,      false } } },
+	{ "scale",
+	  { "projection", "modelview", "paintAttrib", "texture0",
+	    "singleColor", NULL },
+	  { { "projection",   UniformCache::Matrix, m,      false },
+	    { "modelview",    UniformCache::Matrix, m,      true },
+	    { "singleNormal", UniformCache::Float,  3 * f1, false },
+	    { "singleColor",  UniformCache::Float,  4 * f1, false },
+	    { "texture0",     UniformCache::Int,    f1,     false },
+	    { "paintAttrib",  UniformCache::Float,  3 * f1, true },
+	    { NULL,           UniformCache::Float,  0,      false } } }
+    };
+
+    for (int i = 0; i < 16; ++i)
+    {
+	values[0][i] = i;
+	values[1][i] = i + 0.5f;
+    }
+
+    printf ("%d windows, %d iterations\n", nWindows, iterations);
+    printf ("%-8s %12s %12s %8s %12s %8s %14s %14s\n", "path", "uncached",
+	    "by name", "speedup", "by handle", "speedup",
+	    "uploads/frame", "cached/frame");
+
+    for (unsigned int p = 0; p < sizeof (paths) / sizeof (paths[0]); ++p)
+    {
+	const Path                       &path = paths[p];
+	Program                          plain (path.program);
+	Program                          withNames (path.program);
+	Program                          withHandles (path.program);
+	std::vector <UniformCache::Name> names;
+
+	for (int u = 0; path.uniforms[u].name; ++u)
+	    names.push_back (UniformCache::intern (path.uniforms[u].name));
+
+	long   plainUploads = 0;
+	double start = now ();
+
+	for (int n = 0; n < iterations; ++n)
+	    plainUploads += uncached (plain, path);
+
+	double plainTime = now () - start;
+	long   cachedUploads = 0;
+
+	start = now ();
+
+	for (int n = 0; n < iterations; ++n)
+	    cachedUploads += cached (withNames, path, NULL);
+
+	double namesTime = now () - start;
+
+	start = now ();
+
+	for (int n = 0; n < iterations; ++n)
+	    cached (withHandles, path, &names);
+
+	double handlesTime = now () - start;
+
+	printf ("%-8s %9.2f ms %9.2f ms %7.2fx %9.2f ms %7.2fx %14.1f %14.1f\n",
+		path.name, plainTime, namesTime, plainTime / namesTime,
+		handlesTime, plainTime / handlesTime,
+		(double) plainUploads / iterations,
+		(double) cachedUploads / iterations);
+    }
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <map>
+#include <string>
+
+#include "uniformcache.h"
+
+using compiz::opengl::UniformCache;
+
+namespace
+{
+/* Hands out locations from a fixed table and counts the lookups */
+class FakeLocator :
+    public UniformCache::Locator
+{
+    public:
+
+	FakeLocator () :
+	    lookups (0)
+	{
+	    locations["projection"] = 0;
+	    locations["modelview"]  = 1;
+	    locations["paintAttrib"] = 4;
+	}
+
+	int locate (const char *name)
+	{
+	    ++lookups;
+
+	    std::map <std::string, int>::iterator it = locations.find (name);
+
+	    return it != locations.end () ? it->second : -1;
+	}
+
+	std::map <std::string, int> locations;
+	unsigned int                lookups;
+};
+}
+
+class OpenGLUniformCacheTest :
+    public ::testing::Test
+{
+    protected:
+
+	UniformCache cache;
+	FakeLocator  locator;
+};
+
+TEST_F (OpenGLUniformCacheTest, InternedNamesAreShared)
+{
+    UniformCache::Name a = UniformCache::intern ("modelview");
+    UniformCache::Name b = UniformCache::intern ("projection");
+
+    EXPECT_NE (a, b);
+    EXPECT_EQ (a, UniformCache::intern ("modelview"));
+    EXPECT_STREQ ("modelview", UniformCache::name (a));
+    EXPECT_STREQ ("projection", UniformCache::name (b));
+}
+
+TEST_F (OpenGLUniformCacheTest, ReusedBufferGivesTheNameItHoldsNow)
+{
+    char buffer[16];
+
+    strcpy (buffer, "offset0");
+    UniformCache::Name a = UniformCache::intern (buffer);
+
+    strcpy (buffer, "offset1");
+    UniformCache::Name b = UniformCache::intern (buffer);
+
+    EXPECT_NE (a, b);
+    EXPECT_STREQ ("offset0", UniformCache::name (a));
+    EXPECT_STREQ ("offset1", UniformCache::name (b));
+    EXPECT_EQ (a, UniformCache::intern ("offset0"));
+}
+
+TEST_F (OpenGLUniformCacheTest, LocationIsLookedUpOnce)
+{
+    UniformCache::Name n = UniformCache::intern ("paintAttrib");
+
+    EXPECT_EQ (4, cache.location (n, locator));
+    EXPECT_EQ (4, cache.location (n, locator));
+    EXPECT_EQ (1u, locator.lookups);
+}
+
+TEST_F (OpenGLUniformCacheTest, MissingLocationIsRemembered)
+{
+    UniformCache::Name n = UniformCache::intern ("singleNormal");
+
+    EXPECT_EQ (-1, cache.location (n, locator));
+    EXPECT_EQ (-1, cache.location (n, locator));
+    EXPECT_EQ (1u, locator.lookups);
+}
+
+TEST_F (OpenGLUniformCacheTest, UnchangedValuesAreSkipped)
+{
+    UniformCache::Name n = UniformCache::intern ("paintAttrib");
+    float              v[3] = { 1.0f, 1.0f, 1.0f };
+
+    EXPECT_TRUE (cache.update (n, UniformCache::Float, v, sizeof (v)));
+    EXPECT_FALSE (cache.update (n, UniformCache::Float, v, sizeof (v)));
+
+    v[0] = 0.5f;
+
+    EXPECT_TRUE (cache.update (n, UniformCache::Float, v, sizeof (v)));
+    EXPECT_EQ (2u, cache.uploads ());
+    EXPECT_EQ (1u, cache.skipped ());
+}
+
+TEST_F (OpenGLUniformCacheTest, TypeAndSizeAreCompared)
+{
+    UniformCache::Name n = UniformCache::intern ("texture0");
+    int                i = 0;
+    float              f = 0.0f;
+    float              v[2] = { 0.0f, 0.0f };
+
+    EXPECT_TRUE (cache.update (n, UniformCache::Int, &i, sizeof (i)));
+    EXPECT_TRUE (cache.update (n, UniformCache::Float, &f, sizeof (f)));
+    EXPECT_TRUE (cache.update (n, UniformCache::Float, v, sizeof (v)));
+    EXPECT_FALSE (cache.update (n, UniformCache::Float, v, sizeof (v)));
+}
+
+TEST_F (OpenGLUniformCacheTest, CachesAreIndependent)
+{
+    UniformCache       other;
+    UniformCache::Name n = UniformCache::intern ("modelview");
+    float              m[16] = { 1.0f };
+
+    EXPECT_TRUE (cache.update (n, UniformCache::Matrix, m, sizeof (m)));
+    EXPECT_TRUE (other.update (n, UniformCache::Matrix, m, sizeof (m)));
+    EXPECT_FALSE (cache.update (n, UniformCache::Matrix, m, sizeof (m)));
+}
+
+TEST_F (OpenGLUniformCacheTest, ClearForgetsEverything)
+{
+    UniformCache::Name n = UniformCache::intern ("modelview");
+    float              f = 1.0f;
+
+    cache.location (n, locator);
+    cache.update (n, UniformCache::Float, &f, sizeof (f));
+    cache.clear ();
+
+    EXPECT_EQ (1, cache.location (n, locator));
+    EXPECT_EQ (2u, locator.lookups);
+    EXPECT_TRUE (cache.update (n, UniformCache::Float, &f, sizeof (f)));
+}
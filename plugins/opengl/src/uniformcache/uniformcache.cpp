@@ -0,0 +1,196 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <cstring>
+#include <deque>
+#include <map>
+#include <string>
+
+#include "uniformcache.h"
+
+namespace co = compiz::opengl;
+
+namespace
+{
+struct Less
+{
+    bool operator () (const char *a, const char *b) const
+    {
+	return strcmp (a, b) < 0;
+    }
+};
+
+/* Keyed on the stored copies, so looking a name up doesn't have to
+ * copy it. A deque keeps them in place as more are added */
+struct Names
+{
+    Names ()
+    {
+	memset (recent, 0, sizeof (recent));
+    }
+
+    std::map <const char *, co::UniformCache::Name, Less> ids;
+    std::deque <std::string>                                names;
+
+    /* Names are mostly passed as the same literal every time, so
+     * remember which pointer gave which name. The string is still
+     * compared, the pointer may since point to something else */
+    struct Recent
+    {
+	const char             *pointer;
+	co::UniformCache::Name name;
+    };
+
+    static const unsigned int nRecent = 64;
+
+    Recent recent[nRecent];
+};
+
+/* Built on first use, handles may be interned during static
+ * initialisation */
+Names &
+names ()
+{
+    static Names n;
+    return n;
+}
+}
+
+co::UniformCache::Name
+co::UniformCache::intern (const char *name)
+{
+    Names        &n = names ();
+    unsigned int slot = ((size_t) name ^ ((size_t) name >> 7)) % Names::nRecent;
+
+    Names::Recent &recent = n.recent[slot];
+
+    if (recent.pointer == name &&
+	strcmp (n.names[recent.name].c_str (), name) == 0)
+	return recent.name;
+
+    std::map <const char *, Name, Less>::iterator it = n.ids.find (name);
+    Name                                          id;
+
+    if (it != n.ids.end ())
+	id = it->second;
+    else
+    {
+	id = n.names.size ();
+
+	n.names.push_back (name);
+	n.ids[n.names.back ().c_str ()] = id;
+    }
+
+    recent.pointer = name;
+    recent.name    = id;
+
+    return id;
+}
+
+const char *
+co::UniformCache::name (Name name)
+{
+    Names &n = names ();
+
+    if (name >= n.names.size ())
+	return NULL;
+
+    return n.names[name].c_str ();
+}
+
+co::UniformCache::UniformCache () :
+    mUploads (0),
+    mSkipped (0)
+{
+}
+
+co::UniformCache::Slot &
+co::UniformCache::slot (Name name)
+{
+    if (name >= mSlots.size ())
+    {
+	Slot empty;
+
+	empty.location = -1;
+	empty.located  = false;
+	empty.set      = false;
+	empty.type     = Float;
+	empty.size     = 0;
+
+	mSlots.resize (name + 1, empty);
+    }
+
+    return mSlots[name];
+}
+
+int
+co::UniformCache::location (Name name, Locator &locator)
+{
+    Slot &s = slot (name);
+
+    if (!s.located)
+    {
+	s.location = locator.locate (UniformCache::name (name));
+	s.located  = true;
+    }
+
+    return s.location;
+}
+
+bool
+co::UniformCache::update (Name         name,
+			  Type         type,
+			  const void   *value,
+			  unsigned int size)
+{
+    Slot &s = slot (name);
+
+    if (size > MaxSize)
+    {
+	s.set = false;
+	++mUploads;
+	return true;
+    }
+
+    if (s.set && s.type == type && s.size == size &&
+	!memcmp (s.value, value, size))
+    {
+	++mSkipped;
+	return false;
+    }
+
+    s.set  = true;
+    s.type = type;
+    s.size = size;
+    memcpy (s.value, value, size);
+
+    ++mUploads;
+
+    return true;
+}
+
+void
+co::UniformCache::clear ()
+{
+    mSlots.clear ();
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_OPENGL_UNIFORMCACHE_H
+#define _COMPIZ_OPENGL_UNIFORMCACHE_H
+
+#include <vector>
+
+namespace compiz {
+namespace opengl {
+
+/**
+ * Remembers, for one program, where each uniform lives and the value
+ * it was last given.
+ *
+ * Uniform names are turned into small numbers once with intern (),
+ * the same name gives the same number for every program. Interning
+ * a name already seen doesn't allocate. A program
+ * looks a location up the first time a name is used with it and
+ * never again, and a value is only uploaded when it differs from the
+ * one the program already holds.
+ */
+class UniformCache
+{
+    public:
+
+	typedef unsigned int Name;
+
+	/* Values are told apart by type as well as by their bytes */
+	enum Type
+	{
+	    Float,
+	    Int,
+	    Matrix
+	};
+
+	/* Big enough for a 4x4 matrix */
+	static const unsigned int MaxSize = 16 * sizeof (float);
+
+	class Locator
+	{
+	    public:
+
+		virtual ~Locator () {}
+
+		/* The location of name in the program, -1 if it has none */
+		virtual int locate (const char *name) = 0;
+	};
+
+	static Name intern (const char *name);
+	static const char * name (Name name);
+
+	UniformCache ();
+
+	/* The location of the uniform, asking locator only the first
+	 * time the name is used with this program */
+	int location (Name name, Locator &locator);
+
+	/* Whether value differs from what the uniform was last given,
+	 * value is remembered as the uniform's value if so */
+	bool update (Name         name,
+		     Type         type,
+		     const void   *value,
+		     unsigned int size);
+
+	/* Forgets every location and value */
+	void clear ();
+
+	/* Values uploaded and values found unchanged */
+	unsigned long long uploads () const { return mUploads; }
+	unsigned long long skipped () const { return mSkipped; }
+
+    private:
+
+	struct Slot
+	{
+	    int           location;
+	    bool          located;
+	    bool          set;
+	    Type          type;
+	    unsigned int  size;
+	    unsigned char value[MaxSize];
+	};
+
+	Slot & slot (Name name);
+
+	std::vector <Slot> mSlots;
+
+	unsigned long long mUploads;
+	unsigned long long mSkipped;
+};
+
+}
+}
+
+#endif
@@ -27,6 +27,7 @@
 
 #include <vector>
 #include <iostream>
+#include <cstring>
 
 #ifdef USE_GLES
 #include <GLES2/gl2.h>
@@ -41,6 +42,182 @@
 
 GLVertexBuffer *PrivateVertexBuffer::streamingBuffer = NULL;
 
+compiz::opengl::StreamRing *PrivateVertexBuffer::streamRing = NULL;
+
+unsigned long long PrivateVertexBuffer::uploaded = 0;
+unsigned long long PrivateVertexBuffer::lastUploaded = 0;
+unsigned int       PrivateVertexBuffer::allocations = 0;
+unsigned int       PrivateVertexBuffer::lastAllocations = 0;
+
+compiz::opengl::DrawBatch                PrivateVertexBuffer::drawBatch;
+std::vector<PrivateVertexBuffer::HeldDraw> PrivateVertexBuffer::heldDraws;
+GLMatrix                                 PrivateVertexBuffer::heldProjection;
+GLMatrix                                 PrivateVertexBuffer::heldModelview;
+GLVertexBuffer                           *PrivateVertexBuffer::heldBuffer = NULL;
+bool                                     PrivateVertexBuffer::submitting = false;
+PrivateVertexBuffer                      *PrivateVertexBuffer::checked = NULL;
+
+namespace
+{
+/* One buffer object, orphaned whenever the ring needs new storage */
+class StreamStorage :
+    public compiz::opengl::StreamRing::Storage
+{
+    public:
+
+	typedef compiz::opengl::StreamRing::Fence Fence;
+
+	StreamStorage () :
+	    mBuffer (0)
+	{
+	    GL::genBuffers (1, &mBuffer);
+	}
+
+	~StreamStorage ()
+	{
+	    GL::deleteBuffers (1, &mBuffer);
+	}
+
+	GLuint buffer () const
+	{
+	    return mBuffer;
+	}
+
+	void allocate (size_t size)
+	{
+	    GL::bindBuffer (GL::ARRAY_BUFFER, mBuffer);
+	    GL::bufferData (GL::ARRAY_BUFFER, size, NULL, GL::STREAM_DRAW);
+	    GL::bindBuffer (GL::ARRAY_BUFFER, 0);
+	}
+
+	void upload (size_t offset, const void *data, size_t size)
+	{
+	    GL::bindBuffer (GL::ARRAY_BUFFER, mBuffer);
+	    GL::bufferSubData (GL::ARRAY_BUFFER, offset, size, data);
+	    GL::bindBuffer (GL::ARRAY_BUFFER, 0);
+	}
+
+	/* Without fences no space is ever known to be free, the
+	 * storage is orphaned every time the ring is full */
+	Fence fence ()
+	{
+	    if (!GL::sync)
+		return NULL;
+
+	    return GL::fenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	bool signalled (Fence fence)
+	{
+	    if (!fence)
+		return false;
+
+	    GLenum status = GL::clientWaitSync (static_cast <GLsync> (fence),
+						0, 0);
+
+	    return status == GL_ALREADY_SIGNALED ||
+		   status == GL_CONDITION_SATISFIED;
+	}
+
+	void release (Fence fence)
+	{
+	    if (fence)
+		GL::deleteSync (static_cast <GLsync> (fence));
+	}
+
+    private:
+
+	GLuint mBuffer;
+};
+
+StreamStorage *streamStorage = NULL;
+
+/* The uniforms every draw sets */
+const GLProgram::UniformHandle projectionUniform ("projection");
+const GLProgram::UniformHandle modelviewUniform ("modelview");
+const GLProgram::UniformHandle singleNormalUniform ("singleNormal");
+const GLProgram::UniformHandle singleColorUniform ("singleColor");
+const GLProgram::UniformHandle paintAttribUniform ("paintAttrib");
+const GLProgram::UniformHandle textureUniforms[] =
+{
+    GLProgram::UniformHandle ("texture0"),
+    GLProgram::UniformHandle ("texture1"),
+    GLProgram::UniformHandle ("texture2"),
+    GLProgram::UniformHandle ("texture3")
+};
+
+/* Draws using different state held at the same time, each is
+ * submitted with a draw call of its own */
+const unsigned int maxHeldStates = 16;
+
+bool
+sameMatrix (const GLMatrix &a, const GLMatrix &b)
+{
+    return !memcmp (a.getMatrix (), b.getMatrix (), sizeof (float) * 16);
+}
+
+bool
+sameState (const PrivateVertexBuffer::HeldDraw &a,
+	   const PrivateVertexBuffer::HeldDraw &b)
+{
+    return a.texture     == b.texture     &&
+	   a.filter      == b.filter      &&
+	   a.opacity     == b.opacity     &&
+	   a.brightness  == b.brightness  &&
+	   a.saturation  == b.saturation  &&
+	   a.blend       == b.blend       &&
+	   a.autoProgram == b.autoProgram &&
+	   !memcmp (a.color, b.color, sizeof (a.color));
+}
+
+/* What submitting held draws changes, put back for a draw that had
+ * been set up before they were submitted */
+class DrawSetup
+{
+    public:
+
+	DrawSetup ()
+	{
+	    /* Nothing the cache remembers holds afterwards */
+	    glStateCache ().invalidate ();
+
+	    blend = glIsEnabled (GL_BLEND);
+	    glGetIntegerv (GL_ACTIVE_TEXTURE, &unit);
+	    GL::activeTexture (GL_TEXTURE0);
+	    glGetIntegerv (GL_TEXTURE_BINDING_2D, &texture2D);
+	    #ifndef USE_GLES
+	    glGetIntegerv (GL_TEXTURE_BINDING_RECTANGLE_ARB, &textureRect);
+	    #endif
+	}
+
+	~DrawSetup ()
+	{
+	    glStateCache ().invalidate ();
+
+	    if (blend)
+		glEnable (GL_BLEND);
+	    else
+		glDisable (GL_BLEND);
+
+	    GL::activeTexture (GL_TEXTURE0);
+	    glBindTexture (GL_TEXTURE_2D, texture2D);
+	    #ifndef USE_GLES
+	    glBindTexture (GL_TEXTURE_RECTANGLE_ARB, textureRect);
+	    #endif
+	    GL::activeTexture (unit);
+	}
+
+    private:
+
+	GLboolean blend;
+	GLint     unit;
+	GLint     texture2D;
+	#ifndef USE_GLES
+	GLint     textureRect;
+	#endif
+};
+}
+
 bool GLVertexBuffer::enabled ()
 {
     // FIXME: GL::shaders shouldn't be a requirement here. But for now,
@@ -109,19 +286,6 @@ bool GLVertexBuffer::end ()
     if (!enabled ())
 	return true;
 
-    GL::bindBuffer (GL_ARRAY_BUFFER, priv->vertexBuffer);
-    GL::bufferData (GL_ARRAY_BUFFER,
-                    sizeof(GLfloat) * priv->vertexData.size (),
-                    &priv->vertexData[0], priv->usage);
-
-    if (priv->normalData.size ())
-    {
-	GL::bindBuffer (GL_ARRAY_BUFFER, priv->normalBuffer);
-	GL::bufferData (GL_ARRAY_BUFFER,
-	                sizeof(GLfloat) * priv->normalData.size (),
-	                &priv->normalData[0], priv->usage);
-    }
-
     if (!priv->colorData.size ())
     {
 	priv->colorData.resize (4);
@@ -131,27 +295,45 @@ bool GLVertexBuffer::end ()
 	priv->colorData[3] = priv->color[3];
     }
 
-    if (priv->colorData.size ())
+    priv->upload ();
+
+    return true;
+}
+
+bool GLVertexBuffer::restart ()
+{
+    if (priv->vertexData.empty ())
+	return false;
+
+    priv->vertexOffset = 0;
+    priv->maxVertices = -1;
+    for (std::vector<AbstractUniform*>::iterator it = priv->uniforms.begin();
+	 it != priv->uniforms.end();
+	 ++it)
     {
-	GL::bindBuffer (GL_ARRAY_BUFFER, priv->colorBuffer);
-	GL::bufferData (GL_ARRAY_BUFFER,
-	                sizeof(GLfloat) * priv->colorData.size (),
-	                &priv->colorData[0], priv->usage);
+	delete *it;
     }
+    priv->uniforms.clear ();
 
-    for (GLuint i = 0; i < priv->nTextures; i++)
+    // a single color is set as a uniform, pick up the current one
+    if (priv->colorData.size () == 4)
     {
-	GL::bindBuffer (GL_ARRAY_BUFFER, priv->textureBuffers[i]);
-	GL::bufferData (GL_ARRAY_BUFFER,
-	                sizeof(GLfloat) * priv->textureData[i].size (),
-	                &priv->textureData[i][0], priv->usage);
+	priv->colorData[0] = priv->color[0];
+	priv->colorData[1] = priv->color[1];
+	priv->colorData[2] = priv->color[2];
+	priv->colorData[3] = priv->color[3];
     }
 
-    GL::bindBuffer (GL_ARRAY_BUFFER, 0);
-
     return true;
 }
 
+void GLVertexBuffer::frameStatistics (unsigned long long &bytesUploaded,
+                                      unsigned int       &allocations)
+{
+    bytesUploaded = PrivateVertexBuffer::lastUploaded;
+    allocations   = PrivateVertexBuffer::lastAllocations;
+}
+
 void GLVertexBuffer::addVertices (GLuint nVertices, const GLfloat *vertices)
 {
     priv->vertexData.reserve (priv->vertexData.size () + (nVertices * 3));
@@ -242,15 +424,12 @@ void GLVertexBuffer::addTexCoords (GLuint texture,
 
 void GLVertexBuffer::addUniform (const char *name, GLfloat value)
 {
-    // we're casting to double here to make our template va_arg happy
-    Uniform<double, 1>* uniform = new Uniform<double, 1>(name, (double)value);
-    priv->uniforms.push_back (uniform);
+    addUniform (GLProgram::UniformHandle (name), value);
 }
 
 void GLVertexBuffer::addUniform (const char *name, GLint value)
 {
-    Uniform<GLint, 1>* uniform = new Uniform<GLint, 1>(name, value);
-    priv->uniforms.push_back (uniform);
+    addUniform (GLProgram::UniformHandle (name), value);
 }
 
 bool GLVertexBuffer::addUniform (const char *name, const GLMatrix &value)
@@ -263,11 +442,7 @@ void GLVertexBuffer::addUniform2f (const char *name,
                                    GLfloat x,
                                    GLfloat y)
 {
-    // we're casting to double here to make our template va_arg happy
-    Uniform<double, 2>* uniform = new Uniform<double, 2>(name,
-							 (double)x,
-							 (double)y);
-    priv->uniforms.push_back (uniform);
+    addUniform2f (GLProgram::UniformHandle (name), x, y);
 }
 
 void GLVertexBuffer::addUniform3f (const char *name,
@@ -275,12 +450,7 @@ void GLVertexBuffer::addUniform3f (const char *name,
                                    GLfloat y,
                                    GLfloat z)
 {
-     // we're casting to double here to make our template va_arg happy
-    Uniform<double, 3>* uniform = new Uniform<double, 3>(name,
-							 (double)x,
-							 (double)y,
-							 (double)z);
-    priv->uniforms.push_back (uniform);
+    addUniform3f (GLProgram::UniformHandle (name), x, y, z);
 }
 
 void GLVertexBuffer::addUniform4f (const char *name,
@@ -289,21 +459,14 @@ void GLVertexBuffer::addUniform4f (const char *name,
                                    GLfloat z,
                                    GLfloat w)
 {
-    // we're casting to double here to make our template va_arg happy
-    Uniform<double, 4>* uniform = new Uniform<double, 4>(name,
-							 (double)x,
-							 (double)y,
-							 (double)z,
-							 (double)w);
-    priv->uniforms.push_back (uniform);
+    addUniform4f (GLProgram::UniformHandle (name), x, y, z, w);
 }
 
 void GLVertexBuffer::addUniform2i (const char *name,
                                    GLint x,
                                    GLint y)
 {
-    Uniform<GLint, 2>* uniform = new Uniform<GLint, 2>(name, x, y);
-    priv->uniforms.push_back (uniform);
+    addUniform2i (GLProgram::UniformHandle (name), x, y);
 }
 
 void GLVertexBuffer::addUniform3i (const char *name,
@@ -311,8 +474,7 @@ void GLVertexBuffer::addUniform3i (const char *name,
                                    GLint y,
                                    GLint z)
 {
-    Uniform<GLint, 3>* uniform = new Uniform<GLint, 3>(name, x, y, z);
-    priv->uniforms.push_back (uniform);
+    addUniform3i (GLProgram::UniformHandle (name), x, y, z);
 }
 
 void GLVertexBuffer::addUniform4i (const char *name,
@@ -321,8 +483,73 @@ void GLVertexBuffer::addUniform4i (const char *name,
                                    GLint z,
                                    GLint w)
 {
-    Uniform<GLint, 4>* uniform = new Uniform<GLint, 4>(name, x, y, z, w);
-    priv->uniforms.push_back (uniform);
+    addUniform4i (GLProgram::UniformHandle (name), x, y, z, w);
+}
+
+void GLVertexBuffer::addUniform (const GLProgram::UniformHandle &uniform,
+                                 GLfloat                        value)
+{
+    priv->uniforms.push_back (new Uniform<GLfloat, 1> (uniform, &value));
+}
+
+void GLVertexBuffer::addUniform (const GLProgram::UniformHandle &uniform,
+                                 GLint                          value)
+{
+    priv->uniforms.push_back (new Uniform<GLint, 1> (uniform, &value));
+}
+
+void GLVertexBuffer::addUniform2f (const GLProgram::UniformHandle &uniform,
+                                   GLfloat x,
+                                   GLfloat y)
+{
+    GLfloat v[2] = { x, y };
+    priv->uniforms.push_back (new Uniform<GLfloat, 2> (uniform, v));
+}
+
+void GLVertexBuffer::addUniform3f (const GLProgram::UniformHandle &uniform,
+                                   GLfloat x,
+                                   GLfloat y,
+                                   GLfloat z)
+{
+    GLfloat v[3] = { x, y, z };
+    priv->uniforms.push_back (new Uniform<GLfloat, 3> (uniform, v));
+}
+
+void GLVertexBuffer::addUniform4f (const GLProgram::UniformHandle &uniform,
+                                   GLfloat x,
+                                   GLfloat y,
+                                   GLfloat z,
+                                   GLfloat w)
+{
+    GLfloat v[4] = { x, y, z, w };
+    priv->uniforms.push_back (new Uniform<GLfloat, 4> (uniform, v));
+}
+
+void GLVertexBuffer::addUniform2i (const GLProgram::UniformHandle &uniform,
+                                   GLint x,
+                                   GLint y)
+{
+    GLint v[2] = { x, y };
+    priv->uniforms.push_back (new Uniform<GLint, 2> (uniform, v));
+}
+
+void GLVertexBuffer::addUniform3i (const GLProgram::UniformHandle &uniform,
+                                   GLint x,
+                                   GLint y,
+                                   GLint z)
+{
+    GLint v[3] = { x, y, z };
+    priv->uniforms.push_back (new Uniform<GLint, 3> (uniform, v));
+}
+
+void GLVertexBuffer::addUniform4i (const GLProgram::UniformHandle &uniform,
+                                   GLint x,
+                                   GLint y,
+                                   GLint z,
+                                   GLint w)
+{
+    GLint v[4] = { x, y, z, w };
+    priv->uniforms.push_back (new Uniform<GLint, 4> (uniform, v));
 }
 
 void GLVertexBuffer::setProgram (GLProgram *program)
@@ -396,6 +623,12 @@ PrivateVertexBuffer::PrivateVertexBuffer () :
     program (NULL),
     autoProgram (0)
 {
+    Source none = { 0, 0 };
+
+    vertexSource = normalSource = colorSource = none;
+    for (int i = 0; i < MAX_TEXTURES; ++i)
+	textureSources[i] = none;
+
     if (!GL::genBuffers)
 	return;
 
@@ -405,6 +638,138 @@ PrivateVertexBuffer::PrivateVertexBuffer () :
     GL::genBuffers (4, &textureBuffers[0]);
 }
 
+void PrivateVertexBuffer::frameDone ()
+{
+    if (streamRing)
+	streamRing->frameDone ();
+
+    drawBatch.frameDone ();
+
+    lastUploaded    = uploaded;
+    lastAllocations = allocations;
+    uploaded        = 0;
+    allocations     = 0;
+}
+
+void PrivateVertexBuffer::destroyStreamRing ()
+{
+    /* Streams into the ring */
+    delete heldBuffer;
+    heldBuffer = NULL;
+
+    for (unsigned int i = 0; i < heldDraws.size (); ++i)
+	GLTexture::decRef (heldDraws[i].texture);
+
+    heldDraws.clear ();
+    drawBatch.clear ();
+
+    delete streamRing;
+    delete streamStorage;
+
+    streamRing    = NULL;
+    streamStorage = NULL;
+}
+
+void PrivateVertexBuffer::upload ()
+{
+    Source                     *sources[3 + MAX_TEXTURES];
+    GLuint                     buffers[3 + MAX_TEXTURES];
+    const std::vector<GLfloat> *arrays[3 + MAX_TEXTURES];
+    unsigned int               n = 0;
+
+    sources[n] = &vertexSource;
+    buffers[n] = vertexBuffer;
+    arrays[n++] = &vertexData;
+
+    if (normalData.size ())
+    {
+	sources[n] = &normalSource;
+	buffers[n] = normalBuffer;
+	arrays[n++] = &normalData;
+    }
+
+    sources[n] = &colorSource;
+    buffers[n] = colorBuffer;
+    arrays[n++] = &colorData;
+
+    for (GLuint i = 0; i < nTextures; i++)
+    {
+	sources[n] = &textureSources[i];
+	buffers[n] = textureBuffers[i];
+	arrays[n++] = &textureData[i];
+    }
+
+    if (usage != GL::STREAM_DRAW || !GL::bufferSubData)
+    {
+	for (unsigned int i = 0; i < n; i++)
+	    upload (*sources[i], buffers[i], *arrays[i]);
+
+	return;
+    }
+
+    /* Streamed arrays are appended to the shared ring, the draw
+     * only needs to know where. They are reserved in one piece, so
+     * new storage for a later array can't take the earlier ones */
+    typedef compiz::opengl::StreamRing StreamRing;
+
+    if (!streamRing)
+    {
+	streamStorage = new StreamStorage ();
+	streamRing    = new StreamRing (streamStorage);
+    }
+
+    size_t total = 0;
+
+    for (unsigned int i = 0; i < n; i++)
+	total += StreamRing::aligned (sizeof (GLfloat) * arrays[i]->size ());
+
+    unsigned int before = streamRing->allocations ();
+    size_t       offset = streamRing->reserve (total);
+
+    for (unsigned int i = 0; i < n; i++)
+    {
+	size_t size = sizeof (GLfloat) * arrays[i]->size ();
+
+	streamRing->upload (offset, &(*arrays[i])[0], size);
+
+	sources[i]->buffer = streamStorage->buffer ();
+	sources[i]->offset = offset;
+
+	offset   += StreamRing::aligned (size);
+	uploaded += size;
+    }
+
+    allocations += streamRing->allocations () - before;
+}
+
+void PrivateVertexBuffer::upload (Source                     &source,
+                                  GLuint                     buffer,
+                                  const std::vector<GLfloat> &data)
+{
+    size_t size = sizeof (GLfloat) * data.size ();
+
+    GL::bindBuffer (GL::ARRAY_BUFFER, buffer);
+    GL::bufferData (GL::ARRAY_BUFFER, size, &data[0], usage);
+    GL::bindBuffer (GL::ARRAY_BUFFER, 0);
+
+    source.buffer = buffer;
+    source.offset = 0;
+
+    ++allocations;
+    uploaded += size;
+}
+
+void PrivateVertexBuffer::bindAttribute (GLint        index,
+                                         GLint        size,
+                                         const Source &source)
+{
+    (*GL::enableVertexAttribArray) (index);
+    (*GL::bindBuffer) (GL::ARRAY_BUFFER, source.buffer);
+    (*GL::vertexAttribPointer) (index, size, GL_FLOAT, GL_FALSE, 0,
+				reinterpret_cast <const GLvoid *> (source.offset));
+    (*GL::bindBuffer) (GL::ARRAY_BUFFER, 0);
+}
+
 PrivateVertexBuffer::~PrivateVertexBuffer ()
 {
     if (!GL::deleteBuffers)
@@ -426,6 +791,173 @@ PrivateVertexBuffer::~PrivateVertexBuffer ()
     }
 }
 
+bool PrivateVertexBuffer::hold (GLVertexBuffer            *buffer,
+                                GLTexture                 *texture,
+                                GLTexture::Filter         filter,
+                                const GLMatrix            &projection,
+                                const GLMatrix            &modelview,
+                                const GLWindowPaintAttrib &attrib,
+                                bool                      blend)
+{
+    PrivateVertexBuffer            *priv = buffer->priv;
+    compiz::opengl::DrawBatch::Box box;
+
+    if (!GLVertexBuffer::enabled () || submitting)
+	return false;
+
+    /* Anything the automatic program doesn't draw the same way for
+     * every held draw */
+    if (priv->program || !priv->autoProgram || !priv->uniforms.empty () ||
+	!priv->normalData.empty () || priv->colorData.size () != 4 ||
+	priv->nTextures != 1 || priv->primitiveType != GL_TRIANGLES ||
+	priv->vertexOffset || priv->maxVertices > 0)
+	return false;
+
+    unsigned int count = priv->vertexData.size () / 3;
+
+    if (priv->textureData[0].size () != count * 2 ||
+	!compiz::opengl::DrawBatch::bounds (&priv->vertexData[0], count, box))
+	return false;
+
+    HeldDraw held;
+
+    held.texture     = texture;
+    held.filter      = filter;
+    held.opacity     = attrib.opacity;
+    held.brightness  = attrib.brightness;
+    held.saturation  = attrib.saturation;
+    held.blend       = blend;
+    held.autoProgram = priv->autoProgram;
+    memcpy (held.color, &priv->colorData[0], sizeof (held.color));
+
+    if (!heldDraws.empty () &&
+	(!sameMatrix (projection, heldProjection) ||
+	 !sameMatrix (modelview, heldModelview)))
+	submitHeld ();
+
+    unsigned int key = 0;
+
+    while (key < heldDraws.size () && !sameState (heldDraws[key], held))
+	++key;
+
+    if (key == maxHeldStates)
+	submitHeld ();
+
+    if (heldDraws.empty ())
+    {
+	heldProjection = projection;
+	heldModelview  = modelview;
+	key            = 0;
+    }
+
+    /* Can't be moved ahead of a draw held with other state */
+    if (!drawBatch.add (key, &priv->vertexData[0],
+			&priv->textureData[0][0], count, box))
+    {
+	submitHeld ();
+
+	heldProjection = projection;
+	heldModelview  = modelview;
+	key            = 0;
+
+	drawBatch.add (key, &priv->vertexData[0],
+		       &priv->textureData[0][0], count, box);
+    }
+
+    if (key == heldDraws.size ())
+    {
+	GLTexture::incRef (texture);
+	heldDraws.push_back (held);
+    }
+
+    return true;
+}
+
+bool PrivateVertexBuffer::coversHeld (const GLMatrix *projection,
+                                      const GLMatrix *modelview) const
+{
+    compiz::opengl::DrawBatch::Box box;
+
+    if (drawBatch.empty () || submitting || vertexData.empty ())
+	return false;
+
+    /* Boxes drawn with other matrices can't be compared */
+    if (!projection || !modelview ||
+	!sameMatrix (*projection, heldProjection) ||
+	!sameMatrix (*modelview, heldModelview))
+	return true;
+
+    if (!compiz::opengl::DrawBatch::bounds (&vertexData[0],
+					    vertexData.size () / 3, box))
+	return true;
+
+    return drawBatch.overlaps (box);
+}
+
+void PrivateVertexBuffer::submitHeldUnder (GLVertexBuffer *buffer,
+                                           const GLMatrix *projection,
+                                           const GLMatrix *modelview)
+{
+    PrivateVertexBuffer *priv = buffer->priv;
+
+    if (priv->coversHeld (projection, modelview))
+	submitHeld ();
+
+    checked = priv;
+}
+
+void PrivateVertexBuffer::submitHeld ()
+{
+    if (drawBatch.empty () || submitting)
+	return;
+
+    if (!heldBuffer)
+	heldBuffer = new GLVertexBuffer (GL::STREAM_DRAW);
+
+    submitting = true;
+
+    for (unsigned int i = 0; i < drawBatch.spans (); ++i)
+    {
+	const HeldDraw            &held = heldDraws[drawBatch.key (i)];
+	const GLWindowPaintAttrib attrib = { held.opacity, held.brightness,
+					     held.saturation, 0, 0, 0, 0 };
+	unsigned int              count = drawBatch.count (i);
+
+	heldBuffer->begin ();
+	heldBuffer->addVertices (count, drawBatch.vertices (i));
+	heldBuffer->addTexCoords (0, count, drawBatch.texCoords (i));
+	heldBuffer->color4f (held.color[0], held.color[1],
+			     held.color[2], held.color[3]);
+	heldBuffer->setAutoProgram (held.autoProgram);
+
+	if (!heldBuffer->end ())
+	    continue;
+
+	if (held.blend)
+	    glStateCache ().enable (GL_BLEND);
+	else
+	    glStateCache ().settle (GL_BLEND);
+
+	glStateCache ().activeTexture (0);
+	held.texture->enable (held.filter);
+
+	heldBuffer->priv->render (&heldProjection, &heldModelview, &attrib);
+
+	held.texture->disable ();
+
+	if (held.blend)
+	    glStateCache ().release (GL_BLEND);
+    }
+
+    for (unsigned int i = 0; i < heldDraws.size (); ++i)
+	GLTexture::decRef (heldDraws[i].texture);
+
+    heldDraws.clear ();
+    drawBatch.submitted ();
+
+    submitting = false;
+}
+
 int PrivateVertexBuffer::render (const GLMatrix            *projection,
                                  const GLMatrix            *modelview,
                                  const GLWindowPaintAttrib *attrib)
@@ -437,6 +969,15 @@ int PrivateVertexBuffer::render (const GLMatrix            *projection,
     GLint texCoordIndex[4] = {-1, -1, -1, -1};
     GLProgram *tmpProgram = program;
 
+    if (checked != this && coversHeld (projection, modelview))
+    {
+	DrawSetup setup;
+
+	submitHeld ();
+    }
+
+    checked = NULL;
+
     // If we don't have an explicitly set program, try to get one
     // using the AutoProgram callback object.
     if (tmpProgram == NULL && autoProgram) {
@@ -470,50 +1011,41 @@ int PrivateVertexBuffer::render (const GLMatrix            *projection,
     }
 
     if (projection)
-	tmpProgram->setUniform ("projection", *projection);
+	tmpProgram->setUniform (projectionUniform, *projection);
 
     if (modelview)
-	tmpProgram->setUniform ("modelview", *modelview);
+	tmpProgram->setUniform (modelviewUniform, *modelview);
 
     positionIndex = tmpProgram->attributeLocation ("position");
-    (*GL::enableVertexAttribArray) (positionIndex);
-    (*GL::bindBuffer) (GL::ARRAY_BUFFER, vertexBuffer);
-    (*GL::vertexAttribPointer) (positionIndex, 3, GL_FLOAT, GL_FALSE, 0, 0);
-    (*GL::bindBuffer) (GL::ARRAY_BUFFER, 0);
+    bindAttribute (positionIndex, 3, vertexSource);
 
     //use default normal
     if (normalData.empty ())
     {
-	tmpProgram->setUniform3f ("singleNormal", 0.0f, 0.0f, -1.0f);
+	tmpProgram->setUniform3f (singleNormalUniform, 0.0f, 0.0f, -1.0f);
     }
     // special case a single normal and apply it to the entire operation
     else if (normalData.size () == 3)
     {
-	tmpProgram->setUniform3f ("singleNormal",
+	tmpProgram->setUniform3f (singleNormalUniform,
 	                       normalData[0], normalData[1], normalData[2]);
     }
     else if (normalData.size () > 3)
     {
 	normalIndex = tmpProgram->attributeLocation ("normal");
-	(*GL::enableVertexAttribArray) (normalIndex);
-	(*GL::bindBuffer) (GL::ARRAY_BUFFER, normalBuffer);
-	(*GL::vertexAttribPointer) (normalIndex, 3, GL_FLOAT, GL_FALSE, 0, 0);
-	(*GL::bindBuffer) (GL::ARRAY_BUFFER, 0);
+	bindAttribute (normalIndex, 3, normalSource);
     }
 
     // special case a single color and apply it to the entire operation
     if (colorData.size () == 4)
     {
-	tmpProgram->setUniform4f ("singleColor", colorData[0],
+	tmpProgram->setUniform4f (singleColorUniform, colorData[0],
 	                       colorData[1], colorData[2], colorData[3]);
     }
     else if (colorData.size () > 4)
     {
 	colorIndex = tmpProgram->attributeLocation ("color");
-	(*GL::enableVertexAttribArray) (colorIndex);
-	(*GL::bindBuffer) (GL::ARRAY_BUFFER, colorBuffer);
-	(*GL::vertexAttribPointer) (colorIndex, 4, GL_FLOAT, GL_FALSE, 0, 0);
-	(*GL::bindBuffer) (GL::ARRAY_BUFFER, 0);
+	bindAttribute (colorIndex, 4, colorSource);
     }
 
     for (int i = nTextures - 1; i >= 0; i--)
@@ -522,14 +1054,9 @@ int PrivateVertexBuffer::render (const GLMatrix            *projection,
 
 	snprintf (name, 10, "texCoord%d", i);
 	texCoordIndex[i] = tmpProgram->attributeLocation (name);
+	bindAttribute (texCoordIndex[i], 2, textureSources[i]);
 
-	(*GL::enableVertexAttribArray) (texCoordIndex[i]);
-	(*GL::bindBuffer) (GL::ARRAY_BUFFER, textureBuffers[i]);
-	(*GL::vertexAttribPointer) (texCoordIndex[i], 2, GL_FLOAT, GL_FALSE, 0, 0);
-	(*GL::bindBuffer) (GL::ARRAY_BUFFER, 0);
-
-	snprintf (name, 9, "texture%d", i);
-	tmpProgram->setUniform (name, i);
+	tmpProgram->setUniform (textureUniforms[i], i);
     }
 
     // set per-plugin uniforms
@@ -544,7 +1071,7 @@ int PrivateVertexBuffer::render (const GLMatrix            *projection,
 	attribs[0] = attrib->opacity  / 65535.0f;
 	attribs[1] = attrib->brightness / 65535.0f;
 	attribs[2] = attrib->saturation / 65535.0f;
-	tmpProgram->setUniform3f ("paintAttrib", attribs[0], attribs[1], attribs[2]);
+	tmpProgram->setUniform3f (paintAttribUniform, attribs[0], attribs[1], attribs[2]);
     }
 
 
@@ -84,10 +84,16 @@ PrivateGLWindow::PrivateGLWindow (CompWindow *w,
     needsRebind (true),
     clip (),
     bindFailed (false),
-    vertexBuffer (new GLVertexBuffer ()),
+    vertexBuffer (new GLVertexBuffer (GL::STREAM_DRAW)),
+    retained (),
+    dynamicGeometry (false),
+    drawFrame (0),
+    drawOutput (0),
+    drawPass (0),
     autoProgram(new GLWindowAutoProgram (this)),
     icons (),
-    configureLock (w->obtainLockOnConfigureRequests ())
+    configureLock (w->obtainLockOnConfigureRequests ()),
+    paintStamp (0)
 {
     paint.xScale	= 1.0f;
     paint.yScale	= 1.0f;
@@ -104,6 +110,7 @@ PrivateGLWindow::PrivateGLWindow (CompWindow *w,
 
 PrivateGLWindow::~PrivateGLWindow ()
 {
+    releaseRetainedGeometry ();
     delete vertexBuffer;
     delete autoProgram;
     cWindow->setNewPixmapReadyCallback (boost::function <void ()> ());
@@ -127,10 +134,14 @@ PrivateGLWindow::setWindowMatrix ()
     updateState &= ~(UpdateMatrix);
 }
 
+/* The pixmap is replaced or released, bind again before the
+ * next draw */
 void
 PrivateGLWindow::clearTextures ()
 {
     textures.clear ();
+    needsRebind = true;
+    cWindow->setTextureBytes (0);
 }
 
 bool
@@ -185,6 +196,13 @@ GLWindow::bind ()
 	    priv->textures = textures;
 	    priv->needsRebind = false;
 
+	    unsigned long long bytes = 0;
+
+	    foreach (GLTexture *t, textures)
+		bytes += (unsigned long long) t->width () * t->height () * 4;
+
+	    priv->cWindow->setTextureBytes (bytes);
+
 	    /* If the number of textures changed, we should immediately
 	     * update the matrices and regions so that they are at least
 	     * initialized, but we'll queue another update just before
@@ -203,6 +221,21 @@ GLWindow::bind ()
     return true;
 }
 
+void
+GLWindow::prefetch ()
+{
+    if (!priv->needsRebind)
+	return;
+
+    PrivateGLScreen *gs = priv->gScreen->priv;
+
+    gs->prefetchQueue.push_back (priv->window->id ());
+
+    if (!gs->prefetchTimer.active ())
+	gs->prefetchTimer.start
+	    (boost::bind (&PrivateGLScreen::prefetchQueued, gs), 0);
+}
+
 void
 GLWindow::release ()
 {
@@ -311,6 +344,27 @@ GLWindow::vertexBuffer ()
     return priv->vertexBuffer;
 }
 
+void
+GLWindow::setDynamicGeometry (bool dynamic)
+{
+    priv->dynamicGeometry = dynamic;
+
+    if (dynamic)
+	priv->releaseRetainedGeometry ();
+}
+
+void
+PrivateGLWindow::releaseRetainedGeometry ()
+{
+    typedef std::map<RetainedPass, std::vector<RetainedGeometry> > Passes;
+
+    for (Passes::iterator it = retained.begin (); it != retained.end (); ++it)
+	foreach (RetainedGeometry &r, it->second)
+	    delete r.buffer;
+
+    retained.clear ();
+}
+
 const GLTexture::List &
 GLWindow::textures () const
 {
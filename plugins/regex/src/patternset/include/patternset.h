@@ -0,0 +1,118 @@
+/*
+ * Compiz regex plugin, PatternSet class
+ *
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_REGEX_PATTERNSET_H
+#define _COMPIZ_REGEX_PATTERNSET_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace compiz
+{
+namespace regex
+{
+
+namespace impl
+{
+class Automaton;
+}
+
+/*
+ * A set of POSIX basic regular expressions (as passed to regcomp
+ * without REG_EXTENDED) compiled into one lazily built DFA, so a single
+ * pass over a string tells which of them match it.
+ *
+ * Patterns using something the automaton can't reproduce exactly
+ * (backreferences, word anchors, locale dependent classes, ...) are
+ * refused by add () and have to be matched with regexec instead.
+ */
+class PatternSet
+{
+    public:
+
+	static const unsigned int Invalid;
+
+	/* Which patterns matched one string */
+	class Matches
+	{
+	    public:
+
+		Matches ();
+
+		/* Returns false if the string couldn't be run through the
+		 * automaton (eg. it isn't valid in the current locale), in
+		 * which case the caller has to fall back to regexec */
+		bool lookup (unsigned int id, bool &matched) const;
+
+	    private:
+
+		friend class PatternSet;
+
+		std::vector<unsigned long> mBits;
+		unsigned int               mGeneration;
+		bool                       mComplete;
+	};
+
+	PatternSet ();
+	~PatternSet ();
+
+	/* Returns an id for the pattern, or Invalid if it can't go into
+	 * the automaton. Adding the same pattern twice returns the same
+	 * id and needs the same number of calls to remove (). */
+	unsigned int add (const std::string &pattern, int cflags);
+	void remove (unsigned int id);
+
+	void match (const std::string &subject, Matches &matches);
+
+	/* Whether matches still describes the current set of patterns */
+	bool upToDate (const Matches &matches) const;
+
+    private:
+
+	PatternSet (const PatternSet &);
+	PatternSet & operator= (const PatternSet &);
+
+	typedef std::pair<std::string, int> Key;
+
+	struct Entry
+	{
+	    Key          key;
+	    unsigned int refs;
+	};
+
+	std::map<Key, unsigned int> mIds;
+	std::vector<Entry>          mEntries;
+	std::vector<unsigned int>   mFreeIds;
+	unsigned int                mGeneration;
+
+	impl::Automaton             *mAutomaton;
+	bool                        mDirty;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,1271 @@
+/*
+ * Compiz regex plugin, PatternSet class
+ *
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "patternset.h"
+
+#include <bitset>
+#include <algorithm>
+
+#include <ctype.h>
+#include <limits.h>
+#include <locale.h>
+#include <langinfo.h>
+#include <regex.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace cr = compiz::regex;
+
+const unsigned int cr::PatternSet::Invalid = ~0u;
+
+namespace
+{
+const unsigned int BitsPerWord = sizeof (unsigned long) * CHAR_BIT;
+
+/* Bounded repeats are expanded, keep that from getting out of hand */
+const int MaxRepeat = 32;
+
+/* Patterns which would need more NFA states than this are left to
+ * regexec */
+const std::size_t MaxPatternStates = 4096;
+
+/* Once the lazily built DFA gets this big it is thrown away and
+ * started over from the current state */
+const std::size_t MaxDfaStates = 4096;
+
+typedef std::bitset<256> ByteSet;
+
+/* How a pattern sees the bytes of a string, from the current locale */
+typedef enum
+{
+    EncodingBytes,
+    EncodingUtf8,
+    EncodingUnsupported
+} Encoding;
+
+Encoding
+currentEncoding ()
+{
+    if (MB_CUR_MAX == 1)
+	return EncodingBytes;
+
+    const char *codeset = nl_langinfo (CODESET);
+
+    if (codeset && strcmp (codeset, "UTF-8") == 0)
+	return EncodingUtf8;
+
+    return EncodingUnsupported;
+}
+
+/* Strict UTF-8 validation: anything regexec might decode differently
+ * from the automaton (overlong forms, surrogates, ...) is refused */
+bool
+validUtf8 (const std::string &s)
+{
+    const unsigned char *p = (const unsigned char *) s.data ();
+    const unsigned char *end = p + s.size ();
+
+    while (p < end)
+    {
+	unsigned char c = *p++;
+	int           more;
+	unsigned char lo = 0x80, hi = 0xbf;
+
+	if (c < 0x80)
+	    continue;
+	else if (c >= 0xc2 && c <= 0xdf)
+	    more = 1;
+	else if (c >= 0xe0 && c <= 0xef)
+	{
+	    more = 2;
+	    if (c == 0xe0)
+		lo = 0xa0;
+	    else if (c == 0xed)
+		hi = 0x9f;
+	}
+	else if (c >= 0xf0 && c <= 0xf4)
+	{
+	    more = 3;
+	    if (c == 0xf0)
+		lo = 0x90;
+	    else if (c == 0xf4)
+		hi = 0x8f;
+	}
+	else
+	    return false;
+
+	if (end - p < more)
+	    return false;
+
+	if (*p < lo || *p > hi)
+	    return false;
+
+	for (int i = 1; i < more; ++i)
+	    if (p[i] < 0x80 || p[i] > 0xbf)
+		return false;
+
+	p += more;
+    }
+
+    return true;
+}
+
+ByteSet
+byteRange (unsigned int lo, unsigned int hi)
+{
+    ByteSet set;
+
+    for (unsigned int c = lo; c <= hi; ++c)
+	set.set (c);
+
+    return set;
+}
+
+struct Node
+{
+    typedef enum
+    {
+	Set,
+	Seq,
+	Alt,
+	Repeat,
+	Empty
+    } Kind;
+
+    explicit Node (Kind kind = Empty) :
+	kind (kind),
+	min (0),
+	max (0)
+    {
+    }
+
+    static Node bytes (const ByteSet &set)
+    {
+	Node n (Set);
+	n.set = set;
+	return n;
+    }
+
+    Kind              kind;
+    ByteSet           set;
+    std::vector<Node> children;
+    int               min, max;	/* max < 0 is unbounded */
+};
+
+/* Any multibyte character, the input is known to be valid UTF-8 */
+Node
+utf8MultiByte ()
+{
+    Node       alt (Node::Alt);
+    ByteSet    cont (byteRange (0x80, 0xbf));
+    const int  lead[3][2] = { { 0xc2, 0xdf }, { 0xe0, 0xef }, { 0xf0, 0xf4 } };
+
+    for (int n = 0; n < 3; ++n)
+    {
+	Node seq (Node::Seq);
+
+	seq.children.push_back (Node::bytes (byteRange (lead[n][0], lead[n][1])));
+	for (int i = 0; i <= n; ++i)
+	    seq.children.push_back (Node::bytes (cont));
+
+	alt.children.push_back (seq);
+    }
+
+    return alt;
+}
+
+/*
+ * Parses the subset of glibc's basic regular expression syntax which
+ * the automaton reproduces exactly. Returning false just means the
+ * pattern has to be left to regexec; it is assumed to have already been
+ * accepted by regcomp.
+ */
+class Parser
+{
+    public:
+
+	Parser (const std::string &pattern,
+		bool              icase,
+		Encoding          encoding) :
+	    p (pattern),
+	    pos (0),
+	    icase (icase),
+	    encoding (encoding),
+	    anchorStart (false),
+	    anchorEnd (false),
+	    alternation (false)
+	{
+	}
+
+	bool parse (Node &root)
+	{
+	    if (encoding == EncodingUnsupported)
+		return false;
+
+	    if (!p.empty () && p[0] == '^')
+	    {
+		anchorStart = true;
+		++pos;
+	    }
+
+	    if (!parseAlt (root, 0))
+		return false;
+
+	    /* glibc anchors only the first or last alternative then */
+	    if (alternation && (anchorStart || anchorEnd))
+		return false;
+
+	    return pos == p.size ();
+	}
+
+	bool anchoredAtStart () const { return anchorStart; }
+	bool anchoredAtEnd () const { return anchorEnd; }
+
+    private:
+
+	bool at (const char *s) const
+	{
+	    return p.compare (pos, strlen (s), s) == 0;
+	}
+
+	bool parseAlt (Node &out, int depth)
+	{
+	    Node alt (Node::Alt);
+
+	    for (;;)
+	    {
+		Node seq;
+
+		if (!parseSeq (seq, depth))
+		    return false;
+
+		alt.children.push_back (seq);
+
+		if (!at ("\\|"))
+		    break;
+
+		if (!depth)
+		    alternation = true;
+
+		pos += 2;
+	    }
+
+	    if (alt.children.size () == 1)
+		out = alt.children.front ();
+	    else
+		out = alt;
+
+	    return true;
+	}
+
+	bool parseSeq (Node &out, int depth)
+	{
+	    Node seq (Node::Seq);
+	    bool start = true;
+
+	    while (pos < p.size ())
+	    {
+		if (at ("\\|"))
+		    break;
+
+		if (at ("\\)"))
+		{
+		    if (!depth)
+			return false;
+		    break;
+		}
+
+		Node atom;
+		unsigned char c = p[pos];
+
+		if (c == '^')
+		{
+		    /* Only an anchor at the start of the whole pattern is
+		     * handled, elsewhere glibc may treat it as one too */
+		    if (start)
+			return false;
+
+		    atom = literal (c);
+		    ++pos;
+		}
+		else if (c == '$')
+		{
+		    if (pos + 1 == p.size ())
+		    {
+			if (depth)
+			    return false;
+
+			anchorEnd = true;
+			++pos;
+			break;
+		    }
+
+		    if (p.compare (pos + 1, 2, "\\)") == 0 ||
+			p.compare (pos + 1, 2, "\\|") == 0)
+			return false;
+
+		    atom = literal (c);
+		    ++pos;
+		}
+		else if (c == '*' && start)
+		{
+		    /* A leading '*' is literal, but only at the start of
+		     * the pattern is that certain */
+		    if (depth || pos > (anchorStart ? 1u : 0u))
+			return false;
+
+		    atom = literal (c);
+		    ++pos;
+		}
+		else if (c == '.')
+		{
+		    atom = any ();
+		    ++pos;
+		}
+		else if (c == '[')
+		{
+		    if (!parseBracket (atom))
+			return false;
+		}
+		else if (c == '\\')
+		{
+		    if (pos + 1 == p.size ())
+			return false;
+
+		    unsigned char e = p[pos + 1];
+
+		    if (e == '(')
+		    {
+			pos += 2;
+
+			if (!parseAlt (atom, depth + 1) || !at ("\\)"))
+			    return false;
+
+			pos += 2;
+		    }
+		    else if (strchr (".*[]\\^$", e))
+		    {
+			atom = literal (e);
+			pos += 2;
+		    }
+		    else
+			return false;
+		}
+		else if (c == '*')
+		{
+		    /* eg. after a '$' or '^' used as literal */
+		    return false;
+		}
+		else if (!parseLiteral (atom))
+		    return false;
+
+		if (!parsePostfix (atom))
+		    return false;
+
+		seq.children.push_back (atom);
+		start = false;
+	    }
+
+	    if (seq.children.empty ())
+		out = Node (Node::Empty);
+	    else if (seq.children.size () == 1)
+		out = seq.children.front ();
+	    else
+		out = seq;
+
+	    return true;
+	}
+
+	bool parsePostfix (Node &atom)
+	{
+	    for (;;)
+	    {
+		int min, max;
+
+		if (at ("*"))
+		{
+		    min = 0;
+		    max = -1;
+		    pos += 1;
+		}
+		else if (at ("\\+"))
+		{
+		    min = 1;
+		    max = -1;
+		    pos += 2;
+		}
+		else if (at ("\\?"))
+		{
+		    min = 0;
+		    max = 1;
+		    pos += 2;
+		}
+		else if (at ("\\{"))
+		{
+		    pos += 2;
+
+		    if (!parseNumber (min))
+			return false;
+
+		    max = min;
+
+		    if (at (","))
+		    {
+			++pos;
+
+			if (at ("\\}"))
+			    max = -1;
+			else if (!parseNumber (max) || max < min)
+			    return false;
+		    }
+
+		    if (!at ("\\}"))
+			return false;
+
+		    pos += 2;
+		}
+		else
+		    return true;
+
+		Node repeat (Node::Repeat);
+
+		repeat.min = min;
+		repeat.max = max;
+		repeat.children.push_back (atom);
+		atom = repeat;
+	    }
+	}
+
+	bool parseNumber (int &n)
+	{
+	    std::size_t start = pos;
+
+	    n = 0;
+	    while (pos < p.size () && isdigit ((unsigned char) p[pos]) &&
+		   n <= MaxRepeat)
+		n = n * 10 + (p[pos++] - '0');
+
+	    return pos != start && n <= MaxRepeat;
+	}
+
+	bool parseLiteral (Node &atom)
+	{
+	    unsigned char c = p[pos];
+
+	    if (c < 0x80)
+	    {
+		atom = literal (c);
+		++pos;
+		return true;
+	    }
+
+	    /* Case folding outside of ASCII is left to regexec */
+	    if (icase)
+		return false;
+
+	    if (encoding == EncodingBytes)
+	    {
+		atom = Node::bytes (ByteSet ().set (c));
+		++pos;
+		return true;
+	    }
+
+	    /* A multibyte character is one atom, so repeats apply to all
+	     * of it */
+	    std::size_t len = c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : 2;
+
+	    if (pos + len > p.size () || !validUtf8 (p.substr (pos, len)))
+		return false;
+
+	    atom = Node (Node::Seq);
+	    for (std::size_t i = 0; i < len; ++i)
+		atom.children.push_back (
+		    Node::bytes (ByteSet ().set ((unsigned char) p[pos++])));
+
+	    return true;
+	}
+
+	bool parseBracket (Node &atom)
+	{
+	    ByteSet set;
+	    bool    negate = false;
+	    bool    first = true;
+
+	    ++pos;
+
+	    if (at ("^"))
+	    {
+		negate = true;
+		++pos;
+	    }
+
+	    for (;;)
+	    {
+		if (pos >= p.size ())
+		    return false;
+
+		unsigned char c = p[pos];
+
+		if (c == ']' && !first)
+		{
+		    ++pos;
+		    break;
+		}
+
+		first = false;
+
+		if (at ("[:"))
+		{
+		    std::size_t end = p.find (":]", pos + 2);
+
+		    if (end == std::string::npos ||
+			!addClass (set, p.substr (pos + 2, end - pos - 2)))
+			return false;
+
+		    pos = end + 2;
+		    continue;
+		}
+
+		/* Collating elements and equivalence classes */
+		if (at ("[.") || at ("[="))
+		    return false;
+
+		/* Ranges and members outside of ASCII depend on collation */
+		if (c >= 0x80)
+		    return false;
+
+		if (pos + 2 < p.size () && p[pos + 1] == '-' && p[pos + 2] != ']')
+		{
+		    unsigned char hi = p[pos + 2];
+
+		    if (hi >= 0x80 || hi < c || hi == '[')
+			return false;
+
+		    /* glibc folds a range that mixes letters with other
+		     * characters, such as [A-z], its own way under
+		     * REG_ICASE, leave those to regcomp */
+		    if (icase && !(islower (c) && islower (hi)) &&
+			!(isupper (c) && isupper (hi)))
+		    {
+			ByteSet range (byteRange (c, hi));
+
+			for (unsigned int l = 'A'; l <= 'Z'; ++l)
+			    if (range.test (l) || range.test (tolower (l)))
+				return false;
+		    }
+
+		    set |= byteRange (c, hi);
+		    pos += 3;
+		    continue;
+		}
+
+		set.set (c);
+		++pos;
+	    }
+
+	    if (icase)
+		for (unsigned int c = 'a'; c <= 'z'; ++c)
+		    if (set.test (c) || set.test (toupper (c)))
+		    {
+			set.set (c);
+			set.set (toupper (c));
+		    }
+
+	    if (!negate)
+	    {
+		atom = Node::bytes (set);
+		return true;
+	    }
+
+	    if (encoding == EncodingBytes)
+	    {
+		atom = Node::bytes (~set & byteRange (1, 255));
+		return true;
+	    }
+
+	    atom = Node (Node::Alt);
+	    atom.children.push_back (Node::bytes (~set & byteRange (1, 0x7f)));
+	    atom.children.push_back (utf8MultiByte ());
+
+	    return true;
+	}
+
+	bool addClass (ByteSet &set, const std::string &name)
+	{
+	    typedef int (*Classifier) (int);
+
+	    static const struct {
+		const char *name;
+		Classifier is;
+		bool       asciiOnly;
+	    } classes[] = {
+		{ "alpha",  isalpha,  false },
+		{ "upper",  isupper,  false },
+		{ "lower",  islower,  false },
+		{ "digit",  isdigit,  true  },
+		{ "xdigit", isxdigit, true  },
+		{ "alnum",  isalnum,  false },
+		{ "space",  isspace,  false },
+		{ "blank",  isblank,  false },
+		{ "punct",  ispunct,  false },
+		{ "print",  isprint,  false },
+		{ "graph",  isgraph,  false },
+		{ "cntrl",  iscntrl,  false }
+	    };
+
+	    for (unsigned int i = 0; i < sizeof (classes) / sizeof (classes[0]); ++i)
+	    {
+		if (name != classes[i].name)
+		    continue;
+
+		/* Most classes also contain multibyte characters */
+		if (encoding == EncodingUtf8 && !classes[i].asciiOnly)
+		    return false;
+
+		/* [[:upper:]] matches both cases under REG_ICASE */
+		if (icase && (name == "upper" || name == "lower"))
+		    return false;
+
+		for (unsigned int c = 1; c < (encoding == EncodingUtf8 ? 0x80 : 0x100); ++c)
+		    if (classes[i].is (c))
+			set.set (c);
+
+		return true;
+	    }
+
+	    return false;
+	}
+
+	Node literal (unsigned char c) const
+	{
+	    ByteSet set;
+
+	    set.set (c);
+
+	    if (icase && isalpha (c) && c < 0x80)
+	    {
+		set.set (tolower (c));
+		set.set (toupper (c));
+	    }
+
+	    return Node::bytes (set);
+	}
+
+	Node any () const
+	{
+	    if (encoding == EncodingBytes)
+		return Node::bytes (byteRange (1, 255));
+
+	    Node alt (Node::Alt);
+
+	    alt.children.push_back (Node::bytes (byteRange (1, 0x7f)));
+	    alt.children.push_back (utf8MultiByte ());
+
+	    return alt;
+	}
+
+	const std::string &p;
+	std::size_t       pos;
+	bool              icase;
+	Encoding          encoding;
+	bool              anchorStart;
+	bool              anchorEnd;
+	bool              alternation;
+};
+
+/* The number of NFA states Automaton::emit will create for node */
+std::size_t
+stateCount (const Node &node)
+{
+    std::size_t n = 0;
+
+    switch (node.kind)
+    {
+	case Node::Set:
+	    return 1;
+
+	case Node::Seq:
+	case Node::Alt:
+	    for (std::vector<Node>::const_iterator it = node.children.begin ();
+		 it != node.children.end (); ++it)
+		n += stateCount (*it);
+
+	    if (node.kind == Node::Alt)
+		n += node.children.size () - 1;
+
+	    return n;
+
+	case Node::Repeat:
+	    n = stateCount (node.children.front ());
+
+	    if (node.max < 0)
+		return 1 + n * (node.min + 1);
+
+	    return (node.max - node.min) * (n + 1) + node.min * n;
+
+	case Node::Empty:
+	default:
+	    return 0;
+    }
+}
+
+bool
+parsePattern (const std::string &pattern,
+	      int               cflags,
+	      Encoding          encoding,
+	      Node              &root,
+	      bool              &anchorStart,
+	      bool              &anchorEnd)
+{
+    if (cflags & (REG_EXTENDED | REG_NEWLINE))
+	return false;
+
+    Parser parser (pattern, cflags & REG_ICASE, encoding);
+
+    if (!parser.parse (root) || stateCount (root) > MaxPatternStates)
+	return false;
+
+    anchorStart = parser.anchoredAtStart ();
+    anchorEnd = parser.anchoredAtEnd ();
+
+    return true;
+}
+}
+
+namespace compiz
+{
+namespace regex
+{
+namespace impl
+{
+
+/*
+ * A Thompson NFA over all patterns, run as a DFA which is built lazily
+ * while matching. Searching is unanchored, so after every byte the
+ * start states of the patterns not anchored with '^' are added again.
+ */
+class Automaton
+{
+    public:
+
+	Automaton () :
+	    mEncoding (currentEncoding ()),
+	    mUsable (mEncoding != EncodingUnsupported),
+	    mClassCount (1),
+	    mInitial (-1),
+	    mMarkGeneration (0)
+	{
+	    memset (mClassOf, 0, sizeof (mClassOf));
+	}
+
+	bool add (unsigned int id, const std::string &pattern, int cflags);
+	void finish ();
+
+	bool run (const std::string &subject,
+		  std::vector<unsigned long> &bits);
+
+    private:
+
+	struct State
+	{
+	    typedef enum
+	    {
+		Byte,
+		Split,
+		Match,
+		MatchAtEnd
+	    } Kind;
+
+	    Kind         kind;
+	    ByteSet      set;
+	    int          out, out1;
+	    unsigned int id;
+	};
+
+	struct DfaState
+	{
+	    std::vector<int>          nfa;
+	    std::vector<unsigned int> accept;
+	    std::vector<unsigned int> acceptAtEnd;
+	};
+
+	int addState (State::Kind kind, int out = -1, int out1 = -1);
+	int emit (const Node &node, int next);
+
+	void closure (const std::vector<int> &seeds, std::vector<int> &states);
+	int dfaState (const std::vector<int> &states);
+	int initial ();
+	int step (int &from, unsigned char c);
+	void flush ();
+
+	Encoding           mEncoding;
+	bool               mUsable;
+
+	std::vector<State> mStates;
+	std::vector<int>   mStarts;
+	std::vector<int>   mUnanchoredStarts;
+
+	unsigned char      mClassOf[256];
+	unsigned int       mClassCount;
+
+	std::vector<DfaState>             mDfa;
+	std::map<std::vector<int>, int>   mDfaIndex;
+	std::vector<int>                  mTransitions;
+	int                               mInitial;
+
+	std::vector<unsigned int> mMark;
+	unsigned int              mMarkGeneration;
+	std::vector<int>          mStack;
+};
+
+int
+Automaton::addState (State::Kind kind, int out, int out1)
+{
+    State s;
+
+    s.kind = kind;
+    s.out = out;
+    s.out1 = out1;
+    s.id = 0;
+    mStates.push_back (s);
+
+    return mStates.size () - 1;
+}
+
+/* Builds the states for node back to front, next being the state that
+ * follows it. Returns the entry state. */
+int
+Automaton::emit (const Node &node, int next)
+{
+    int s;
+
+    switch (node.kind)
+    {
+	case Node::Set:
+	    s = addState (State::Byte, next);
+	    mStates[s].set = node.set;
+	    return s;
+
+	case Node::Seq:
+	    for (std::vector<Node>::const_reverse_iterator it = node.children.rbegin ();
+		 it != node.children.rend (); ++it)
+		next = emit (*it, next);
+	    return next;
+
+	case Node::Alt:
+	    s = emit (node.children.back (), next);
+	    for (int i = node.children.size () - 2; i >= 0; --i)
+		s = addState (State::Split, emit (node.children[i], next), s);
+	    return s;
+
+	case Node::Repeat:
+	{
+	    const Node &child = node.children.front ();
+
+	    if (node.max < 0)
+	    {
+		s = addState (State::Split, -1, next);
+
+		/* emit may grow mStates, don't hold on to the state
+		 * across the call */
+		int body = emit (child, s);
+		mStates[s].out = body;
+	    }
+	    else
+	    {
+		s = next;
+		for (int i = node.min; i < node.max; ++i)
+		    s = addState (State::Split, emit (child, s), next);
+	    }
+
+	    for (int i = 0; i < node.min; ++i)
+		s = emit (child, s);
+
+	    return s;
+	}
+
+	case Node::Empty:
+	default:
+	    return next;
+    }
+}
+
+bool
+Automaton::add (unsigned int       id,
+		const std::string &pattern,
+		int                cflags)
+{
+    Node root;
+    bool anchorStart, anchorEnd;
+
+    if (!parsePattern (pattern, cflags, mEncoding, root, anchorStart, anchorEnd))
+	return false;
+
+    int accept = addState (anchorEnd ? State::MatchAtEnd : State::Match);
+    mStates[accept].id = id;
+
+    int start = emit (root, accept);
+
+    mStarts.push_back (start);
+    if (!anchorStart)
+	mUnanchoredStarts.push_back (start);
+
+    return true;
+}
+
+/* Splits the bytes into classes which no state tells apart, so the
+ * DFA only needs a transition per class */
+void
+Automaton::finish ()
+{
+    for (std::vector<State>::const_iterator it = mStates.begin ();
+	 it != mStates.end (); ++it)
+    {
+	if (it->kind != State::Byte)
+	    continue;
+
+	unsigned char               refined[256];
+	std::map<std::pair<int, bool>, int> classes;
+
+	for (unsigned int c = 0; c < 256; ++c)
+	{
+	    std::pair<int, bool> key (mClassOf[c], it->set.test (c));
+	    std::map<std::pair<int, bool>, int>::iterator found = classes.find (key);
+
+	    if (found == classes.end ())
+		found = classes.insert (std::make_pair (key, classes.size ())).first;
+
+	    refined[c] = found->second;
+	}
+
+	memcpy (mClassOf, refined, sizeof (mClassOf));
+	mClassCount = classes.size ();
+    }
+
+    mMark.assign (mStates.size (), 0);
+}
+
+void
+Automaton::closure (const std::vector<int> &seeds,
+		    std::vector<int>       &states)
+{
+    if (++mMarkGeneration == 0)
+    {
+	std::fill (mMark.begin (), mMark.end (), 0);
+	mMarkGeneration = 1;
+    }
+
+    states.clear ();
+    mStack.assign (seeds.begin (), seeds.end ());
+
+    while (!mStack.empty ())
+    {
+	int s = mStack.back ();
+	mStack.pop_back ();
+
+	if (s < 0 || mMark[s] == mMarkGeneration)
+	    continue;
+
+	mMark[s] = mMarkGeneration;
+
+	const State &state = mStates[s];
+
+	if (state.kind == State::Split)
+	{
+	    mStack.push_back (state.out1);
+	    mStack.push_back (state.out);
+	}
+	else
+	    states.push_back (s);
+    }
+
+    std::sort (states.begin (), states.end ());
+}
+
+int
+Automaton::dfaState (const std::vector<int> &states)
+{
+    std::map<std::vector<int>, int>::iterator it = mDfaIndex.find (states);
+
+    if (it != mDfaIndex.end ())
+	return it->second;
+
+    DfaState d;
+
+    d.nfa = states;
+    for (std::vector<int>::const_iterator s = states.begin ();
+	 s != states.end (); ++s)
+    {
+	if (mStates[*s].kind == State::Match)
+	    d.accept.push_back (mStates[*s].id);
+	else if (mStates[*s].kind == State::MatchAtEnd)
+	    d.acceptAtEnd.push_back (mStates[*s].id);
+    }
+
+    int index = mDfa.size ();
+
+    mDfa.push_back (d);
+    mDfaIndex[states] = index;
+    mTransitions.resize (mDfa.size () * mClassCount, -1);
+
+    return index;
+}
+
+int
+Automaton::initial ()
+{
+    if (mInitial < 0)
+    {
+	std::vector<int> states;
+
+	closure (mStarts, states);
+	mInitial = dfaState (states);
+    }
+
+    return mInitial;
+}
+
+void
+Automaton::flush ()
+{
+    mDfa.clear ();
+    mDfaIndex.clear ();
+    mTransitions.clear ();
+    mInitial = -1;
+}
+
+/* Follows the transition on c out of from, building it if needed.
+ * from is updated if the DFA had to be flushed. */
+int
+Automaton::step (int          &from,
+		 unsigned char c)
+{
+    unsigned int cls = mClassOf[c];
+    int          to = mTransitions[from * mClassCount + cls];
+
+    if (to >= 0)
+	return to;
+
+    std::vector<int> seeds (mUnanchoredStarts);
+    std::vector<int> states;
+
+    const std::vector<int> &current = mDfa[from].nfa;
+
+    for (std::vector<int>::const_iterator s = current.begin ();
+	 s != current.end (); ++s)
+	if (mStates[*s].kind == State::Byte && mStates[*s].set.test (c))
+	    seeds.push_back (mStates[*s].out);
+
+    closure (seeds, states);
+
+    if (mDfa.size () >= MaxDfaStates &&
+	mDfaIndex.find (states) == mDfaIndex.end ())
+    {
+	std::vector<int> keep (current);
+
+	flush ();
+	from = dfaState (keep);
+    }
+
+    to = dfaState (states);
+    mTransitions[from * mClassCount + cls] = to;
+
+    return to;
+}
+
+bool
+Automaton::run (const std::string          &subject,
+		std::vector<unsigned long> &bits)
+{
+    if (!mUsable)
+	return false;
+
+    if (mEncoding == EncodingUtf8 && !validUtf8 (subject))
+	return false;
+
+    int state = initial ();
+
+    for (std::string::const_iterator it = subject.begin ();
+	 it != subject.end (); ++it)
+    {
+	const std::vector<unsigned int> &accept = mDfa[state].accept;
+
+	for (std::vector<unsigned int>::const_iterator a = accept.begin ();
+	     a != accept.end (); ++a)
+	    bits[*a / BitsPerWord] |= 1UL << (*a % BitsPerWord);
+
+	state = step (state, (unsigned char) *it);
+    }
+
+    const DfaState &last = mDfa[state];
+
+    for (std::vector<unsigned int>::const_iterator a = last.accept.begin ();
+	 a != last.accept.end (); ++a)
+	bits[*a / BitsPerWord] |= 1UL << (*a % BitsPerWord);
+
+    for (std::vector<unsigned int>::const_iterator a = last.acceptAtEnd.begin ();
+	 a != last.acceptAtEnd.end (); ++a)
+	bits[*a / BitsPerWord] |= 1UL << (*a % BitsPerWord);
+
+    return true;
+}
+
+}
+}
+}
+
+cr::PatternSet::Matches::Matches () :
+    mBits (),
+    mGeneration (0),
+    mComplete (false)
+{
+}
+
+bool
+cr::PatternSet::Matches::lookup (unsigned int id,
+				 bool         &matched) const
+{
+    if (!mComplete)
+	return false;
+
+    unsigned int word = id / BitsPerWord;
+
+    matched = word < mBits.size () &&
+	      (mBits[word] & (1UL << (id % BitsPerWord)));
+
+    return true;
+}
+
+cr::PatternSet::PatternSet () :
+    mGeneration (1),
+    mAutomaton (NULL),
+    mDirty (true)
+{
+}
+
+cr::PatternSet::~PatternSet ()
+{
+    delete mAutomaton;
+}
+
+unsigned int
+cr::PatternSet::add (const std::string &pattern,
+		     int               cflags)
+{
+    /* REG_NOSUB makes no difference to whether a string matches */
+    Key                                   key (pattern, cflags & ~REG_NOSUB);
+    std::map<Key, unsigned int>::iterator it = mIds.find (key);
+
+    if (it != mIds.end ())
+    {
+	++mEntries[it->second].refs;
+	return it->second;
+    }
+
+    Node root;
+    bool anchorStart, anchorEnd;
+
+    if (!parsePattern (pattern, key.second, currentEncoding (),
+		       root, anchorStart, anchorEnd))
+	return Invalid;
+
+    unsigned int id;
+
+    if (mFreeIds.empty ())
+    {
+	id = mEntries.size ();
+	mEntries.push_back (Entry ());
+    }
+    else
+    {
+	id = mFreeIds.back ();
+	mFreeIds.pop_back ();
+    }
+
+    mEntries[id].key = key;
+    mEntries[id].refs = 1;
+    mIds[key] = id;
+
+    /* Results computed before can't say anything about the new id */
+    ++mGeneration;
+    mDirty = true;
+
+    return id;
+}
+
+void
+cr::PatternSet::remove (unsigned int id)
+{
+    if (id >= mEntries.size () || !mEntries[id].refs)
+	return;
+
+    if (--mEntries[id].refs)
+	return;
+
+    mIds.erase (mEntries[id].key);
+    mFreeIds.push_back (id);
+
+    /* Earlier results stay valid, the id is meaningless until reused */
+    mDirty = true;
+}
+
+void
+cr::PatternSet::match (const std::string &subject,
+		       Matches           &matches)
+{
+    if (mDirty)
+    {
+	delete mAutomaton;
+	mAutomaton = new impl::Automaton ();
+
+	bool usable = true;
+
+	for (unsigned int id = 0; id < mEntries.size (); ++id)
+	    if (mEntries[id].refs)
+		usable &= mAutomaton->add (id, mEntries[id].key.first,
+					   mEntries[id].key.second);
+
+	mAutomaton->finish ();
+
+	/* The locale must have changed, let regexec deal with it */
+	if (!usable)
+	{
+	    delete mAutomaton;
+	    mAutomaton = NULL;
+	}
+
+	mDirty = false;
+    }
+
+    matches.mGeneration = mGeneration;
+    matches.mBits.assign ((mEntries.size () + BitsPerWord - 1) / BitsPerWord, 0);
+    matches.mComplete = mAutomaton && mAutomaton->run (subject, matches.mBits);
+}
+
+bool
+cr::PatternSet::upToDate (const Matches &matches) const
+{
+    return matches.mGeneration == mGeneration;
+}
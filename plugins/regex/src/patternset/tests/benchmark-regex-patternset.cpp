@@ -0,0 +1,232 @@
+/*
+ * Compares matching window rules one regexec at a time against
+ * running each window string through a PatternSet once.
+ *
+ * 500 rules spread over title=, class=, name= and role= are checked
+ * against 300 windows, as RegexExp::evaluate would do.
+ *
+ * Run compiz_regex_patternset_benchmark [iterations]
+ */
+
+#include "patternset.h"
+
+#include <regex.h>
+#include <locale.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+using compiz::regex::PatternSet;
+
+namespace
+{
+
+const int nRules (500);
+const int nWindows (300);
+const int nFields (4);
+
+const char *applications[] = {
+    "Firefox", "Thunderbird", "Gimp", "Inkscape", "Gedit", "Emacs",
+    "XTerm", "Gnome-terminal", "Nautilus", "Evince", "Totem", "Rhythmbox",
+    "Pidgin", "Chromium", "Libreoffice", "Vlc"
+};
+
+const int nApplications (sizeof (applications) / sizeof (applications[0]));
+
+struct Rule
+{
+    int         field;
+    std::string pattern;
+    int         cflags;
+    regex_t     regex;
+    unsigned int id;
+};
+
+struct Window
+{
+    std::string field[nFields];
+};
+
+double
+now ()
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+char buffer[256];
+
+/* The kinds of expressions people put in window rules */
+std::string
+rulePattern (int i, int &field, int &cflags)
+{
+    const char *app = applications[i % nApplications];
+
+    cflags = REG_NOSUB;
+    field = i % nFields;
+
+    switch ((i / nFields) % 5)
+    {
+	case 0:
+	    snprintf (buffer, sizeof (buffer), "^%s$", app);
+	    break;
+	case 1:
+	    snprintf (buffer, sizeof (buffer), "%s", app);
+	    cflags |= REG_ICASE;
+	    break;
+	case 2:
+	    snprintf (buffer, sizeof (buffer), "Document %d - ", i);
+	    break;
+	case 3:
+	    snprintf (buffer, sizeof (buffer), "^%.3s.*\\(%d\\|%d\\)$", app, i, i + 1);
+	    break;
+	default:
+	    snprintf (buffer, sizeof (buffer), "[Pp]roject[[:digit:]]\\{2\\}-%d", i);
+	    break;
+    }
+
+    return buffer;
+}
+
+Window
+makeWindow (int i)
+{
+    const char *app = applications[(i * 7) % nApplications];
+    Window     w;
+
+    snprintf (buffer, sizeof (buffer), "Document %d - %s", i * 3, app);
+    w.field[0] = buffer;
+    snprintf (buffer, sizeof (buffer), "%s-window-%d", app, i);
+    w.field[1] = buffer;
+    w.field[2] = app;
+    snprintf (buffer, sizeof (buffer), "%s.%d", app, i % 3);
+    w.field[3] = buffer;
+
+    return w;
+}
+
+/* Keeps the optimiser from throwing the work away */
+volatile long sink;
+
+}
+
+int
+main (int argc, char **argv)
+{
+    int iterations = argc > 1 ? atoi (argv[1]) : 10;
+
+    setlocale (LC_ALL, "");
+
+    std::vector<Rule>   rules (nRules);
+    std::vector<Window> windows;
+    PatternSet          sets[nFields];
+    int                 fallbacks = 0;
+
+    for (int i = 0; i < nRules; ++i)
+    {
+	Rule &r = rules[i];
+
+	r.pattern = rulePattern (i, r.field, r.cflags);
+	if (regcomp (&r.regex, r.pattern.c_str (), r.cflags))
+	{
+	    fprintf (stderr, "bad pattern %s\n", r.pattern.c_str ());
+	    return 1;
+	}
+
+	r.id = sets[r.field].add (r.pattern, r.cflags);
+	if (r.id == PatternSet::Invalid)
+	    ++fallbacks;
+    }
+
+    for (int i = 0; i < nWindows; ++i)
+	windows.push_back (makeWindow (i));
+
+    printf ("%d rules (%d left to regexec), %d windows, %d iterations\n",
+	    nRules, fallbacks, nWindows, iterations);
+
+    long   regexecMatches = 0;
+    double start = now ();
+
+    for (int n = 0; n < iterations; ++n)
+	for (int w = 0; w < nWindows; ++w)
+	    for (int i = 0; i < nRules; ++i)
+		if (!regexec (&rules[i].regex,
+			      windows[w].field[rules[i].field].c_str (),
+			      0, NULL, 0))
+		    ++regexecMatches;
+
+    double regexecTime = now () - start;
+
+    /* Warm the lazily built automata up once, like a running compiz */
+    std::vector<PatternSet::Matches> matches (nWindows * nFields);
+
+    for (int w = 0; w < nWindows; ++w)
+	for (int f = 0; f < nFields; ++f)
+	    sets[f].match (windows[w].field[f], matches[w * nFields + f]);
+
+    long setMatches = 0;
+
+    start = now ();
+
+    for (int n = 0; n < iterations; ++n)
+	for (int w = 0; w < nWindows; ++w)
+	{
+	    /* What updateTitle and friends do when a property changes */
+	    for (int f = 0; f < nFields; ++f)
+		sets[f].match (windows[w].field[f], matches[w * nFields + f]);
+
+	    for (int i = 0; i < nRules; ++i)
+	    {
+		bool matched;
+
+		if (!matches[w * nFields + rules[i].field].lookup (rules[i].id,
+								   matched))
+		    matched = !regexec (&rules[i].regex,
+					windows[w].field[rules[i].field].c_str (),
+					0, NULL, 0);
+
+		if (matched)
+		    ++setMatches;
+	    }
+	}
+
+    double setTime = now () - start;
+
+    /* Evaluating again while no property changed */
+    start = now ();
+
+    for (int n = 0; n < iterations; ++n)
+	for (int w = 0; w < nWindows; ++w)
+	    for (int i = 0; i < nRules; ++i)
+	    {
+		bool matched;
+
+		if (matches[w * nFields + rules[i].field].lookup (rules[i].id,
+								  matched))
+		    sink += matched;
+	    }
+
+    double lookupTime = now () - start;
+
+    if (regexecMatches != setMatches)
+    {
+	fprintf (stderr, "results differ: regexec %ld, pattern set %ld\n",
+		 regexecMatches, setMatches);
+	return 1;
+    }
+
+    printf ("%-28s %10.2f ms\n", "regexec per rule", regexecTime);
+    printf ("%-28s %10.2f ms %8.2fx\n", "pattern set, rematching", setTime,
+	    regexecTime / setTime);
+    printf ("%-28s %10.2f ms %8.2fx\n", "pattern set, cached", lookupTime,
+	    regexecTime / lookupTime);
+
+    for (int i = 0; i < nRules; ++i)
+	regfree (&rules[i].regex);
+
+    return 0;
+}
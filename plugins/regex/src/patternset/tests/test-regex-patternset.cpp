@@ -0,0 +1,300 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <regex.h>
+#include <locale.h>
+#include <stdlib.h>
+
+#include "patternset.h"
+
+using compiz::regex::PatternSet;
+
+namespace
+{
+const int flags = REG_NOSUB;
+
+bool
+matches (PatternSet &set, unsigned int id, const std::string &subject)
+{
+    PatternSet::Matches m;
+    bool                matched = false;
+
+    set.match (subject, m);
+    EXPECT_TRUE (m.lookup (id, matched));
+
+    return matched;
+}
+
+bool
+regexMatches (const std::string &pattern, int cflags, const std::string &subject)
+{
+    regex_t re;
+
+    if (regcomp (&re, pattern.c_str (), cflags))
+	return false;
+
+    bool matched = regexec (&re, subject.c_str (), 0, NULL, 0) == 0;
+
+    regfree (&re);
+
+    return matched;
+}
+}
+
+class RegexPatternSetTest :
+    public ::testing::Test
+{
+    protected:
+
+	void SetUp ()
+	{
+	    setlocale (LC_ALL, "C");
+	}
+
+	PatternSet set;
+};
+
+TEST_F (RegexPatternSetTest, SubstringSearch)
+{
+    unsigned int id = set.add ("fox", flags);
+
+    ASSERT_NE (PatternSet::Invalid, id);
+    EXPECT_TRUE (matches (set, id, "Firefox"));
+    EXPECT_FALSE (matches (set, id, "Firefo"));
+}
+
+TEST_F (RegexPatternSetTest, Anchors)
+{
+    unsigned int start = set.add ("^Fire", flags);
+    unsigned int end = set.add ("fox$", flags);
+    unsigned int both = set.add ("^Firefox$", flags);
+
+    EXPECT_TRUE (matches (set, start, "Firefox"));
+    EXPECT_FALSE (matches (set, start, "A Firefox"));
+    EXPECT_TRUE (matches (set, end, "Firefox"));
+    EXPECT_FALSE (matches (set, end, "Firefox 2"));
+    EXPECT_TRUE (matches (set, both, "Firefox"));
+    EXPECT_FALSE (matches (set, both, "Firefoxx"));
+}
+
+TEST_F (RegexPatternSetTest, IgnoreCase)
+{
+    unsigned int id = set.add ("terminal", flags | REG_ICASE);
+    unsigned int exact = set.add ("terminal", flags);
+
+    EXPECT_NE (id, exact);
+    EXPECT_TRUE (matches (set, id, "GNOME Terminal"));
+    EXPECT_FALSE (matches (set, exact, "GNOME Terminal"));
+}
+
+TEST_F (RegexPatternSetTest, GroupsAndRepeats)
+{
+    unsigned int alt = set.add ("\\(gedit\\|emacs\\)$", flags);
+    unsigned int interval = set.add ("^x\\{2,3\\}y", flags);
+    unsigned int star = set.add ("a.*b", flags);
+
+    EXPECT_TRUE (matches (set, alt, "file.txt - emacs"));
+    EXPECT_FALSE (matches (set, alt, "emacs - file.txt"));
+    EXPECT_TRUE (matches (set, interval, "xxxy"));
+    EXPECT_FALSE (matches (set, interval, "xy"));
+    EXPECT_FALSE (matches (set, interval, "xxxxy"));
+    EXPECT_TRUE (matches (set, star, "a to b"));
+    EXPECT_FALSE (matches (set, star, "b to a"));
+}
+
+TEST_F (RegexPatternSetTest, StarsAndRepeatsAgreeWithRegexec)
+{
+    static const char *patterns[] = {
+	"a*", ".*Firefox", "^\\(ab\\)*c$", "x\\{2,\\}", "\\(a*b*\\)*c",
+	"^[a-c]*\\(x\\|y\\)\\{0,2\\}$"
+    };
+    static const char *subjects[] = {
+	"", "a", "aaa", "Firefox", "Mozilla Firefox", "Firefo", "ababc",
+	"abac", "c", "xx", "x", "abcxy", "abcxyx", "cbaxx"
+    };
+
+    for (unsigned int p = 0; p < sizeof (patterns) / sizeof (patterns[0]); ++p)
+    {
+	unsigned int id = set.add (patterns[p], flags);
+
+	ASSERT_NE (PatternSet::Invalid, id) << patterns[p];
+
+	for (unsigned int s = 0; s < sizeof (subjects) / sizeof (subjects[0]); ++s)
+	    EXPECT_EQ (regexMatches (patterns[p], flags, subjects[s]),
+		       matches (set, id, subjects[s]))
+		<< patterns[p] << " on '" << subjects[s] << "'";
+    }
+}
+
+TEST_F (RegexPatternSetTest, MixedCaseInsensitiveRangesAreLeftToRegcomp)
+{
+    EXPECT_EQ (PatternSet::Invalid, set.add ("[A-z]", flags | REG_ICASE));
+    EXPECT_EQ (PatternSet::Invalid, set.add ("[0-a]", flags | REG_ICASE));
+
+    unsigned int lower = set.add ("[a-f]", flags | REG_ICASE);
+    unsigned int digits = set.add ("[0-9]", flags | REG_ICASE);
+    unsigned int exact = set.add ("[A-z]", flags);
+
+    ASSERT_NE (PatternSet::Invalid, lower);
+    ASSERT_NE (PatternSet::Invalid, digits);
+    ASSERT_NE (PatternSet::Invalid, exact);
+
+    EXPECT_TRUE (matches (set, lower, "E"));
+    EXPECT_FALSE (matches (set, digits, "E"));
+    EXPECT_EQ (regexMatches ("[A-z]", flags, "["), matches (set, exact, "["));
+    EXPECT_EQ (regexMatches ("[A-z]", flags, "\\"), matches (set, exact, "\\"));
+}
+
+TEST_F (RegexPatternSetTest, UnsupportedPatternsAreRefused)
+{
+    EXPECT_EQ (PatternSet::Invalid, set.add ("\\(a\\)\\1", flags));
+    EXPECT_EQ (PatternSet::Invalid, set.add ("\\<word\\>", flags));
+    EXPECT_EQ (PatternSet::Invalid, set.add ("[[.a.]]", flags));
+    EXPECT_EQ (PatternSet::Invalid, set.add ("^a\\|b", flags));
+    EXPECT_EQ (PatternSet::Invalid, set.add ("a+", REG_EXTENDED));
+}
+
+TEST_F (RegexPatternSetTest, SamePatternSharesId)
+{
+    unsigned int first = set.add ("xterm", flags);
+    unsigned int second = set.add ("xterm", flags);
+
+    EXPECT_EQ (first, second);
+
+    set.remove (first);
+    EXPECT_TRUE (matches (set, second, "xterm"));
+
+    set.remove (second);
+
+    unsigned int reused = set.add ("other", flags);
+
+    EXPECT_EQ (first, reused);
+    EXPECT_FALSE (matches (set, reused, "xterm"));
+}
+
+TEST_F (RegexPatternSetTest, AddingPatternsOutdatesMatches)
+{
+    PatternSet::Matches m;
+    unsigned int        first = set.add ("a", flags);
+
+    set.match ("ab", m);
+    EXPECT_TRUE (set.upToDate (m));
+
+    set.remove (first);
+    EXPECT_TRUE (set.upToDate (m));
+
+    unsigned int second = set.add ("b", flags);
+    EXPECT_FALSE (set.upToDate (m));
+
+    bool matched;
+    set.match ("ab", m);
+    ASSERT_TRUE (m.lookup (second, matched));
+    EXPECT_TRUE (matched);
+}
+
+TEST_F (RegexPatternSetTest, InvalidUtf8IsLeftToRegexec)
+{
+    if (!setlocale (LC_ALL, "C.UTF-8"))
+	return;
+
+    unsigned int        id = set.add ("caf.", flags);
+    PatternSet::Matches m;
+    bool                matched;
+
+    ASSERT_NE (PatternSet::Invalid, id);
+
+    set.match ("caf\xc3\xa9", m);
+    ASSERT_TRUE (m.lookup (id, matched));
+    EXPECT_TRUE (matched);
+
+    set.match ("caf\xe9", m);
+    EXPECT_FALSE (m.lookup (id, matched));
+}
+
+/* Whatever the set accepts has to agree with regexec */
+TEST_F (RegexPatternSetTest, AgreesWithRegexec)
+{
+    static const char *pieces[] = {
+	"a", "b", "A", ".", "*", "\\+", "\\?", "\\{1,2\\}", "^", "$",
+	"[ab]", "[^a]", "[a-c]", "[[:digit:]]", "\\(", "\\)", "\\|",
+	"\\.", "1", " ", "[A-z]", "[Z-a]", "[a-z]*"
+    };
+    static const char *letters[] = {
+	"a", "b", "c", "A", "1", " ", ".", "[", "\\", "]", "_", "z", "Z"
+    };
+
+    const unsigned int nPieces = sizeof (pieces) / sizeof (pieces[0]);
+    const unsigned int nLetters = sizeof (letters) / sizeof (letters[0]);
+
+    std::vector<std::pair<std::string, int> > patterns;
+    std::vector<unsigned int>                 ids;
+
+    srand (42);
+
+    for (int i = 0; i < 300; ++i)
+    {
+	std::string pattern;
+	int         cflags = flags | (rand () % 2 ? REG_ICASE : 0);
+	regex_t     re;
+
+	for (int n = rand () % 5; n >= 0; --n)
+	    pattern += pieces[rand () % nPieces];
+
+	if (regcomp (&re, pattern.c_str (), cflags))
+	    continue;
+
+	regfree (&re);
+
+	unsigned int id = set.add (pattern, cflags);
+
+	if (id == PatternSet::Invalid)
+	    continue;
+
+	patterns.push_back (std::make_pair (pattern, cflags));
+	ids.push_back (id);
+    }
+
+    ASSERT_FALSE (ids.empty ());
+
+    for (int i = 0; i < 200; ++i)
+    {
+	std::string         subject;
+	PatternSet::Matches m;
+
+	for (int n = rand () % 8; n > 0; --n)
+	    subject += letters[rand () % nLetters];
+
+	set.match (subject, m);
+
+	for (unsigned int p = 0; p < ids.size (); ++p)
+	{
+	    bool matched;
+
+	    ASSERT_TRUE (m.lookup (ids[p], matched));
+	    EXPECT_EQ (regexMatches (patterns[p].first, patterns[p].second, subject),
+		       matched) << patterns[p].first << " on '" << subject << "'";
+	}
+    }
+}
@@ -35,14 +35,7 @@ COMPIZ_PLUGIN_20090315 (regex, RegexPluginVTable)
 class RegexExp : public CompMatch::Expression
 {
     public:
-	typedef enum {
-	    TypeTitle,
-	    TypeRole,
-	    TypeClass,
-	    TypeName,
-	} Type;
-
-	RegexExp (const CompString& str, int item);
+	RegexExp (const CompString& str, int item, RegexScreen *rs);
 	virtual ~RegexExp ();
 
 	bool evaluate (const CompWindow *w) const;
@@ -52,29 +45,33 @@ class RegexExp : public CompMatch::Expression
 	typedef struct {
 	    const char   *name;
 	    size_t       length;
-	    Type         type;
+	    RegexField   field;
 	    unsigned int flags;
 	} Prefix;
 
 	static const Prefix prefix[];
 
-	Type    mType;
-	regex_t *mRegex;
+	RegexField mField;
+	regex_t    *mRegex;
+
+	boost::shared_ptr<compiz::regex::PatternSet> mPatterns;
+	unsigned int                                 mId;
 };
 
 const RegexExp::Prefix RegexExp::prefix[] = {
-    { "title=", 6, TypeTitle, 0 },
-    { "role=",  5, TypeRole, 0  },
-    { "class=", 6, TypeClass, 0 },
-    { "name=",  5, TypeName, 0  },
-    { "ititle=", 7, TypeTitle, REG_ICASE },
-    { "irole=",  6, TypeRole, REG_ICASE  },
-    { "iclass=", 7, TypeClass, REG_ICASE },
-    { "iname=",  6, TypeName, REG_ICASE  }
+    { "title=", 6, RegexFieldTitle, 0 },
+    { "role=",  5, RegexFieldRole, 0  },
+    { "class=", 6, RegexFieldClass, 0 },
+    { "name=",  5, RegexFieldName, 0  },
+    { "ititle=", 7, RegexFieldTitle, REG_ICASE },
+    { "irole=",  6, RegexFieldRole, REG_ICASE  },
+    { "iclass=", 7, RegexFieldClass, REG_ICASE },
+    { "iname=",  6, RegexFieldName, REG_ICASE  }
 };
 
-RegexExp::RegexExp (const CompString& str, int item) :
-    mRegex (NULL)
+RegexExp::RegexExp (const CompString& str, int item, RegexScreen *rs) :
+    mRegex (NULL),
+    mId (compiz::regex::PatternSet::Invalid)
 {
     if ((unsigned int) item < sizeof (prefix) / sizeof (prefix[0]))
     {
@@ -100,12 +97,22 @@ RegexExp::RegexExp (const CompString& str, int item) :
 	    mRegex = NULL;
 	}
 
-	mType = prefix[item].type;
+	mField = prefix[item].field;
+
+	/* Patterns the automaton can't handle are left to regexec */
+	if (mRegex)
+	{
+	    mPatterns = rs->patterns[mField];
+	    mId = mPatterns->add (value, REG_NOSUB | prefix[item].flags);
+	}
     }
 }
 
 RegexExp::~RegexExp ()
 {
+    if (mId != compiz::regex::PatternSet::Invalid)
+	mPatterns->remove (mId);
+
     if (mRegex)
     {
 	regfree (mRegex);
@@ -116,29 +123,17 @@ RegexExp::~RegexExp ()
 bool
 RegexExp::evaluate (const CompWindow *w) const
 {
-    const CompString *string = NULL;
     const RegexWindow *rw = RegexWindow::get (w);
+    bool              matched;
 
-    switch (mType)
-    {
-	case TypeRole:
-	    string = &rw->role;
-	    break;
-	case TypeTitle:
-	    string = &rw->title;
-	    break;
-	case TypeClass:
-	    string = &rw->resClass;
-	    break;
-	case TypeName:
-	    string = &rw->resName;
-	    break;
-    }
-
-    if (!mRegex || !string)
+    if (!mRegex)
 	return false;
 
-    if (regexec (mRegex, string->c_str (), 0, NULL, 0))
+    if (mId != compiz::regex::PatternSet::Invalid &&
+	rw->lookup (mField, mId, matched))
+	return matched;
+
+    if (regexec (mRegex, rw->field (mField).c_str (), 0, NULL, 0))
 	return false;
 
     return true;
@@ -160,7 +155,7 @@ RegexScreen::matchInitExp (const CompString& str)
     int item = RegexExp::matches (str);
 
     if (item >= 0)
-	return new RegexExp (str, item);
+	return new RegexExp (str, item, this);
 
     return screen->matchInitExp (str);
 }
@@ -196,6 +191,45 @@ RegexWindow::getStringProperty (Atom        nameAtom,
     return true;
 }
 
+const CompString &
+RegexWindow::field (RegexField field) const
+{
+    switch (field)
+    {
+	case RegexFieldTitle:
+	    return title;
+	case RegexFieldRole:
+	    return role;
+	case RegexFieldClass:
+	    return resClass;
+	case RegexFieldName:
+	default:
+	    return resName;
+    }
+}
+
+void
+RegexWindow::updateMatches (RegexField field) const
+{
+    RegexScreen *rs = RegexScreen::get (screen);
+
+    rs->patterns[field]->match (this->field (field), mMatches[field]);
+}
+
+bool
+RegexWindow::lookup (RegexField   field,
+		     unsigned int id,
+		     bool         &matched) const
+{
+    RegexScreen *rs = RegexScreen::get (screen);
+
+    /* Patterns were added since the string was last matched */
+    if (!rs->patterns[field]->upToDate (mMatches[field]))
+	updateMatches (field);
+
+    return mMatches[field].lookup (id, matched);
+}
+
 void
 RegexWindow::updateRole ()
 {
@@ -203,6 +237,8 @@ RegexWindow::updateRole ()
 
     role = "";
     getStringProperty (rs->roleAtom, XA_STRING, role);
+
+    updateMatches (RegexFieldRole);
 }
 
 void
@@ -212,13 +248,11 @@ RegexWindow::updateTitle ()
 
     title = "";
 
-    if (getStringProperty (rs->visibleNameAtom, Atoms::utf8String, title))
-	return;
-
-    if (getStringProperty (Atoms::wmName, Atoms::utf8String, title))
-	return;
+    if (!getStringProperty (rs->visibleNameAtom, Atoms::utf8String, title) &&
+	!getStringProperty (Atoms::wmName, Atoms::utf8String, title))
+	getStringProperty (XA_WM_NAME, XA_STRING, title);
 
-    getStringProperty (XA_WM_NAME, XA_STRING, title);
+    updateMatches (RegexFieldTitle);
 }
 
 void RegexWindow::updateClass ()
@@ -228,20 +262,23 @@ void RegexWindow::updateClass ()
     resClass = "";
     resName  = "";
 
-    if (!XGetClassHint (screen->dpy (), window->id (), &classHint) != Success)
-	return;
-
-    if (classHint.res_name)
+    if (XGetClassHint (screen->dpy (), window->id (), &classHint))
     {
-	resName = classHint.res_name;
-	XFree (classHint.res_name);
-    }
+	if (classHint.res_name)
+	{
+	    resName = classHint.res_name;
+	    XFree (classHint.res_name);
+	}
 
-    if (classHint.res_class)
-    {
-	resClass = classHint.res_class;
-	XFree (classHint.res_class);
+	if (classHint.res_class)
+	{
+	    resClass = classHint.res_class;
+	    XFree (classHint.res_class);
+	}
     }
+
+    updateMatches (RegexFieldClass);
+    updateMatches (RegexFieldName);
 }
 
 void
@@ -300,6 +337,9 @@ RegexScreen::RegexScreen (CompScreen *s) :
     roleAtom        = XInternAtom (s->dpy (), "WM_WINDOW_ROLE", 0);
     visibleNameAtom = XInternAtom (s->dpy (), "_NET_WM_VISIBLE_NAME", 0);
 
+    for (int i = 0; i < RegexFieldNum; ++i)
+	patterns[i].reset (new compiz::regex::PatternSet ());
+
     mApplyInitialActionsTimer.setTimes (0, 0);
     mApplyInitialActionsTimer.setCallback (cb);
     mApplyInitialActionsTimer.start ();
@@ -32,6 +32,19 @@
 
 #include <X11/Xatom.h>
 
+#include <boost/shared_ptr.hpp>
+
+#include "patternset.h"
+
+/* The window strings regex match expressions can look at */
+typedef enum {
+    RegexFieldTitle,
+    RegexFieldRole,
+    RegexFieldClass,
+    RegexFieldName,
+    RegexFieldNum
+} RegexField;
+
 class RegexScreen :
     public PluginClassHandler<RegexScreen, CompScreen>,
     public ScreenInterface
@@ -49,6 +62,9 @@ class RegexScreen :
 	Atom roleAtom;
 	Atom visibleNameAtom;
 
+	/* Every active pattern, one automaton per window string */
+	boost::shared_ptr<compiz::regex::PatternSet> patterns[RegexFieldNum];
+
 	CompTimer mApplyInitialActionsTimer;
 };
 
@@ -64,12 +80,23 @@ class RegexWindow :
 	bool getStringProperty (Atom nameAtom, Atom typeAtom,
 				CompString& string);
 
+	const CompString & field (RegexField field) const;
+
+	/* Whether pattern id of the field's automaton matches this window.
+	 * Returns false if the automaton can't tell. */
+	bool lookup (RegexField field, unsigned int id, bool &matched) const;
+
 	CompString role;
 	CompString title;
 	CompString resName;
 	CompString resClass;
 
 	CompWindow *window;
+
+    private:
+	void updateMatches (RegexField field) const;
+
+	mutable compiz::regex::PatternSet::Matches mMatches[RegexFieldNum];
 };
 
 class RegexPluginVTable :
@@ -389,6 +389,8 @@ namespace
 		    (GL::bindFramebuffer) (GL::READ_FRAMEBUFFER, drawBinding);
 		}
 
+		GLScreen::get (::screen)->submitHeldDraws ();
+
 		glGetError ();
 		glReadPixels (x1, ::screen->height () - y2, w, h,
 			      GL_RGBA, GL_UNSIGNED_BYTE,
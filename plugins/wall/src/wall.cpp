@@ -457,6 +457,9 @@ WallScreen::moveViewport (int    x,
 
     screen->moveViewport (x, y, true);
 
+    /* Have the destination bound before the first frame of the slide */
+    glScreen->prefetchViewport (screen->vp ());
+
     moving          = true;
     focusDefault    = true;
     boxOutputDevice = screen->outputDeviceForPoint (pointerX, pointerY);
@@ -35,6 +35,17 @@ const unsigned int TEXTURE_SIZE = 256;
 
 const float K = 0.1964f;
 
+/* The uniforms of the water programs */
+const GLProgram::UniformHandle prevTexUniform ("prevTex");
+const GLProgram::UniformHandle currTexUniform ("currTex");
+const GLProgram::UniformHandle timeLapseUniform ("timeLapse");
+const GLProgram::UniformHandle fadeUniform ("fade");
+const GLProgram::UniformHandle colorUniform ("color");
+const GLProgram::UniformHandle baseTexUniform ("baseTex");
+const GLProgram::UniformHandle waveTexUniform ("waveTex");
+const GLProgram::UniformHandle lightVecUniform ("lightVec");
+const GLProgram::UniformHandle offsetScaleUniform ("offsetScale");
+
 static int waterLastPointerX = 0;
 static int waterLastPointerY = 0;
 
@@ -112,10 +123,10 @@ WaterScreen::waterUpdate (float dt)
     waterFbo[INDEX (this, 0)]->tex ()->setFilter (GL_NEAREST);
     glBindTexture (GL_TEXTURE_2D, waterFbo[INDEX (this, 0)]->tex ()->name ());
 
-    vertexBuffer[UPDATE]->addUniform ("prevTex", 0);
-    vertexBuffer[UPDATE]->addUniform ("currTex", 1);
-    vertexBuffer[UPDATE]->addUniform ("timeLapse", dt * K);
-    vertexBuffer[UPDATE]->addUniform ("fade", fade);
+    vertexBuffer[UPDATE]->addUniform (prevTexUniform, 0);
+    vertexBuffer[UPDATE]->addUniform (currTexUniform, 1);
+    vertexBuffer[UPDATE]->addUniform (timeLapseUniform, dt * K);
+    vertexBuffer[UPDATE]->addUniform (fadeUniform, fade);
 
     GLboolean isBlendingEnabled;
     glGetBooleanv (GL_BLEND, &isBlendingEnabled);
@@ -165,7 +176,7 @@ WaterScreen::waterVertices (GLenum type,
 	}
 	vertexBuffer[SET]->end();
 
-	vertexBuffer[SET]->addUniform ("color", v);
+	vertexBuffer[SET]->addUniform (colorUniform, v);
 	GLboolean isBlendingEnabled;
 	glGetBooleanv (GL_BLEND, &isBlendingEnabled);
 	glDisable (GL_BLEND);
@@ -346,19 +357,19 @@ WaterScreen::glPaintCompositedOutput (const CompRegion    &region,
 	    glActiveTexture (GL_TEXTURE0);
 	    fbo->tex ()->setFilter (GL_LINEAR);
 	    glBindTexture (GL_TEXTURE_2D, fbo->tex ()->name ());
-	    vertexBuffer[PAINT]->addUniform ("baseTex", 0);
+	    vertexBuffer[PAINT]->addUniform (baseTexUniform, 0);
 
 	    glActiveTexture (GL_TEXTURE1);
 	    waterFbo[INDEX (this, 0)]->tex ()->setFilter (GL_LINEAR);
 	    glBindTexture (GL_TEXTURE_2D,
 			waterFbo[INDEX (this, 0)]->tex ()->name ());
-	    vertexBuffer[PAINT]->addUniform ("waveTex", 1);
+	    vertexBuffer[PAINT]->addUniform (waveTexUniform, 1);
 
-	    vertexBuffer[PAINT]->addUniform3f ("lightVec",
+	    vertexBuffer[PAINT]->addUniform3f (lightVecUniform,
 					lightVec[0],
 					lightVec[1],
 					lightVec[2]);
-	    vertexBuffer[PAINT]->addUniform ("offsetScale", offsetScale);
+	    vertexBuffer[PAINT]->addUniform (offsetScaleUniform, offsetScale);
 	    GLboolean isBlendingEnabled;
 	    glGetBooleanv (GL_BLEND, &isBlendingEnabled);
 	    glDisable (GL_BLEND);
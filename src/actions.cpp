@@ -263,3 +263,57 @@ CompScreenImpl::shadeWin (CompAction         *action,
 
     return true;
 }
+
+namespace
+{
+const char *
+eventName (int type)
+{
+    switch (type)
+    {
+	case KeyPress:
+	    return "KeyPress";
+	case KeyRelease:
+	    return "KeyRelease";
+	case ButtonPress:
+	    return "ButtonPress";
+	case ButtonRelease:
+	    return "ButtonRelease";
+	case MotionNotify:
+	    return "MotionNotify";
+	default:
+	    return "Unknown";
+    }
+}
+}
+
+bool
+CompScreenImpl::dumpInputLatency (CompAction         *action,
+				  CompAction::State  state,
+				  CompOption::Vector &options)
+{
+    std::vector<compiz::core::InputLatency> latencies;
+
+    screen->inputLatencyStatistics (latencies);
+
+    for (unsigned int i = 0; i < latencies.size (); i++)
+    {
+	const compiz::core::InputLatency &l = latencies[i];
+	CompString                       histogram;
+
+	for (unsigned int b = 0; b < compiz::core::InputLatency::Buckets; b++)
+	    histogram += compPrintf (" %u", l.histogram[b]);
+
+	compLogMessage ("core", CompLogLevelInfo,
+			"%s: %u events, %u unseen, average %.1fms "
+			"(%.1fms before compiz read them), worst %.1fms, "
+			"by ms <1 1 2 4 .. 1024+:%s",
+			eventName (l.type), l.events, l.unseen,
+			l.averageLatency / 1000.0f,
+			l.averageDelivery / 1000.0f,
+			l.worstLatency / 1000.0f,
+			histogram.c_str ());
+    }
+
+    return true;
+}
@@ -1401,14 +1401,15 @@ CompScreenImpl::_handleEvent (XEvent *event)
 	    wa.override_redirect = event->xcreatewindow.override_redirect;
 	}
 
-	foreach (CompWindow *w, screen->windows ())
+	if (CompWindow *w =
+		windowManager.findServerFrame (event->xcreatewindow.window))
 	{
-	    if (w->priv->serverFrame == event->xcreatewindow.window)
-	    {
-		w->priv->frame = event->xcreatewindow.window;
-		w->priv->updatePassiveButtonGrabs ();
-		create = false;
-	    }
+	    Window oldFrame = w->priv->frame;
+
+	    w->priv->frame = event->xcreatewindow.window;
+	    windowManager.updateFrameWindows (w, oldFrame, w->priv->serverFrame);
+	    w->priv->updatePassiveButtonGrabs ();
+	    create = false;
 	}
 
 	foreach (CompWindow *w, destroyedWindows())
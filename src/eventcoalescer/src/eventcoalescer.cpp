@@ -0,0 +1,308 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <X11/extensions/Xdamage.h>
+
+#include <algorithm>
+
+#include "eventcoalescer.h"
+
+namespace ce = compiz::events;
+
+namespace
+{
+long long
+area (const XRectangle &r)
+{
+    return (long long) r.width * r.height;
+}
+}
+
+ce::Coalescer::Coalescer () :
+    mHead (0),
+    mConfigure (0),
+    mHaveConfigure (false),
+    mDamageEvent (-1),
+    mReceived (0),
+    mDispatched (0)
+{
+}
+
+void
+ce::Coalescer::setDamageEvent (int type)
+{
+    mDamageEvent = type;
+}
+
+void
+ce::Coalescer::setConfigureIsExpected (const ConfigureIsExpected &expected)
+{
+    mConfigureIsExpected = expected;
+}
+
+void
+ce::Coalescer::inhibit (int type)
+{
+    ++mInhibited[type];
+}
+
+void
+ce::Coalescer::uninhibit (int type)
+{
+    std::map <int, unsigned int>::iterator it = mInhibited.find (type);
+
+    if (it != mInhibited.end () && !--it->second)
+	mInhibited.erase (it);
+}
+
+bool
+ce::Coalescer::inhibited (int type) const
+{
+    return mInhibited.find (type) != mInhibited.end ();
+}
+
+bool
+ce::Coalescer::canHold (const XEvent &event) const
+{
+    return kind (event) != Barrier;
+}
+
+void
+ce::Coalescer::push (const XEvent &event)
+{
+    Entry entry;
+
+    entry.event   = event;
+    entry.dropped = false;
+
+    mEntries.push_back (entry);
+    ++mReceived;
+}
+
+bool
+ce::Coalescer::pop (XEvent &event)
+{
+    while (mHead < mEntries.size () && mEntries[mHead].dropped)
+	++mHead;
+
+    if (mHead == mEntries.size ())
+    {
+	mEntries.clear ();
+	mHead = 0;
+	return false;
+    }
+
+    event = mEntries[mHead++].event;
+    ++mDispatched;
+
+    return true;
+}
+
+bool
+ce::Coalescer::empty () const
+{
+    for (unsigned int i = mHead; i < mEntries.size (); ++i)
+	if (!mEntries[i].dropped)
+	    return false;
+
+    return true;
+}
+
+void
+ce::Coalescer::discard (int type)
+{
+    for (unsigned int i = mHead; i < mEntries.size (); ++i)
+	if (mEntries[i].event.type == type)
+	    mEntries[i].dropped = true;
+}
+
+ce::Coalescer::Kind
+ce::Coalescer::kind (const XEvent &event) const
+{
+    switch (event.type) {
+	case MotionNotify:
+	    return Motion;
+	case ConfigureNotify:
+	    return Configure;
+	case Expose:
+	case GraphicsExpose:
+	case NoExpose:
+	case VisibilityNotify:
+	case PropertyNotify:
+	case SelectionClear:
+	case SelectionRequest:
+	case SelectionNotify:
+	case ColormapNotify:
+	case MappingNotify:
+	    return Passive;
+	default:
+	    break;
+    }
+
+    if (event.type == mDamageEvent)
+	return Damage;
+
+    /* Input, mapping and stacking changes and every extension
+     * event we don't know about */
+    return Barrier;
+}
+
+void
+ce::Coalescer::coalesce ()
+{
+    mMotion.clear ();
+    mDamage.clear ();
+    mHaveConfigure = false;
+
+    for (unsigned int i = mHead; i < mEntries.size (); ++i)
+    {
+	if (mEntries[i].dropped)
+	    continue;
+
+	const XEvent &event = mEntries[i].event;
+	bool         skip  = inhibited (event.type);
+
+	switch (kind (event)) {
+	    case Motion:
+		if (!skip)
+		    coalesceMotion (i);
+		break;
+	    case Configure:
+		if (!skip)
+		    coalesceConfigure (i);
+		else
+		{
+		    mDamage.clear ();
+		    mHaveConfigure = false;
+		}
+		break;
+	    case Damage:
+		if (!skip)
+		    coalesceDamage (i);
+		break;
+	    case Barrier:
+		mMotion.clear ();
+		mDamage.clear ();
+		mHaveConfigure = false;
+		break;
+	    case Passive:
+		break;
+	}
+    }
+}
+
+void
+ce::Coalescer::coalesceMotion (unsigned int i)
+{
+    const XMotionEvent &motion = mEntries[i].event.xmotion;
+
+    std::map <Window, unsigned int>::iterator it = mMotion.find (motion.window);
+
+    if (it != mMotion.end ())
+    {
+	if (mEntries[it->second].event.xmotion.root == motion.root)
+	    mEntries[it->second].dropped = true;
+
+	it->second = i;
+    }
+    else
+	mMotion[motion.window] = i;
+}
+
+void
+ce::Coalescer::coalesceConfigure (unsigned int i)
+{
+    const XConfigureEvent &configure = mEntries[i].event.xconfigure;
+
+    /* A resize replaces the pixmap damage is reported against */
+    mDamage.clear ();
+
+    if (!mConfigureIsExpected.empty () && mConfigureIsExpected (configure))
+    {
+	mHaveConfigure = false;
+	return;
+    }
+
+    if (mHaveConfigure)
+    {
+	const XConfigureEvent &earlier = mEntries[mConfigure].event.xconfigure;
+
+	if (earlier.window == configure.window &&
+	    earlier.event == configure.event)
+	    mEntries[mConfigure].dropped = true;
+    }
+
+    mConfigure     = i;
+    mHaveConfigure = true;
+}
+
+void
+ce::Coalescer::coalesceDamage (unsigned int i)
+{
+    XDamageNotifyEvent *damage =
+	reinterpret_cast <XDamageNotifyEvent *> (&mEntries[i].event);
+
+    std::map <unsigned long, unsigned int>::iterator it =
+	mDamage.find (damage->damage);
+
+    if (it == mDamage.end ())
+    {
+	mDamage[damage->damage] = i;
+	return;
+    }
+
+    unsigned int       previous = it->second;
+    XDamageNotifyEvent *earlier =
+	reinterpret_cast <XDamageNotifyEvent *> (&mEntries[previous].event);
+
+    it->second = i;
+
+    if (earlier->level != damage->level)
+	return;
+
+    const XRectangle &a = earlier->area;
+    const XRectangle &b = damage->area;
+
+    int x1 = std::min (a.x, b.x);
+    int y1 = std::min (a.y, b.y);
+    int x2 = std::max (a.x + a.width, b.x + b.width);
+    int y2 = std::max (a.y + a.height, b.y + b.height);
+
+    /* Doesn't fit an XRectangle */
+    if (x2 - x1 > 0xffff || y2 - y1 > 0xffff)
+	return;
+
+    XRectangle box;
+
+    box.x      = x1;
+    box.y      = y1;
+    box.width  = x2 - x1;
+    box.height = y2 - y1;
+
+    /* Two far apart rectangles would damage everything in between */
+    if (area (box) > area (a) + area (b))
+	return;
+
+    damage->area = box;
+    mEntries[previous].dropped = true;
+}
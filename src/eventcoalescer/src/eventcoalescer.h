@@ -0,0 +1,152 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_EVENT_COALESCER_H
+#define _COMPIZ_EVENT_COALESCER_H
+
+#include <X11/Xlib.h>
+
+#include <map>
+#include <vector>
+
+#include <boost/function.hpp>
+
+namespace compiz
+{
+namespace events
+{
+
+/**
+ * Holds the events read from the server in one go and drops the
+ * ones a later event makes redundant before they are dispatched.
+ *
+ * Ordering guarantees:
+ *
+ * - Events come out in the order they were pushed. Coalescing only
+ *   ever removes an event, a surviving event is never moved and
+ *   merged data is always written into the later event.
+ * - A MotionNotify is dropped when a later MotionNotify for the same
+ *   window follows with only non input events in between.
+ * - A ConfigureNotify is dropped when a later ConfigureNotify for the
+ *   same window and event window follows, with no ConfigureNotify for
+ *   any other window, no mapping or stacking change and no input
+ *   event in between. The window must not be waiting for a reply to
+ *   its own configure requests, see setConfigureIsExpected.
+ * - A DamageNotify is dropped when a later DamageNotify on the same
+ *   damage object follows with no ConfigureNotify, mapping or stacking
+ *   change and no input event in between. The later event gets the
+ *   bounding box of both areas, but only if that box covers no more
+ *   pixels than the two areas do, so damage never grows by much.
+ * - Input events (keys, buttons, crossing, focus, client messages,
+ *   XI2 and any extension event other than damage) and mapping or
+ *   stacking changes are never dropped and nothing is merged across
+ *   them.
+ *
+ * Any event type can be excluded from coalescing with inhibit ().
+ *
+ * Only events that canHold () accepts should be taken from Xlib ahead
+ * of time. Anything else ends the batch and is dispatched on its own,
+ * so code that looks for input or extension events in Xlib's queue
+ * with XIfEvent and friends still finds them there.
+ */
+class Coalescer
+{
+    public:
+
+	typedef boost::function <bool (const XConfigureEvent &)> ConfigureIsExpected;
+
+	Coalescer ();
+
+	/* The event type of XDamageNotify, damage is not coalesced
+	 * until this is set */
+	void setDamageEvent (int type);
+
+	/* Returns true if the ConfigureNotify answers a request the
+	 * window manager is still waiting for, those are never dropped */
+	void setConfigureIsExpected (const ConfigureIsExpected &);
+
+	/* Calls nest, events of type are passed through untouched
+	 * until every inhibit has been matched by an uninhibit */
+	void inhibit (int type);
+	void uninhibit (int type);
+	bool inhibited (int type) const;
+
+	/* Whether the event may be read ahead of the events before it
+	 * have been dispatched */
+	bool canHold (const XEvent &event) const;
+
+	void push (const XEvent &event);
+	void coalesce ();
+	bool pop (XEvent &event);
+	bool empty () const;
+
+	/* Drops events of type that were read but not dispatched yet */
+	void discard (int type);
+
+	/* Events pushed and events popped so far */
+	unsigned long long received () const { return mReceived; }
+	unsigned long long dispatched () const { return mDispatched; }
+
+    private:
+
+	enum Kind
+	{
+	    Passive,
+	    Motion,
+	    Configure,
+	    Damage,
+	    Barrier
+	};
+
+	struct Entry
+	{
+	    XEvent event;
+	    bool   dropped;
+	};
+
+	Kind kind (const XEvent &event) const;
+	void coalesceMotion (unsigned int);
+	void coalesceConfigure (unsigned int);
+	void coalesceDamage (unsigned int);
+
+	std::vector <Entry> mEntries;
+	unsigned int        mHead;
+
+	/* The last coalescing candidate of each kind, reset by barriers */
+	std::map <Window, unsigned int>        mMotion;
+	std::map <unsigned long, unsigned int> mDamage;
+	unsigned int                           mConfigure;
+	bool                                   mHaveConfigure;
+
+	int                 mDamageEvent;
+	ConfigureIsExpected mConfigureIsExpected;
+	std::map <int, unsigned int> mInhibited;
+
+	unsigned long long mReceived;
+	unsigned long long mDispatched;
+};
+
+}
+}
+
+#endif
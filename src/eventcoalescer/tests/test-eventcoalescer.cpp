@@ -0,0 +1,334 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <X11/Xlib.h>
+#include <X11/extensions/Xdamage.h>
+
+#include <cstring>
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include "eventcoalescer.h"
+
+using compiz::events::Coalescer;
+
+namespace
+{
+const int   DamageEventBase = 90;
+const Window root = 1;
+
+XEvent
+motion (Window w, int x, int y)
+{
+    XEvent event;
+
+    memset (&event, 0, sizeof (event));
+    event.xmotion.type   = MotionNotify;
+    event.xmotion.window = w;
+    event.xmotion.root   = root;
+    event.xmotion.x_root = x;
+    event.xmotion.y_root = y;
+
+    return event;
+}
+
+XEvent
+configure (Window w, int x, int y, Window above = None)
+{
+    XEvent event;
+
+    memset (&event, 0, sizeof (event));
+    event.xconfigure.type   = ConfigureNotify;
+    event.xconfigure.event  = root;
+    event.xconfigure.window = w;
+    event.xconfigure.x      = x;
+    event.xconfigure.y      = y;
+    event.xconfigure.width  = 100;
+    event.xconfigure.height = 100;
+    event.xconfigure.above  = above;
+
+    return event;
+}
+
+XEvent
+damage (Damage d, short x, short y, unsigned short width, unsigned short height)
+{
+    XEvent             event;
+    XDamageNotifyEvent *de = reinterpret_cast <XDamageNotifyEvent *> (&event);
+
+    memset (&event, 0, sizeof (event));
+    de->type        = DamageEventBase + XDamageNotify;
+    de->damage      = d;
+    de->drawable    = d + 1000;
+    de->area.x      = x;
+    de->area.y      = y;
+    de->area.width  = width;
+    de->area.height = height;
+
+    return event;
+}
+
+XEvent
+simple (int type, Window w)
+{
+    XEvent event;
+
+    memset (&event, 0, sizeof (event));
+    event.xany.type   = type;
+    event.xany.window = w;
+
+    return event;
+}
+
+bool
+expectedFor (Window expected, const XConfigureEvent &ce)
+{
+    return ce.window == expected;
+}
+}
+
+class EventCoalescerTest :
+    public ::testing::Test
+{
+    protected:
+
+	void SetUp ()
+	{
+	    coalescer.setDamageEvent (DamageEventBase + XDamageNotify);
+	}
+
+	void push (const XEvent &event)
+	{
+	    coalescer.push (event);
+	}
+
+	std::vector <XEvent> drain ()
+	{
+	    std::vector <XEvent> events;
+	    XEvent               event;
+
+	    coalescer.coalesce ();
+
+	    while (coalescer.pop (event))
+		events.push_back (event);
+
+	    return events;
+	}
+
+	Coalescer coalescer;
+};
+
+TEST_F (EventCoalescerTest, LastMotionPerWindowWins)
+{
+    push (motion (10, 1, 1));
+    push (motion (11, 5, 5));
+    push (motion (10, 2, 2));
+    push (motion (10, 3, 3));
+
+    std::vector <XEvent> events = drain ();
+
+    ASSERT_EQ (2u, events.size ());
+    EXPECT_EQ (11u, events[0].xmotion.window);
+    EXPECT_EQ (10u, events[1].xmotion.window);
+    EXPECT_EQ (3, events[1].xmotion.x_root);
+}
+
+TEST_F (EventCoalescerTest, MotionIsNotMergedAcrossInput)
+{
+    push (motion (10, 1, 1));
+    push (simple (ButtonPress, 10));
+    push (motion (10, 2, 2));
+    push (simple (PropertyNotify, 10));
+    push (motion (10, 3, 3));
+
+    std::vector <XEvent> events = drain ();
+
+    ASSERT_EQ (4u, events.size ());
+    EXPECT_EQ (MotionNotify, events[0].type);
+    EXPECT_EQ (ButtonPress, events[1].type);
+    EXPECT_EQ (PropertyNotify, events[2].type);
+    EXPECT_EQ (3, events[3].xmotion.x_root);
+}
+
+TEST_F (EventCoalescerTest, LastConfigureWins)
+{
+    push (configure (20, 0, 0));
+    push (configure (20, 10, 0));
+    push (simple (PropertyNotify, 20));
+    push (configure (20, 20, 0));
+
+    std::vector <XEvent> events = drain ();
+
+    ASSERT_EQ (2u, events.size ());
+    EXPECT_EQ (PropertyNotify, events[0].type);
+    EXPECT_EQ (20, events[1].xconfigure.x);
+}
+
+/* Restacking two windows relative to each other has to replay
+ * every step, dropping one would change the final stack */
+TEST_F (EventCoalescerTest, ConfigureIsNotMergedAcrossOtherWindows)
+{
+    push (configure (20, 0, 0, 30));
+    push (configure (21, 0, 0, 20));
+    push (configure (20, 0, 0, 40));
+
+    EXPECT_EQ (3u, drain ().size ());
+}
+
+TEST_F (EventCoalescerTest, ConfigureIsNotMergedAcrossMapping)
+{
+    push (configure (20, 0, 0));
+    push (simple (MapNotify, 21));
+    push (configure (20, 10, 0));
+
+    EXPECT_EQ (3u, drain ().size ());
+}
+
+TEST_F (EventCoalescerTest, ExpectedConfigureIsKept)
+{
+    coalescer.setConfigureIsExpected (boost::bind (expectedFor, 20, _1));
+
+    push (configure (20, 0, 0));
+    push (configure (20, 10, 0));
+    push (configure (21, 0, 0));
+    push (configure (21, 10, 0));
+
+    std::vector <XEvent> events = drain ();
+
+    ASSERT_EQ (3u, events.size ());
+    EXPECT_EQ (20u, events[0].xconfigure.window);
+    EXPECT_EQ (20u, events[1].xconfigure.window);
+    EXPECT_EQ (10, events[2].xconfigure.x);
+}
+
+TEST_F (EventCoalescerTest, OverlappingDamageIsUnioned)
+{
+    push (damage (5, 0, 0, 10, 10));
+    push (damage (5, 5, 0, 10, 10));
+    push (damage (6, 100, 100, 1, 1));
+    push (damage (5, 0, 0, 15, 10));
+
+    std::vector <XEvent> events = drain ();
+
+    ASSERT_EQ (2u, events.size ());
+
+    XDamageNotifyEvent *first = reinterpret_cast <XDamageNotifyEvent *> (&events[0]);
+    XDamageNotifyEvent *last = reinterpret_cast <XDamageNotifyEvent *> (&events[1]);
+
+    EXPECT_EQ (6u, first->damage);
+    EXPECT_EQ (5u, last->damage);
+    EXPECT_EQ (0, last->area.x);
+    EXPECT_EQ (0, last->area.y);
+    EXPECT_EQ (15, last->area.width);
+    EXPECT_EQ (10, last->area.height);
+}
+
+TEST_F (EventCoalescerTest, DistantDamageIsKeptApart)
+{
+    push (damage (5, 0, 0, 10, 10));
+    push (damage (5, 500, 500, 10, 10));
+
+    EXPECT_EQ (2u, drain ().size ());
+}
+
+TEST_F (EventCoalescerTest, DamageIsNotMergedAcrossConfigure)
+{
+    push (damage (5, 0, 0, 10, 10));
+    push (configure (20, 0, 0));
+    push (damage (5, 0, 0, 10, 10));
+
+    EXPECT_EQ (3u, drain ().size ());
+}
+
+TEST_F (EventCoalescerTest, InhibitedTypesPassThrough)
+{
+    coalescer.inhibit (MotionNotify);
+    coalescer.inhibit (MotionNotify);
+    coalescer.uninhibit (MotionNotify);
+
+    push (motion (10, 1, 1));
+    push (motion (10, 2, 2));
+    push (configure (20, 0, 0));
+    push (configure (20, 10, 0));
+
+    EXPECT_EQ (3u, drain ().size ());
+
+    coalescer.uninhibit (MotionNotify);
+    EXPECT_FALSE (coalescer.inhibited (MotionNotify));
+
+    push (motion (10, 1, 1));
+    push (motion (10, 2, 2));
+
+    EXPECT_EQ (1u, drain ().size ());
+}
+
+TEST_F (EventCoalescerTest, CountsReceivedAndDispatched)
+{
+    for (int i = 0; i < 10; ++i)
+	push (motion (10, i, i));
+
+    push (simple (KeyPress, 10));
+
+    EXPECT_FALSE (coalescer.empty ());
+    EXPECT_EQ (2u, drain ().size ());
+    EXPECT_TRUE (coalescer.empty ());
+    EXPECT_EQ (11u, coalescer.received ());
+    EXPECT_EQ (2u, coalescer.dispatched ());
+}
+
+TEST_F (EventCoalescerTest, UnknownExtensionEventsAreBarriers)
+{
+    push (damage (5, 0, 0, 10, 10));
+    push (simple (DamageEventBase + 7, 10));
+    push (damage (5, 0, 0, 10, 10));
+
+    EXPECT_EQ (3u, drain ().size ());
+}
+
+TEST_F (EventCoalescerTest, OnlyInputFreeEventsCanBeHeld)
+{
+    EXPECT_TRUE (coalescer.canHold (motion (10, 1, 1)));
+    EXPECT_TRUE (coalescer.canHold (configure (20, 0, 0)));
+    EXPECT_TRUE (coalescer.canHold (damage (5, 0, 0, 1, 1)));
+    EXPECT_TRUE (coalescer.canHold (simple (PropertyNotify, 10)));
+    EXPECT_FALSE (coalescer.canHold (simple (ButtonPress, 10)));
+    EXPECT_FALSE (coalescer.canHold (simple (MapNotify, 10)));
+    EXPECT_FALSE (coalescer.canHold (simple (DamageEventBase + 7, 10)));
+}
+
+TEST_F (EventCoalescerTest, DiscardDropsHeldEvents)
+{
+    push (motion (10, 1, 1));
+    push (simple (PropertyNotify, 10));
+    push (motion (11, 2, 2));
+
+    coalescer.discard (MotionNotify);
+
+    std::vector <XEvent> events = drain ();
+
+    ASSERT_EQ (1u, events.size ());
+    EXPECT_EQ (PropertyNotify, events[0].type);
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <X11/X.h>
+
+#include <cstring>
+
+#include "inputlatency.h"
+
+namespace ce = compiz::events;
+namespace cc = compiz::core;
+
+namespace
+{
+const int tracedTypes[] =
+{
+    KeyPress, KeyRelease, ButtonPress, ButtonRelease, MotionNotify
+};
+
+/* A server timestamp this much later than the calibration allows is
+ * taken to mean the server clock wrapped or jumped */
+const long long recalibrate = 10000000;
+
+unsigned int
+bucket (unsigned long long latency)
+{
+    unsigned long long ms = latency / 1000;
+    unsigned int       i = 0;
+
+    while (ms && i < cc::InputLatency::Buckets - 1)
+    {
+	ms >>= 1;
+	i++;
+    }
+
+    return i;
+}
+}
+
+const ce::LatencyTracker::Time ce::LatencyTracker::Horizon;
+const unsigned int ce::LatencyTracker::MaxWaiting;
+const unsigned int ce::LatencyTracker::Types;
+
+ce::LatencyTracker::LatencyTracker () :
+    calibrated (false),
+    offset (0)
+{
+    reset ();
+}
+
+int
+ce::LatencyTracker::index (int type)
+{
+    for (unsigned int i = 0; i < Types; i++)
+	if (tracedTypes[i] == type)
+	    return i;
+
+    return -1;
+}
+
+bool
+ce::LatencyTracker::traced (int type)
+{
+    return index (type) >= 0;
+}
+
+ce::LatencyTracker::Time
+ce::LatencyTracker::generated (unsigned long serverTime,
+			       Time          now)
+{
+    if (!serverTime)
+	return now;
+
+    long long behind = (long long) now - (long long) serverTime * 1000;
+
+    if (!calibrated || behind < offset || behind - offset > recalibrate)
+    {
+	offset     = behind;
+	calibrated = true;
+    }
+
+    return now - (behind - offset);
+}
+
+void
+ce::LatencyTracker::expire (Time now)
+{
+    std::vector<Event>::iterator it = waiting.begin ();
+
+    while (it != waiting.end () && now - it->arrival > Horizon)
+    {
+	totals[index (it->type)].unseen++;
+	++it;
+    }
+
+    waiting.erase (waiting.begin (), it);
+}
+
+void
+ce::LatencyTracker::arrived (int           type,
+			     unsigned long serverTime,
+			     Time          now)
+{
+    if (!traced (type))
+	return;
+
+    expire (now);
+
+    if (waiting.size () >= MaxWaiting)
+    {
+	totals[index (waiting.front ().type)].unseen++;
+	waiting.erase (waiting.begin ());
+    }
+
+    Event event;
+
+    event.type      = type;
+    event.generated = generated (serverTime, now);
+    event.arrival   = now;
+
+    waiting.push_back (event);
+}
+
+bool
+ce::LatencyTracker::awaitingDamage () const
+{
+    return !waiting.empty ();
+}
+
+void
+ce::LatencyTracker::damaged (Time now)
+{
+    expire (now);
+
+    settled.insert (settled.end (), waiting.begin (), waiting.end ());
+    waiting.clear ();
+}
+
+void
+ce::LatencyTracker::cutoff ()
+{
+    frame.insert (frame.end (), settled.begin (), settled.end ());
+    settled.clear ();
+}
+
+void
+ce::LatencyTracker::presented (Time now)
+{
+    for (std::vector<Event>::iterator it = frame.begin ();
+	 it != frame.end (); ++it)
+    {
+	Totals             &t = totals[index (it->type)];
+	unsigned long long latency = now > it->generated ?
+				     now - it->generated : 0;
+
+	t.events++;
+	t.latency  += latency;
+	t.delivery += it->arrival - it->generated;
+	t.histogram[bucket (latency)]++;
+
+	if (latency > t.worst)
+	    t.worst = latency;
+    }
+
+    frame.clear ();
+}
+
+void
+ce::LatencyTracker::statistics (std::vector<cc::InputLatency> &latencies) const
+{
+    latencies.resize (Types);
+
+    for (unsigned int i = 0; i < Types; i++)
+    {
+	const Totals     &t = totals[i];
+	cc::InputLatency &l = latencies[i];
+
+	l.type            = tracedTypes[i];
+	l.events          = t.events;
+	l.unseen          = t.unseen;
+	l.averageLatency  = t.events ? t.latency / t.events : 0;
+	l.worstLatency    = t.worst;
+	l.averageDelivery = t.events ? t.delivery / t.events : 0;
+
+	memcpy (l.histogram, t.histogram, sizeof (l.histogram));
+    }
+}
+
+void
+ce::LatencyTracker::reset ()
+{
+    memset (totals, 0, sizeof (totals));
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_INPUT_LATENCY_TRACKER_H
+#define _COMPIZ_INPUT_LATENCY_TRACKER_H
+
+#include <vector>
+
+#include <core/inputlatency.h>
+
+namespace compiz
+{
+namespace events
+{
+
+/**
+ * Follows key and pointer events from the server to the screen.
+ *
+ * An event waits until damage is added after it arrived, the first
+ * frame to stop taking damage after that is the one it shows up in,
+ * and its latency is taken when that frame's swap returns. Damage
+ * added for other reasons settles an event just the same, so what is
+ * recorded is the time to the first frame that could have shown it.
+ * Events that see no damage within Horizon are counted as unseen.
+ */
+class LatencyTracker
+{
+    public:
+
+	/* Microseconds on the monotonic clock */
+	typedef unsigned long long Time;
+
+	static const Time         Horizon    = 1000000;
+	static const unsigned int MaxWaiting = 256;
+
+	LatencyTracker ();
+
+	/* Whether events of this type are followed */
+	static bool traced (int type);
+
+	/* An event of a traced type was read at now, serverTime is its
+	 * timestamp in server milliseconds or 0 if it has none */
+	void arrived (int type, unsigned long serverTime, Time now);
+
+	/* Whether damage added now would settle any event */
+	bool awaitingDamage () const;
+
+	void damaged (Time now);
+
+	/* The frame about to be painted takes no more damage */
+	void cutoff ();
+
+	/* The swap of that frame returned at now */
+	void presented (Time now);
+
+	/* One entry for each traced type */
+	void statistics (std::vector<compiz::core::InputLatency> &) const;
+	void reset ();
+
+    private:
+
+	struct Event
+	{
+	    int  type;
+	    Time generated;
+	    Time arrival;
+	};
+
+	struct Totals
+	{
+	    unsigned int       events;
+	    unsigned int       unseen;
+	    unsigned long long latency;
+	    unsigned long long delivery;
+	    unsigned int       worst;
+	    unsigned int       histogram[compiz::core::InputLatency::Buckets];
+	};
+
+	static const unsigned int Types = 5;
+
+	static int index (int type);
+
+	Time generated (unsigned long serverTime, Time now);
+	void expire (Time now);
+
+	std::vector<Event> waiting;
+	std::vector<Event> settled;
+	std::vector<Event> frame;
+
+	/* How far the server clock is behind ours, taken from the event
+	 * that was quickest to reach us */
+	bool      calibrated;
+	long long offset;
+
+	Totals totals[Types];
+};
+
+}
+}
+
+#endif
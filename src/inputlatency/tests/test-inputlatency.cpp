@@ -0,0 +1,203 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <X11/X.h>
+
+#include <vector>
+
+#include "inputlatency.h"
+
+using compiz::events::LatencyTracker;
+using compiz::core::InputLatency;
+
+namespace
+{
+const InputLatency &
+latencyFor (const std::vector<InputLatency> &latencies, int type)
+{
+    for (unsigned int i = 0; i < latencies.size (); i++)
+	if (latencies[i].type == type)
+	    return latencies[i];
+
+    ADD_FAILURE () << "no entry for event type " << type;
+    return latencies.front ();
+}
+
+InputLatency
+statistics (const LatencyTracker &tracker, int type)
+{
+    std::vector<InputLatency> latencies;
+
+    tracker.statistics (latencies);
+    return latencyFor (latencies, type);
+}
+}
+
+TEST (InputLatency, OnlyInputEventsAreTraced)
+{
+    EXPECT_TRUE (LatencyTracker::traced (KeyPress));
+    EXPECT_TRUE (LatencyTracker::traced (ButtonRelease));
+    EXPECT_TRUE (LatencyTracker::traced (MotionNotify));
+    EXPECT_FALSE (LatencyTracker::traced (ConfigureNotify));
+    EXPECT_FALSE (LatencyTracker::traced (Expose));
+}
+
+TEST (InputLatency, EventIsMeasuredToTheSwapOfTheFrameShowingIt)
+{
+    LatencyTracker tracker;
+
+    tracker.arrived (KeyPress, 0, 1000);
+    tracker.damaged (1500);
+    tracker.cutoff ();
+    tracker.presented (6000);
+
+    InputLatency l = statistics (tracker, KeyPress);
+
+    EXPECT_EQ (1u, l.events);
+    EXPECT_EQ (5000u, l.averageLatency);
+    EXPECT_EQ (5000u, l.worstLatency);
+    EXPECT_EQ (0u, l.averageDelivery);
+    EXPECT_EQ (1u, l.histogram[3]);
+}
+
+TEST (InputLatency, DamageBeforeTheEventDoesNotSettleIt)
+{
+    LatencyTracker tracker;
+
+    tracker.damaged (1000);
+    tracker.arrived (MotionNotify, 0, 2000);
+    tracker.cutoff ();
+    tracker.presented (3000);
+
+    EXPECT_EQ (0u, statistics (tracker, MotionNotify).events);
+    EXPECT_TRUE (tracker.awaitingDamage ());
+
+    /* Damage added while the first frame was painted */
+    tracker.damaged (3500);
+    tracker.cutoff ();
+    tracker.presented (20000);
+
+    EXPECT_EQ (18000u, statistics (tracker, MotionNotify).worstLatency);
+    EXPECT_FALSE (tracker.awaitingDamage ());
+}
+
+TEST (InputLatency, DamageAfterTheCutoffGoesToTheNextFrame)
+{
+    LatencyTracker tracker;
+
+    tracker.arrived (ButtonPress, 0, 1000);
+    tracker.cutoff ();
+    tracker.damaged (2000);
+    tracker.presented (3000);
+
+    EXPECT_EQ (0u, statistics (tracker, ButtonPress).events);
+
+    tracker.cutoff ();
+    tracker.presented (9000);
+
+    EXPECT_EQ (8000u, statistics (tracker, ButtonPress).averageLatency);
+}
+
+TEST (InputLatency, ServerTimestampsAddTheTimeBeforeTheEventWasRead)
+{
+    LatencyTracker tracker;
+
+    /* The server clock runs 1000s behind ours, the first event is
+     * read the moment it was generated and the second 3ms late */
+    tracker.arrived (KeyPress, 5000, 1005000000ULL);
+    tracker.arrived (KeyPress, 5010, 1005013000ULL);
+    tracker.damaged (1005014000ULL);
+    tracker.cutoff ();
+    tracker.presented (1005020000ULL);
+
+    InputLatency l = statistics (tracker, KeyPress);
+
+    EXPECT_EQ (2u, l.events);
+    EXPECT_EQ (20000u, l.worstLatency);
+    EXPECT_EQ (1500u, l.averageDelivery);
+    EXPECT_EQ (1u, l.histogram[4]);
+    EXPECT_EQ (1u, l.histogram[5]);
+}
+
+TEST (InputLatency, EventsWithoutDamageAreGivenUpOn)
+{
+    LatencyTracker tracker;
+
+    tracker.arrived (KeyRelease, 0, 1000);
+    tracker.damaged (1000 + LatencyTracker::Horizon + 1);
+    tracker.cutoff ();
+    tracker.presented (1000 + LatencyTracker::Horizon + 2);
+
+    InputLatency l = statistics (tracker, KeyRelease);
+
+    EXPECT_EQ (0u, l.events);
+    EXPECT_EQ (1u, l.unseen);
+}
+
+TEST (InputLatency, WaitingEventsAreCapped)
+{
+    LatencyTracker tracker;
+
+    for (unsigned int i = 0; i < LatencyTracker::MaxWaiting + 10; i++)
+	tracker.arrived (MotionNotify, 0, 1000 + i);
+
+    tracker.damaged (5000);
+    tracker.cutoff ();
+    tracker.presented (6000);
+
+    InputLatency l = statistics (tracker, MotionNotify);
+
+    EXPECT_EQ (LatencyTracker::MaxWaiting, l.events);
+    EXPECT_EQ (10u, l.unseen);
+}
+
+TEST (InputLatency, SlowFramesLandInTheLastBucket)
+{
+    LatencyTracker tracker;
+
+    tracker.arrived (KeyPress, 0, 0);
+    tracker.damaged (1);
+    tracker.cutoff ();
+    tracker.presented (5000000);
+
+    EXPECT_EQ (1u, statistics (tracker, KeyPress).histogram[InputLatency::Buckets - 1]);
+}
+
+TEST (InputLatency, ResetClearsTheStatistics)
+{
+    LatencyTracker tracker;
+
+    tracker.arrived (KeyPress, 0, 1000);
+    tracker.damaged (1000);
+    tracker.cutoff ();
+    tracker.presented (2000);
+    tracker.reset ();
+
+    InputLatency l = statistics (tracker, KeyPress);
+
+    EXPECT_EQ (0u, l.events);
+    EXPECT_EQ (0u, l.worstLatency);
+    EXPECT_EQ (0u, l.histogram[1]);
+}
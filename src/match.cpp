@@ -149,6 +149,8 @@ matchUpdateMatchOptions (CompOption::Vector& options)
 void
 CompScreen::matchExpHandlerChanged ()
 {
+    ++PrivateMatch::expHandlerGeneration;
+
     WRAPABLE_HND_FUNCTN (matchExpHandlerChanged);
     _matchExpHandlerChanged ();
 }
@@ -166,6 +168,10 @@ CompScreenImpl::_matchExpHandlerChanged ()
 void
 CompScreen::matchPropertyChanged (CompWindow *w)
 {
+    /* Plugins wrapping this may evaluate matches for w before passing
+     * the call on, so the cached results have to go first */
+    PrivateMatch::windowChanged (w);
+
     WRAPABLE_HND_FUNCTN (matchPropertyChanged, w);
     _matchPropertyChanged (w);
 }
@@ -462,58 +468,6 @@ matchUpdateOps (MatchOp::List &list)
     }
 }
 
-static bool
-matchEvalOps (MatchOp::List &list,
-	      const CompWindow *w)
-{
-    bool       value, result = false;
-    MatchExpOp *exp;
-
-    foreach (MatchOp *op, list)
-    {
-	/* fast evaluation */
-	if (op->flags & MATCH_OP_AND_MASK)
-	{
-	    /* result will never be true */
-	    if (!result)
-		return false;
-	}
-	else
-	{
-	    /* result will always be true */
-	    if (result)
-		return true;
-	}
-
-	switch (op->type ()) {
-	    case MatchOp::TypeGroup:
-		value =
-		    matchEvalOps (dynamic_cast <MatchGroupOp *> (op)->op, w);
-		break;
-	    case MatchOp::TypeExp:
-		exp = dynamic_cast <MatchExpOp *> (op);
-		if (exp->e.get ())
-		    value = exp->e->evaluate (w);
-		else
-		    value = true;
-		break;
-	    default:
-		value = true;
-		break;
-	}
-
-	if (op->flags & MATCH_OP_NOT_MASK)
-	    value = !value;
-
-	if (op->flags & MATCH_OP_AND_MASK)
-	    result = (result && value);
-	else
-	    result = (result || value);
-    }
-
-    return result;
-}
-
 MatchOp::MatchOp () :
     flags (0)
 {
@@ -585,11 +539,188 @@ MatchGroupOp::operator= (const MatchGroupOp &gr)
     return *this;
 }
 
+MatchInstruction::MatchInstruction (Type                  type,
+				    CompMatch::Expression *exp) :
+    type (type),
+    exp (exp),
+    target (0)
+{
+}
+
+unsigned int PrivateMatch::expHandlerGeneration = 1;
+
+static std::vector<unsigned int> freeWindowSlots;
+static unsigned int              windowSlotCount = 0;
+static unsigned int              windowGeneration = 0;
+
+unsigned int
+PrivateMatch::allocateWindowSlot ()
+{
+    if (freeWindowSlots.empty ())
+	return windowSlotCount++;
+
+    unsigned int slot = freeWindowSlots.back ();
+    freeWindowSlots.pop_back ();
+
+    return slot;
+}
+
+void
+PrivateMatch::releaseWindowSlot (unsigned int slot)
+{
+    freeWindowSlots.push_back (slot);
+}
+
+unsigned int
+PrivateMatch::nextWindowGeneration ()
+{
+    /* 0 marks an unused cache entry */
+    if (++windowGeneration == 0)
+	++windowGeneration;
+
+    return windowGeneration;
+}
+
+void
+PrivateMatch::windowChanged (CompWindow *w)
+{
+    w->priv->matchGeneration = nextWindowGeneration ();
+}
+
 PrivateMatch::PrivateMatch () :
-    op ()
+    op (),
+    program (),
+    cache ()
 {
 }
 
+/*
+ * A group evaluates its ops left to right, each one replacing the
+ * result, but stops early once an AND op sees a false result or an
+ * OR op sees a true one. Nested groups leave their value in the same
+ * accumulator, so they are simply inlined.
+ */
+void
+PrivateMatch::compileGroup (const MatchOp::List &list)
+{
+    std::vector<MatchInstruction::Program::size_type> exits;
+    MatchExpOp                                        *exp;
+    bool                                              first = true;
+
+    program.push_back (MatchInstruction (MatchInstruction::Clear));
+
+    foreach (MatchOp *o, list)
+    {
+	if (o->flags & MATCH_OP_AND_MASK)
+	{
+	    exits.push_back (program.size ());
+	    program.push_back (MatchInstruction (MatchInstruction::JumpIfFalse));
+	}
+	else if (!first)
+	{
+	    exits.push_back (program.size ());
+	    program.push_back (MatchInstruction (MatchInstruction::JumpIfTrue));
+	}
+
+	first = false;
+
+	switch (o->type ()) {
+	    case MatchOp::TypeGroup:
+		compileGroup (static_cast <MatchGroupOp *> (o)->op);
+		break;
+	    case MatchOp::TypeExp:
+		exp = static_cast <MatchExpOp *> (o);
+		program.push_back (MatchInstruction (MatchInstruction::Evaluate,
+						     exp->e.get ()));
+		break;
+	    default:
+		program.push_back (MatchInstruction (MatchInstruction::Evaluate));
+		break;
+	}
+
+	if (o->flags & MATCH_OP_NOT_MASK)
+	    program.push_back (MatchInstruction (MatchInstruction::Invert));
+    }
+
+    foreach (MatchInstruction::Program::size_type i, exits)
+	program[i].target = program.size ();
+}
+
+void
+PrivateMatch::compile ()
+{
+    program.clear ();
+    cache.clear ();
+
+    compileGroup (op.op);
+}
+
+bool
+PrivateMatch::run (const CompWindow *w) const
+{
+    MatchInstruction::Program::size_type pc = 0, end = program.size ();
+    bool                                 result = false;
+
+    while (pc < end)
+    {
+	const MatchInstruction &i = program[pc++];
+
+	switch (i.type) {
+	    case MatchInstruction::Clear:
+		result = false;
+		break;
+	    case MatchInstruction::Evaluate:
+		result = i.exp ? i.exp->evaluate (w) : true;
+		break;
+	    case MatchInstruction::Invert:
+		result = !result;
+		break;
+	    case MatchInstruction::JumpIfFalse:
+		if (!result)
+		    pc = i.target;
+		break;
+	    case MatchInstruction::JumpIfTrue:
+		if (result)
+		    pc = i.target;
+		break;
+	}
+    }
+
+    return result;
+}
+
+/*
+ * Results are kept per window until matchPropertyChanged is called for
+ * it or matchExpHandlerChanged is called at all. The core properties
+ * CoreExp looks at are compared as well, since core does not always
+ * notify when it changes them (eg. while the window is being created).
+ */
+bool
+PrivateMatch::evaluate (const CompWindow *w)
+{
+    if (!w)
+	return run (w);
+
+    const PrivateWindow             *pw = w->priv;
+    compiz::match::ResultCache::Key key;
+    bool                            result;
+
+    key.windowGeneration  = pw->matchGeneration;
+    key.handlerGeneration = expHandlerGeneration;
+    key.state             = pw->state;
+    key.wmType            = pw->wmType;
+
+    if (cache.lookup (pw->matchSlot, key, result))
+	return result;
+
+    /* Expressions may end up evaluating other matches, or even this
+     * one, so only store once done running */
+    result = run (w);
+    cache.store (pw->matchSlot, key, result);
+
+    return result;
+}
+
 
 CompMatch::CompMatch () :
     priv (new PrivateMatch ())
@@ -620,12 +751,13 @@ CompMatch::update ()
 {
     matchResetOps (priv->op.op);
     matchUpdateOps (priv->op.op);
+    priv->compile ();
 }
 
 bool
 CompMatch::evaluate (const CompWindow *window) const
 {
-    return matchEvalOps (priv->op.op, window);
+    return priv->evaluate (window);
 }
 
 CompString
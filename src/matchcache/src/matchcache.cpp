@@ -0,0 +1,68 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "matchcache.h"
+
+namespace cm = compiz::match;
+
+bool
+cm::ResultCache::lookup (unsigned int slot,
+			 const Key    &key,
+			 bool         &result) const
+{
+    if (slot >= mEntries.size ())
+	return false;
+
+    const Entry &e = mEntries[slot];
+
+    if (e.key.windowGeneration  != key.windowGeneration  ||
+	e.key.handlerGeneration != key.handlerGeneration ||
+	e.key.state             != key.state             ||
+	e.key.wmType            != key.wmType)
+	return false;
+
+    result = e.result;
+
+    return true;
+}
+
+void
+cm::ResultCache::store (unsigned int slot,
+			const Key    &key,
+			bool         result)
+{
+    if (slot >= mEntries.size ())
+    {
+	Entry unused = { { 0, 0, 0, 0 }, false };
+	mEntries.resize (slot + 1, unused);
+    }
+
+    mEntries[slot].key    = key;
+    mEntries[slot].result = result;
+}
+
+void
+cm::ResultCache::clear ()
+{
+    mEntries.clear ();
+}
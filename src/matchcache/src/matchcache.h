@@ -0,0 +1,79 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_MATCH_CACHE_H
+#define _COMPIZ_MATCH_CACHE_H
+
+#include <vector>
+
+namespace compiz
+{
+namespace match
+{
+
+/**
+ * The last result of one match for every window.
+ *
+ * Windows are told apart by a slot of their own. A result stays
+ * valid as long as everything it was worked out from is the same,
+ * see Key. A match whose expressions change has to clear () it.
+ */
+class ResultCache
+{
+    public:
+
+	/* What a result depends on besides the match */
+	struct Key
+	{
+	    /* Changes whenever matchPropertyChanged is called for
+	     * the window, 0 is never used */
+	    unsigned int windowGeneration;
+	    /* Changes whenever matchExpHandlerChanged is called */
+	    unsigned int handlerGeneration;
+	    /* Core doesn't always notify when it changes these */
+	    unsigned int state;
+	    unsigned int wmType;
+	};
+
+	/* Whether a result for key is known, result is set if so */
+	bool lookup (unsigned int slot, const Key &key, bool &result) const;
+
+	void store (unsigned int slot, const Key &key, bool result);
+
+	void clear ();
+
+    private:
+
+	struct Entry
+	{
+	    Key  key;
+	    bool result;
+	};
+
+	std::vector <Entry> mEntries;
+};
+
+}
+}
+
+#endif
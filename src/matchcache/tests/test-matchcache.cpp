@@ -0,0 +1,134 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "matchcache.h"
+
+using compiz::match::ResultCache;
+
+namespace
+{
+ResultCache::Key
+key (unsigned int windowGeneration,
+     unsigned int handlerGeneration = 1,
+     unsigned int state = 0,
+     unsigned int wmType = 0)
+{
+    ResultCache::Key k = { windowGeneration, handlerGeneration,
+			   state, wmType };
+
+    return k;
+}
+}
+
+class CompizMatchCacheTest :
+    public ::testing::Test
+{
+    protected:
+
+	ResultCache cache;
+};
+
+TEST_F (CompizMatchCacheTest, NothingIsKnownAtFirst)
+{
+    bool result;
+
+    EXPECT_FALSE (cache.lookup (0, key (1), result));
+    EXPECT_FALSE (cache.lookup (7, key (1), result));
+}
+
+TEST_F (CompizMatchCacheTest, StoredResultIsAHit)
+{
+    bool result = false;
+
+    cache.store (3, key (5), true);
+
+    ASSERT_TRUE (cache.lookup (3, key (5), result));
+    EXPECT_TRUE (result);
+
+    cache.store (3, key (5), false);
+
+    ASSERT_TRUE (cache.lookup (3, key (5), result));
+    EXPECT_FALSE (result);
+}
+
+TEST_F (CompizMatchCacheTest, WindowsHaveTheirOwnResults)
+{
+    bool result;
+
+    cache.store (0, key (1), true);
+    cache.store (1, key (2), false);
+
+    ASSERT_TRUE (cache.lookup (0, key (1), result));
+    EXPECT_TRUE (result);
+    ASSERT_TRUE (cache.lookup (1, key (2), result));
+    EXPECT_FALSE (result);
+
+    /* A slot reused by a new window comes with a new generation */
+    EXPECT_FALSE (cache.lookup (1, key (3), result));
+}
+
+/* CompMatch::update () clears the cache whenever the match string
+ * is set again */
+TEST_F (CompizMatchCacheTest, NewMatchStringForgetsResults)
+{
+    bool result;
+
+    cache.store (0, key (1), true);
+    cache.store (4, key (2), false);
+    cache.clear ();
+
+    EXPECT_FALSE (cache.lookup (0, key (1), result));
+    EXPECT_FALSE (cache.lookup (4, key (2), result));
+}
+
+/* matchPropertyChanged gives the window a new generation */
+TEST_F (CompizMatchCacheTest, ChangedWindowPropertiesAreAMiss)
+{
+    bool result;
+
+    cache.store (0, key (1), true);
+
+    EXPECT_FALSE (cache.lookup (0, key (2), result));
+}
+
+TEST_F (CompizMatchCacheTest, ChangedExpressionHandlersAreAMiss)
+{
+    bool result;
+
+    cache.store (0, key (1, 1), true);
+
+    EXPECT_FALSE (cache.lookup (0, key (1, 2), result));
+}
+
+TEST_F (CompizMatchCacheTest, ChangedStateOrTypeIsAMiss)
+{
+    bool result;
+
+    cache.store (0, key (1, 1, 0, 0), true);
+
+    EXPECT_FALSE (cache.lookup (0, key (1, 1, 4, 0), result));
+    EXPECT_FALSE (cache.lookup (0, key (1, 1, 0, 2), result));
+    EXPECT_TRUE (cache.lookup (0, key (1, 1, 0, 0), result));
+}
@@ -37,7 +37,8 @@ class PluginClassIndex {
     public:
 	PluginClassIndex () : index ((unsigned)~0), refCount (0),
 			      initiated (false), failed (false),
-			      pcFailed (false), pcIndex (0) {}
+			      pcFailed (false), pcIndex (0),
+			      key ((unsigned)~0) {}
 
 	unsigned int index;
 	int          refCount;
@@ -45,6 +46,7 @@ class PluginClassIndex {
 	bool         failed;
 	bool         pcFailed;
 	unsigned int pcIndex;
+	unsigned int key;
 };
 
 /**
@@ -122,6 +122,19 @@ class PluginClassHandler
 	    return compPrintf ("%s_index_%lu", typeid (Tp).name (), ABI);
 	}
 
+	/**
+	 * Returns the number ValueHolder uses for keyName (). The
+	 * string is only built the first time, after that looking up
+	 * the index of this plugin class is an array access.
+	 */
+	static unsigned int key ()
+	{
+	    if (mIndex.key == (unsigned) ~0)
+		mIndex.key = ValueHolder::keyIndex (keyName ());
+
+	    return mIndex.key;
+	}
+
 	/**
 	 * Actually initializes the index of this plugin class
 	 * by allocating a new index for plugin class storage
@@ -229,9 +242,9 @@ PluginClassHandler<Tp,Tb,ABI>::initializeIndex (Tb *base)
 	/* Also store the index value inside of ValueHolder for this plugin-base
 	 * combination so that we can fetch it later should the index location
 	 * change */
-	if (!ValueHolder::Default ()->hasValue (keyName ()))
+	if (!ValueHolder::Default ()->hasValue (key ()))
 	{
-	    ValueHolder::Default ()->storeValue (keyName (), p);
+	    ValueHolder::Default ()->storeValue (key (), p);
 	    pluginClassHandlerIndex++;
 	}
 	else
@@ -275,7 +288,7 @@ PluginClassHandler<Tp,Tb,ABI>::~PluginClassHandler ()
 	    mIndex.initiated = false;
 	    mIndex.failed = false;
 	    mIndex.pcIndex = pluginClassHandlerIndex;
-	    ValueHolder::Default ()->eraseValue (keyName ());
+	    ValueHolder::Default ()->eraseValue (key ());
 	    pluginClassHandlerIndex++;
 	}
     }
@@ -340,7 +353,9 @@ PluginClassHandler<Tp,Tb,ABI>::get (Tb *base)
 
     /* If pluginClassHandlerIndex == mIndex.pcIndex it means that our
      * mIndex.index is fresh and can be used directly without needing
-     * to fetch it from ValueHolder */
+     * to fetch it from ValueHolder. Otherwise another plugin class
+     * came or went, and ValueHolder has the current index under the
+     * number for our key */
     if (mIndex.initiated && pluginClassHandlerIndex == mIndex.pcIndex)
 	return getInstance (base);
 
@@ -349,9 +364,9 @@ PluginClassHandler<Tp,Tb,ABI>::get (Tb *base)
     if (mIndex.failed && pluginClassHandlerIndex == mIndex.pcIndex)
 	return NULL;
 
-    if (ValueHolder::Default ()->hasValue (keyName ()))
+    if (ValueHolder::Default ()->hasValue (key ()))
     {
-	mIndex.index     = ValueHolder::Default ()->getValue (keyName ()).uval;
+	mIndex.index     = ValueHolder::Default ()->getValue (key ()).uval;
 	mIndex.initiated = true;
 	mIndex.failed    = false;
 	mIndex.pcIndex = pluginClassHandlerIndex;
@@ -46,6 +46,22 @@ class ValueHolder : boost::noncopyable
 	void storeValue (CompString key, CompPrivate value);
 	CompPrivate getValue (CompString key);
 
+	/**
+	 * The same operations on a key already turned into a number
+	 * with keyIndex (), so no string has to be built or compared
+	 */
+	void eraseValue (unsigned int key);
+	bool hasValue (unsigned int key) const;
+	void storeValue (unsigned int key, CompPrivate value);
+	CompPrivate getValue (unsigned int key) const;
+
+	/**
+	 * Returns the number standing for key. Numbers are shared by
+	 * every ValueHolder in the process and never change, so callers
+	 * only need to look a key up once.
+	 */
+	static unsigned int keyIndex (const CompString &key);
+
 	static ValueHolder * Default ();
 	static void SetDefault (ValueHolder *);
 
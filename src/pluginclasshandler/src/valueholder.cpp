@@ -25,17 +25,48 @@
 
 #include <core/valueholder.h>
 #include <map>
+#include <vector>
 
 namespace
 {
   static ValueHolder *gDefault;
+
+  typedef std::map<CompString, unsigned int> KeyMap;
+
+  /* Keys are numbered once for the whole process */
+  KeyMap &
+  keys ()
+  {
+      static KeyMap keyMap;
+      return keyMap;
+  }
+
+  bool
+  findKey (const CompString &key, unsigned int &index)
+  {
+      KeyMap::const_iterator it = keys ().find (key);
+
+      if (it == keys ().end ())
+	  return false;
+
+      index = it->second;
+      return true;
+  }
 }
 
 class PrivateValueHolder
 {
     public:
 
-	std::map<CompString, CompPrivate> valueMap;
+	struct Value
+	{
+	    Value () : stored (false) { value.uval = 0; }
+
+	    CompPrivate value;
+	    bool        stored;
+	};
+
+	std::vector<Value> values;
 };
 
 ValueHolder::ValueHolder () :
@@ -60,56 +91,88 @@ ValueHolder::SetDefault (ValueHolder *v)
     gDefault = v;
 }
 
-void
-ValueHolder::storeValue (CompString key, CompPrivate value)
+unsigned int
+ValueHolder::keyIndex (const CompString &key)
 {
-    std::map<CompString,CompPrivate>::iterator it;
+    unsigned int index;
 
-    it = priv->valueMap.find (key);
-
-    if (it != priv->valueMap.end ())
-    {
-	it->second = value;
-    }
-    else
+    if (!findKey (key, index))
     {
-	priv->valueMap.insert (std::pair<CompString,CompPrivate> (key, value));
+	index = keys ().size ();
+	keys ()[key] = index;
     }
+
+    return index;
+}
+
+void
+ValueHolder::storeValue (CompString key, CompPrivate value)
+{
+    storeValue (keyIndex (key), value);
 }
 
 void
 ValueHolder::eraseValue (CompString key)
 {
-    std::map<CompString,CompPrivate>::iterator it;
-    it = priv->valueMap.find (key);
+    unsigned int index;
 
-    if (it != priv->valueMap.end ())
-    {
-	priv->valueMap.erase (key);
-    }
+    if (findKey (key, index))
+	eraseValue (index);
 }
 
 bool
 ValueHolder::hasValue (CompString key)
 {
-    return (priv->valueMap.find (key) != priv->valueMap.end ());
+    unsigned int index;
+
+    return findKey (key, index) && hasValue (index);
 }
 
 CompPrivate
 ValueHolder::getValue (CompString key)
 {
+    unsigned int index;
+
+    if (findKey (key, index))
+	return getValue (index);
+
     CompPrivate p;
+    p.uval = 0;
 
-    std::map<CompString,CompPrivate>::iterator it;
-    it = priv->valueMap.find (key);
+    return p;
+}
 
-    if (it != priv->valueMap.end ())
-    {
-	return it->second;
-    }
-    else
-    {
-	p.uval = 0;
-	return p;
-    }
+void
+ValueHolder::storeValue (unsigned int key, CompPrivate value)
+{
+    if (key >= priv->values.size ())
+	priv->values.resize (key + 1);
+
+    priv->values[key].value  = value;
+    priv->values[key].stored = true;
+}
+
+void
+ValueHolder::eraseValue (unsigned int key)
+{
+    if (key < priv->values.size ())
+	priv->values[key] = PrivateValueHolder::Value ();
+}
+
+bool
+ValueHolder::hasValue (unsigned int key) const
+{
+    return key < priv->values.size () && priv->values[key].stored;
+}
+
+CompPrivate
+ValueHolder::getValue (unsigned int key) const
+{
+    if (key < priv->values.size ())
+	return priv->values[key].value;
+
+    CompPrivate p;
+    p.uval = 0;
+
+    return p;
 }
@@ -0,0 +1,218 @@
+/*
+ * Times PluginClassHandler::get () on 100 windows while other plugins
+ * are loaded and unloaded, which makes every plugin class look its
+ * index up again.
+ *
+ * The worst case bumps pluginClassHandlerIndex before every get ().
+ * For comparison the same lookup is done through the string keyed
+ * ValueHolder functions, as get () used to do.
+ *
+ * Run compiz_pch_benchmark [iterations]
+ */
+
+#include <core/pluginclasshandler.h>
+#include <core/pluginclasses.h>
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <list>
+
+unsigned int pluginClassHandlerIndex = 0;
+bool	     debugOutput;
+char	     *programName;
+
+namespace cpi = compiz::plugin::internal;
+
+namespace compiz
+{
+namespace plugin
+{
+namespace internal
+{
+class PluginKey
+{
+};
+}
+}
+}
+
+namespace
+{
+
+const unsigned int nBases (100);
+
+PluginClassStorage::Indices indices (0);
+
+class Base :
+    public PluginClassStorage
+{
+    public:
+
+	Base () :
+	    PluginClassStorage (indices)
+	{
+	    bases.push_back (this);
+	}
+
+	~Base ()
+	{
+	    bases.remove (this);
+	}
+
+	static unsigned int allocPluginClassIndex ()
+	{
+	    unsigned int i = allocatePluginClassIndex (indices);
+	    resize ();
+	    return i;
+	}
+
+	static void freePluginClassIndex (unsigned int index)
+	{
+	    PluginClassStorage::freePluginClassIndex (indices, index);
+	    resize ();
+	}
+
+    private:
+
+	static void resize ()
+	{
+	    for (std::list<Base *>::iterator it = bases.begin ();
+		 it != bases.end (); ++it)
+		(*it)->pluginClasses.resize (indices.size ());
+	}
+
+	static std::list<Base *> bases;
+};
+
+std::list<Base *> Base::bases;
+
+class PaintPlugin :
+    public PluginClassHandler <PaintPlugin, Base>
+{
+    public:
+	PaintPlugin (Base *base) :
+	    PluginClassHandler <PaintPlugin, Base> (base)
+	{
+	}
+};
+
+class ReloadedPlugin :
+    public PluginClassHandler <ReloadedPlugin, Base>
+{
+    public:
+	ReloadedPlugin (Base *base) :
+	    PluginClassHandler <ReloadedPlugin, Base> (base)
+	{
+	}
+};
+
+double
+now ()
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* Keeps the optimiser from throwing the work away */
+volatile unsigned long sink;
+
+}
+
+int
+main (int argc, char **argv)
+{
+    int              iterations = argc > 1 ? atoi (argv[1]) : 2000000;
+    ValueHolder      holder;
+    cpi::PluginKey   key;
+    Base             *bases[nBases];
+    ReloadedPlugin   *reloaded[nBases];
+
+    ValueHolder::SetDefault (&holder);
+
+    cpi::LoadedPluginClassBridge <PaintPlugin, Base>::allowInstantiations (key);
+    cpi::LoadedPluginClassBridge <ReloadedPlugin, Base>::allowInstantiations (key);
+
+    for (unsigned int i = 0; i < nBases; ++i)
+    {
+	bases[i] = new Base ();
+	new PaintPlugin (bases[i]);
+    }
+
+    printf ("%u bases, %d iterations\n", nBases, iterations);
+
+    /* Nothing changes between calls */
+    double start = now ();
+
+    for (int n = 0; n < iterations; ++n)
+	sink += (unsigned long) PaintPlugin::get (bases[n % nBases]);
+
+    double steadyTime = now () - start;
+
+    /* Every call sees a new plugin class generation */
+    start = now ();
+
+    for (int n = 0; n < iterations; ++n)
+    {
+	++pluginClassHandlerIndex;
+	sink += (unsigned long) PaintPlugin::get (bases[n % nBases]);
+    }
+
+    double staleTime = now () - start;
+
+    /* The same refresh through string keys */
+    start = now ();
+
+    for (int n = 0; n < iterations; ++n)
+    {
+	CompString name = compPrintf ("%s_index_%lu",
+				      typeid (PaintPlugin).name (), 0);
+
+	if (holder.hasValue (name))
+	    sink += holder.getValue (compPrintf ("%s_index_%lu",
+						 typeid (PaintPlugin).name (),
+						 0)).uval;
+    }
+
+    double stringTime = now () - start;
+
+    /* Load and unload a plugin class on every base, then paint */
+    int reloads = iterations / nBases / 10;
+
+    start = now ();
+
+    for (int n = 0; n < reloads; ++n)
+    {
+	for (unsigned int i = 0; i < nBases; ++i)
+	    reloaded[i] = new ReloadedPlugin (bases[i]);
+
+	for (unsigned int i = 0; i < nBases; ++i)
+	    delete reloaded[i];
+
+	for (unsigned int i = 0; i < nBases * 10; ++i)
+	    sink += (unsigned long) PaintPlugin::get (bases[i % nBases]);
+    }
+
+    double reloadTime = now () - start;
+
+    printf ("%-30s %8.2f ns/get\n", "unchanged",
+	    steadyTime * 1000000.0 / iterations);
+    printf ("%-30s %8.2f ns/get\n", "new generation every get",
+	    staleTime * 1000000.0 / iterations);
+    printf ("%-30s %8.2f ns/get\n", "string key lookup",
+	    stringTime * 1000000.0 / iterations);
+    printf ("%-30s %8.2f us/reload (%d reloads)\n", "reload and paint",
+	    reloadTime * 1000.0 / reloads, reloads);
+
+    for (unsigned int i = 0; i < nBases; ++i)
+    {
+	delete PaintPlugin::get (bases[i]);
+	delete bases[i];
+    }
+
+    ValueHolder::SetDefault (NULL);
+
+    return 0;
+}
@@ -86,3 +86,63 @@ TEST_F (PluginClassHandlerGet, TestGetNoInstantiationsAllowed)
 
     EXPECT_THAT (p, IsNull ());
 }
+
+class OtherPlugin :
+    public Plugin,
+    public PluginClassHandler <OtherPlugin, Base>
+{
+    public:
+	OtherPlugin (Base *);
+};
+
+OtherPlugin::OtherPlugin (Base *base):
+    Plugin (base),
+    PluginClassHandler <OtherPlugin, Base> (base)
+{
+}
+
+TEST_F (PluginClassHandlerGet, TestGetAfterOtherPluginClassesComeAndGo)
+{
+    cpi::LoadedPluginClassBridge <OtherPlugin, Base>::allowInstantiations (key);
+
+    bases.push_back (new Base ());
+
+    /* Takes the first index, so GetPlugin ends up at a later one */
+    OtherPlugin *other = new OtherPlugin (bases.back ());
+
+    plugins.push_back (new GetPlugin (bases.back ()));
+    EXPECT_EQ (plugins.back (), GetPlugin::get (bases.back ()));
+
+    unsigned int generation = pluginClassHandlerIndex;
+
+    delete other;
+    EXPECT_NE (generation, pluginClassHandlerIndex);
+    EXPECT_EQ (plugins.back (), GetPlugin::get (bases.back ()));
+
+    other = new OtherPlugin (bases.back ());
+    EXPECT_EQ (other, OtherPlugin::get (bases.back ()));
+    EXPECT_EQ (plugins.back (), GetPlugin::get (bases.back ()));
+
+    delete other;
+
+    cpi::LoadedPluginClassBridge <OtherPlugin, Base>::disallowInstantiations (key);
+}
+
+TEST_F (PluginClassHandlerGet, TestValueHolderKeysMatchStrings)
+{
+    unsigned int index = ValueHolder::keyIndex ("test_index_0");
+    CompPrivate  p;
+
+    EXPECT_EQ (index, ValueHolder::keyIndex ("test_index_0"));
+    EXPECT_NE (index, ValueHolder::keyIndex ("test_index_1"));
+
+    p.uval = 42;
+    global->storeValue ("test_index_0", p);
+
+    ASSERT_TRUE (global->hasValue (index));
+    EXPECT_EQ (42u, global->getValue (index).uval);
+
+    global->eraseValue (index);
+    EXPECT_FALSE (global->hasValue ("test_index_0"));
+    EXPECT_FALSE (global->hasValue (ValueHolder::keyIndex ("test_index_1")));
+}
@@ -30,6 +30,9 @@
 
 #include <core/match.h>
 #include <boost/shared_ptr.hpp>
+#include <vector>
+
+#include "matchcache.h"
 
 #define MATCH_OP_AND_MASK (1 << 0)
 #define MATCH_OP_NOT_MASK (1 << 1)
@@ -77,12 +80,59 @@ class MatchGroupOp : public MatchOp {
 	MatchOp::List op;
 };
 
+/*
+ * CompMatch::update flattens the op tree into a list of these, so
+ * evaluating a match is a single loop over an accumulator instead of
+ * a recursive walk with a dynamic_cast per node.
+ */
+class MatchInstruction {
+    public:
+	typedef enum {
+	    Clear,	  /* result = false */
+	    Evaluate,	  /* result = exp ? exp->evaluate (w) : true */
+	    Invert,	  /* result = !result */
+	    JumpIfFalse,  /* continue at target if result is false */
+	    JumpIfTrue	  /* continue at target if result is true */
+	} Type;
+
+	typedef std::vector<MatchInstruction> Program;
+
+	MatchInstruction (Type type,
+			  CompMatch::Expression *exp = NULL);
+
+	Type                  type;
+	CompMatch::Expression *exp;
+	Program::size_type    target;
+};
+
 class PrivateMatch {
     public:
 	PrivateMatch ();
 
+	void compile ();
+	bool evaluate (const CompWindow *w);
+
+	/* Every window owns a slot in the result cache of each match,
+	 * and a generation which changes whenever matchPropertyChanged
+	 * is called for it */
+	static unsigned int allocateWindowSlot ();
+	static void releaseWindowSlot (unsigned int slot);
+	static unsigned int nextWindowGeneration ();
+	static void windowChanged (CompWindow *w);
+
+	/* Bumped by matchExpHandlerChanged, invalidates every cache */
+	static unsigned int expHandlerGeneration;
+
+    private:
+	void compileGroup (const MatchOp::List &list);
+	bool run (const CompWindow *w) const;
+
     public:
 	MatchGroupOp op;
+
+    private:
+	MatchInstruction::Program program;
+	compiz::match::ResultCache cache;
 };
 
 #endif
@@ -44,6 +44,12 @@
 #include "privateeventsource.h"
 #include "privatesignalsource.h"
 #include "outputdevices.h"
+#include "eventcoalescer.h"
+#include "inputlatency.h"
+#include "windowidmap.h"
+#include "windowstackorder.h"
+#include "windowpaintorder.h"
+#include "windowspatialindex.h"
 
 #include "core_options.h"
 
@@ -124,7 +130,7 @@ class WindowManager : boost::noncopyable
 	void removeGroup (CompGroup *group);
 	CompGroup * findGroup (Window id);
 
-	void eraseWindowFromMap (Window id);
+	void eraseWindowFromMap (CompWindow *w);
 	void removeDestroyed ();
 
 	void updateClientList (PrivateScreen& ps);
@@ -139,21 +145,15 @@ class WindowManager : boost::noncopyable
 	    { return clientListStacking; }
 
 	CompWindow * findWindow (Window id) const;
+	CompWindow * findFrame (Window frame) const;
+	CompWindow * findServerFrame (Window serverFrame) const;
 	CompWindow * getTopWindow() const;
 	CompWindow * getTopServerWindow() const;
 
-
-	void removeFromFindWindowCache(CompWindow* w)
-	{
-	    if (w == lastFoundWindow)
-		lastFoundWindow = 0;
-	}
-
-	void addWindowToMap(CompWindow* w)
-	{
-	    if (w->id () != 1)
-		windowsMap[w->id ()] = w;
-	}
+	void addWindowToMap(CompWindow* w);
+	void updateFrameWindows (CompWindow *w,
+				 Window     oldFrame,
+				 Window     oldServerFrame);
 
 	void validateServerWindows();
 
@@ -165,6 +165,18 @@ class WindowManager : boost::noncopyable
 
 	CompWindowList& getDestroyedWindows()	{ return destroyedWindows; }
 
+	const CompWindowList& getPaintOrder() const { return paintOrder.list (); }
+	unsigned int getPaintOrderGeneration() const { return paintOrder.generation (); }
+	void freezePaintOrder() { paintOrder.freeze (); }
+	void thawPaintOrder() { paintOrder.thaw (); }
+	void removeFromPaintOrder(CompWindow *w) { paintOrder.remove (w); }
+
+	void setSpatialBounds (const CompRect &bounds);
+	void updateSpatialIndex (CompWindow *w);
+	void removeFromSpatialIndex(CompWindow *w) { spatialIndex.remove (w); }
+	void findWindowsInRect (const CompRect &rect, CompWindowVector &windows);
+	void findWindowsAt (const CompPoint &point, CompWindowVector &windows);
+
 	void insertServerWindow(CompWindow* w, Window aboveId);
 	void unhookServerWindow(CompWindow *w);
 	CompWindowList& getServerWindows()	{ return serverWindows; }
@@ -194,12 +206,44 @@ class WindowManager : boost::noncopyable
 	}
 
     private:
+	typedef compiz::window::IdMap<CompWindow *>      WindowIdMap;
+	typedef compiz::window::StackOrder<CompWindow *> WindowStackOrder;
+
 	CompWindowList windows;
 	CompWindowList serverWindows;
 	CompWindowList destroyedWindows;
 	bool           stackIsFresh;
 
-	CompWindow::Map windowsMap;
+	/* Windows in the stack by id, and by the frame ids the
+	 * client and server side stacks use for them */
+	WindowIdMap windowsMap;
+	WindowIdMap framesMap;
+	WindowIdMap serverFramesMap;
+
+	WindowStackOrder stackOrder;
+	WindowStackOrder serverStackOrder;
+
+	static unsigned long long & stackLabelOf (CompWindow *w);
+	static unsigned long long & serverStackLabelOf (CompWindow *w);
+
+	/* The stack with the destroyed windows that are still
+	 * painted in between, what composite paints */
+	typedef compiz::window::PaintOrder<CompWindow *> WindowPaintOrder;
+
+	WindowPaintOrder paintOrder;
+
+	static WindowPaintOrder::Entry & paintEntryOf (CompWindow *w);
+	static CompWindow * paintBelowOf (CompWindow *w);
+	static bool paintHeldBelow (CompWindow *dw, CompWindow *w);
+
+	/* The output rects of all windows, destroyed ones included
+	 * until they are deleted */
+	typedef compiz::window::SpatialIndex<CompWindow *> WindowSpatialIndex;
+
+	WindowSpatialIndex spatialIndex;
+
+	static WindowSpatialIndex::Entry & spatialEntryOf (CompWindow *w);
+
 	std::list<CompGroup *> groups;
 
 	CompWindowVector clientList;            /* clients in mapping order */
@@ -209,8 +253,6 @@ class WindowManager : boost::noncopyable
 	std::vector<Window> clientIdListStacking;/* client ids in stacking order */
 
 	unsigned int pendingDestroys;
-
-	mutable CompWindow* lastFoundWindow;
 };
 
 unsigned int windowStateFromString (const char *str);
@@ -616,6 +658,8 @@ class PrivateScreen :
 	bool getNextXEvent (XEvent &);
 	void processEvents ();
 
+	bool expectsConfigureNotify (const XConfigureEvent &);
+
 	bool triggerButtonPressBindings (CompOption::Vector &options,
 					 XButtonEvent       *event,
 					 CompOption::Vector &arguments);
@@ -672,6 +716,10 @@ class PrivateScreen :
 
 	void setVirtualScreenSize (int hsize, int vsize);
 
+	/* Covers everywhere the windows on some viewport can be,
+	 * whichever viewport is current */
+	void updateSpatialBounds ();
+
 	void updateScreenEdges ();
 
 	void reshape (int w, int h);
@@ -749,6 +797,8 @@ public:
     compiz::private_screen::ViewPort viewPort;
     compiz::private_screen::StartupSequenceImpl startupSequence;
     compiz::private_screen::EventManager eventManager;
+    compiz::events::Coalescer eventCoalescer;
+    compiz::events::LatencyTracker inputLatency;
     compiz::private_screen::OrphanData orphanData;
     compiz::core::OutputDevices outputDevices;
 
@@ -937,6 +987,15 @@ class CompScreenImpl : public CompScreen,
 	CompWindowList & serverWindows ();
 	CompWindowList & destroyedWindows ();
 
+	const CompWindowList & windowPaintOrder ();
+	unsigned int windowPaintOrderGeneration ();
+	void freezeWindowPaintOrder ();
+	void thawWindowPaintOrder ();
+
+	void updateWindowOutputRect (CompWindow *w);
+	void findWindowsInRect (const CompRect &rect, CompWindowVector &windows);
+	void findWindowsAt (const CompPoint &point, CompWindowVector &windows);
+
 	void warpPointer (int dx, int dy);
 
 	Time getCurrentTime ();
@@ -953,6 +1012,10 @@ class CompScreenImpl : public CompScreen,
 	void insertServerWindow (CompWindow *w, Window aboveId);
 	void unhookServerWindow (CompWindow *w);
 
+	void updateFrameWindows (CompWindow *w,
+				 Window     oldFrame,
+				 Window     oldServerFrame);
+
 	Cursor normalCursor ();
 
 	Cursor invisibleCursor ();
@@ -1051,6 +1114,15 @@ class CompScreenImpl : public CompScreen,
 	virtual void addToDestroyedWindows(CompWindow * cw);
 	virtual void processEvents ();
 	virtual void alwaysHandleEvent (XEvent *event);
+	virtual void inhibitEventCoalescing (int type);
+	virtual void uninhibitEventCoalescing (int type);
+	virtual void eventCounts (unsigned long long &received,
+				  unsigned long long &dispatched);
+	virtual void inputLatencyDamaged ();
+	virtual void inputLatencyCutoff ();
+	virtual void inputLatencyPresented ();
+	virtual void inputLatencyStatistics (std::vector<compiz::core::InputLatency> &);
+	virtual void resetInputLatencyStatistics ();
 
 	virtual ServerGrabInterface * serverGrabInterface ();
 
@@ -1134,6 +1206,10 @@ class CompScreenImpl : public CompScreen,
 			      CompAction::State  state,
 			      CompOption::Vector &options);
 
+	static bool dumpInputLatency (CompAction         *action,
+				      CompAction::State  state,
+				      CompOption::Vector &options);
+
 	bool createFailed () const;
 
 
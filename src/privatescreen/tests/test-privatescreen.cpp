@@ -105,6 +105,7 @@ public:
     MOCK_METHOD0(screenNum, int ());
     MOCK_METHOD1(unhookServerWindow, void (CompWindow *w));
     MOCK_METHOD1(unhookWindow, void (CompWindow *w));
+    MOCK_METHOD3(updateFrameWindows, void (CompWindow *w, Window oldFrame, Window oldServerFrame));
     MOCK_METHOD2(viewportForGeometry, void (const CompWindow::Geometry &gm,
 				  CompPoint                   &viewport));
 
@@ -130,6 +131,13 @@ public:
     MOCK_CONST_METHOD0(getFileWatches, const CompFileWatchList& ());
     MOCK_METHOD0(updateSupportedWmHints, void ());
     MOCK_METHOD0(destroyedWindows, CompWindowList & ());
+    MOCK_METHOD0(windowPaintOrder, const CompWindowList & ());
+    MOCK_METHOD0(windowPaintOrderGeneration, unsigned int ());
+    MOCK_METHOD0(freezeWindowPaintOrder, void ());
+    MOCK_METHOD0(thawWindowPaintOrder, void ());
+    MOCK_METHOD1(updateWindowOutputRect, void (CompWindow *));
+    MOCK_METHOD2(findWindowsInRect, void (const CompRect &, CompWindowVector &));
+    MOCK_METHOD2(findWindowsAt, void (const CompPoint &, CompWindowVector &));
     MOCK_CONST_METHOD0(region, const CompRegion & ());
     MOCK_METHOD0(hasOverlappingOutputs, bool ());
     MOCK_METHOD0(fullscreenOutput, CompOutput & ());
@@ -172,6 +180,14 @@ public:
     MOCK_METHOD0(autoRaiseWindow, Window  ());
     MOCK_METHOD0(processEvents, void ());
     MOCK_METHOD1(alwaysHandleEvent, void (XEvent *event));
+    MOCK_METHOD1(inhibitEventCoalescing, void (int type));
+    MOCK_METHOD1(uninhibitEventCoalescing, void (int type));
+    MOCK_METHOD2(eventCounts, void (unsigned long long &received, unsigned long long &dispatched));
+    MOCK_METHOD0(inputLatencyDamaged, void ());
+    MOCK_METHOD0(inputLatencyCutoff, void ());
+    MOCK_METHOD0(inputLatencyPresented, void ());
+    MOCK_METHOD1(inputLatencyStatistics, void (std::vector<compiz::core::InputLatency> &));
+    MOCK_METHOD0(resetInputLatencyStatistics, void ());
     MOCK_METHOD0(displayString, const char * ());
     MOCK_METHOD0(getCurrentOutputExtents, CompRect ());
     MOCK_METHOD0(normalCursor, Cursor ());
@@ -39,6 +39,8 @@
 
 #include "syncserverwindow.h"
 #include "asyncserverwindow.h"
+#include "windowpaintorder.h"
+#include "windowspatialindex.h"
 
 #define XWINDOWCHANGES_INIT {0, 0, 0, 0, 0, None, 0}
 
@@ -209,6 +211,14 @@ class PrivateWindow :
 				    CompWindowList   &updateList,
 				    const ServerLock &lock);
 
+	/* Whether w is above sibling in the server side stack,
+	 * both have to be in it */
+	static bool serverStackedAbove (CompWindow *w,
+					CompWindow *sibling)
+	{
+	    return w->priv->serverStackLabel > sibling->priv->serverStackLabel;
+	}
+
 	static bool isAncestorTo (CompWindow *transient,
 				  CompWindow *ancestor);
 
@@ -453,6 +463,24 @@ class PrivateWindow :
 
 	bool nextMoveImmediate;
 
+	unsigned int matchSlot;
+	unsigned int matchGeneration;
+
+	/* Where the window is in the client and server side
+	 * stacks, kept up to date by the WindowManager */
+	CompWindowList::iterator stackEntry;
+	CompWindowList::iterator serverStackEntry;
+	unsigned long long       stackLabel;
+	unsigned long long       serverStackLabel;
+	bool                     stacked;
+	bool                     serverStacked;
+
+	/* Where the window is painted, see WindowManager::paintOrder */
+	compiz::window::PaintOrder<CompWindow *>::Entry paintEntry;
+
+	/* Where the output rect is, see WindowManager::spatialIndex */
+	compiz::window::SpatialIndex<CompWindow *>::Entry spatialEntry;
+
 	X11SyncServerWindow                            syncServerWindow;
 	compiz::window::configure_buffers::Buffer::Ptr configureBuffer;
 };
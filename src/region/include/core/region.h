@@ -40,6 +40,11 @@ COMPIZ_EXTERN_STD(vector<CompRegion>)
  * A 2D region with an (x,y) position and arbitrary dimensions similar to
  * an XRegion. It's data membmers are private and  must be manipulated with
  * set() methods.
+ *
+ * The rectangles are kept in the same y-x banded layout as an XRegion, so
+ * handle () can be passed to any Xlib function that reads a Region. Small
+ * regions store their rectangles inside the object and only spill to the
+ * heap once they hold more than InlineRects rectangles.
  */
 class CompRegion {
     public:
@@ -52,6 +57,11 @@ class CompRegion {
         CompRegion (const CompRect &);
 	~CompRegion ();
 
+#if __cplusplus >= 201103L
+	CompRegion (CompRegion &&);
+	CompRegion & operator= (CompRegion &&);
+#endif
+
 	/**
 	 * Returns a CompRect which encapsulates a given CompRegion
 	 */
@@ -70,7 +80,9 @@ class CompRegion {
 	CompRect::vector rects () const;
 	
 	/**
-	 * Returns the internal XRegion handle
+	 * Returns the internal XRegion handle. The handle is only valid
+	 * for reading by Xlib, it must never be passed as the destination
+	 * of an Xlib region operation or to XDestroyRegion.
 	 */
 	Region handle () const;
 
@@ -179,11 +191,21 @@ class CompRegion {
 	const CompRegion operator| (const CompRegion &) const;
 	CompRegion & operator|= (const CompRegion &);
 
+	/**
+	 * Number of rectangles a CompRegion can hold without allocating
+	 */
+	static const int InlineRects = 4;
+
     protected:
 	/* Construct a CompRegion based on an externally managed Region */
 	explicit CompRegion (Region);
 	void init ();
-	void *priv;
+
+    private:
+	/* Points at mRegion, or at the Region of a CompRegionRef */
+	Region mHandle;
+	REGION mRegion;
+	BOX    mInline[InlineRects];
 };
 
 class CompRegionRef : public CompRegion
@@ -26,29 +26,848 @@
 #include "core/rect.h"
 #include "core/region.h"
 
-#include <X11/Xlib-xcb.h>
 #include <X11/Xutil.h>
 #include <X11/Xregion.h>
 
-#include <stdio.h>
-#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <new>
 
-#include <boost/foreach.hpp>
-#define foreach BOOST_FOREACH
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 template class std::vector<CompRegion>;
 
+const int CompRegion::InlineRects;
+
 const CompRegion infiniteRegion (CompRect (MINSHORT, MINSHORT,
 				           MAXSHORT * 2, MAXSHORT * 2));
 const CompRegion emptyRegion;
 
-/* Alternate emptyRegion, mostly just required to construct infiniteRegion
-   when emptyRegion may still be uninitialized */
-static const CompRegion &
-_emptyRegion ()
+/*
+ * Rectangles are kept exactly like the rectangles of an Xlib REGION:
+ * sorted by y1 and then by x1, grouped into bands that share y1 and y2,
+ * with no two rectangles of a band touching and no two touching bands
+ * having identical x spans. Equal regions therefore always have
+ * identical rectangle lists, and handle () can be given to Xlib as is.
+ *
+ * The band walking below follows the algorithm of the X sample server
+ * (miRegionOp and friends), but builds its result in a scratch buffer
+ * on the stack instead of reallocating the destination as it goes.
+ *
+ * Box storage which was not obtained from malloc, such as the inline
+ * boxes of a CompRegion, is flagged with a negative size so that it is
+ * never handed to realloc or free. Everything else follows the Xlib
+ * conventions, which keeps CompRegionRef working on regions created
+ * with XCreateRegion.
+ */
+
+namespace
+{
+
+typedef long BoxIndex;
+
+inline long
+boxCapacity (const REGION *r)
+{
+    return r->size < 0 ? -r->size : r->size;
+}
+
+inline void
+releaseBoxes (REGION *r)
+{
+    if (r->size > 0)
+	free (r->rects);
+}
+
+/* Makes room for n boxes in r, the current boxes may be discarded */
+bool
+reserveBoxes (REGION *r, long n)
+{
+    if (n <= boxCapacity (r))
+	return true;
+
+    BOX *boxes = static_cast <BOX *> (malloc (n * sizeof (BOX)));
+
+    if (!boxes)
+	return false;
+
+    releaseBoxes (r);
+    r->rects = boxes;
+    r->size = n;
+
+    return true;
+}
+
+void
+setExtents (REGION *r)
+{
+    if (!r->numRects)
+    {
+	r->extents.x1 = r->extents.y1 = 0;
+	r->extents.x2 = r->extents.y2 = 0;
+	return;
+    }
+
+    const BOX *box = r->rects;
+    const BOX *end = box + r->numRects;
+
+    /* Bands are sorted, so only the x extents need to be searched for */
+    r->extents.y1 = box->y1;
+    r->extents.y2 = end[-1].y2;
+    r->extents.x1 = box->x1;
+    r->extents.x2 = end[-1].x2;
+
+    for (; box != end; ++box)
+    {
+	if (box->x1 < r->extents.x1)
+	    r->extents.x1 = box->x1;
+	if (box->x2 > r->extents.x2)
+	    r->extents.x2 = box->x2;
+    }
+}
+
+inline void
+setEmpty (REGION *r)
+{
+    r->numRects = 0;
+    setExtents (r);
+}
+
+void
+setBox (REGION *r, int x1, int y1, int x2, int y2)
+{
+    if (x1 >= x2 || y1 >= y2 || !reserveBoxes (r, 1))
+    {
+	setEmpty (r);
+	return;
+    }
+
+    r->rects[0].x1 = x1;
+    r->rects[0].y1 = y1;
+    r->rects[0].x2 = x2;
+    r->rects[0].y2 = y2;
+    r->numRects = 1;
+    r->extents = r->rects[0];
+}
+
+void
+copyRegion (REGION *dst, const REGION *src)
+{
+    if (dst == src)
+	return;
+
+    if (!reserveBoxes (dst, src->numRects))
+    {
+	setEmpty (dst);
+	return;
+    }
+
+    memcpy (dst->rects, src->rects, src->numRects * sizeof (BOX));
+    dst->numRects = src->numRects;
+    dst->extents = src->extents;
+}
+
+/* Fills in a read only single box region describing rect */
+void
+rectRegion (const CompRect &rect, REGION *r)
+{
+    r->size = -1;
+    r->rects = &r->extents;
+
+    if (rect.isEmpty ())
+    {
+	setEmpty (r);
+	return;
+    }
+
+    r->numRects = 1;
+    r->extents.x1 = rect.x1 ();
+    r->extents.y1 = rect.y1 ();
+    r->extents.x2 = rect.x2 ();
+    r->extents.y2 = rect.y2 ();
+}
+
+/* Scratch space the result of a region operation is built in */
+class BoxBuffer
+{
+    public:
+	BoxBuffer () :
+	    boxes (local),
+	    numBoxes (0),
+	    size (LocalBoxes)
+	{
+	}
+
+	~BoxBuffer ()
+	{
+	    if (boxes != local)
+		free (boxes);
+	}
+
+	inline void
+	append (int x1, int y1, int x2, int y2)
+	{
+	    if (numBoxes == size)
+		grow ();
+
+	    BOX &box = boxes[numBoxes++];
+
+	    box.x1 = x1;
+	    box.y1 = y1;
+	    box.x2 = x2;
+	    box.y2 = y2;
+	}
+
+	/* Moves the result into r, taking over the heap storage if r
+	 * would need to grow anyway */
+	void
+	store (REGION *r)
+	{
+	    if (boxes != local && numBoxes > boxCapacity (r))
+	    {
+		releaseBoxes (r);
+		r->rects = boxes;
+		r->size = size;
+		boxes = local;
+	    }
+	    else if (reserveBoxes (r, numBoxes))
+	    {
+		memcpy (r->rects, boxes, numBoxes * sizeof (BOX));
+	    }
+	    else
+	    {
+		setEmpty (r);
+		return;
+	    }
+
+	    r->numRects = numBoxes;
+	    setExtents (r);
+	}
+
+	BOX      *boxes;
+	BoxIndex numBoxes;
+
+    private:
+	void
+	grow ()
+	{
+	    BOX *larger = static_cast <BOX *> (malloc (size * 2 * sizeof (BOX)));
+
+	    if (!larger)
+		throw std::bad_alloc ();
+
+	    memcpy (larger, boxes, numBoxes * sizeof (BOX));
+
+	    if (boxes != local)
+		free (boxes);
+
+	    boxes = larger;
+	    size *= 2;
+	}
+
+	static const int LocalBoxes = 64;
+
+	long size;
+	BOX  local[LocalBoxes];
+};
+
+/* Returns true if the n boxes at a and b have the same x spans */
+inline bool
+sameSpans (const BOX *a, const BOX *b, long n)
+{
+#ifdef __SSE2__
+    /* x1 and x2 are the first four bytes of each box, compare two boxes
+     * at once and ignore the y lanes */
+    for (; n >= 2; n -= 2, a += 2, b += 2)
+    {
+	__m128i va = _mm_loadu_si128 (reinterpret_cast <const __m128i *> (a));
+	__m128i vb = _mm_loadu_si128 (reinterpret_cast <const __m128i *> (b));
+
+	if ((_mm_movemask_epi8 (_mm_cmpeq_epi16 (va, vb)) & 0x0f0f) != 0x0f0f)
+	    return false;
+    }
+#endif
+
+    for (; n; --n, ++a, ++b)
+	if (a->x1 != b->x1 || a->x2 != b->x2)
+	    return false;
+
+    return true;
+}
+
+/*
+ * Merges the band starting at curStart into the band starting at
+ * prevStart if they touch and have the same x spans. Returns the start
+ * of the band later calls should try to merge with.
+ */
+BoxIndex
+coalesce (BoxBuffer &buf, BoxIndex prevStart, BoxIndex curStart)
+{
+    BOX      *boxes = buf.boxes;
+    BoxIndex end = buf.numBoxes;
+    BoxIndex curEnd = curStart;
+    BoxIndex lastStart = curStart;
+
+    while (curEnd != end && boxes[curEnd].y1 == boxes[curStart].y1)
+	++curEnd;
+
+    /* More than one band was added, only the last one is of
+     * interest to later calls */
+    if (curEnd != end)
+    {
+	lastStart = end - 1;
+	while (boxes[lastStart - 1].y1 == boxes[lastStart].y1)
+	    --lastStart;
+    }
+
+    BoxIndex curNum = curEnd - curStart;
+
+    if (!curNum || curNum != curStart - prevStart ||
+	boxes[prevStart].y2 != boxes[curStart].y1 ||
+	!sameSpans (boxes + prevStart, boxes + curStart, curNum))
+	return lastStart;
+
+    for (BoxIndex i = 0; i < curNum; ++i)
+	boxes[prevStart + i].y2 = boxes[curStart + i].y2;
+
+    memmove (boxes + curStart, boxes + curEnd, (end - curEnd) * sizeof (BOX));
+    buf.numBoxes -= curNum;
+
+    return curEnd == end ? prevStart : lastStart - curNum;
+}
+
+typedef void (*OverlapFunc) (BoxBuffer &,
+			     const BOX *, const BOX *,
+			     const BOX *, const BOX *,
+			     int, int);
+typedef void (*NonOverlapFunc) (BoxBuffer &,
+				const BOX *, const BOX *,
+				int, int);
+
+inline const BOX *
+bandEnd (const BOX *box, const BOX *end)
+{
+    const BOX *e = box;
+
+    while (e != end && e->y1 == box->y1)
+	++e;
+
+    return e;
+}
+
+/*
+ * Walks the bands of both regions, handing every y range covered by
+ * both of them to overlap and the ranges covered by just one of them to
+ * the respective nonOverlap function. Both regions must be non-empty.
+ */
+void
+regionOp (BoxBuffer      &buf,
+	  const REGION   *reg1,
+	  const REGION   *reg2,
+	  OverlapFunc    overlap,
+	  NonOverlapFunc nonOverlap1,
+	  NonOverlapFunc nonOverlap2)
+{
+    const BOX *r1 = reg1->rects;
+    const BOX *r2 = reg2->rects;
+    const BOX *r1End = r1 + reg1->numRects;
+    const BOX *r2End = r2 + reg2->numRects;
+    const BOX *r1BandEnd, *r2BandEnd;
+    BoxIndex  prevBand = 0, curBand;
+    int       ytop, ybot;
+
+    ybot = std::min (reg1->extents.y1, reg2->extents.y1);
+
+    do
+    {
+	curBand = buf.numBoxes;
+	r1BandEnd = bandEnd (r1, r1End);
+	r2BandEnd = bandEnd (r2, r2End);
+
+	/* Part of a band that is only covered by one of the regions */
+	if (r1->y1 < r2->y1)
+	{
+	    int top = std::max<int> (r1->y1, ybot);
+	    int bot = std::min<int> (r1->y2, r2->y1);
+
+	    if (top != bot && nonOverlap1)
+		nonOverlap1 (buf, r1, r1BandEnd, top, bot);
+
+	    ytop = r2->y1;
+	}
+	else if (r2->y1 < r1->y1)
+	{
+	    int top = std::max<int> (r2->y1, ybot);
+	    int bot = std::min<int> (r2->y2, r1->y1);
+
+	    if (top != bot && nonOverlap2)
+		nonOverlap2 (buf, r2, r2BandEnd, top, bot);
+
+	    ytop = r1->y1;
+	}
+	else
+	{
+	    ytop = r1->y1;
+	}
+
+	if (buf.numBoxes != curBand)
+	    prevBand = coalesce (buf, prevBand, curBand);
+
+	/* Part covered by both */
+	ybot = std::min (r1->y2, r2->y2);
+	curBand = buf.numBoxes;
+
+	if (ybot > ytop)
+	    overlap (buf, r1, r1BandEnd, r2, r2BandEnd, ytop, ybot);
+
+	if (buf.numBoxes != curBand)
+	    prevBand = coalesce (buf, prevBand, curBand);
+
+	if (r1->y2 == ybot)
+	    r1 = r1BandEnd;
+	if (r2->y2 == ybot)
+	    r2 = r2BandEnd;
+    }
+    while (r1 != r1End && r2 != r2End);
+
+    /* Whatever is left of one of the regions */
+    curBand = buf.numBoxes;
+
+    if (r1 != r1End && nonOverlap1)
+    {
+	do
+	{
+	    r1BandEnd = bandEnd (r1, r1End);
+	    nonOverlap1 (buf, r1, r1BandEnd, std::max<int> (r1->y1, ybot), r1->y2);
+	    r1 = r1BandEnd;
+	}
+	while (r1 != r1End);
+    }
+    else if (r2 != r2End && nonOverlap2)
+    {
+	do
+	{
+	    r2BandEnd = bandEnd (r2, r2End);
+	    nonOverlap2 (buf, r2, r2BandEnd, std::max<int> (r2->y1, ybot), r2->y2);
+	    r2 = r2BandEnd;
+	}
+	while (r2 != r2End);
+    }
+
+    if (buf.numBoxes != curBand)
+	coalesce (buf, prevBand, curBand);
+}
+
+void
+appendBand (BoxBuffer &buf,
+	    const BOX *r,
+	    const BOX *rEnd,
+	    int       y1,
+	    int       y2)
 {
-    static const CompRegion r;
-    return r;
+    for (; r != rEnd; ++r)
+	buf.append (r->x1, y1, r->x2, y2);
+}
+
+void
+intersectBands (BoxBuffer &buf,
+		const BOX *r1,
+		const BOX *r1End,
+		const BOX *r2,
+		const BOX *r2End,
+		int       y1,
+		int       y2)
+{
+    while (r1 != r1End && r2 != r2End)
+    {
+	int x1 = std::max (r1->x1, r2->x1);
+	int x2 = std::min (r1->x2, r2->x2);
+
+	if (x1 < x2)
+	    buf.append (x1, y1, x2, y2);
+
+	/* Advance whichever box ends first, or both if they end together */
+	if (r1->x2 < r2->x2)
+	    ++r1;
+	else if (r2->x2 < r1->x2)
+	    ++r2;
+	else
+	{
+	    ++r1;
+	    ++r2;
+	}
+    }
+}
+
+inline void
+mergeBox (BoxBuffer &buf, BoxIndex bandStart, const BOX *r, int y1, int y2)
+{
+    if (buf.numBoxes != bandStart &&
+	buf.boxes[buf.numBoxes - 1].x2 >= r->x1)
+    {
+	BOX &last = buf.boxes[buf.numBoxes - 1];
+
+	if (last.x2 < r->x2)
+	    last.x2 = r->x2;
+    }
+    else
+    {
+	buf.append (r->x1, y1, r->x2, y2);
+    }
+}
+
+void
+uniteBands (BoxBuffer &buf,
+	    const BOX *r1,
+	    const BOX *r1End,
+	    const BOX *r2,
+	    const BOX *r2End,
+	    int       y1,
+	    int       y2)
+{
+    BoxIndex bandStart = buf.numBoxes;
+
+    while (r1 != r1End && r2 != r2End)
+    {
+	if (r1->x1 < r2->x1)
+	    mergeBox (buf, bandStart, r1++, y1, y2);
+	else
+	    mergeBox (buf, bandStart, r2++, y1, y2);
+    }
+
+    for (; r1 != r1End; ++r1)
+	mergeBox (buf, bandStart, r1, y1, y2);
+
+    for (; r2 != r2End; ++r2)
+	mergeBox (buf, bandStart, r2, y1, y2);
+}
+
+void
+subtractBands (BoxBuffer &buf,
+	       const BOX *r1,
+	       const BOX *r1End,
+	       const BOX *r2,
+	       const BOX *r2End,
+	       int       y1,
+	       int       y2)
+{
+    int x1 = r1->x1;
+
+    while (r1 != r1End && r2 != r2End)
+    {
+	if (r2->x2 <= x1)
+	{
+	    /* Subtrahend entirely to the left */
+	    ++r2;
+	}
+	else if (r2->x1 <= x1)
+	{
+	    /* Subtrahend covers the left edge of the minuend */
+	    x1 = r2->x2;
+
+	    if (x1 >= r1->x2)
+	    {
+		if (++r1 != r1End)
+		    x1 = r1->x1;
+	    }
+	    else
+	    {
+		++r2;
+	    }
+	}
+	else if (r2->x1 < r1->x2)
+	{
+	    /* Left part of the minuend survives */
+	    buf.append (x1, y1, r2->x1, y2);
+	    x1 = r2->x2;
+
+	    if (x1 >= r1->x2)
+	    {
+		if (++r1 != r1End)
+		    x1 = r1->x1;
+	    }
+	    else
+	    {
+		++r2;
+	    }
+	}
+	else
+	{
+	    /* Subtrahend entirely to the right */
+	    if (r1->x2 > x1)
+		buf.append (x1, y1, r1->x2, y2);
+
+	    if (++r1 != r1End)
+		x1 = r1->x1;
+	}
+    }
+
+    while (r1 != r1End)
+    {
+	buf.append (x1, y1, r1->x2, y2);
+
+	if (++r1 != r1End)
+	    x1 = r1->x1;
+    }
+}
+
+inline bool
+boxContains (const BOX &outer, const BOX &inner)
+{
+    return outer.x1 <= inner.x1 && outer.x2 >= inner.x2 &&
+	   outer.y1 <= inner.y1 && outer.y2 >= inner.y2;
+}
+
+void
+intersectRegions (REGION *dst, const REGION *a, const REGION *b)
+{
+    if (!a->numRects || !b->numRects ||
+	!EXTENTCHECK (&a->extents, &b->extents))
+    {
+	setEmpty (dst);
+	return;
+    }
+
+    if (a->numRects == 1 && b->numRects == 1)
+    {
+	setBox (dst,
+		std::max (a->extents.x1, b->extents.x1),
+		std::max (a->extents.y1, b->extents.y1),
+		std::min (a->extents.x2, b->extents.x2),
+		std::min (a->extents.y2, b->extents.y2));
+	return;
+    }
+
+    BoxBuffer buf;
+
+    regionOp (buf, a, b, intersectBands, NULL, NULL);
+    buf.store (dst);
+}
+
+void
+uniteRegions (REGION *dst, const REGION *a, const REGION *b)
+{
+    if (a == b || !b->numRects ||
+	(a->numRects == 1 && boxContains (a->extents, b->extents)))
+    {
+	copyRegion (dst, a);
+	return;
+    }
+
+    if (!a->numRects ||
+	(b->numRects == 1 && boxContains (b->extents, a->extents)))
+    {
+	copyRegion (dst, b);
+	return;
+    }
+
+    BoxBuffer buf;
+
+    regionOp (buf, a, b, uniteBands, appendBand, appendBand);
+    buf.store (dst);
+}
+
+void
+subtractRegions (REGION *dst, const REGION *a, const REGION *b)
+{
+    if (!a->numRects || !b->numRects ||
+	!EXTENTCHECK (&a->extents, &b->extents))
+    {
+	copyRegion (dst, a);
+	return;
+    }
+
+    BoxBuffer buf;
+
+    regionOp (buf, a, b, subtractBands, appendBand, NULL);
+    buf.store (dst);
+}
+
+void
+offsetRegion (REGION *r, int dx, int dy)
+{
+    if (!r->numRects)
+	return;
+
+    BOX  *box = r->rects;
+    long n = r->numRects;
+
+#ifdef __SSE2__
+    const __m128i d = _mm_setr_epi16 (dx, dx, dy, dy, dx, dx, dy, dy);
+
+    for (; n >= 2; n -= 2, box += 2)
+    {
+	__m128i *p = reinterpret_cast <__m128i *> (box);
+
+	_mm_storeu_si128 (p, _mm_add_epi16 (_mm_loadu_si128 (p), d));
+    }
+#endif
+
+    for (; n; --n, ++box)
+    {
+	box->x1 += dx;
+	box->y1 += dy;
+	box->x2 += dx;
+	box->y2 += dy;
+    }
+
+    r->extents.x1 += dx;
+    r->extents.y1 += dy;
+    r->extents.x2 += dx;
+    r->extents.y2 += dy;
+}
+
+bool
+equalRegions (const REGION *a, const REGION *b)
+{
+    if (a->numRects != b->numRects)
+	return false;
+
+    if (!a->numRects)
+	return true;
+
+    return memcmp (&a->extents, &b->extents, sizeof (BOX)) == 0 &&
+	   memcmp (a->rects, b->rects, a->numRects * sizeof (BOX)) == 0;
+}
+
+bool
+pointInRegion (const REGION *r, int x, int y)
+{
+    if (!r->numRects ||
+	x < r->extents.x1 || x >= r->extents.x2 ||
+	y < r->extents.y1 || y >= r->extents.y2)
+	return false;
+
+    const BOX *end = r->rects + r->numRects;
+
+    for (const BOX *box = r->rects; box != end && box->y1 <= y; ++box)
+	if (x >= box->x1 && x < box->x2 && y < box->y2)
+	    return true;
+
+    return false;
+}
+
+/* Returns RectangleIn, RectangleOut or RectanglePart like XRectInRegion */
+int
+rectInRegion (const REGION *r, int x, int y, int width, int height)
+{
+    BOX rect;
+
+    rect.x1 = x;
+    rect.y1 = y;
+    rect.x2 = x + width;
+    rect.y2 = y + height;
+
+    if (!r->numRects || !EXTENTCHECK (&r->extents, &rect))
+	return RectangleOut;
+
+    const BOX *end = r->rects + r->numRects;
+    bool      partIn = false, partOut = false;
+
+    /* (x, y) walks the part of the rectangle not yet known to be covered */
+    x = rect.x1;
+    y = rect.y1;
+
+    for (const BOX *box = r->rects; box != end; ++box)
+    {
+	if (box->y2 <= y)
+	    continue;
+
+	if (box->y1 > y)
+	{
+	    partOut = true;
+	    if (partIn || box->y1 >= rect.y2)
+		break;
+	    y = box->y1;
+	}
+
+	if (box->x2 <= x)
+	    continue;
+
+	if (box->x1 > x)
+	{
+	    partOut = true;
+	    if (partIn)
+		break;
+	}
+
+	if (box->x1 < rect.x2)
+	{
+	    partIn = true;
+	    if (partOut)
+		break;
+	}
+
+	if (box->x2 >= rect.x2)
+	{
+	    y = box->y2;
+	    if (y >= rect.y2)
+		break;
+	    x = rect.x1;
+	}
+	else
+	{
+	    partOut = true;
+	    break;
+	}
+    }
+
+    if (!partIn)
+	return RectangleOut;
+
+    return y < rect.y2 ? RectanglePart : RectangleIn;
+}
+
+/*
+ * Erodes (or for a negative distance, dilates) r along one axis by
+ * combining shifted copies of it, the same way XShrinkRegion does.
+ */
+void
+compress (CompRegion   &r,
+	  CompRegion   &s,
+	  CompRegion   &t,
+	  unsigned int distance,
+	  bool         xdir,
+	  bool         grow)
+{
+    unsigned int shift = 1;
+
+    s = r;
+
+    while (distance)
+    {
+	int dx = xdir ? -static_cast <int> (shift) : 0;
+	int dy = xdir ? 0 : -static_cast <int> (shift);
+
+	if (distance & shift)
+	{
+	    r.translate (dx, dy);
+
+	    if (grow)
+		r += s;
+	    else
+		r &= s;
+
+	    distance -= shift;
+	    if (!distance)
+		break;
+	}
+
+	t = s;
+	s.translate (dx, dy);
+
+	if (grow)
+	    s += t;
+	else
+	    s &= t;
+
+	shift <<= 1;
+    }
+}
+
 }
 
 CompRegion::CompRegion ()
@@ -59,40 +878,54 @@ CompRegion::CompRegion ()
 CompRegion::CompRegion (const CompRegion &c)
 {
     init ();
-    XUnionRegion (_emptyRegion ().handle (), c.handle (), handle ());
+    copyRegion (mHandle, c.mHandle);
 }
 
 CompRegion::CompRegion ( int x, int y, int w, int h)
 {
     init ();
-    
-    XRectangle rect;
-    
-    rect.x = x;
-    rect.y = y;
-    rect.width = w;
-    rect.height = h;
-    
-    XUnionRectWithRegion (&rect, _emptyRegion ().handle (), handle ());
+    setBox (mHandle, x, y, x + w, y + h);
 }
 
 CompRegion::CompRegion (const CompRect &r)
 {
     init ();
-    
-    XRectangle rect;
-    
-    rect.x = r.x ();
-    rect.y = r.y ();
-    rect.width = r.width ();
-    rect.height = r.height ();
-    
-    XUnionRectWithRegion (&rect, _emptyRegion ().handle (), handle ());
+    setBox (mHandle, r.x1 (), r.y1 (), r.x2 (), r.y2 ());
+}
+
+#if __cplusplus >= 201103L
+CompRegion::CompRegion (CompRegion &&c)
+{
+    init ();
+    *this = static_cast <CompRegion &&> (c);
+}
+
+CompRegion &
+CompRegion::operator= (CompRegion &&c)
+{
+    /* Heap storage can simply change hands, anything else is copied */
+    if (this != &c &&
+	mHandle == &mRegion &&
+	c.mHandle == &c.mRegion &&
+	c.mRegion.size > 0)
+    {
+	releaseBoxes (&mRegion);
+	mRegion = c.mRegion;
+	c.init ();
+    }
+    else
+    {
+	copyRegion (mHandle, c.mHandle);
+    }
+
+    return *this;
 }
+#endif
 
 CompRegion::CompRegion (Region external)
 {
-    priv = external;
+    init ();
+    mHandle = external;
 }
 
 CompRegionRef::CompRegionRef (Region external) :
@@ -102,41 +935,43 @@ CompRegionRef::CompRegionRef (Region external) :
 
 CompRegionRef::~CompRegionRef ()
 {
-    /* Ensure CompRegion::~CompRegion does not destroy the region, because
-       it's external and we don't own it. */
-    priv = NULL;
+    /* CompRegion::~CompRegion only releases storage it owns, so the
+       external region is left alone. */
 }
 
 CompRegion::~CompRegion ()
 {
-    if (priv)
-        XDestroyRegion (static_cast<Region> (priv));
+    if (mHandle == &mRegion)
+	releaseBoxes (&mRegion);
 }
 
 void
 CompRegion::init ()
 {
-    assert (sizeof (Region) == sizeof (void*));
-    priv = XCreateRegion ();
+    mHandle = &mRegion;
+
+    mRegion.size = -InlineRects;
+    mRegion.rects = mInline;
+    setEmpty (&mRegion);
 }
 
 Region
 CompRegion::handle () const
 {
-    return static_cast<Region> (priv);
+    return mHandle;
 }
 
 CompRegion &
 CompRegion::operator= (const CompRegion &c)
 {
-    XUnionRegion (emptyRegion.handle (), c.handle (), handle ());
+    copyRegion (mHandle, c.mHandle);
     return *this;
 }
 
 bool
 CompRegion::operator== (const CompRegion &c) const
 {
-    return XEqualRegion (handle (), c.handle ());
+    return equalRegions (mHandle, c.mHandle);
 }
 
 bool
@@ -148,14 +983,14 @@ CompRegion::operator!= (const CompRegion &c) const
 CompRect
 CompRegion::boundingRect () const
 {
-    BOX b = handle ()->extents;
+    BOX b = mHandle->extents;
     return CompRect (b.x1, b.y1, b.x2 - b.x1, b.y2 - b.y1);
 }
 
 bool
 CompRegion::contains (const CompPoint &p) const
 {
-    return XPointInRegion (handle (), p.x (), p.y ());
+    return pointInRegion (mHandle, p.x (), p.y ());
 }
 
 bool
@@ -163,7 +998,7 @@ CompRegion::contains (const CompRect &r) const
 {
     int result;
 
-    result = XRectInRegion (handle (), r.x (), r.y (), r.width (), r.height ());
+    result = rectInRegion (mHandle, r.x (), r.y (), r.width (), r.height ());
 
     return result == RectangleIn;
 }
@@ -173,7 +1008,7 @@ CompRegion::contains (int x, int y, int width, int height) const
 {
     int result;
 
-    result = XRectInRegion (handle (), x, y, width, height);
+    result = rectInRegion (mHandle, x, y, width, height);
 
     return result == RectangleIn;
 }
@@ -181,22 +1016,29 @@ CompRegion::contains (int x, int y, int width, int height) const
 CompRegion
 CompRegion::intersected (const CompRegion &r) const
 {
-    CompRegion reg (r);
-    XIntersectRegion (reg.handle (), handle (), reg.handle ());
+    CompRegion reg;
+    intersectRegions (reg.mHandle, mHandle, r.mHandle);
     return reg;
 }
 
 CompRegion
 CompRegion::intersected (const CompRect &r) const
 {
-    CompRegion reg (r);
-    XIntersectRegion (reg.handle (), handle (), reg.handle ());
+    CompRegion reg;
+    REGION     rect;
+
+    rectRegion (r, &rect);
+    intersectRegions (reg.mHandle, mHandle, &rect);
     return reg;
 }
 
 bool
 CompRegion::intersects (const CompRegion &r) const
 {
+    if (isEmpty () || r.isEmpty () ||
+	!EXTENTCHECK (&mHandle->extents, &r.mHandle->extents))
+	return false;
+
     return !intersected (r).isEmpty ();
 }
 
@@ -204,7 +1046,7 @@ bool
 CompRegion::intersects (const CompRect &r) const
 {
     int result;
-    result = XRectInRegion (handle (), r.x (), r.y (), r.width (), r.height ());
+    result = rectInRegion (mHandle, r.x (), r.y (), r.width (), r.height ());
 
     return result != RectangleOut;
 }
@@ -212,13 +1054,13 @@ CompRegion::intersects (const CompRect &r) const
 bool
 CompRegion::isEmpty () const
 {
-    return XEmptyRegion (handle ());
+    return !mHandle->numRects;
 }
 
 int
 CompRegion::numRects () const
 {
-    return handle ()->numRects;
+    return mHandle->numRects;
 }
 
 CompRect::vector
@@ -228,10 +1070,12 @@ CompRegion::rects () const
     if (!numRects ())
 	return rv;
 
+    rv.reserve (numRects ());
+
     BOX b;
-    for (int i = 0; i < handle ()->numRects; i++)
+    for (int i = 0; i < mHandle->numRects; i++)
     {
-	b = handle ()->rects[i];
+	b = mHandle->rects[i];
 	rv.push_back (CompRect (b.x1, b.y1, b.x2 - b.x1, b.y2 - b.y1));
     }
     return rv;
@@ -241,7 +1085,7 @@ CompRegion
 CompRegion::subtracted (const CompRegion &r) const
 {
     CompRegion rv;
-    XSubtractRegion (handle (), r.handle (), rv.handle ());
+    subtractRegions (rv.mHandle, mHandle, r.mHandle);
     return rv;
 }
 
@@ -249,14 +1093,17 @@ CompRegion
 CompRegion::subtracted (const CompRect &r) const
 {
     CompRegion rv;
-    XSubtractRegion (handle (), r.region (), rv.handle ());
+    REGION     rect;
+
+    rectRegion (r, &rect);
+    subtractRegions (rv.mHandle, mHandle, &rect);
     return rv;
 }
 
 void
 CompRegion::translate (int dx, int dy)
 {
-    XOffsetRegion (handle (), dx, dy);
+    offsetRegion (mHandle, dx, dy);
 }
 
 void
@@ -284,7 +1131,23 @@ CompRegion::translated (const CompPoint &p) const
 void
 CompRegion::shrink (int dx, int dy)
 {
-    XShrinkRegion (handle (), dx, dy);
+    if (!dx && !dy)
+	return;
+
+    CompRegion s, t;
+    bool       grow;
+
+    if ((grow = (dx < 0)))
+	dx = -dx;
+    if (dx)
+	compress (*this, s, t, 2 * dx, true, grow);
+
+    if ((grow = (dy < 0)))
+	dy = -dy;
+    if (dy)
+	compress (*this, s, t, 2 * dy, false, grow);
+
+    translate (dx, dy);
 }
 
 void
@@ -313,7 +1176,7 @@ CompRegion
 CompRegion::united (const CompRegion &r) const
 {
     CompRegion rv;
-    XUnionRegion (handle (), r.handle (), rv.handle ());
+    uniteRegions (rv.mHandle, mHandle, r.mHandle);
     return rv;
 }
 
@@ -321,16 +1184,17 @@ CompRegion
 CompRegion::united (const CompRect &r) const
 {
     CompRegion rv;
-    XUnionRegion (handle (), r.region (), rv.handle ());
+    REGION     rect;
+
+    rectRegion (r, &rect);
+    uniteRegions (rv.mHandle, mHandle, &rect);
     return rv;
 }
 
 CompRegion
 CompRegion::xored (const CompRegion &r) const
 {
-    CompRegion rv;
-    XXorRegion (handle (), r.handle (), rv.handle ());
-    return rv;
+    return subtracted (r).united (r.subtracted (*this));
 }
 
 const CompRegion
@@ -348,15 +1212,17 @@ CompRegion::operator& (const CompRect &r) const
 CompRegion &
 CompRegion::operator&= (const CompRegion &r)
 {
-    XIntersectRegion (r.handle (), handle (), handle ());
+    intersectRegions (mHandle, r.mHandle, mHandle);
     return *this;
 }
 
 CompRegion &
 CompRegion::operator&= (const CompRect &r)
 {
-    CompRegionRef ref (r.region ());
-    XIntersectRegion (ref.handle (), handle (), handle ());
+    REGION rect;
+
+    rectRegion (r, &rect);
+    intersectRegions (mHandle, &rect, mHandle);
     return *this;
 }
 
@@ -375,15 +1241,17 @@ CompRegion::operator+ (const CompRect &r) const
 CompRegion &
 CompRegion::operator+= (const CompRegion &r)
 {
-    XUnionRegion (handle (), r.handle (), handle ());
+    uniteRegions (mHandle, mHandle, r.mHandle);
     return *this;
 }
 
 CompRegion &
 CompRegion::operator+= (const CompRect &r)
 {
-    CompRegionRef ref (r.region ());
-    XUnionRegion (handle (), ref.handle (), handle ());
+    REGION rect;
+
+    rectRegion (r, &rect);
+    uniteRegions (mHandle, mHandle, &rect);
     return *this;
 }
 
@@ -402,15 +1270,17 @@ CompRegion::operator- (const CompRect &r) const
 CompRegion &
 CompRegion::operator-= (const CompRegion &r)
 {
-    XSubtractRegion (handle (), r.handle (), handle ());
+    subtractRegions (mHandle, mHandle, r.mHandle);
     return *this;
 }
 
 CompRegion &
 CompRegion::operator-= (const CompRect &r)
 {
-    CompRegionRef ref (r.region ());
-    XSubtractRegion (handle (), ref.handle (), handle ());
+    REGION rect;
+
+    rectRegion (r, &rect);
+    subtractRegions (mHandle, mHandle, &rect);
     return *this;
 }
 
@@ -423,7 +1293,7 @@ CompRegion::operator^ (const CompRegion &r) const
 CompRegion &
 CompRegion::operator^= (const CompRegion &r)
 {
-    XXorRegion (handle (), r.handle (), handle ());
+    *this = xored (r);
     return *this;
 }
 
@@ -436,7 +1306,6 @@ CompRegion::operator| (const CompRegion &r) const
 CompRegion &
 CompRegion::operator|= (const CompRegion &r)
 {
-    XUnionRegion (handle (), r.handle (), handle ());
+    uniteRegions (mHandle, mHandle, r.mHandle);
     return *this;
 }
-
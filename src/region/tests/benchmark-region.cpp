@@ -0,0 +1,267 @@
+/*
+ * Compares CompRegion against the Xlib Region code it replaced, using
+ * the rectangles from test-region.cpp plus a paintOutputRegion style
+ * occlusion pass over a stack of windows.
+ *
+ * Run compiz_region_benchmark [iterations]
+ */
+
+#include "core/region.h"
+
+#include <X11/Xutil.h>
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace
+{
+
+int const x1(13);
+int const y1(11);
+int const width1(97);
+int const height1(93);
+
+int const x2(53);
+int const y2(47);
+int const width2(147);
+int const height2(157);
+
+int const dx(3);
+int const dy(5);
+
+int const nWindows (60);
+
+CompRect rect1 (x1, y1, width1, height1);
+CompRect rect2 (x2, y2, width2, height2);
+
+double
+now ()
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+Region
+xRegion (const CompRect &r)
+{
+    Region     region = XCreateRegion ();
+    XRectangle rect = { short (r.x ()), short (r.y ()),
+			(unsigned short) r.width (),
+			(unsigned short) r.height () };
+
+    XUnionRectWithRegion (&rect, region, region);
+    return region;
+}
+
+/* Keeps the optimiser from throwing the work away */
+volatile long sink;
+
+void
+report (const char *name, double xlib, double comp)
+{
+    printf ("%-24s %10.2f ms %10.2f ms %8.2fx\n", name, xlib, comp, xlib / comp);
+}
+
+void
+benchCopy (int iterations)
+{
+    CompRegion c (CompRegion (rect1).subtracted (rect2));
+    Region     x = xRegion (rect1);
+    Region     r2 = xRegion (rect2);
+    XSubtractRegion (x, r2, x);
+
+    double start = now ();
+    for (int i = 0; i < iterations; ++i)
+    {
+	Region copy = XCreateRegion ();
+	XUnionRegion (copy, x, copy);
+	sink += copy->numRects;
+	XDestroyRegion (copy);
+    }
+    double xlib = now () - start;
+
+    start = now ();
+    for (int i = 0; i < iterations; ++i)
+    {
+	CompRegion copy (c);
+	sink += copy.numRects ();
+    }
+    report ("copy", xlib, now () - start);
+
+    XDestroyRegion (x);
+    XDestroyRegion (r2);
+}
+
+void
+benchBinary (const char *name,
+	     int        (*xop) (Region, Region, Region),
+	     CompRegion (*cop) (const CompRegion &, const CompRegion &),
+	     int        iterations)
+{
+    CompRegion c1 (rect1), c2 (rect2);
+    Region     r1 = xRegion (rect1), r2 = xRegion (rect2);
+
+    double start = now ();
+    for (int i = 0; i < iterations; ++i)
+    {
+	Region result = XCreateRegion ();
+	xop (r1, r2, result);
+	sink += result->numRects;
+	XDestroyRegion (result);
+    }
+    double xlib = now () - start;
+
+    start = now ();
+    for (int i = 0; i < iterations; ++i)
+	sink += cop (c1, c2).numRects ();
+    report (name, xlib, now () - start);
+
+    XDestroyRegion (r1);
+    XDestroyRegion (r2);
+}
+
+CompRegion intersect (const CompRegion &a, const CompRegion &b) { return a & b; }
+CompRegion unite (const CompRegion &a, const CompRegion &b) { return a | b; }
+CompRegion subtract (const CompRegion &a, const CompRegion &b) { return a - b; }
+CompRegion xorRegion (const CompRegion &a, const CompRegion &b) { return a ^ b; }
+
+void
+benchTranslate (int iterations)
+{
+    CompRegion c (CompRegion (rect1).subtracted (rect2));
+    Region     x = xRegion (rect1);
+    Region     r2 = xRegion (rect2);
+    XSubtractRegion (x, r2, x);
+
+    double start = now ();
+    for (int i = 0; i < iterations; ++i)
+    {
+	Region copy = XCreateRegion ();
+	XUnionRegion (copy, x, copy);
+	XOffsetRegion (copy, dx, dy);
+	sink += copy->extents.x1;
+	XDestroyRegion (copy);
+    }
+    double xlib = now () - start;
+
+    start = now ();
+    for (int i = 0; i < iterations; ++i)
+	sink += c.translated (dx, dy).boundingRect ().x ();
+    report ("translated", xlib, now () - start);
+
+    XDestroyRegion (x);
+    XDestroyRegion (r2);
+}
+
+void
+benchShrink (int iterations)
+{
+    CompRegion c (CompRegion (rect1).subtracted (rect2));
+    Region     x = xRegion (rect1);
+    Region     r2 = xRegion (rect2);
+    XSubtractRegion (x, r2, x);
+
+    double start = now ();
+    for (int i = 0; i < iterations; ++i)
+    {
+	Region copy = XCreateRegion ();
+	XUnionRegion (copy, x, copy);
+	XShrinkRegion (copy, dx, dy);
+	sink += copy->numRects;
+	XDestroyRegion (copy);
+    }
+    double xlib = now () - start;
+
+    start = now ();
+    for (int i = 0; i < iterations; ++i)
+	sink += c.shrinked (dx, dy).numRects ();
+    report ("shrinked", xlib, now () - start);
+
+    XDestroyRegion (x);
+    XDestroyRegion (r2);
+}
+
+void
+benchContains (int iterations)
+{
+    CompRegion c (CompRegion (rect1).united (rect2));
+    Region     x = xRegion (rect1);
+    Region     r2 = xRegion (rect2);
+    XUnionRegion (x, r2, x);
+
+    double start = now ();
+    for (int i = 0; i < iterations; ++i)
+	sink += XRectInRegion (x, x2, y2, width1, height1) +
+		XPointInRegion (x, x1 + i % width2, y1);
+    double xlib = now () - start;
+
+    start = now ();
+    for (int i = 0; i < iterations; ++i)
+	sink += c.contains (x2, y2, width1, height1) +
+		c.contains (CompPoint (x1 + i % width2, y1));
+    report ("contains", xlib, now () - start);
+
+    XDestroyRegion (x);
+    XDestroyRegion (r2);
+}
+
+/* A screen sized region with every window subtracted front to back */
+void
+benchOcclusion (int iterations)
+{
+    CompRect windows[nWindows];
+
+    srand (1);
+    for (int i = 0; i < nWindows; ++i)
+	windows[i] = CompRect (rand () % 1600, rand () % 900,
+			       rand () % 800 + 50, rand () % 500 + 50);
+
+    double start = now ();
+    for (int i = 0; i < iterations; ++i)
+    {
+	Region tmp = xRegion (CompRect (0, 0, 1920, 1080));
+	for (int w = 0; w < nWindows; ++w)
+	{
+	    REGION rect = *windows[w].region ();
+	    rect.rects = &rect.extents;
+	    XSubtractRegion (tmp, &rect, tmp);
+	}
+	sink += tmp->numRects;
+	XDestroyRegion (tmp);
+    }
+    double xlib = now () - start;
+
+    start = now ();
+    for (int i = 0; i < iterations; ++i)
+    {
+	CompRegion tmp (0, 0, 1920, 1080);
+	for (int w = 0; w < nWindows; ++w)
+	    tmp -= windows[w];
+	sink += tmp.numRects ();
+    }
+    report ("occlusion (60 windows)", xlib, now () - start);
+}
+
+}
+
+int
+main (int argc, char **argv)
+{
+    int iterations = argc > 1 ? atoi (argv[1]) : 1000000;
+
+    printf ("%-24s %13s %13s %9s\n", "operation", "Xlib", "CompRegion", "speedup");
+
+    benchCopy (iterations);
+    benchBinary ("intersected", XIntersectRegion, intersect, iterations);
+    benchBinary ("united", XUnionRegion, unite, iterations);
+    benchBinary ("subtracted", XSubtractRegion, subtract, iterations);
+    benchBinary ("xored", XXorRegion, xorRegion, iterations);
+    benchTranslate (iterations);
+    benchShrink (iterations / 10);
+    benchContains (iterations);
+    benchOcclusion (iterations / 100);
+
+    return 0;
+}
@@ -7,6 +7,7 @@
 #include <gmock/gmock.h>
 
 #include <iostream>
+#include <cstdlib>
 
 namespace {
 
@@ -564,4 +565,93 @@ TEST(RegionTest, external_refs)
     delete p;
 }
 
+
+TEST(RegionTest, external_ref_grows_beyond_inline_storage)
+{
+    CompRegion r1(rect1);
+
+    {
+	CompRegionRef ref(r1.handle());
+
+	for (int i = 1; i <= CompRegion::InlineRects * 2; ++i)
+	    ref += CompRect(i * 200, 0, 10, 10);
+    }
+
+    EXPECT_EQ(CompRegion::InlineRects * 2 + 1, r1.numRects());
+    EXPECT_TRUE(r1.contains(rect1));
+}
+
+TEST(RegionTest, copy_and_assign_after_spilling_to_heap)
+{
+    CompRegion r1;
+
+    for (int i = 0; i < CompRegion::InlineRects * 4; ++i)
+	r1 += CompRect(i * 20, i * 20, 10, 10);
+
+    CompRegion r2(r1);
+    EXPECT_EQ(r1, r2);
+
+    CompRegion r3(rect1);
+    r3 = r1;
+    EXPECT_EQ(r1, r3);
+
+    r3 = rect2;
+    EXPECT_EQ(CompRegion(rect2), r3);
+    EXPECT_NE(r1, r3);
+}
+
+TEST(RegionTest, matches_xlib)
+{
+    srand(13);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+	CompRegion r1, r2;
+	Region x1 = XCreateRegion ();
+	Region x2 = XCreateRegion ();
+	Region result = XCreateRegion ();
+
+	for (int j = rand() % 6; j; --j)
+	{
+	    XRectangle r = { short (rand() % 50), short (rand() % 50),
+			     (unsigned short) (rand() % 30 + 1),
+			     (unsigned short) (rand() % 30 + 1) };
+	    r1 += CompRect(r.x, r.y, r.width, r.height);
+	    XUnionRectWithRegion(&r, x1, x1);
+	}
+
+	for (int j = rand() % 6; j; --j)
+	{
+	    XRectangle r = { short (rand() % 50), short (rand() % 50),
+			     (unsigned short) (rand() % 30 + 1),
+			     (unsigned short) (rand() % 30 + 1) };
+	    r2 += CompRect(r.x, r.y, r.width, r.height);
+	    XUnionRectWithRegion(&r, x2, x2);
+	}
+
+	EXPECT_EQ(CompRegionRef(x1), r1);
+	EXPECT_EQ(CompRegionRef(x2), r2);
+
+	XIntersectRegion(x1, x2, result);
+	EXPECT_EQ(CompRegionRef(result), r1 & r2);
+
+	XUnionRegion(x1, x2, result);
+	EXPECT_EQ(CompRegionRef(result), r1 | r2);
+
+	XSubtractRegion(x1, x2, result);
+	EXPECT_EQ(CompRegionRef(result), r1 - r2);
+
+	XXorRegion(x1, x2, result);
+	EXPECT_EQ(CompRegionRef(result), r1 ^ r2);
+
+	XUnionRegion(x1, x1, result);
+	XShrinkRegion(result, dx, -dy);
+	EXPECT_EQ(CompRegionRef(result), r1.shrinked(dx, -dy));
+
+	XDestroyRegion(x1);
+	XDestroyRegion(x2);
+	XDestroyRegion(result);
+    }
+}
+
 }
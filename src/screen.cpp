@@ -79,6 +79,17 @@ namespace
 bool inHandleEvent = false;
 
 bool screenInitalized = false;
+
+compiz::events::LatencyTracker::Time
+now ()
+{
+    struct timeval tv;
+
+    compiz::core::timer::monotonic_time (&tv);
+
+    return (compiz::events::LatencyTracker::Time) tv.tv_sec * 1000000 +
+	   tv.tv_usec;
+}
 }
 
 #define MwmHintsFunctions   (1L << 0)
@@ -119,6 +130,57 @@ void CompScreenImpl::addToDestroyedWindows(CompWindow * cw)
 
 void CompScreenImpl::processEvents () { privateScreen.processEvents (); }
 
+void
+CompScreenImpl::inhibitEventCoalescing (int type)
+{
+    privateScreen.eventCoalescer.inhibit (type);
+}
+
+void
+CompScreenImpl::uninhibitEventCoalescing (int type)
+{
+    privateScreen.eventCoalescer.uninhibit (type);
+}
+
+void
+CompScreenImpl::eventCounts (unsigned long long &received,
+			     unsigned long long &dispatched)
+{
+    received   = privateScreen.eventCoalescer.received ();
+    dispatched = privateScreen.eventCoalescer.dispatched ();
+}
+
+void
+CompScreenImpl::inputLatencyDamaged ()
+{
+    if (privateScreen.inputLatency.awaitingDamage ())
+	privateScreen.inputLatency.damaged (now ());
+}
+
+void
+CompScreenImpl::inputLatencyCutoff ()
+{
+    privateScreen.inputLatency.cutoff ();
+}
+
+void
+CompScreenImpl::inputLatencyPresented ()
+{
+    privateScreen.inputLatency.presented (now ());
+}
+
+void
+CompScreenImpl::inputLatencyStatistics (std::vector<compiz::core::InputLatency> &latencies)
+{
+    privateScreen.inputLatency.statistics (latencies);
+}
+
+void
+CompScreenImpl::resetInputLatencyStatistics ()
+{
+    privateScreen.inputLatency.reset ();
+}
+
 unsigned int
 CompScreen::allocPluginClassIndex ()
 {
@@ -789,8 +851,47 @@ PrivateScreen::getNextEvent (XEvent &ev)
     {
 	return dbg->getNextEvent (ev);
     }
-    else
-	return getNextXEvent (ev);
+
+    /* Take the whole burst the server has sent so far, so redundant
+     * events in it can be dropped before any of them goes through
+     * handleEvent. A batch ends at the first event that can't be held
+     * back, that one is left in the queue until the batch is done */
+    if (eventCoalescer.empty ())
+    {
+	while (XEventsQueued (dpy, QueuedAfterReading))
+	{
+	    XPeekEvent (dpy, &ev);
+
+	    bool hold = eventCoalescer.canHold (ev);
+
+	    if (!hold && !eventCoalescer.empty ())
+		break;
+
+	    XNextEvent (dpy, &ev);
+	    eventCoalescer.push (ev);
+
+	    if (!hold)
+		break;
+	}
+
+	eventCoalescer.coalesce ();
+    }
+
+    return eventCoalescer.pop (ev);
+}
+
+/* ConfigureNotify events answering our own configure requests are
+ * matched one by one against the pending requests, see
+ * PrivateWindow::configureFrame */
+bool
+PrivateScreen::expectsConfigureNotify (const XConfigureEvent &ce)
+{
+    CompWindow *w = windowManager.findWindow (ce.window);
+
+    if (!w)
+	w = windowManager.findServerFrame (ce.window);
+
+    return w && w->priv->pendingConfigures.pending ();
 }
 
 void
@@ -822,18 +923,20 @@ PrivateScreen::processEvents ()
 	switch (event.type) {
 	case ButtonPress:
 	case ButtonRelease:
+	    inputLatency.arrived (event.type, event.xbutton.time, now ());
 	    pointerX = event.xbutton.x_root;
 	    pointerY = event.xbutton.y_root;
 	    pointerMods = event.xbutton.state;
 	    break;
 	case KeyPress:
 	case KeyRelease:
+	    inputLatency.arrived (event.type, event.xkey.time, now ());
 	    pointerX = event.xkey.x_root;
 	    pointerY = event.xkey.y_root;
 	    pointerMods = event.xkey.state;
 	    break;
 	case MotionNotify:
-
+	    inputLatency.arrived (event.type, event.xmotion.time, now ());
 	    pointerX = event.xmotion.x_root;
 	    pointerY = event.xmotion.y_root;
 	    pointerMods = event.xmotion.state;
@@ -911,13 +1014,20 @@ cps::WindowManager::validateServerWindows()
      * the server */
     if (stackIsFresh)
     {
+	foreach (CompWindow *sw, serverWindows)
+	    sw->priv->serverStacked = false;
+
 	serverWindows.clear ();
 
+	/* The client side labels are already in this order */
 	foreach (CompWindow *sw, windows)
 	{
 	    sw->serverPrev = sw->prev;
 	    sw->serverNext = sw->next;
-	    serverWindows.push_back (sw);
+	    sw->priv->serverStackEntry =
+		serverWindows.insert (serverWindows.end (), sw);
+	    sw->priv->serverStackLabel = sw->priv->stackLabel;
+	    sw->priv->serverStacked = true;
 	}
     }
 }
@@ -2019,14 +2129,31 @@ PrivateScreen::setVirtualScreenSize (int newh, int newv)
     viewPort.vpSize.setWidth (newh);
     viewPort.vpSize.setHeight (newv);
 
+    updateSpatialBounds ();
     setDesktopHints ();
 }
 
+void
+PrivateScreen::updateSpatialBounds ()
+{
+    int width  = screen->width ();
+    int height = screen->height ();
+    int hsize  = std::max (viewPort.vpSize.width (), 1);
+    int vsize  = std::max (viewPort.vpSize.height (), 1);
+
+    windowManager.setSpatialBounds (CompRect (-(hsize - 1) * width,
+					      -(vsize - 1) * height,
+					      (2 * hsize - 1) * width,
+					      (2 * vsize - 1) * height));
+}
+
 void
 PrivateScreen::updateOutputDevices (CoreOptions& coreOptions)
 {
     outputDevices.updateOutputDevices(coreOptions, screen);
 
+    updateSpatialBounds ();
+
     windowManager.clearFullscreenHints();
 
     screen->updateWorkarea ();
@@ -2754,19 +2881,86 @@ CompScreenImpl::findWindow (Window id)
 CompWindow*
 cps::WindowManager::findWindow (Window id) const
 {
-    if (lastFoundWindow && lastFoundWindow->id () == id)
-    {
-	return lastFoundWindow;
-    }
-    else
-    {
-        CompWindow::Map::const_iterator it = windowsMap.find (id);
+    return windowsMap.find (id);
+}
 
-        if (it != windowsMap.end ())
-            return (lastFoundWindow = it->second);
-    }
+CompWindow *
+cps::WindowManager::findFrame (Window frame) const
+{
+    return framesMap.find (frame);
+}
 
-    return 0;
+CompWindow *
+cps::WindowManager::findServerFrame (Window serverFrame) const
+{
+    return serverFramesMap.find (serverFrame);
+}
+
+unsigned long long &
+cps::WindowManager::stackLabelOf (CompWindow *w)
+{
+    return w->priv->stackLabel;
+}
+
+unsigned long long &
+cps::WindowManager::serverStackLabelOf (CompWindow *w)
+{
+    return w->priv->serverStackLabel;
+}
+
+cps::WindowManager::WindowPaintOrder::Entry &
+cps::WindowManager::paintEntryOf (CompWindow *w)
+{
+    return w->priv->paintEntry;
+}
+
+CompWindow *
+cps::WindowManager::paintBelowOf (CompWindow *w)
+{
+    return w->prev;
+}
+
+/* destroy () keeps next pointing at the window that was above */
+bool
+cps::WindowManager::paintHeldBelow (CompWindow *dw, CompWindow *w)
+{
+    return dw->destroyed () && dw->next == w;
+}
+
+cps::WindowManager::WindowSpatialIndex::Entry &
+cps::WindowManager::spatialEntryOf (CompWindow *w)
+{
+    return w->priv->spatialEntry;
+}
+
+void
+cps::WindowManager::setSpatialBounds (const CompRect &bounds)
+{
+    spatialIndex.setBounds (bounds.x (), bounds.y (),
+			    bounds.width (), bounds.height ());
+}
+
+void
+cps::WindowManager::updateSpatialIndex (CompWindow *w)
+{
+    CompRect r (w->outputRect ());
+
+    spatialIndex.update (w, r.x (), r.y (), r.width (), r.height ());
+}
+
+void
+cps::WindowManager::findWindowsInRect (const CompRect   &rect,
+				       CompWindowVector &found)
+{
+    spatialIndex.query (rect.x (), rect.y (), rect.width (), rect.height (),
+			found);
+}
+
+void
+cps::WindowManager::findWindowsAt (const CompPoint  &point,
+				   CompWindowVector &found)
+{
+    spatialIndex.query (point.x (), point.y (), found);
 }
 
 CompWindow *
@@ -2776,27 +2970,13 @@ CompScreenImpl::findTopLevelWindow (Window id, bool override_redirect)
 
     w = findWindow (id);
 
-    if (w)
-    {
-	if (w->overrideRedirect () && !override_redirect)
-	    return NULL;
-	else
-	    return w;
-    }
+    if (!w)
+	w = windowManager.findServerFrame (id);
 
-    for (cps::WindowManager::iterator i = windowManager.begin(); i != windowManager.end(); ++i)
-    {
-	CompWindow* const w(*i);
-	if (w->priv->serverFrame == id)
-	{
-	    if (w->overrideRedirect () && !override_redirect)
-		return NULL;
-	    else
-		return w;
-	}
-    }
+    if (w && w->overrideRedirect () && !override_redirect)
+	return NULL;
 
-    return NULL;
+    return w;
 }
 
 void
@@ -2826,24 +3006,25 @@ cps::WindowManager::insertWindow (CompWindow* w, Window aboveId)
 	}
 	windows.push_front (w);
 
+	w->priv->stackEntry = windows.begin ();
+	w->priv->stacked = true;
+	stackOrder.inserted (w->priv->stackEntry);
+	paintOrder.inserted (w);
+
+	if (!w->priv->spatialEntry.listed)
+	    updateSpatialIndex (w);
+
 	addWindowToMap(w);
 
 	return;
     }
 
-    CompWindowList::iterator it = windows.begin ();
+    CompWindow *above = findWindow (aboveId);
 
-    while (it != windows.end ())
-    {
-	if ((*it)->id () == aboveId ||
-	    ((*it)->priv->frame && (*it)->priv->frame == aboveId))
-	{
-	    break;
-	}
-	++it;
-    }
+    if (!above)
+	above = findFrame (aboveId);
 
-    if (it == windows.end ())
+    if (!above)
     {
 	compLogMessage ("core", CompLogLevelDebug, "could not insert 0x%x above 0x%x",
 			(unsigned int) w->priv->serverId, aboveId);
@@ -2853,19 +3034,38 @@ cps::WindowManager::insertWindow (CompWindow* w, Window aboveId)
 	return;
     }
 
-    w->next = (*it)->next;
-    w->prev = (*it);
-    (*it)->next = w;
+    CompWindowList::iterator it = above->priv->stackEntry;
+
+    w->next = above->next;
+    w->prev = above;
+    above->next = w;
 
     if (w->next)
     {
 	w->next->prev = w;
     }
 
-    windows.insert (++it, w);
+    w->priv->stackEntry = windows.insert (++it, w);
+    w->priv->stacked = true;
+    stackOrder.inserted (w->priv->stackEntry);
+    paintOrder.inserted (w);
+
+    if (!w->priv->spatialEntry.listed)
+	updateSpatialIndex (w);
+
     addWindowToMap(w);
 }
 
+void
+cps::WindowManager::addWindowToMap (CompWindow *w)
+{
+    if (w->id () != 1)
+	windowsMap.insert (w->id (), w);
+
+    framesMap.insert (w->priv->frame, w);
+    serverFramesMap.insert (w->priv->serverFrame, w);
+}
+
 void
 CompScreenImpl::insertServerWindow (CompWindow *w, Window	aboveId)
 {
@@ -2892,19 +3092,33 @@ cps::WindowManager::insertServerWindow(CompWindow* w, Window aboveId)
 	}
 	serverWindows.push_front (w);
 
+	w->priv->serverStackEntry = serverWindows.begin ();
+	w->priv->serverStacked = true;
+	serverStackOrder.inserted (w->priv->serverStackEntry);
+
 	return;
     }
 
-    CompWindowList::iterator it = serverWindows.begin ();
+    CompWindowList::iterator it = serverWindows.end ();
+    CompWindow               *above = findWindow (aboveId);
+
+    if (!above || above->priv->serverId != aboveId)
+	above = findServerFrame (aboveId);
 
-    while (it != serverWindows.end ())
+    if (above && above->priv->serverStacked)
+	it = above->priv->serverStackEntry;
+    else
     {
-	if ((*it)->priv->serverId == aboveId ||
-	    ((*it)->priv->serverFrame && (*it)->priv->serverFrame == aboveId))
+	/* Not in the client side stack, look through the
+	 * server side one */
+	for (it = serverWindows.begin (); it != serverWindows.end (); ++it)
 	{
-	    break;
+	    if ((*it)->priv->serverId == aboveId ||
+		((*it)->priv->serverFrame && (*it)->priv->serverFrame == aboveId))
+	    {
+		break;
+	    }
 	}
-	++it;
     }
 
     if (it == serverWindows.end ())
@@ -2926,14 +3140,49 @@ cps::WindowManager::insertServerWindow(CompWindow* w, Window aboveId)
 	w->serverNext->serverPrev = w;
     }
 
-    serverWindows.insert (++it, w);
+    w->priv->serverStackEntry = serverWindows.insert (++it, w);
+    w->priv->serverStacked = true;
+    serverStackOrder.inserted (w->priv->serverStackEntry);
 }
 
 void
-cps::WindowManager::eraseWindowFromMap (Window id)
+cps::WindowManager::eraseWindowFromMap (CompWindow *w)
 {
-    if (id != 1)
-        windowsMap.erase (id);
+    if (w->id () != 1)
+        windowsMap.erase (w->id ());
+
+    if (framesMap.find (w->priv->frame) == w)
+	framesMap.erase (w->priv->frame);
+
+    if (serverFramesMap.find (w->priv->serverFrame) == w)
+	serverFramesMap.erase (w->priv->serverFrame);
+}
+
+void
+CompScreenImpl::updateFrameWindows (CompWindow *w,
+				    Window     oldFrame,
+				    Window     oldServerFrame)
+{
+    windowManager.updateFrameWindows (w, oldFrame, oldServerFrame);
+}
+
+void
+cps::WindowManager::updateFrameWindows (CompWindow *w,
+					Window     oldFrame,
+					Window     oldServerFrame)
+{
+    /* Only windows in the stack can be found by their frames */
+    if (!w->priv->stacked)
+	return;
+
+    if (framesMap.find (oldFrame) == w)
+	framesMap.erase (oldFrame);
+
+    if (serverFramesMap.find (oldServerFrame) == w)
+	serverFramesMap.erase (oldServerFrame);
+
+    framesMap.insert (w->priv->frame, w);
+    serverFramesMap.insert (w->priv->serverFrame, w);
 }
 
 void
@@ -2950,17 +3199,15 @@ cps::WindowManager::unhookWindow(CompWindow* w)
     if (dbg)
 	dbg->windowsChanged (true);
 
-    CompWindowList::iterator it =
-	std::find (windows.begin(), windows.end(), w);
-
-    if (it == windows.end())
+    if (!w->priv->stacked)
     {
 	compLogMessage ("core", CompLogLevelWarn, "a broken plugin tried to remove a window twice, we won't allow that!");
 	return;
     }
 
-    windows.erase (it);
-    eraseWindowFromMap (w->id ());
+    windows.erase (w->priv->stackEntry);
+    w->priv->stacked = false;
+    eraseWindowFromMap (w);
 
     if (w->next)
 	w->next->prev = w->prev;
@@ -2970,8 +3217,6 @@ cps::WindowManager::unhookWindow(CompWindow* w)
 
     w->next = NULL;
     w->prev = NULL;
-
-    removeFromFindWindowCache(w);
 }
 
 void
@@ -2988,16 +3233,14 @@ cps::WindowManager::unhookServerWindow (CompWindow *w)
     if (dbg)
 	dbg->serverWindowsChanged (true);
 
-    CompWindowList::iterator it =
-	std::find (serverWindows.begin (), serverWindows.end (), w);
-
-    if (it == serverWindows.end ())
+    if (!w->priv->serverStacked)
     {
 	compLogMessage ("core", CompLogLevelWarn, "a broken plugin tried to remove a window twice, we won't allow that!");
 	return;
     }
 
-    serverWindows.erase (it);
+    serverWindows.erase (w->priv->serverStackEntry);
+    w->priv->serverStacked = false;
 
     if (w->serverNext)
 	w->serverNext->serverPrev = w->serverPrev;
@@ -4236,6 +4479,8 @@ CompScreenImpl::warpPointer (int dx,
      * FIXME: Probably don't need to process *all* the crossing
      * events here ... maybe there is a way to check only the last
      * event in the output buffer without roundtripping a lot */
+    privateScreen.eventCoalescer.discard (MotionNotify);
+
     while (XCheckMaskEvent (privateScreen.dpy,
 			    LeaveWindowMask |
 			    EnterWindowMask |
@@ -4278,6 +4523,50 @@ CompScreenImpl::destroyedWindows ()
     return windowManager.getDestroyedWindows();
 }
 
+const CompWindowList &
+CompScreenImpl::windowPaintOrder ()
+{
+    return windowManager.getPaintOrder ();
+}
+
+unsigned int
+CompScreenImpl::windowPaintOrderGeneration ()
+{
+    return windowManager.getPaintOrderGeneration ();
+}
+
+void
+CompScreenImpl::freezeWindowPaintOrder ()
+{
+    windowManager.freezePaintOrder ();
+}
+
+void
+CompScreenImpl::thawWindowPaintOrder ()
+{
+    windowManager.thawPaintOrder ();
+}
+
+void
+CompScreenImpl::updateWindowOutputRect (CompWindow *w)
+{
+    windowManager.updateSpatialIndex (w);
+}
+
+void
+CompScreenImpl::findWindowsInRect (const CompRect   &rect,
+				   CompWindowVector &windows)
+{
+    windowManager.findWindowsInRect (rect, windows);
+}
+
+void
+CompScreenImpl::findWindowsAt (const CompPoint  &point,
+			       CompWindowVector &windows)
+{
+    windowManager.findWindowsAt (point, windows);
+}
+
 
 Time
 CompScreenImpl::getCurrentTime ()
@@ -4387,6 +4676,8 @@ cps::WindowManager::removeDestroyed ()
 	{
 	    if (w->destroyed ())
 	    {
+		paintOrder.remove (w);
+		spatialIndex.remove (w);
 		delete w;
 		break;
 	    }
@@ -4536,6 +4827,8 @@ CompScreenImpl::init (const char *name)
 
 	privateScreen.optionSetToggleWindowShadedKeyInitiate (CompScreenImpl::shadeWin);
 
+	privateScreen.optionSetDumpInputLatencyKeyInitiate (CompScreenImpl::dumpInputLatency);
+
 	privateScreen.initPlugins();
 
 	if (debugOutput)
@@ -4750,6 +5043,10 @@ PrivateScreen::initDisplay (const char *name, cps::History& history, unsigned in
     xRandr.init<XRRQueryExtension> (dpy);
     xShape.init<XShapeQueryExtension> (dpy);
 
+    int damageEvent, damageError;
+    if (XDamageQueryExtension (dpy, &damageEvent, &damageError))
+	eventCoalescer.setDamageEvent (damageEvent + XDamageNotify);
+
     xkbEvent.init<XkbQueryExtension> (dpy);
     if (xkbEvent.isEnabled ())
     {
@@ -5140,6 +5437,7 @@ PrivateScreen::initDisplay (const char *name, cps::History& history, unsigned in
      * especially those that modify option values */
     viewPort.vpSize.setWidth (optionGetHsize ());
     viewPort.vpSize.setHeight (optionGetVsize ());
+    updateSpatialBounds ();
     setDesktopHints ();
 
     setAudibleBell (optionGetAudibleBell ());
@@ -5160,7 +5458,13 @@ CompScreenImpl::~CompScreenImpl ()
     privateScreen.startupSequence.removeAllSequences ();
 
     while (!windowManager.getWindows().empty ())
-        delete windowManager.getWindows().front ();
+    {
+	CompWindow *w = windowManager.getWindows().front ();
+
+	windowManager.removeFromPaintOrder (w);
+	windowManager.removeFromSpatialIndex (w);
+	delete w;
+    }
 
     while (CompPlugin* p = CompPlugin::pop ())
 	CompPlugin::unload (p);
@@ -5226,6 +5530,8 @@ PrivateScreen::PrivateScreen (CompScreen *screen, cps::WindowManager& windowMana
 	screenEdge[i].count = 0;
     }
 
+    eventCoalescer.setConfigureIsExpected (
+	boost::bind (&PrivateScreen::expectsConfigureNotify, this, _1));
 }
 
 cps::History::History() :
@@ -5240,9 +5546,15 @@ cps::WindowManager::WindowManager() :
     serverWindows (),
     destroyedWindows (),
     stackIsFresh (false),
+    windowsMap (),
+    framesMap (),
+    serverFramesMap (),
+    stackOrder (windows, stackLabelOf),
+    serverStackOrder (serverWindows, serverStackLabelOf),
+    paintOrder (windows, paintEntryOf, paintBelowOf, paintHeldBelow),
+    spatialIndex (spatialEntryOf),
     groups (0),
-    pendingDestroys (0),
-    lastFoundWindow(0)
+    pendingDestroys (0)
 {
 }
 
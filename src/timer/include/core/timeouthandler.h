@@ -42,6 +42,24 @@ class TimeoutHandler : boost::noncopyable
 	void addTimer (CompTimer *timer);
 	void removeTimer (CompTimer *timer);
 
+	/**
+	 * Returns the active timer with the earliest minimum expiry time,
+	 * or NULL if there are no active timers.
+	 */
+	CompTimer * earliest ();
+
+	/**
+	 * Returns the active timer with the earliest maximum expiry time,
+	 * or NULL if there are no active timers. Waking up at this time
+	 * lets every timer whose min/max window it falls into fire at once.
+	 */
+	CompTimer * mostUrgent ();
+
+	/**
+	 * Returns the active timers sorted by their minimum expiry time.
+	 * The list is rebuilt on every call, so it should only be used for
+	 * debugging and tests.
+	 */
 	std::list <CompTimer *>  & timers ();
 
 	static TimeoutHandler *
@@ -28,10 +28,12 @@
 
 #include <boost/function.hpp>
 #include <sys/time.h>
+#include <time.h>
 #include <glibmm/main.h>
 
 class CompTimeoutSource;
 class PrivateTimer;
+class PrivateTimeoutHandler;
 
 namespace compiz {
 namespace core {
@@ -46,6 +48,16 @@ namespace timer {
 	    return (((tv1->tv_sec - 1 - tv2->tv_sec) * 1000000) +
 		   (1000000 + tv1->tv_usec - tv2->tv_usec)) / 1000;
     }
+
+    /* Like gettimeofday, but CLOCK_MONOTONIC never jumps backwards */
+    inline void monotonic_time (struct timeval *tv)
+    {
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	tv->tv_sec = ts.tv_sec;
+	tv->tv_usec = ts.tv_nsec / 1000;
+    }
 }
 }
 }
@@ -139,6 +151,7 @@ class CompTimer {
 
 	PrivateTimer *priv;
 
+    friend class PrivateTimeoutHandler;
 };
 
 #endif
@@ -27,10 +27,42 @@
 #define _COMPIZ_PRIVATETIMEOUTHANDLER_H
 
 #include <core/timeouthandler.h>
+#include <cstddef>
+#include <vector>
 
+/*
+ * Active timers are kept in two indexed binary heaps, one ordered by
+ * the minimum and one by the maximum deadline. Each timer remembers its
+ * position in both, so adding, removing and re-arming are O(log n) and
+ * the next wakeup can be read off the top of the heaps.
+ */
 class PrivateTimeoutHandler
 {
     public:
-	std::list <CompTimer *> mTimers;
+
+	enum Deadline
+	{
+	    MinDeadline = 0,
+	    MaxDeadline = 1
+	};
+
+	PrivateTimeoutHandler ();
+
+	bool queued (CompTimer *timer) const;
+	void insert (CompTimer *timer);
+	void erase (CompTimer *timer);
+	CompTimer * top (Deadline d) const;
+
+	static bool before (Deadline d, CompTimer *a, CompTimer *b);
+
+	std::vector <CompTimer *> mHeap[2];
+	std::list <CompTimer *>   mTimers;
+	unsigned int              mSequence;
+
+    private:
+
+	void place (Deadline d, std::size_t index, CompTimer *timer);
+	void siftUp (Deadline d, std::size_t index);
+	void siftDown (Deadline d, std::size_t index);
 };
 #endif
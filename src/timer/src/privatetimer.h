@@ -24,6 +24,7 @@
  */
 
 #include <core/timer.h>
+#include <cstddef>
 
 #ifndef _PRIVATETIMER_H
 #define _PRIVATETIMER_H
@@ -41,6 +42,11 @@ class PrivateTimer
 	gint64                   mMinDeadline;
 	gint64                   mMaxDeadline;
 	CompTimer::CallBack      mCallBack;
+
+	/* Position in the TimeoutHandler heaps, NotQueued if not added */
+	static const std::size_t NotQueued = static_cast <std::size_t> (-1);
+	std::size_t              mHeapIndex[2];
+	unsigned int             mSequence;
 };
 
 #endif
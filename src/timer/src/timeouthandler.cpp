@@ -25,6 +25,7 @@
  */
 
 #include "privatetimeouthandler.h"
+#include "privatetimer.h"
 #include "core/timer.h"
 
 #include <boost/scoped_ptr.hpp>
@@ -35,53 +36,188 @@ namespace
   static boost::scoped_ptr<TimeoutHandler> gDefault;
 }
 
-TimeoutHandler::TimeoutHandler () :
-    priv (new PrivateTimeoutHandler ())
+PrivateTimeoutHandler::PrivateTimeoutHandler () :
+    mSequence (0)
 {
 }
 
-TimeoutHandler::~TimeoutHandler ()
+bool
+PrivateTimeoutHandler::queued (CompTimer *timer) const
 {
-    delete priv;
+    return timer->priv->mHeapIndex[MinDeadline] != PrivateTimer::NotQueued;
+}
+
+bool
+PrivateTimeoutHandler::before (Deadline d, CompTimer *a, CompTimer *b)
+{
+    gint64 da = d == MinDeadline ? a->priv->mMinDeadline : a->priv->mMaxDeadline;
+    gint64 db = d == MinDeadline ? b->priv->mMinDeadline : b->priv->mMaxDeadline;
+
+    if (da != db)
+	return da < db;
+
+    /* Timers with the same deadline fire in the order they were added */
+    return static_cast <int> (a->priv->mSequence - b->priv->mSequence) < 0;
 }
 
 void
-TimeoutHandler::addTimer (CompTimer *timer)
+PrivateTimeoutHandler::place (Deadline d, std::size_t index, CompTimer *timer)
 {
-    std::list<CompTimer *>::iterator it;
+    mHeap[d][index] = timer;
+    timer->priv->mHeapIndex[d] = index;
+}
 
-    it = std::find (priv->mTimers.begin (), priv->mTimers.end (), timer);
+void
+PrivateTimeoutHandler::siftUp (Deadline d, std::size_t index)
+{
+    std::vector <CompTimer *> &heap = mHeap[d];
+    CompTimer                 *timer = heap[index];
 
-    if (it != priv->mTimers.end ())
-	return;
+    while (index)
+    {
+	std::size_t parent = (index - 1) / 2;
+
+	if (!before (d, timer, heap[parent]))
+	    break;
+
+	place (d, index, heap[parent]);
+	index = parent;
+    }
+
+    place (d, index, timer);
+}
 
-    for (it = priv->mTimers.begin (); it != priv->mTimers.end (); ++it)
+void
+PrivateTimeoutHandler::siftDown (Deadline d, std::size_t index)
+{
+    std::vector <CompTimer *> &heap = mHeap[d];
+    CompTimer                 *timer = heap[index];
+    std::size_t               size = heap.size ();
+
+    for (;;)
     {
-	if (timer->minTime () < (*it)->minLeft ())
+	std::size_t child = index * 2 + 1;
+
+	if (child >= size)
 	    break;
+
+	if (child + 1 < size && before (d, heap[child + 1], heap[child]))
+	    ++child;
+
+	if (!before (d, heap[child], timer))
+	    break;
+
+	place (d, index, heap[child]);
+	index = child;
+    }
+
+    place (d, index, timer);
+}
+
+void
+PrivateTimeoutHandler::insert (CompTimer *timer)
+{
+    timer->priv->mSequence = mSequence++;
+
+    for (int d = MinDeadline; d <= MaxDeadline; ++d)
+    {
+	mHeap[d].push_back (timer);
+	siftUp (static_cast <Deadline> (d), mHeap[d].size () - 1);
+    }
+}
+
+void
+PrivateTimeoutHandler::erase (CompTimer *timer)
+{
+    for (int d = MinDeadline; d <= MaxDeadline; ++d)
+    {
+	Deadline                  deadline = static_cast <Deadline> (d);
+	std::vector <CompTimer *> &heap = mHeap[d];
+	std::size_t               index = timer->priv->mHeapIndex[d];
+	CompTimer                 *last = heap.back ();
+
+	heap.pop_back ();
+	timer->priv->mHeapIndex[d] = PrivateTimer::NotQueued;
+
+	if (last == timer)
+	    continue;
+
+	/* Fill the hole with the last element and restore the heap */
+	place (deadline, index, last);
+
+	if (index && before (deadline, last, heap[(index - 1) / 2]))
+	    siftUp (deadline, index);
+	else
+	    siftDown (deadline, index);
     }
+}
+
+CompTimer *
+PrivateTimeoutHandler::top (Deadline d) const
+{
+    return mHeap[d].empty () ? NULL : mHeap[d].front ();
+}
+
+TimeoutHandler::TimeoutHandler () :
+    priv (new PrivateTimeoutHandler ())
+{
+}
+
+TimeoutHandler::~TimeoutHandler ()
+{
+    delete priv;
+}
+
+void
+TimeoutHandler::addTimer (CompTimer *timer)
+{
+    if (priv->queued (timer))
+	return;
 
     timer->setExpiryTimes (timer->minTime (), timer->maxTime ());
 
-    priv->mTimers.insert (it, timer);
+    priv->insert (timer);
 }
 
 void
 TimeoutHandler::removeTimer (CompTimer *timer)
 {
-    std::list<CompTimer *>::iterator it;
+    if (!priv->queued (timer))
+	return;
 
-    it = std::find (priv->mTimers.begin (), priv->mTimers.end (), timer);
+    priv->erase (timer);
+}
 
-    if (it == priv->mTimers.end ())
-	return;
+CompTimer *
+TimeoutHandler::earliest ()
+{
+    return priv->top (PrivateTimeoutHandler::MinDeadline);
+}
 
-    priv->mTimers.erase (it);
+CompTimer *
+TimeoutHandler::mostUrgent ()
+{
+    return priv->top (PrivateTimeoutHandler::MaxDeadline);
+}
+
+namespace
+{
+    bool
+    minDeadlineOrder (CompTimer *a, CompTimer *b)
+    {
+	return PrivateTimeoutHandler::before (PrivateTimeoutHandler::MinDeadline,
+					      a, b);
+    }
 }
 
 std::list <CompTimer *> &
 TimeoutHandler::timers ()
 {
+    std::vector <CompTimer *> sorted (priv->mHeap[PrivateTimeoutHandler::MinDeadline]);
+
+    std::sort (sorted.begin (), sorted.end (), minDeadlineOrder);
+    priv->mTimers.assign (sorted.begin (), sorted.end ());
+
     return priv->mTimers;
 }
 
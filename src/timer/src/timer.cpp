@@ -81,8 +81,10 @@ bool
 CompTimeoutSource::prepare (int &timeout)
 {
     /* Determine time to wait */
+    TimeoutHandler *handler = TimeoutHandler::Default ();
+    CompTimer      *first = handler->earliest ();
 
-    if (TimeoutHandler::Default ()->timers ().empty ())
+    if (!first)
     {
 	/* This kind of sucks, but we have to do it, considering
 	 * that glib provides us no safe way to remove the source -
@@ -96,26 +98,12 @@ CompTimeoutSource::prepare (int &timeout)
 	return true;
     }
 
-    if (TimeoutHandler::Default ()->timers ().front ()->minLeft () > 0)
-    {
-	std::list<CompTimer *>::iterator it = TimeoutHandler::Default ()->timers ().begin ();
-
-	CompTimer *t = (*it);
-	timeout = t->maxLeft ();
-	while (it != TimeoutHandler::Default ()->timers ().end ())
-	{
-	    t = (*it);
-	    if (t->minLeft () >= (unsigned int) timeout)
-		break;
-	    if (t->maxLeft () < (unsigned int) timeout)
-		timeout = (int) t->maxLeft ();
-	    ++it;
-	}
-    }
+    /* Sleep until the earliest maximum deadline, at which point every
+     * timer whose minimum deadline has passed fires in the same wakeup */
+    if (first->minLeft () > 0)
+	timeout = (int) handler->mostUrgent ()->maxLeft ();
     else
-    {
 	timeout = 0;
-    }
 
     return timeout <= 0;
 }
@@ -123,8 +111,9 @@ CompTimeoutSource::prepare (int &timeout)
 bool
 CompTimeoutSource::check ()
 {
-    return (!TimeoutHandler::Default ()->timers ().empty () &&
-	     TimeoutHandler::Default ()->timers ().front ()->minLeft () <= 0);
+    CompTimer *first = TimeoutHandler::Default ()->earliest ();
+
+    return first && first->minLeft () <= 0;
 }
 
 bool
@@ -138,14 +127,14 @@ bool
 CompTimeoutSource::callback ()
 {
     TimeoutHandler *handler = TimeoutHandler::Default ();
-    std::list<CompTimer*> requeue, &timers = handler->timers ();
+    std::list<CompTimer*> requeue;
+    CompTimer *t;
 
-    while (!timers.empty ())
+    while ((t = handler->earliest ()))
     {
-	CompTimer *t = timers.front ();
 	if (t->minLeft () > 0)
 	    break;
-	timers.pop_front ();
+	handler->removeTimer (t);
 	t->setActive (false);
 	if (t->triggerCallback ())
 	    requeue.push_back (t);
@@ -159,17 +148,21 @@ CompTimeoutSource::callback ()
 	t->setActive (true);
     }
 
-    return !timers.empty ();
+    return handler->earliest () != NULL;
 }
 
+const std::size_t PrivateTimer::NotQueued;
+
 PrivateTimer::PrivateTimer () :
     mActive (false),
     mMinTime (0),
     mMaxTime (0),
     mMinDeadline (0),
     mMaxDeadline (0),
-    mCallBack (NULL)
+    mCallBack (NULL),
+    mSequence (0)
 {
+    mHeapIndex[0] = mHeapIndex[1] = NotQueued;
 }
 
 PrivateTimer::~PrivateTimer ()
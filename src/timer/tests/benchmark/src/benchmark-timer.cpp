@@ -0,0 +1,112 @@
+/*
+ * Times adding, re-arming and removing 10000 timers, and the cost of
+ * computing the next wakeup with all of them queued.
+ *
+ * Run compiz_timer_benchmark [timers]
+ */
+
+#include <core/timer.h>
+#include <core/timeouthandler.h>
+#include <privatetimeoutsource.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace
+{
+
+class BenchmarkTimeoutSource :
+    public CompTimeoutSource
+{
+    public:
+
+	static Glib::RefPtr <BenchmarkTimeoutSource>
+	create (Glib::RefPtr <Glib::MainContext> &ctx)
+	{
+	    return Glib::RefPtr <BenchmarkTimeoutSource> (new BenchmarkTimeoutSource (ctx));
+	}
+
+	using CompTimeoutSource::prepare;
+
+    private:
+
+	explicit BenchmarkTimeoutSource (Glib::RefPtr <Glib::MainContext> &ctx) :
+	    CompTimeoutSource (ctx)
+	{
+	}
+};
+
+bool
+callback ()
+{
+    return false;
+}
+
+double
+now ()
+{
+    return g_get_monotonic_time () / 1000.0;
+}
+
+void
+report (const char *name, double ms, unsigned int n)
+{
+    printf ("%-28s %10.2f ms %10.1f ns/op\n", name, ms, ms * 1000000.0 / n);
+}
+
+}
+
+int
+main (int argc, char **argv)
+{
+    unsigned int nTimers = argc > 1 ? atoi (argv[1]) : 10000;
+    unsigned int nWakeups = 100000;
+
+    Glib::RefPtr <Glib::MainContext> ctx = Glib::MainContext::get_default ();
+    Glib::RefPtr <BenchmarkTimeoutSource> source = BenchmarkTimeoutSource::create (ctx);
+
+    TimeoutHandler::SetDefault (new TimeoutHandler ());
+
+    std::vector <CompTimer *> timers (nTimers);
+
+    srand (1);
+
+    for (unsigned int i = 0; i < nTimers; ++i)
+    {
+	timers[i] = new CompTimer ();
+	timers[i]->setCallback (callback);
+	timers[i]->setTimes (1000 + rand () % 10000, 12000 + rand () % 10000);
+    }
+
+    double start = now ();
+    for (unsigned int i = 0; i < nTimers; ++i)
+	timers[i]->start ();
+    report ("start", now () - start, nTimers);
+
+    start = now ();
+    for (unsigned int i = 0; i < nTimers; ++i)
+	timers[rand () % nTimers]->start (1000 + rand () % 10000,
+					  12000 + rand () % 10000);
+    report ("re-arm", now () - start, nTimers);
+
+    int timeout = 0;
+
+    start = now ();
+    for (unsigned int i = 0; i < nWakeups; ++i)
+	source->prepare (timeout);
+    report ("prepare", now () - start, nWakeups);
+
+    start = now ();
+    for (unsigned int i = 0; i < nTimers; ++i)
+	timers[i]->stop ();
+    report ("stop", now () - start, nTimers);
+
+    for (unsigned int i = 0; i < nTimers; ++i)
+	delete timers[i];
+
+    TimeoutHandler::SetDefault (NULL);
+    source->destroy ();
+
+    return 0;
+}
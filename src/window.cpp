@@ -46,6 +46,7 @@
 #include "privatewindow.h"
 #include "privatescreen.h"
 #include "privatestackdebugger.h"
+#include "privatematch.h"
 
 #include "configurerequestbuffer-impl.h"
 
@@ -846,6 +847,7 @@ CompWindow::updateWindowOutputExtents ()
     {
 	priv->output = output;
 
+	screen->updateWindowOutputRect (this);
 	resizeNotify (0, 0, 0, 0);
     }
 }
@@ -1356,6 +1358,7 @@ CompWindow::map ()
     }
 
     windowNotify (CompWindowNotifyMap);
+    screen->updateWindowOutputRect (this);
     /* Send a resizeNotify to plugins to indicate
      * that the map is complete */
     resizeNotify (0, 0, 0, 0);
@@ -1545,6 +1548,7 @@ PrivateWindow::resize (const CompWindow::Geometry &gm)
 	    if (priv->mapNum)
 		priv->updateRegion ();
 
+	    screen->updateWindowOutputRect (window);
 	    window->resizeNotify (dx, dy, dwidth, dheight);
 	}
     }
@@ -1895,6 +1899,7 @@ PrivateWindow::move (int dx,
 
 	    priv->invisible = priv->isInvisible ();
 
+	    screen->updateWindowOutputRect (window);
 	    window->moveNotify (dx, dy, true);
 	}
     }
@@ -3283,6 +3288,7 @@ PrivateWindow::reconfigureXWindow (unsigned int   valueMask,
 	if (valueMask & (CWWidth | CWHeight))
 	{
 	    updateRegion ();
+	    screen->updateWindowOutputRect (window);
 	    window->resizeNotify (dx, dy, dwidth, dheight);
 	}
 	else if (valueMask & (CWX | CWY))
@@ -3295,6 +3301,7 @@ PrivateWindow::reconfigureXWindow (unsigned int   valueMask,
 
 	    if (dx || dy)
 	    {
+		screen->updateWindowOutputRect (window);
 		window->moveNotify (dx, dy, priv->nextMoveImmediate);
 		priv->nextMoveImmediate = true;
 	    }
@@ -4363,11 +4370,14 @@ CompWindow::updateAttributes (CompStackingUpdateMode stackingMode)
 	if (sibling &&
 	    (stackingMode == CompStackingUpdateModeInitialMapDeniedFocus))
 	{
-	    CompWindow *p;
+	    CompWindow *p = screen->findWindow (screen->activeWindow ());
 
-	    for (p = sibling; p; p = p->serverPrev)
-		if (p->priv->id == screen->activeWindow ())
-		    break;
+	    /* Only interesting if the active window is at or
+	     * below sibling */
+	    if (p && (!p->priv->serverStacked			||
+		      !sibling->priv->serverStacked		||
+		      PrivateWindow::serverStackedAbove (p, sibling)))
+		p = NULL;
 
 	    /* window is above active window so we should lower it,
 	     * assuing that is allowed (if, for example, our window has
@@ -5623,15 +5633,10 @@ PrivateWindow::updatePassiveButtonGrabs ()
 		    PrivateWindow::findSiblingBelow (window, true, lock);
 
 	    /* Check if this window is permitted to be raised */
-	    for (CompWindow *above = window->serverNext;
-		above != NULL; above = above->serverNext)
-	    {
-		if (highestSibling == above)
-		{
-		    onlyActions = false;
-		    break;
-		}
-	    }
+	    if (highestSibling && serverStacked &&
+		highestSibling->priv->serverStacked &&
+		serverStackedAbove (highestSibling, window))
+		onlyActions = false;
 	}
     }
 
@@ -6433,6 +6438,16 @@ PrivateWindow::PrivateWindow () :
     closeRequests (false),
     lastCloseRequestTime (0),
 
+    matchSlot (PrivateMatch::allocateWindowSlot ()),
+    matchGeneration (PrivateMatch::nextWindowGeneration ()),
+
+    stackEntry (),
+    serverStackEntry (),
+    stackLabel (0),
+    serverStackLabel (0),
+    stacked (false),
+    serverStacked (false),
+
     syncServerWindow (screen->dpy (),
 		      &id,
 		      &serverFrame),
@@ -6487,6 +6502,8 @@ PrivateWindow::~PrivateWindow ()
 
     if (resClass)
 	free (resClass);
+
+    PrivateMatch::releaseWindowSlot (matchSlot);
 }
 
 bool
@@ -6724,6 +6741,8 @@ CompWindow::setWindowFrameExtents (const CompWindowExtents *b,
 	windowNotify (CompWindowNotifyFrameUpdate);
 	recalcActions ();
 
+	screen->updateWindowOutputRect (this);
+
 	/* Always send a moveNotify
 	 * whenever the frame extents update
 	 * so that plugins can re-position appropriately */
@@ -6862,6 +6881,9 @@ PrivateWindow::reparent ()
 					  serverInput.bottom),
 			     0);
 
+    Window oldFrame       = frame;
+    Window oldServerFrame = serverFrame;
+
     /* Awaiting a new frame to be given to us */
     frame       = None;
     serverFrame = XCreateWindow (dpy,
@@ -6877,6 +6899,8 @@ PrivateWindow::reparent ()
 				 mask,
 				 &attr);
 
+    screen->updateFrameWindows (window, oldFrame, oldServerFrame);
+
     /* Do not get any events from here on */
     XSelectInput (dpy, screen->root (), NoEventMask);
 
@@ -7137,10 +7161,15 @@ PrivateWindow::unreparent ()
      * handle the ReparentNotify */
     pendingConfigures.clear ();
 
+    Window oldFrame       = frame;
+    Window oldServerFrame = serverFrame;
+
     frame       = None;
     wrapper     = None;
     serverFrame = None;
 
+    screen->updateFrameWindows (window, oldFrame, oldServerFrame);
+
     // Finally, (i.e. after updating state) notify the change
     window->windowNotify (CompWindowNotifyUnreparent);
 }
@@ -0,0 +1,187 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_WINDOW_IDMAP_H
+#define _COMPIZ_WINDOW_IDMAP_H
+
+#include <vector>
+
+namespace compiz
+{
+namespace window
+{
+
+/**
+ * Maps X resource ids to windows with open addressing.
+ *
+ * Ids are spread with Fibonacci hashing, so clients that allocate
+ * consecutive ids from their resource base do not cluster. Collisions
+ * are resolved by linear probing and erasing shifts the following
+ * entries back, so the table never fills up with tombstones. The
+ * table is kept at most half full.
+ *
+ * Id 0 (None) marks an empty slot and can't be stored.
+ */
+template <typename T>
+class IdMap
+{
+    public:
+
+	typedef unsigned long Id;
+
+	IdMap () :
+	    mSlots (MinSize),
+	    mCount (0),
+	    mShift (64 - MinBits)
+	{
+	}
+
+	/* Returns T () if id is not in the map */
+	T find (Id id) const
+	{
+	    if (!id)
+		return T ();
+
+	    for (unsigned int i = home (id);; i = next (i))
+	    {
+		const Slot &slot = mSlots[i];
+
+		if (slot.id == id)
+		    return slot.value;
+		else if (!slot.id)
+		    return T ();
+	    }
+	}
+
+	void insert (Id id, T value)
+	{
+	    if (!id)
+		return;
+
+	    if ((mCount + 1) * 2 > mSlots.size ())
+		grow ();
+
+	    unsigned int i = home (id);
+
+	    while (mSlots[i].id && mSlots[i].id != id)
+		i = next (i);
+
+	    if (!mSlots[i].id)
+		++mCount;
+
+	    mSlots[i].id    = id;
+	    mSlots[i].value = value;
+	}
+
+	void erase (Id id)
+	{
+	    if (!id)
+		return;
+
+	    unsigned int i = home (id);
+
+	    while (mSlots[i].id != id)
+	    {
+		if (!mSlots[i].id)
+		    return;
+
+		i = next (i);
+	    }
+
+	    /* Move back every following entry which would otherwise
+	     * become unreachable from its home slot */
+	    for (unsigned int j = next (i); mSlots[j].id; j = next (j))
+	    {
+		unsigned int k = home (mSlots[j].id);
+
+		if ((j > i && (k <= i || k > j)) ||
+		    (j < i && (k <= i && k > j)))
+		{
+		    mSlots[i] = mSlots[j];
+		    i = j;
+		}
+	    }
+
+	    mSlots[i] = Slot ();
+	    --mCount;
+	}
+
+	unsigned int size () const
+	{
+	    return mCount;
+	}
+
+	void clear ()
+	{
+	    std::vector<Slot> (MinSize).swap (mSlots);
+	    mCount = 0;
+	    mShift = 64 - MinBits;
+	}
+
+    private:
+
+	struct Slot
+	{
+	    Slot () : id (0), value () {}
+
+	    Id id;
+	    T  value;
+	};
+
+	static const unsigned int MinBits = 4;
+	static const unsigned int MinSize = 1 << MinBits;
+
+	unsigned int home (Id id) const
+	{
+	    unsigned long long h = (unsigned long long) id;
+
+	    return (unsigned int) ((h * 0x9e3779b97f4a7c15ULL) >> mShift);
+	}
+
+	unsigned int next (unsigned int i) const
+	{
+	    return (i + 1) & (mSlots.size () - 1);
+	}
+
+	void grow ()
+	{
+	    std::vector<Slot> old (mSlots.size () * 2);
+
+	    old.swap (mSlots);
+	    --mShift;
+	    mCount = 0;
+
+	    for (unsigned int i = 0; i < old.size (); ++i)
+		if (old[i].id)
+		    insert (old[i].id, old[i].value);
+	}
+
+	std::vector<Slot> mSlots;
+	unsigned int      mCount;
+	unsigned int      mShift;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,208 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_WINDOW_PAINTORDER_H
+#define _COMPIZ_WINDOW_PAINTORDER_H
+
+#include <list>
+
+namespace compiz
+{
+namespace window
+{
+
+/**
+ * The windows of a bottom to top stack list with the destroyed
+ * windows that are still being painted kept in between, each one
+ * right below the window it was stacked under when it went away.
+ *
+ * The list is kept up to date as windows are stacked and deleted
+ * rather than rebuilt for every paint. A destroyed window never
+ * moves on its own, but follows the window it is held below when
+ * that one is restacked.
+ *
+ * While frozen, restacked and new windows are only marked. thaw ()
+ * puts them in place walking the stack once, so a paint that is
+ * iterating over the list never sees it reordered. Deleting is not
+ * deferred, windows are only deleted from the main loop.
+ *
+ * The generation changes whenever the order does.
+ */
+template <typename T>
+class PaintOrder
+{
+    public:
+
+	typedef std::list<T>                   List;
+	typedef typename List::iterator        iterator;
+	typedef typename List::const_iterator  const_iterator;
+
+	struct Entry
+	{
+	    Entry () : listed (false), pending (false) {}
+
+	    iterator position;
+	    bool     listed;
+	    bool     pending;
+	};
+
+	typedef Entry & (*EntryFunc) (T);
+
+	/* The window right below in the stack, or 0 at the bottom */
+	typedef T (*BelowFunc) (T);
+
+	/* Whether the first window is destroyed and painted right
+	 * below the second */
+	typedef bool (*HeldBelowFunc) (T, T);
+
+	PaintOrder (const List    &stack,
+		    EntryFunc     entry,
+		    BelowFunc     below,
+		    HeldBelowFunc heldBelow) :
+	    mStack (stack),
+	    mEntry (entry),
+	    mBelow (below),
+	    mHeldBelow (heldBelow),
+	    mFrozen (0),
+	    mGeneration (0)
+	{
+	}
+
+	const List & list () const { return mList; }
+	unsigned int generation () const { return mGeneration; }
+
+	/* Call after w was inserted into the stack */
+	void inserted (T w)
+	{
+	    if (mFrozen)
+		mEntry (w).pending = true;
+	    else
+		place (w);
+	}
+
+	/* Call before w is deleted */
+	void remove (T w)
+	{
+	    Entry &e = mEntry (w);
+
+	    e.pending = false;
+
+	    if (!e.listed)
+		return;
+
+	    mList.erase (e.position);
+	    e.listed = false;
+	    ++mGeneration;
+	}
+
+	/* Calls nest */
+	void freeze ()
+	{
+	    ++mFrozen;
+	}
+
+	void thaw ()
+	{
+	    if (!mFrozen || --mFrozen)
+		return;
+
+	    /* Bottom to top, so the window below is always in
+	     * its final place already */
+	    for (const_iterator it = mStack.begin (); it != mStack.end (); ++it)
+	    {
+		Entry &e = mEntry (*it);
+
+		if (e.pending)
+		{
+		    e.pending = false;
+		    place (*it);
+		}
+	    }
+	}
+
+    private:
+
+	void place (T w)
+	{
+	    Entry    &e    = mEntry (w);
+	    T        b     = mBelow (w);
+	    iterator dest  = mList.begin ();
+
+	    if (b && mEntry (b).listed)
+	    {
+		dest = mEntry (b).position;
+		++dest;
+	    }
+
+	    if (!e.listed)
+	    {
+		e.position = mList.insert (dest, w);
+		e.listed   = true;
+		++mGeneration;
+		return;
+	    }
+
+	    /* Take the destroyed windows held below along, and the
+	     * ones held below those */
+	    iterator first = e.position;
+	    iterator last  = e.position;
+
+	    while (first != mList.begin ())
+	    {
+		iterator candidate = first;
+
+		if (!heldBelowRun (*--candidate, first, last))
+		    break;
+
+		first = candidate;
+	    }
+
+	    if (dest == first || dest == ++last)
+		return;
+
+	    mList.splice (dest, mList, first, last);
+	    ++mGeneration;
+	}
+
+	bool heldBelowRun (T dw, iterator first, iterator last)
+	{
+	    for (++last; first != last; ++first)
+		if (mHeldBelow (dw, *first))
+		    return true;
+
+	    return false;
+	}
+
+	List          mList;
+	const List    &mStack;
+	EntryFunc     mEntry;
+	BelowFunc     mBelow;
+	HeldBelowFunc mHeldBelow;
+	unsigned int  mFrozen;
+	unsigned int  mGeneration;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,300 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_WINDOW_SPATIALINDEX_H
+#define _COMPIZ_WINDOW_SPATIALINDEX_H
+
+#include <vector>
+#include <algorithm>
+
+namespace compiz
+{
+namespace window
+{
+
+/**
+ * Finds the windows covering a rectangle or a point without looking
+ * at every window.
+ *
+ * The bounds are cut into square cells and every window is listed
+ * in each cell its rectangle touches. Windows outside the bounds
+ * are listed in the cells along the edge they are beyond, so they
+ * are still found, just not as quickly.
+ *
+ * Queries return windows in no particular order and each window
+ * only once. Rectangles are half open, a window at 0,0 that is 10
+ * wide covers x 0 to 9.
+ */
+template <typename T>
+class SpatialIndex
+{
+    public:
+
+	struct Entry
+	{
+	    Entry () : listed (false) {}
+
+	    /* The rectangle and the cells it is listed in */
+	    int          x1, y1, x2, y2;
+	    int          cx1, cy1, cx2, cy2;
+	    unsigned int index;
+	    bool         listed;
+	};
+
+	typedef Entry & (*EntryFunc) (T);
+
+	static const int DefaultCellSize = 256;
+
+	SpatialIndex (EntryFunc entry, int cellSize = DefaultCellSize) :
+	    mEntry (entry),
+	    mCellSize (cellSize),
+	    mX (0),
+	    mY (0),
+	    mColumns (1),
+	    mRows (1),
+	    mCells (1)
+	{
+	}
+
+	/* Lists every window again if the cells change */
+	void setBounds (int x, int y, int width, int height)
+	{
+	    int columns = std::max (1, (width + mCellSize - 1) / mCellSize);
+	    int rows    = std::max (1, (height + mCellSize - 1) / mCellSize);
+
+	    if (x == mX && y == mY && columns == mColumns && rows == mRows)
+		return;
+
+	    mX       = x;
+	    mY       = y;
+	    mColumns = columns;
+	    mRows    = rows;
+
+	    std::vector<Cell> (columns * rows).swap (mCells);
+
+	    for (unsigned int i = 0; i < mWindows.size (); ++i)
+	    {
+		Entry &e = mEntry (mWindows[i]);
+
+		cellRange (e);
+		list (mWindows[i], e);
+	    }
+	}
+
+	/* Call whenever the rectangle of w changes, the first
+	 * call adds it */
+	void update (T w, int x, int y, int width, int height)
+	{
+	    Entry &e = mEntry (w);
+
+	    e.x1 = x;
+	    e.y1 = y;
+	    e.x2 = x + std::max (width, 0);
+	    e.y2 = y + std::max (height, 0);
+
+	    if (!e.listed)
+	    {
+		e.index  = mWindows.size ();
+		e.listed = true;
+		mWindows.push_back (w);
+
+		cellRange (e);
+		list (w, e);
+		return;
+	    }
+
+	    int cx1 = e.cx1, cy1 = e.cy1, cx2 = e.cx2, cy2 = e.cy2;
+
+	    cellRange (e);
+
+	    /* Moving within the same cells is common while dragging */
+	    if (cx1 == e.cx1 && cy1 == e.cy1 && cx2 == e.cx2 && cy2 == e.cy2)
+	    {
+		for (int cy = cy1; cy <= cy2; ++cy)
+		    for (int cx = cx1; cx <= cx2; ++cx)
+			*find (w, mCells[cy * mColumns + cx]) = item (w, e);
+
+		return;
+	    }
+
+	    for (int cy = cy1; cy <= cy2; ++cy)
+		for (int cx = cx1; cx <= cx2; ++cx)
+		    unlist (w, mCells[cy * mColumns + cx]);
+
+	    list (w, e);
+	}
+
+	/* Call before w is deleted */
+	void remove (T w)
+	{
+	    Entry &e = mEntry (w);
+
+	    if (!e.listed)
+		return;
+
+	    for (int cy = e.cy1; cy <= e.cy2; ++cy)
+		for (int cx = e.cx1; cx <= e.cx2; ++cx)
+		    unlist (w, mCells[cy * mColumns + cx]);
+
+	    T last = mWindows.back ();
+
+	    mWindows[e.index] = last;
+	    mEntry (last).index = e.index;
+	    mWindows.pop_back ();
+
+	    e.listed = false;
+	}
+
+	unsigned int size () const
+	{
+	    return mWindows.size ();
+	}
+
+	/* Appends the windows intersecting the rectangle */
+	void query (int x, int y, int width, int height, std::vector<T> &result)
+	{
+	    if (width <= 0 || height <= 0)
+		return;
+
+	    int x2 = x + width, y2 = y + height;
+	    int qx1 = column (x), qy1 = row (y);
+	    int qx2 = column (x2 - 1), qy2 = row (y2 - 1);
+
+	    for (int cy = qy1; cy <= qy2; ++cy)
+		for (int cx = qx1; cx <= qx2; ++cx)
+		{
+		    const Cell &cell = mCells[cy * mColumns + cx];
+
+		    for (unsigned int i = 0; i < cell.size (); ++i)
+		    {
+			const Item &it = cell[i];
+
+			/* Only the first cell of the query a window
+			 * is listed in reports it */
+			if (cx != std::max (it.cx, qx1) ||
+			    cy != std::max (it.cy, qy1))
+			    continue;
+
+			if (it.x1 < x2 && it.x2 > x && it.y1 < y2 && it.y2 > y)
+			    result.push_back (it.w);
+		    }
+		}
+	}
+
+	/* Appends the windows containing the point */
+	void query (int x, int y, std::vector<T> &result)
+	{
+	    const Cell &cell = mCells[row (y) * mColumns + column (x)];
+
+	    /* A window is only listed once per cell */
+	    for (unsigned int i = 0; i < cell.size (); ++i)
+	    {
+		const Item &it = cell[i];
+
+		if (it.x1 <= x && it.x2 > x && it.y1 <= y && it.y2 > y)
+		    result.push_back (it.w);
+	    }
+	}
+
+    private:
+
+	/* Cells keep their own copy of the rectangles, so queries
+	 * don't have to look at the windows */
+	struct Item
+	{
+	    int x1, y1, x2, y2;
+	    int cx, cy;
+	    T   w;
+	};
+
+	typedef std::vector<Item> Cell;
+
+	static Item item (T w, const Entry &e)
+	{
+	    Item it = { e.x1, e.y1, e.x2, e.y2, e.cx1, e.cy1, w };
+
+	    return it;
+	}
+
+	static typename Cell::iterator find (T w, Cell &cell)
+	{
+	    typename Cell::iterator it = cell.begin ();
+
+	    while (it->w != w)
+		++it;
+
+	    return it;
+	}
+
+	int column (int x) const
+	{
+	    if (x < mX)
+		return 0;
+
+	    return std::min ((x - mX) / mCellSize, mColumns - 1);
+	}
+
+	int row (int y) const
+	{
+	    if (y < mY)
+		return 0;
+
+	    return std::min ((y - mY) / mCellSize, mRows - 1);
+	}
+
+	/* Empty rectangles still get a cell, so they are
+	 * always listed somewhere */
+	void cellRange (Entry &e) const
+	{
+	    e.cx1 = column (e.x1);
+	    e.cy1 = row (e.y1);
+	    e.cx2 = column (std::max (e.x1, e.x2 - 1));
+	    e.cy2 = row (std::max (e.y1, e.y2 - 1));
+	}
+
+	void list (T w, const Entry &e)
+	{
+	    for (int cy = e.cy1; cy <= e.cy2; ++cy)
+		for (int cx = e.cx1; cx <= e.cx2; ++cx)
+		    mCells[cy * mColumns + cx].push_back (item (w, e));
+	}
+
+	static void unlist (T w, Cell &cell)
+	{
+	    *find (w, cell) = cell.back ();
+	    cell.pop_back ();
+	}
+
+	EntryFunc mEntry;
+	int       mCellSize;
+	int       mX, mY;
+	int       mColumns, mRows;
+
+	std::vector<Cell> mCells;
+	std::vector<T>    mWindows;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,133 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _COMPIZ_WINDOW_STACKORDER_H
+#define _COMPIZ_WINDOW_STACKORDER_H
+
+#include <list>
+
+namespace compiz
+{
+namespace window
+{
+
+/**
+ * Gives every entry of a bottom to top stack list a number which
+ * grows towards the top, so which of two windows is higher up is a
+ * single comparison instead of a walk along the list.
+ *
+ * A window inserted somewhere takes a number between the ones of its
+ * neighbours. Only when two neighbours end up with consecutive
+ * numbers is the whole list numbered again, spreading the numbers
+ * evenly over 64 bits. Pushing to either end leaves a fixed gap, so
+ * raising or lowering windows to the top or bottom over and over
+ * does not use up the space between numbers.
+ *
+ * The label function returns where an entry keeps its number.
+ */
+template <typename T>
+class StackOrder
+{
+    public:
+
+	typedef unsigned long long       Label;
+	typedef std::list<T>             List;
+	typedef typename List::iterator  iterator;
+	typedef Label & (*LabelFunc) (T);
+
+	StackOrder (List &list, LabelFunc label) :
+	    mList (list),
+	    mLabel (label),
+	    mRelabels (0)
+	{
+	}
+
+	/* Call after inserting the entry at it into the list */
+	void inserted (iterator it)
+	{
+	    iterator below = it;
+	    iterator above = it;
+	    Label    low   = Bottom;
+	    Label    high  = Top;
+
+	    if (it != mList.begin ())
+		low = mLabel (*--below);
+
+	    if (++above != mList.end ())
+		high = mLabel (*above);
+
+	    if (high - low < 2)
+	    {
+		relabel ();
+		return;
+	    }
+
+	    /* Leave room at the ends rather than halving the
+	     * remaining space every time */
+	    if (above == mList.end () && high - low > Gap)
+		mLabel (*it) = low + Gap;
+	    else if (it == mList.begin () && high - low > Gap)
+		mLabel (*it) = high - Gap;
+	    else
+		mLabel (*it) = low + (high - low) / 2;
+	}
+
+	/* Numbers the whole list again, for example after it was
+	 * rebuilt from scratch */
+	void relabel ()
+	{
+	    Label step = (Top - Bottom) / (mList.size () + 1);
+	    Label l    = Bottom;
+
+	    for (iterator it = mList.begin (); it != mList.end (); ++it)
+		mLabel (*it) = (l += step);
+
+	    ++mRelabels;
+	}
+
+	/* Whether a is stacked above b. Both have to be in the list */
+	bool above (T a, T b) const
+	{
+	    return mLabel (a) > mLabel (b);
+	}
+
+	unsigned int relabels () const
+	{
+	    return mRelabels;
+	}
+
+    private:
+
+	static const Label Bottom = 0;
+	static const Label Top    = ~0ULL;
+	static const Label Gap    = 1ULL << 32;
+
+	List         &mList;
+	LabelFunc    mLabel;
+	unsigned int mRelabels;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,252 @@
+/*
+ * Compares finding the windows on an output, in a damaged area and
+ * under the pointer by checking every window's output rect with
+ * asking a SpatialIndex.
+ *
+ * 500 windows spread over a 3x3 wall of 1920x1080 viewports with
+ * the middle one current, so the others are at negative and large
+ * positive coordinates like in core. Windows move now and then, as
+ * while dragging one around.
+ *
+ * Run compiz_window_spatialindex_benchmark [iterations]
+ */
+
+#include "windowspatialindex.h"
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+using compiz::window::SpatialIndex;
+
+namespace
+{
+
+const int nWindows (500);
+const int screenWidth (1920);
+const int screenHeight (1080);
+const int hsize (3);
+const int vsize (3);
+
+struct Window
+{
+    int x, y, width, height;
+
+    SpatialIndex<Window *>::Entry entry;
+};
+
+SpatialIndex<Window *>::Entry &
+entryOf (Window *w)
+{
+    return w->entry;
+}
+
+struct Query
+{
+    int x, y, width, height;
+};
+
+double
+now ()
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* Keeps the optimiser from throwing the work away */
+volatile unsigned long sink;
+
+void
+timeRects (std::vector<Window>       &windows,
+	   SpatialIndex<Window *>    &index,
+	   const std::vector<Query>  &rects,
+	   int                       iterations,
+	   double                    &scanTime,
+	   double                    &indexTime)
+{
+    std::vector<Window *> found;
+
+    found.reserve (windows.size ());
+
+    double start = now ();
+
+    for (int n = 0; n < iterations; ++n)
+    {
+	const Query &q = rects[n & 4095];
+
+	found.clear ();
+
+	for (unsigned int i = 0; i < windows.size (); ++i)
+	{
+	    const Window &w = windows[i];
+
+	    if (w.x < q.x + q.width && w.x + w.width > q.x &&
+		w.y < q.y + q.height && w.y + w.height > q.y)
+		found.push_back (&windows[i]);
+	}
+
+	sink += found.size ();
+    }
+
+    scanTime = now () - start;
+
+    start = now ();
+
+    for (int n = 0; n < iterations; ++n)
+    {
+	const Query &q = rects[n & 4095];
+
+	found.clear ();
+	index.query (q.x, q.y, q.width, q.height, found);
+
+	sink += found.size ();
+    }
+
+    indexTime = now () - start;
+}
+
+}
+
+int
+main (int argc, char **argv)
+{
+    int                    iterations = argc > 1 ? atoi (argv[1]) : 200000;
+    std::vector<Window>    windows (nWindows);
+    SpatialIndex<Window *> index (entryOf);
+    std::vector<Query>     rects (4096);
+    std::vector<Query>     points (4096);
+    std::vector<Window *>  found;
+
+    srand (5);
+
+    /* Every place the current viewport can be, as core does */
+    index.setBounds (-(hsize - 1) * screenWidth, -(vsize - 1) * screenHeight,
+		     (2 * hsize - 1) * screenWidth, (2 * vsize - 1) * screenHeight);
+
+    for (int i = 0; i < nWindows; ++i)
+    {
+	Window &w = windows[i];
+
+	w.width  = 200 + rand () % 1000;
+	w.height = 150 + rand () % 700;
+	w.x      = (rand () % hsize - 1) * screenWidth +
+		   rand () % (screenWidth - w.width / 2);
+	w.y      = (rand () % vsize - 1) * screenHeight +
+		   rand () % (screenHeight - w.height / 2);
+
+	index.update (&w, w.x, w.y, w.width, w.height);
+    }
+
+    /* Damage from a window or two, outputs are added below */
+    for (unsigned int i = 0; i < rects.size (); ++i)
+    {
+	Query &q = rects[i];
+
+	q.x = rand () % screenWidth;
+	q.y = rand () % screenHeight;
+	q.width  = 20 + rand () % 400;
+	q.height = 20 + rand () % 300;
+
+	points[i].x = rand () % screenWidth;
+	points[i].y = rand () % screenHeight;
+    }
+
+    found.reserve (nWindows);
+
+    printf ("%d windows on a %dx%d wall, %d iterations\n",
+	    nWindows, hsize, vsize, iterations);
+
+    double scanDamageTime, indexDamageTime;
+    double scanOutputTime, indexOutputTime;
+
+    timeRects (windows, index, rects, iterations,
+	       scanDamageTime, indexDamageTime);
+
+    /* Two outputs side by side on the current viewport */
+    for (unsigned int i = 0; i < rects.size (); ++i)
+    {
+	rects[i].x      = i % 2 ? screenWidth / 2 : 0;
+	rects[i].y      = 0;
+	rects[i].width  = screenWidth / 2;
+	rects[i].height = screenHeight;
+    }
+
+    timeRects (windows, index, rects, iterations,
+	       scanOutputTime, indexOutputTime);
+
+    double start = now ();
+
+    start = now ();
+
+    for (int n = 0; n < iterations; ++n)
+    {
+	const Query &p = points[n & 4095];
+
+	found.clear ();
+
+	for (int i = 0; i < nWindows; ++i)
+	{
+	    const Window &w = windows[i];
+
+	    if (w.x <= p.x && w.x + w.width > p.x &&
+		w.y <= p.y && w.y + w.height > p.y)
+		found.push_back (&windows[i]);
+	}
+
+	sink += found.size ();
+    }
+
+    double scanPointTime = now () - start;
+
+    start = now ();
+
+    for (int n = 0; n < iterations; ++n)
+    {
+	const Query &p = points[n & 4095];
+
+	found.clear ();
+	index.query (p.x, p.y, found);
+
+	sink += found.size ();
+    }
+
+    double indexPointTime = now () - start;
+
+    /* Dragging a window a few pixels per motion event */
+    start = now ();
+
+    for (int n = 0; n < iterations; ++n)
+    {
+	Window &w = windows[n % nWindows];
+
+	w.x += n & 1 ? 3 : -2;
+	w.y += n & 2 ? 2 : -1;
+
+	index.update (&w, w.x, w.y, w.width, w.height);
+    }
+
+    double updateTime = now () - start;
+
+    printf ("%-24s %8.2f ns/query\n", "damage, every window",
+	    scanDamageTime * 1000000.0 / iterations);
+    printf ("%-24s %8.2f ns/query %8.2fx\n", "damage, index",
+	    indexDamageTime * 1000000.0 / iterations,
+	    scanDamageTime / indexDamageTime);
+    printf ("%-24s %8.2f ns/query\n", "output, every window",
+	    scanOutputTime * 1000000.0 / iterations);
+    printf ("%-24s %8.2f ns/query %8.2fx\n", "output, index",
+	    indexOutputTime * 1000000.0 / iterations,
+	    scanOutputTime / indexOutputTime);
+    printf ("%-24s %8.2f ns/query\n", "point, every window",
+	    scanPointTime * 1000000.0 / iterations);
+    printf ("%-24s %8.2f ns/query %8.2fx\n", "point, index",
+	    indexPointTime * 1000000.0 / iterations,
+	    scanPointTime / indexPointTime);
+    printf ("%-24s %8.2f ns/update\n", "moving a window",
+	    updateTime * 1000000.0 / iterations);
+
+    return 0;
+}
@@ -0,0 +1,166 @@
+/*
+ * Compares finding windows by id in a std::map with the IdMap, and
+ * deciding which of two windows is stacked higher by walking the
+ * stack with comparing their StackOrder labels.
+ *
+ * 1500 windows with ids from a handful of clients, as with a few
+ * browsers and terminals opening override redirect menus.
+ *
+ * Run compiz_window_stacking_benchmark [iterations]
+ */
+
+#include "windowidmap.h"
+#include "windowstackorder.h"
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <map>
+#include <vector>
+
+using compiz::window::IdMap;
+using compiz::window::StackOrder;
+
+namespace
+{
+
+const unsigned int nWindows (1500);
+
+struct Window
+{
+    Window () : id (0), label (0), prev (NULL) {}
+
+    unsigned long      id;
+    unsigned long long label;
+    Window             *prev;
+};
+
+unsigned long long &
+labelOf (Window *w)
+{
+    return w->label;
+}
+
+double
+now ()
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* Keeps the optimiser from throwing the work away */
+volatile unsigned long sink;
+
+}
+
+int
+main (int argc, char **argv)
+{
+    int                               iterations = argc > 1 ? atoi (argv[1]) : 2000000;
+    std::vector<Window>               windows (nWindows);
+    std::list<Window *>               stack;
+    StackOrder<Window *>              order (stack, labelOf);
+    std::map<unsigned long, Window *> map;
+    IdMap<Window *>                   idMap;
+    std::vector<unsigned long>        lookups (4096);
+    std::vector<Window *>             pairs (4096 * 2);
+
+    srand (3);
+
+    for (unsigned int i = 0; i < nWindows; ++i)
+    {
+	Window &w = windows[i];
+
+	w.id = ((i % 6 + 1) << 21) + i;
+	w.prev = stack.empty () ? NULL : stack.back ();
+	stack.push_back (&w);
+	order.inserted (--stack.end ());
+
+	map[w.id] = &w;
+	idMap.insert (w.id, &w);
+    }
+
+    /* Mostly known windows, some ids we don't manage */
+    for (unsigned int i = 0; i < lookups.size (); ++i)
+	lookups[i] = rand () % 8 ? windows[rand () % nWindows].id :
+				   (7 << 21) + rand ();
+
+    for (unsigned int i = 0; i < pairs.size (); ++i)
+	pairs[i] = &windows[rand () % nWindows];
+
+    printf ("%u windows, %d iterations\n", nWindows, iterations);
+
+    double start = now ();
+
+    for (int n = 0; n < iterations; ++n)
+    {
+	std::map<unsigned long, Window *>::iterator it =
+	    map.find (lookups[n & 4095]);
+
+	if (it != map.end ())
+	    sink += it->second->id;
+    }
+
+    double mapTime = now () - start;
+
+    start = now ();
+
+    for (int n = 0; n < iterations; ++n)
+    {
+	Window *w = idMap.find (lookups[n & 4095]);
+
+	if (w)
+	    sink += w->id;
+    }
+
+    double idMapTime = now () - start;
+
+    /* Is a below b? Walk down from b like the old code */
+    int walks = iterations / 100;
+
+    start = now ();
+
+    for (int n = 0; n < walks; ++n)
+    {
+	Window *a = pairs[(n & 4095) * 2];
+	Window *b = pairs[(n & 4095) * 2 + 1];
+	bool   above = false;
+
+	for (Window *w = b->prev; w; w = w->prev)
+	    if (w == a)
+	    {
+		above = true;
+		break;
+	    }
+
+	sink += above;
+    }
+
+    double walkTime = now () - start;
+
+    start = now ();
+
+    for (int n = 0; n < iterations; ++n)
+    {
+	Window *a = pairs[(n & 4095) * 2];
+	Window *b = pairs[(n & 4095) * 2 + 1];
+
+	sink += order.above (b, a);
+    }
+
+    double labelTime = now () - start;
+
+    printf ("%-24s %8.2f ns/lookup\n", "std::map find",
+	    mapTime * 1000000.0 / iterations);
+    printf ("%-24s %8.2f ns/lookup %8.2fx\n", "IdMap find",
+	    idMapTime * 1000000.0 / iterations, mapTime / idMapTime);
+    printf ("%-24s %8.2f ns/compare\n", "walking the stack",
+	    walkTime * 1000000.0 / walks);
+    printf ("%-24s %8.2f ns/compare %8.2fx\n", "comparing labels",
+	    labelTime * 1000000.0 / iterations,
+	    walkTime * iterations / (labelTime * walks));
+
+    return 0;
+}
@@ -0,0 +1,657 @@
+/*
+ * Copyright © 2026 Compiz Project
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the Compiz Project not be used in advertising or publicity pertaining
+ * to distribution of the software without specific, written prior
+ * permission. The Compiz Project makes no representations about the
+ * suitability of this software for any purpose. It is provided "as is"
+ * without express or implied warranty.
+ *
+ * THE COMPIZ PROJECT DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE COMPIZ PROJECT BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <map>
+#include <algorithm>
+
+#include "windowidmap.h"
+#include "windowstackorder.h"
+#include "windowpaintorder.h"
+#include "windowspatialindex.h"
+
+using compiz::window::IdMap;
+using compiz::window::StackOrder;
+using compiz::window::PaintOrder;
+using compiz::window::SpatialIndex;
+
+namespace
+{
+struct Entry
+{
+    Entry () : label (0) {}
+
+    unsigned long long label;
+};
+
+unsigned long long &
+labelOf (Entry *e)
+{
+    return e->label;
+}
+
+typedef StackOrder<Entry *> Order;
+
+void
+expectOrdered (Order::List &list)
+{
+    unsigned long long last = 0;
+
+    for (Order::iterator it = list.begin (); it != list.end (); ++it)
+    {
+	ASSERT_LT (last, (*it)->label);
+	last = (*it)->label;
+    }
+}
+
+struct Win
+{
+    Win () : below (NULL), above (NULL), destroyed (false) {}
+
+    Win  *below;
+    Win  *above;
+    bool destroyed;
+
+    PaintOrder<Win *>::Entry entry;
+};
+
+PaintOrder<Win *>::Entry &
+entryOf (Win *w)
+{
+    return w->entry;
+}
+
+Win *
+belowOf (Win *w)
+{
+    return w->below;
+}
+
+bool
+heldBelow (Win *dw, Win *w)
+{
+    return dw->destroyed && dw->above == w;
+}
+
+/* Does what core does to its stack and the paint order */
+class PaintOrderStack
+{
+    public:
+
+	PaintOrderStack () :
+	    order (stack, entryOf, belowOf, heldBelow)
+	{
+	}
+
+	void insert (Win *w, Win *above)
+	{
+	    std::list<Win *>::iterator it = stack.begin ();
+
+	    if (above)
+	    {
+		while (*it != above)
+		    ++it;
+		++it;
+	    }
+
+	    w->below = above;
+	    w->above = it == stack.end () ? NULL : *it;
+
+	    if (w->below)
+		w->below->above = w;
+	    if (w->above)
+		w->above->below = w;
+
+	    stack.insert (it, w);
+	    order.inserted (w);
+	}
+
+	void unhook (Win *w)
+	{
+	    stack.remove (w);
+
+	    if (w->below)
+		w->below->above = w->above;
+	    if (w->above)
+		w->above->below = w->below;
+
+	    w->below = w->above = NULL;
+	}
+
+	void restack (Win *w, Win *above)
+	{
+	    unhook (w);
+	    insert (w, above);
+	}
+
+	void destroy (Win *w)
+	{
+	    Win *above = w->above;
+
+	    unhook (w);
+	    w->above     = above;
+	    w->destroyed = true;
+	}
+
+	void remove (Win *w, Win *windows, int n)
+	{
+	    order.remove (w);
+
+	    for (int i = 0; i < n; ++i)
+		if (windows[i].destroyed && windows[i].above == w)
+		    windows[i].above = w->above;
+	}
+
+	std::list<Win *>  stack;
+	PaintOrder<Win *> order;
+};
+
+std::list<Win *>
+paintList (Win *windows, const char *order)
+{
+    std::list<Win *> list;
+
+    for (; *order; ++order)
+	list.push_back (&windows[*order - 'a']);
+
+    return list;
+}
+
+struct Box
+{
+    int x, y, width, height;
+
+    SpatialIndex<Box *>::Entry entry;
+};
+
+SpatialIndex<Box *>::Entry &
+entryOf (Box *b)
+{
+    return b->entry;
+}
+
+std::vector<Box *>
+sorted (std::vector<Box *> boxes)
+{
+    std::sort (boxes.begin (), boxes.end ());
+    return boxes;
+}
+
+void
+place (SpatialIndex<Box *> &index, Box &b, int x, int y, int width, int height)
+{
+    b.x      = x;
+    b.y      = y;
+    b.width  = width;
+    b.height = height;
+
+    index.update (&b, x, y, width, height);
+}
+}
+
+TEST (WindowIdMap, FindsWhatWasInserted)
+{
+    IdMap<int> map;
+
+    map.insert (0x1a00001, 1);
+    map.insert (0x1a00002, 2);
+    map.insert (0x2c00001, 3);
+
+    EXPECT_EQ (1, map.find (0x1a00001));
+    EXPECT_EQ (2, map.find (0x1a00002));
+    EXPECT_EQ (3, map.find (0x2c00001));
+    EXPECT_EQ (0, map.find (0x2c00002));
+    EXPECT_EQ (3u, map.size ());
+
+    map.insert (0x1a00002, 4);
+    EXPECT_EQ (4, map.find (0x1a00002));
+    EXPECT_EQ (3u, map.size ());
+}
+
+TEST (WindowIdMap, NoneIsNeverStored)
+{
+    IdMap<int> map;
+
+    map.insert (0, 1);
+    EXPECT_EQ (0u, map.size ());
+    EXPECT_EQ (0, map.find (0));
+}
+
+TEST (WindowIdMap, EraseKeepsCollidingEntriesReachable)
+{
+    IdMap<int> map;
+
+    /* Enough consecutive ids to force probing and several grows */
+    for (int i = 1; i <= 1000; ++i)
+	map.insert (0x3e00000 + i, i);
+
+    for (int i = 1; i <= 1000; i += 2)
+	map.erase (0x3e00000 + i);
+
+    EXPECT_EQ (500u, map.size ());
+
+    for (int i = 1; i <= 1000; ++i)
+	EXPECT_EQ (i % 2 ? 0 : i, map.find (0x3e00000 + i));
+}
+
+TEST (WindowIdMap, AgreesWithStdMap)
+{
+    IdMap<int>              map;
+    std::map<unsigned long, int> reference;
+
+    srand (7);
+
+    for (int n = 0; n < 20000; ++n)
+    {
+	unsigned long id = (rand () % 4) << 21 | (rand () % 512 + 1);
+
+	switch (rand () % 3)
+	{
+	    case 0:
+		map.insert (id, n + 1);
+		reference[id] = n + 1;
+		break;
+	    case 1:
+		map.erase (id);
+		reference.erase (id);
+		break;
+	    default:
+	    {
+		std::map<unsigned long, int>::iterator it = reference.find (id);
+
+		ASSERT_EQ (it == reference.end () ? 0 : it->second, map.find (id));
+		break;
+	    }
+	}
+
+	ASSERT_EQ (reference.size (), map.size ());
+    }
+}
+
+TEST (WindowStackOrder, LabelsFollowTheList)
+{
+    Order::List list;
+    Order       order (list, labelOf);
+    Entry       entries[200];
+
+    srand (11);
+
+    for (int i = 0; i < 200; ++i)
+    {
+	Order::iterator it = list.begin ();
+
+	std::advance (it, list.empty () ? 0 : rand () % (list.size () + 1));
+	order.inserted (list.insert (it, &entries[i]));
+
+	expectOrdered (list);
+
+	if (rand () % 4 == 0)
+	{
+	    it = list.begin ();
+	    std::advance (it, rand () % list.size ());
+	    list.erase (it);
+	}
+    }
+
+    Order::iterator a = list.begin ();
+    Order::iterator b = list.end ();
+
+    --b;
+    EXPECT_TRUE (order.above (*b, *a));
+    EXPECT_FALSE (order.above (*a, *b));
+}
+
+TEST (WindowStackOrder, RaisingToTheTopRarelyRelabels)
+{
+    Order::List list;
+    Order       order (list, labelOf);
+    Entry       entries[10];
+
+    for (int i = 0; i < 10; ++i)
+	order.inserted (list.insert (list.end (), &entries[i]));
+
+    /* Keep raising the bottom window */
+    for (int n = 0; n < 100000; ++n)
+    {
+	Entry *e = list.front ();
+
+	list.pop_front ();
+	order.inserted (list.insert (list.end (), e));
+    }
+
+    expectOrdered (list);
+    EXPECT_GE (1u, order.relabels ());
+}
+
+TEST (WindowStackOrder, CrowdedGapsGetRelabelled)
+{
+    Order::List list;
+    Order       order (list, labelOf);
+    Entry       entries[200];
+
+    order.inserted (list.insert (list.end (), &entries[0]));
+    order.inserted (list.insert (list.end (), &entries[1]));
+
+    /* Always insert right above the bottom window */
+    for (int i = 2; i < 200; ++i)
+    {
+	order.inserted (list.insert (++list.begin (), &entries[i]));
+	expectOrdered (list);
+    }
+
+    EXPECT_LT (0u, order.relabels ());
+}
+
+TEST (WindowPaintOrder, FollowsTheStack)
+{
+    PaintOrderStack s;
+    Win             w[4];
+
+    s.insert (&w[0], NULL);
+    s.insert (&w[1], &w[0]);
+    s.insert (&w[2], NULL);
+    s.insert (&w[3], &w[1]);
+
+    EXPECT_EQ (s.stack, s.order.list ());
+
+    s.restack (&w[2], &w[3]);
+    s.restack (&w[3], NULL);
+
+    EXPECT_EQ (s.stack, s.order.list ());
+}
+
+TEST (WindowPaintOrder, DestroyedWindowsStayInPlace)
+{
+    PaintOrderStack s;
+    Win             w[4];
+
+    for (int i = 0; i < 4; ++i)
+	s.insert (&w[i], i ? &w[i - 1] : NULL);
+
+    unsigned int generation = s.order.generation ();
+
+    s.destroy (&w[1]);
+    s.destroy (&w[3]);
+
+    EXPECT_EQ (paintList (w, "abcd"), s.order.list ());
+    EXPECT_EQ (generation, s.order.generation ());
+
+    /* A new top window goes above the destroyed one held below
+     * nothing */
+    Win top;
+
+    s.insert (&top, &w[2]);
+
+    std::list<Win *> expected = paintList (w, "abc");
+
+    expected.push_back (&top);
+    expected.push_back (&w[3]);
+    EXPECT_EQ (expected, s.order.list ());
+}
+
+TEST (WindowPaintOrder, DestroyedWindowsFollowTheWindowAbove)
+{
+    PaintOrderStack s;
+    Win             w[5];
+
+    for (int i = 0; i < 5; ++i)
+	s.insert (&w[i], i ? &w[i - 1] : NULL);
+
+    s.destroy (&w[1]);
+    s.destroy (&w[2]);
+
+    /* b was below c when it went away, c below d, so both come
+     * along when d is raised */
+    s.restack (&w[3], &w[4]);
+    EXPECT_EQ (paintList (w, "aebcd"), s.order.list ());
+
+    s.restack (&w[3], NULL);
+    EXPECT_EQ (paintList (w, "bcdae"), s.order.list ());
+}
+
+TEST (WindowPaintOrder, DeletedWindowsAreRemoved)
+{
+    PaintOrderStack s;
+    Win             w[4];
+
+    for (int i = 0; i < 4; ++i)
+	s.insert (&w[i], i ? &w[i - 1] : NULL);
+
+    s.destroy (&w[1]);
+    s.destroy (&w[2]);
+
+    unsigned int generation = s.order.generation ();
+
+    s.remove (&w[2], w, 4);
+    EXPECT_EQ (paintList (w, "abd"), s.order.list ());
+    EXPECT_NE (generation, s.order.generation ());
+
+    /* b is held below d now */
+    s.restack (&w[3], NULL);
+    EXPECT_EQ (paintList (w, "bda"), s.order.list ());
+}
+
+TEST (WindowPaintOrder, FrozenOrderChangesOnThaw)
+{
+    PaintOrderStack s;
+    Win             w[4];
+
+    for (int i = 0; i < 3; ++i)
+	s.insert (&w[i], i ? &w[i - 1] : NULL);
+
+    s.order.freeze ();
+    s.order.freeze ();
+
+    unsigned int generation = s.order.generation ();
+
+    s.restack (&w[0], &w[2]);
+    s.restack (&w[1], &w[0]);
+    s.insert (&w[3], NULL);
+
+    s.order.thaw ();
+    EXPECT_EQ (paintList (w, "abc"), s.order.list ());
+    EXPECT_EQ (generation, s.order.generation ());
+
+    s.order.thaw ();
+    EXPECT_EQ (s.stack, s.order.list ());
+    EXPECT_NE (generation, s.order.generation ());
+}
+
+TEST (WindowPaintOrder, AgreesWithTheStack)
+{
+    PaintOrderStack s;
+    Win             w[50];
+
+    srand (7);
+
+    for (int i = 0; i < 50; ++i)
+	s.insert (&w[i], i ? &w[rand () % i] : NULL);
+
+    for (int n = 0; n < 2000; ++n)
+    {
+	if (n % 10 == 0)
+	    s.order.freeze ();
+
+	Win *moved = &w[rand () % 50];
+	Win *above = &w[rand () % 50];
+
+	if (moved != above)
+	    s.restack (moved, rand () % 5 ? above : NULL);
+
+	if (n % 10 == 9)
+	{
+	    s.order.thaw ();
+	    ASSERT_EQ (s.stack, s.order.list ());
+	}
+    }
+}
+
+TEST (WindowSpatialIndex, FindsIntersectingWindowsOnce)
+{
+    SpatialIndex<Box *> index (entryOf, 100);
+    Box                 boxes[3];
+    std::vector<Box *>  found;
+
+    index.setBounds (0, 0, 1000, 1000);
+
+    place (index, boxes[0], 0, 0, 450, 450);
+    place (index, boxes[1], 500, 500, 10, 10);
+    place (index, boxes[2], 440, 440, 70, 70);
+
+    index.query (400, 400, 200, 200, found);
+
+    std::vector<Box *> expected;
+
+    expected.push_back (&boxes[0]);
+    expected.push_back (&boxes[1]);
+    expected.push_back (&boxes[2]);
+
+    EXPECT_EQ (sorted (expected), sorted (found));
+
+    found.clear ();
+    index.query (0, 0, 440, 440, found);
+
+    ASSERT_EQ (1u, found.size ());
+    EXPECT_EQ (&boxes[0], found[0]);
+}
+
+TEST (WindowSpatialIndex, EdgesAreHalfOpen)
+{
+    SpatialIndex<Box *> index (entryOf, 100);
+    Box                 box;
+    std::vector<Box *>  found;
+
+    index.setBounds (0, 0, 1000, 1000);
+    place (index, box, 100, 100, 100, 100);
+
+    index.query (200, 100, found);
+    index.query (100, 200, found);
+    index.query (0, 0, 100, 100, found);
+    EXPECT_TRUE (found.empty ());
+
+    index.query (199, 199, found);
+    index.query (199, 199, 1, 1, found);
+    EXPECT_EQ (2u, found.size ());
+}
+
+TEST (WindowSpatialIndex, FollowsMovesAndRemovals)
+{
+    SpatialIndex<Box *> index (entryOf, 100);
+    Box                 boxes[2];
+    std::vector<Box *>  found;
+
+    index.setBounds (0, 0, 1000, 1000);
+    place (index, boxes[0], 0, 0, 50, 50);
+    place (index, boxes[1], 10, 10, 50, 50);
+
+    place (index, boxes[0], 800, 800, 50, 50);
+
+    index.query (20, 20, found);
+    ASSERT_EQ (1u, found.size ());
+    EXPECT_EQ (&boxes[1], found[0]);
+
+    found.clear ();
+    index.query (820, 820, found);
+    ASSERT_EQ (1u, found.size ());
+    EXPECT_EQ (&boxes[0], found[0]);
+
+    index.remove (&boxes[0]);
+    index.remove (&boxes[0]);
+    EXPECT_EQ (1u, index.size ());
+
+    found.clear ();
+    index.query (0, 0, 1000, 1000, found);
+    ASSERT_EQ (1u, found.size ());
+    EXPECT_EQ (&boxes[1], found[0]);
+}
+
+TEST (WindowSpatialIndex, FindsWindowsOutsideTheBounds)
+{
+    SpatialIndex<Box *> index (entryOf, 100);
+    Box                 boxes[2];
+    std::vector<Box *>  found;
+
+    index.setBounds (0, 0, 300, 300);
+    place (index, boxes[0], -500, -500, 100, 100);
+    place (index, boxes[1], 250, 900, 100, 100);
+
+    index.query (-450, -450, found);
+    index.query (300, 950, found);
+    EXPECT_EQ (2u, found.size ());
+
+    found.clear ();
+    index.setBounds (-1000, -1000, 3000, 3000);
+    index.query (-1000, -1000, 3000, 3000, found);
+    EXPECT_EQ (2u, found.size ());
+}
+
+TEST (WindowSpatialIndex, AgreesWithCheckingEveryWindow)
+{
+    SpatialIndex<Box *> index (entryOf, 64);
+    Box                 boxes[200];
+
+    srand (11);
+
+    index.setBounds (-500, -500, 2000, 2000);
+
+    for (int n = 0; n < 5000; ++n)
+    {
+	Box &b = boxes[rand () % 200];
+
+	if (rand () % 2)
+	{
+	    place (index, b, rand () % 3000 - 1000, rand () % 3000 - 1000,
+		   rand () % 800, rand () % 800);
+	    continue;
+	}
+
+	int x = rand () % 3000 - 1000, y = rand () % 3000 - 1000;
+	int width = rand () % 500 + 1, height = rand () % 500 + 1;
+
+	std::vector<Box *> found, reference, at, atReference;
+
+	index.query (x, y, width, height, found);
+	index.query (x, y, at);
+
+	for (int i = 0; i < 200; ++i)
+	{
+	    const Box &r = boxes[i];
+
+	    if (!r.entry.listed)
+		continue;
+
+	    if (r.x < x + width && r.x + r.width > x &&
+		r.y < y + height && r.y + r.height > y)
+		reference.push_back (&boxes[i]);
+
+	    if (r.x <= x && r.x + r.width > x &&
+		r.y <= y && r.y + r.height > y)
+		atReference.push_back (&boxes[i]);
+	}
+
+	ASSERT_EQ (sorted (reference), sorted (found));
+	ASSERT_EQ (sorted (atReference), sorted (at));
+    }
+}
@@ -0,0 +1,159 @@
+/*
+ * Measures what it costs to get through a wrapped function when most
+ * plugins have it disabled, as with glPaint or damageRect on a busy
+ * screen.
+ *
+ * The handler is wrapped 16 times with only every fourth wrapper
+ * enabled. The same chain is also walked by scanning every interface
+ * for the enabled flag, as the dispatch macros used to do.
+ *
+ * Run compiz_wrapsystem_benchmark [iterations]
+ */
+
+#include "core/wrapsystem.h"
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* The dispatch macro as it was before chains were precomputed */
+#define LINEAR_HND_FUNCTN_RETURN(rtype, func, ...)			\
+{									\
+    enum { num = func ## Index };                                       \
+    unsigned int curr = mCurrFunction[num];				\
+    while (mCurrFunction[num] < mInterface.size () &&			\
+           !mInterface[mCurrFunction[num]].enabled[num])		\
+	++mCurrFunction[num];						\
+    if (mCurrFunction[num] < mInterface.size ())			\
+    {									\
+	rtype rv = mInterface[mCurrFunction[num]++].obj-> func (__VA_ARGS__); \
+	mCurrFunction[num] = curr;					\
+	return rv;							\
+    }									\
+    mCurrFunction[num] = curr;						\
+}
+
+namespace
+{
+
+const unsigned int nWrappers (16);
+
+template <typename H>
+class DamageInterface :
+    public WrapableInterface<H, DamageInterface<H> >
+{
+    public:
+	virtual int damage (int v)
+	{
+	    this->mHandler->damageSetEnabled (this, false);
+	    return this->mHandler->damage (v);
+	}
+};
+
+class ChainHandler;
+class LinearHandler;
+
+class ChainHandler :
+    public WrapableHandler<DamageInterface<ChainHandler>, 1>
+{
+    public:
+	WRAPABLE_HND (0, DamageInterface<ChainHandler>, int, damage, int)
+};
+
+class LinearHandler :
+    public WrapableHandler<DamageInterface<LinearHandler>, 1>
+{
+    public:
+	WRAPABLE_HND (0, DamageInterface<LinearHandler>, int, damage, int)
+};
+
+int
+ChainHandler::damage (int v)
+{
+    WRAPABLE_HND_FUNCTN_RETURN (int, damage, v)
+    return v;
+}
+
+int
+LinearHandler::damage (int v)
+{
+    LINEAR_HND_FUNCTN_RETURN (int, damage, v)
+    return v;
+}
+
+template <typename H>
+class Wrapper :
+    public DamageInterface<H>
+{
+    public:
+	Wrapper (H *handler, bool enabled)
+	{
+	    this->setHandler (handler, enabled);
+	}
+
+	~Wrapper ()
+	{
+	    this->setHandler (NULL);
+	}
+
+	int damage (int v)
+	{
+	    return this->mHandler->damage (v + 1);
+	}
+};
+
+double
+now ()
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* Keeps the optimiser from throwing the work away */
+volatile long sink;
+
+template <typename H>
+double
+run (int iterations)
+{
+    H          handler;
+    Wrapper<H> *wrappers[nWrappers];
+
+    for (unsigned int i = 0; i < nWrappers; ++i)
+	wrappers[i] = new Wrapper<H> (&handler, i % 4 == 0);
+
+    double start = now ();
+
+    for (int n = 0; n < iterations; ++n)
+	sink += handler.damage (n);
+
+    double time = now () - start;
+
+    for (unsigned int i = 0; i < nWrappers; ++i)
+	delete wrappers[i];
+
+    return time;
+}
+
+}
+
+int
+main (int argc, char **argv)
+{
+    int iterations = argc > 1 ? atoi (argv[1]) : 5000000;
+
+    printf ("%u wrappers (%u enabled), %d iterations\n",
+	    nWrappers, (nWrappers + 3) / 4, iterations);
+
+    double linearTime = run<LinearHandler> (iterations);
+    double chainTime = run<ChainHandler> (iterations);
+
+    printf ("%-24s %10.2f ms %8.2f ns/call\n", "linear scan",
+	    linearTime, linearTime * 1000000.0 / iterations);
+    printf ("%-24s %10.2f ms %8.2f ns/call %8.2fx\n", "precomputed chain",
+	    chainTime, chainTime * 1000000.0 / iterations,
+	    linearTime / chainTime);
+
+    return 0;
+}
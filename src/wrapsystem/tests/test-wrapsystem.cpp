@@ -59,6 +59,10 @@ public:
     void disableTestMethodReturningVoid() {
         impl.testMethodReturningVoidSetEnabled (this, false);
     }
+
+    void enableTestMethodReturningVoid() {
+        impl.testMethodReturningVoidSetEnabled (this, true);
+    }
 };
 } // (abstract) namespace
 
@@ -227,3 +231,147 @@ TEST(WrapSystem, two_wrappers_get_their_functions_called)
     ASSERT_EQ(2, TestWrapper::testMethodReturningVoidCalls);
 }
 
+
+
+TEST(WrapSystem, a_reenabled_wrapper_gets_its_functions_called)
+{
+    TestWrapper::testMethodReturningVoidCalls = 0;
+
+    TestImplementation imp;
+    {
+        TestWrapper wrap1(imp);
+        TestWrapper wrap2(imp);
+
+        wrap1.disableTestMethodReturningVoid();
+        imp.testMethodReturningVoid();
+
+        ASSERT_EQ(1, TestWrapper::testMethodReturningVoidCalls);
+
+        wrap1.enableTestMethodReturningVoid();
+        imp.testMethodReturningVoid();
+
+        ASSERT_EQ(3, TestWrapper::testMethodReturningVoidCalls);
+    }
+}
+
+TEST(WrapSystem, disabled_wrappers_are_skipped_but_keep_their_index)
+{
+    TestImplementation::testMethodReturningIntCalls = 0;
+    TestWrapper::testMethodReturningVoidCalls = 0;
+
+    TestImplementation imp;
+    {
+        TestWrapper wrap1(imp);
+        TestWrapper wrap2(imp);
+        TestWrapper wrap3(imp);
+
+        wrap2.disableTestMethodReturningVoid();
+        imp.testMethodReturningVoid();
+
+        ASSERT_EQ(2, TestWrapper::testMethodReturningVoidCalls);
+        ASSERT_EQ(0u, imp.testMethodReturningVoidGetCurrentIndex());
+
+        // Other functions keep their own chain
+        ASSERT_EQ(5, imp.testMethodReturningInt(5));
+        ASSERT_EQ(1, TestImplementation::testMethodReturningIntCalls);
+    }
+}
+
+TEST(WrapSystem, wrapped_tells_whether_any_wrapper_is_enabled)
+{
+    TestImplementation imp;
+
+    ASSERT_FALSE(imp.testMethodReturningVoidWrapped());
+    {
+        TestWrapper wrap1(imp);
+        TestWrapper wrap2(imp);
+
+        ASSERT_TRUE(imp.testMethodReturningVoidWrapped());
+
+        wrap1.disableTestMethodReturningVoid();
+        ASSERT_TRUE(imp.testMethodReturningVoidWrapped());
+
+        wrap2.disableTestMethodReturningVoid();
+        ASSERT_FALSE(imp.testMethodReturningVoidWrapped());
+        ASSERT_TRUE(imp.testMethodReturningIntWrapped());
+    }
+    ASSERT_FALSE(imp.testMethodReturningIntWrapped());
+}
+
+TEST(WrapSystem, an_index_past_the_end_skips_all_wrappers)
+{
+    TestImplementation::testMethodReturningVoidCalls = 0;
+    TestWrapper::testMethodReturningVoidCalls = 0;
+
+    TestImplementation imp;
+    {
+        TestWrapper wrap1(imp);
+        TestWrapper wrap2(imp);
+
+        imp.testMethodReturningVoidSetCurrentIndex(32767);
+        imp.testMethodReturningVoid();
+        imp.testMethodReturningVoidSetCurrentIndex(0);
+
+        ASSERT_EQ(0, TestWrapper::testMethodReturningVoidCalls);
+        ASSERT_EQ(1, TestImplementation::testMethodReturningVoidCalls);
+    }
+}
+
+TEST(WrapSystem, the_interface_default_disables_itself_during_a_call)
+{
+    TestImplementation::testMethodReturningIntCalls = 0;
+    TestInterface::testMethodReturningIntCalls = 0;
+
+    // An interface which doesn't override the function
+    // falls through to WRAPABLE_DEF the first time
+    class PassThrough : public TestInterface {
+    public:
+        PassThrough(TestImplementation& impl) : impl(impl)
+        { setHandler(&impl, true); }
+        ~PassThrough()
+        { setHandler(NULL); }
+
+        virtual void testMethodReturningVoid()
+        { TestInterface::testMethodReturningVoid(); }
+        virtual int testMethodReturningInt(int i)
+        { return TestInterface::testMethodReturningInt(i); }
+
+    private:
+        TestImplementation& impl;
+    };
+
+    TestImplementation imp;
+    {
+        PassThrough pass(imp);
+        TestWrapper wrap(imp);
+
+        ASSERT_EQ(7, imp.testMethodReturningInt(7));
+        ASSERT_EQ(7, imp.testMethodReturningInt(7));
+
+        ASSERT_EQ(0, TestInterface::testMethodReturningIntCalls);
+        ASSERT_EQ(2, TestImplementation::testMethodReturningIntCalls);
+    }
+}
+
+#ifdef COMPIZ_WRAPSYSTEM_STATS
+TEST(WrapSystem, dispatch_stats_count_calls_and_depth)
+{
+    TestImplementation imp;
+    {
+        TestWrapper wrap1(imp);
+        TestWrapper wrap2(imp);
+        TestWrapper wrap3(imp);
+
+        wrap2.disableTestMethodReturningVoid();
+        imp.testMethodReturningVoid();
+        imp.testMethodReturningVoid();
+    }
+
+    const TestImplementation::DispatchStats &stats =
+        imp.dispatchStats(TestImplementation::testMethodReturningVoidIndex);
+
+    ASSERT_EQ(2u, stats.calls);
+    ASSERT_EQ(4u, stats.hops);
+    ASSERT_EQ(2u, stats.maxDepth);
+}
+#endif